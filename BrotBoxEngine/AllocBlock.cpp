@@ -1,193 +1,396 @@
 #include "BBE/AllocBlock.h"
-#include "BBE/List.h"
-#include "BBE/Math.h"
-#include "BBE/Logging.h"
+#include "BBE/Error.h"
+#include <atomic>
 #include <cstdlib>
-#include <vector>
-#include <array>
+#include <cstring>
 #include <mutex>
-#define EASY_ALLOC
+#include <new>
+
+#if defined(__EMSCRIPTEN__)
+// Emscripten's mmap is an emulation on top of malloc anyway, so we use aligned_alloc directly.
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define BBE_ALLOC_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define BBE_ALLOC_ASAN
+#endif
+#endif
+
+#ifdef BBE_ALLOC_ASAN
+#include <sanitizer/asan_interface.h>
+// Blocks that sit in a free list are poisoned (except for the free list link) so that ASan still reports use after
+// free, even though it no longer sees the individual allocations through malloc.
+#define BBE_POISON(addr, size)   ASAN_POISON_MEMORY_REGION(addr, size)
+#define BBE_UNPOISON(addr, size) ASAN_UNPOISON_MEMORY_REGION(addr, size)
+#else
+#define BBE_POISON(addr, size)   ((void)(addr), (void)(size))
+#define BBE_UNPOISON(addr, size) ((void)(addr), (void)(size))
+#endif
 
+// Layout
+// ------
+// Small allocations (up to MAX_SMALL_SIZE) are rounded up to one of AMOUNT_OF_SIZE_CLASSES size classes. Blocks of
+// a size class are carved out of spans. A span is a SPAN_SIZE big, SPAN_SIZE aligned chunk of memory that is owned
+// by exactly one thread cache and only contains blocks of a single size class. Its header sits at the start of the
+// span, so the owner of any small block can be found by masking its address.
+//
+// Every thread has its own cache with one free list per size class. Allocating and freeing blocks that belong to
+// the current thread does not need any synchronization. Blocks that are freed by a different thread are pushed on
+// a lock free stack of the owning cache, which the owner drains the next time one of its free lists runs empty.
+//
+// Caches of threads that ended are kept alive and handed to the next new thread, so blocks that are still alive
+// always have a valid owner to return to. Spans are never given back to the OS.
+//
+// Allocations bigger than MAX_SMALL_SIZE are served directly by the OS (mmap/VirtualAlloc) and returned on free.
 
-static bool isBlockZero(void* ptr, size_t size)
+static constexpr size_t SPAN_SIZE = 256 * 1024;
+static constexpr size_t SPAN_HEADER_SIZE = 64;
+static constexpr size_t MAX_SMALL_SIZE = 32 * 1024;
+static constexpr size_t AMOUNT_OF_SIZE_CLASSES = bbe::INTERNAL::AMOUNT_OF_SIZE_CLASSES;
+static constexpr size_t PAGE_SIZE = 4096;
+
+static size_t log2Floor(size_t val)
 {
-	const char* cptr = (const char*)ptr;
-	return cptr[0] == 0 && !memcmp(cptr, cptr + 1, size - 1);
+	size_t retVal = 0;
+	while (val >>= 1) retVal++;
+	return retVal;
 }
 
-static std::array<std::vector<void*>, 64> storedBlocks; // Can't be a bbe::List, because bbe::List depends on this allocator.
-static constexpr size_t BBE_PAGE_SIZE = 4096;
-static bool allocatorShutdown = false;
-static std::mutex mutex;
+// 16 byte steps up to 128 bytes, after that 4 classes per power of two (160, 192, 224, 256, 320, ...).
+static size_t sizeToClass(size_t size)
+{
+	if (size <= 128) return (size + 15) / 16 - 1;
+	const size_t log = log2Floor(size - 1);
+	const size_t step = ((size_t)1) << (log - 2);
+	const size_t sub = (size - 1 - (((size_t)1) << log)) / step;
+	return 8 + (log - 7) * 4 + sub;
+}
 
-void bbe::INTERNAL::allocCleanup()
+static size_t classToSize(size_t sizeClass)
 {
-	std::lock_guard<std::mutex> guard(mutex);
-	allocatorShutdown = true;
-	for (size_t i = 0; i < storedBlocks.size(); i++)
-	{
-		for (size_t k = 0; k < storedBlocks[i].size(); k++)
-		{
-			std::free(storedBlocks[i][k]);
-		}
-		storedBlocks[i].clear();
-	}
+	if (sizeClass < 8) return (sizeClass + 1) * 16;
+	const size_t log = 7 + (sizeClass - 8) / 4;
+	const size_t sub = (sizeClass - 8) % 4;
+	return (((size_t)1) << log) + (sub + 1) * (((size_t)1) << (log - 2));
 }
 
-static void checkBlockHealth()
+static_assert(AMOUNT_OF_SIZE_CLASSES == 40, "Size class count does not match the class layout.");
+
+static void* osAllocate(size_t size, size_t alignment)
 {
-#ifdef _DEBUG
-	for (size_t i = 0; i < storedBlocks.size(); i++)
+#if defined(__EMSCRIPTEN__)
+	return std::aligned_alloc(alignment, size);
+#elif defined(_WIN32)
+	if (alignment <= 64 * 1024)
 	{
-		const size_t size = (((size_t)1) << (i));
-		for (size_t k = 0; k < storedBlocks[i].size(); k++)
-		{
-			void* block = storedBlocks[i][k];
-			if (!isBlockZero(block, size))
-			{
-				bbe::Crash(bbe::Error::IllegalState);
-			}
-		}
+		// VirtualAlloc already aligns to the 64 KiB allocation granularity.
+		return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
 	}
+	// Reserve enough to find an aligned address within and only commit that part. The rest stays reserved address
+	// space, which is only relevant for spans, which are never released anyway.
+	char* reserved = (char*)VirtualAlloc(nullptr, size + alignment, MEM_RESERVE, PAGE_NOACCESS);
+	if (!reserved) return nullptr;
+	char* aligned = (char*)(((uintptr_t)reserved + alignment - 1) & ~(uintptr_t)(alignment - 1));
+	return VirtualAlloc(aligned, size, MEM_COMMIT, PAGE_READWRITE);
+#else
+	const size_t mapSize = alignment <= PAGE_SIZE ? size : size + alignment;
+	void* mapped = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapped == MAP_FAILED) return nullptr;
+	if (alignment <= PAGE_SIZE) return mapped;
+
+	char* aligned = (char*)(((uintptr_t)mapped + alignment - 1) & ~(uintptr_t)(alignment - 1));
+	const size_t frontTrim = aligned - (char*)mapped;
+	const size_t backTrim = mapSize - frontTrim - size;
+	if (frontTrim) munmap(mapped, frontTrim);
+	if (backTrim) munmap(aligned + size, backTrim);
+	return aligned;
 #endif
 }
 
-bbe::AllocBlock bbe::allocateBlock(size_t size)
+static void osFree(void* ptr, size_t size)
 {
-#ifdef EASY_ALLOC
-	bbe::AllocBlock ab;
-	ab.size = size;
-	ab.data = malloc(size);
-	return ab;
+#if defined(__EMSCRIPTEN__)
+	std::free(ptr);
+#elif defined(_WIN32)
+	VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+	munmap(ptr, size);
 #endif
-	std::lock_guard<std::mutex> guard(mutex);
-	checkBlockHealth();
-	if (size == 0) return AllocBlock{ nullptr, 0 };
+}
 
-	auto access = bbe::Math::log2Floor((uint32_t)size);
-	if (!bbe::Math::isPowerOfTwo(size))
+struct FreeNode
+{
+	FreeNode* next;
+};
+
+struct ThreadCache;
+
+struct alignas(SPAN_HEADER_SIZE) SpanHeader
+{
+	ThreadCache* owner;
+	size_t sizeClass;
+};
+static_assert(sizeof(SpanHeader) <= SPAN_HEADER_SIZE);
+
+static SpanHeader* spanOf(void* ptr)
+{
+	return (SpanHeader*)((uintptr_t)ptr & ~(uintptr_t)(SPAN_SIZE - 1));
+}
+
+struct SizeClassCache
+{
+	FreeNode* freeList = nullptr;
+	char* bumpCurrent = nullptr; // Not yet handed out part of the newest span.
+	char* bumpEnd = nullptr;
+
+	// Only written by the owning thread, but read by getAllocStats() from any thread.
+	std::atomic<uint64_t> hits = 0;
+	std::atomic<uint64_t> misses = 0;
+	std::atomic<uint64_t> frees = 0;
+};
+
+struct ThreadCache
+{
+	SizeClassCache classes[AMOUNT_OF_SIZE_CLASSES];
+	std::atomic<FreeNode*> remoteFrees = nullptr;
+	std::atomic_bool orphaned = false;
+	ThreadCache* nextCache = nullptr;
+};
+
+static void bumpCounter(std::atomic<uint64_t>& counter)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+static std::mutex registryMutex;
+static ThreadCache* allCaches = nullptr;
+static std::atomic<uint64_t> largeLiveBytes = 0;
+static std::atomic<uint64_t> largeAllocations = 0;
+static std::atomic<uint64_t> largeFrees = 0;
+
+static ThreadCache* acquireCache()
+{
+	std::lock_guard lg(registryMutex);
+	for (ThreadCache* cache = allCaches; cache; cache = cache->nextCache)
 	{
-		size = (((size_t)1) << (access + 1));
-		access++;
+		bool expected = true;
+		if (cache->orphaned.compare_exchange_strong(expected, false))
+		{
+			return cache;
+		}
 	}
-	
-	if (storedBlocks[access].size() != 0)
+	// Deliberately not going through operator new: It might be replaced by something that uses this allocator.
+	void* mem = osAllocate((sizeof(ThreadCache) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1), PAGE_SIZE);
+	if (!mem) bbe::Crash(bbe::Error::OutOfMemory);
+	ThreadCache* cache = new (mem) ThreadCache();
+	cache->nextCache = allCaches;
+	allCaches = cache;
+	return cache;
+}
+
+static thread_local ThreadCache* threadCache = nullptr;
+static thread_local bool threadCacheReleased = false;
+
+struct ThreadCacheReleaser
+{
+	void arm() {}
+
+	~ThreadCacheReleaser()
 	{
-		void* addr = storedBlocks[access].back();
-		storedBlocks[access].pop_back();
-#ifdef _DEBUG
-		if (!isBlockZero(addr, size))
+		if (threadCache)
 		{
-			bbe::Crash(bbe::Error::IllegalState);
+			threadCache->orphaned = true;
+			threadCache = nullptr;
 		}
-#endif
-		return AllocBlock{ addr, size };
+		threadCacheReleased = true;
 	}
+};
+static thread_local ThreadCacheReleaser threadCacheReleaser;
 
-	void* ptr = std::malloc(size);
-	if (!ptr) bbe::Crash(bbe::Error::NullPointer);
-	return AllocBlock{ ptr , size };
-}
+// Threads may still allocate while their thread_local objects are destroyed (e.g. static destructors at exit).
+// They share this cache, guarded by a mutex.
+static std::mutex lateMutex;
+static ThreadCache* lateCache = nullptr;
 
-void bbe::freeBlock(AllocBlock& block)
+static void drainRemoteFrees(ThreadCache* cache)
 {
-#ifdef EASY_ALLOC
-	free(block.data);
+	FreeNode* node = cache->remoteFrees.exchange(nullptr, std::memory_order_acquire);
+	while (node)
+	{
+		FreeNode* next = node->next;
+		SizeClassCache& scc = cache->classes[spanOf(node)->sizeClass];
+		node->next = scc.freeList;
+		scc.freeList = node;
+		bumpCounter(scc.frees);
+		node = next;
+	}
+}
 
-	block.data = nullptr;
-	block.size = 0;
-	return;
-#endif
-	std::lock_guard<std::mutex> guard(mutex);
-	if (allocatorShutdown)
+static void* allocateSmall(ThreadCache* cache, size_t sizeClass)
+{
+	SizeClassCache& scc = cache->classes[sizeClass];
+	if (!scc.freeList)
 	{
-		std::free(block.data);
+		drainRemoteFrees(cache);
 	}
-	else
+	if (scc.freeList)
 	{
-		checkBlockHealth();
-		if (block.data == nullptr || block.size == 0) return;
-
-		auto access = bbe::Math::log2Floor((uint32_t)block.size);
-		storedBlocks[access].push_back(block.data);
-#ifdef _DEBUG
-		memset(block.data, 0, block.size);
-#endif
+		bumpCounter(scc.hits);
+		FreeNode* node = scc.freeList;
+		BBE_UNPOISON(node, classToSize(sizeClass));
+		scc.freeList = node->next;
+		return node;
 	}
 
-	block.data = nullptr;
-	block.size = 0;
+	bumpCounter(scc.misses);
+	const size_t blockSize = classToSize(sizeClass);
+	if (scc.bumpCurrent + blockSize > scc.bumpEnd || !scc.bumpCurrent)
+	{
+		char* span = (char*)osAllocate(SPAN_SIZE, SPAN_SIZE);
+		if (!span) bbe::Crash(bbe::Error::OutOfMemory);
+		SpanHeader* header = new (span) SpanHeader();
+		header->owner = cache;
+		header->sizeClass = sizeClass;
+		scc.bumpCurrent = span + SPAN_HEADER_SIZE;
+		scc.bumpEnd = span + SPAN_SIZE;
+	}
+	void* retVal = scc.bumpCurrent;
+	scc.bumpCurrent += blockSize;
+	return retVal;
 }
 
-
-
-// From: https://en.cppreference.com/w/cpp/memory/new/operator_new
-// See for license: https://en.cppreference.com/w/Cppreference:FAQ
-// Quote:
-// What can I do with the material on this site?
-// The content is licensed under Creative Commons Attribution - Sharealike 3.0 
-// Unported License(CC - BY - SA) and by the GNU Free Documentation License(GFDL)
-// (unversioned, with no invariant sections, front - cover texts, or back - cover
-// texts).That means that you can use this site in almost any way you like,
-// including mirroring, copying, translating, etc.All we would ask is to provide
-// link back to cppreference.com so that people know where to get the most up -
-// to - date content.In addition to that, any modified content should be released
-// under an equivalent license so that everyone could benefit from the modified
-// versions.
-
-//#define CHECK_ALLOCS
-#ifdef CHECK_ALLOCS
-#include <cstdio>
-#include <cstdlib>
-#include <new>
- 
-// no inline, required by [replacement.functions]/3
-void* operator new(std::size_t sz)
+static void freeSmall(void* ptr, size_t sizeClass)
 {
-    std::printf("1) new(size_t), size = %zu\n", sz);
-    if (sz == 0)
-        ++sz; // avoid std::malloc(0) which may return nullptr on success
- 
-    if (void *ptr = std::malloc(sz))
-        return ptr;
- 
-    throw std::bad_alloc{}; // required by [new.delete.single]/3
+	SpanHeader* span = spanOf(ptr);
+	ThreadCache* owner = span->owner;
+	BBE_POISON((char*)ptr + sizeof(FreeNode), classToSize(sizeClass) - sizeof(FreeNode));
+	FreeNode* node = (FreeNode*)ptr;
+	if (owner == threadCache)
+	{
+		SizeClassCache& scc = owner->classes[sizeClass];
+		node->next = scc.freeList;
+		scc.freeList = node;
+		bumpCounter(scc.frees);
+	}
+	else
+	{
+		FreeNode* head = owner->remoteFrees.load(std::memory_order_relaxed);
+		do
+		{
+			node->next = head;
+		} while (!owner->remoteFrees.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+	}
 }
- 
-// no inline, required by [replacement.functions]/3
-void* operator new[](std::size_t sz)
+
+void bbe::INTERNAL::allocCleanup()
 {
-    std::printf("2) new[](size_t), size = %zu\n", sz);
-    if (sz == 0)
-        ++sz; // avoid std::malloc(0) which may return nullptr on success
- 
-    if (void *ptr = std::malloc(sz))
-        return ptr;
- 
-    throw std::bad_alloc{}; // required by [new.delete.single]/3
+	// Blocks that other threads returned to us are moved back into our free lists. Spans are kept, as blocks of
+	// them might still be alive in objects with static storage duration.
+	if (threadCache)
+	{
+		drainRemoteFrees(threadCache);
+	}
 }
- 
-void operator delete(void* ptr) noexcept
+
+bbe::AllocBlock bbe::allocateBlock(size_t size)
 {
-    std::puts("3) delete(void*)");
-    std::free(ptr);
+	if (size == 0) return AllocBlock{ nullptr, 0 };
+
+	if (size > MAX_SMALL_SIZE)
+	{
+		size = (size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+		void* ptr = osAllocate(size, PAGE_SIZE);
+		if (!ptr) bbe::Crash(bbe::Error::OutOfMemory);
+		largeLiveBytes += size;
+		largeAllocations++;
+		return AllocBlock{ ptr, size };
+	}
+
+	const size_t sizeClass = sizeToClass(size);
+	if (!threadCache && !threadCacheReleased)
+	{
+		threadCache = acquireCache();
+		threadCacheReleaser.arm(); // Makes sure that the releaser is constructed for this thread.
+	}
+	if (threadCache)
+	{
+		return AllocBlock{ allocateSmall(threadCache, sizeClass), classToSize(sizeClass) };
+	}
+
+	std::lock_guard lg(lateMutex);
+	if (!lateCache) lateCache = acquireCache();
+	return AllocBlock{ allocateSmall(lateCache, sizeClass), classToSize(sizeClass) };
 }
- 
-void operator delete(void* ptr, std::size_t size) noexcept
+
+void bbe::freeBlock(AllocBlock& block)
 {
-    std::printf("4) delete(void*, size_t), size = %zu\n", size);
-    std::free(ptr);
+	if (block.data != nullptr && block.size != 0)
+	{
+		if (block.size > MAX_SMALL_SIZE)
+		{
+			osFree(block.data, block.size);
+			largeLiveBytes -= block.size;
+			largeFrees++;
+		}
+		else
+		{
+			freeSmall(block.data, sizeToClass(block.size));
+		}
+	}
+
+	block.data = nullptr;
+	block.size = 0;
 }
- 
-void operator delete[](void* ptr) noexcept
+
+bbe::AllocStats bbe::getAllocStats()
 {
-    std::puts("5) delete[](void* ptr)");
-    std::free(ptr);
+	AllocStats retVal;
+	for (size_t i = 0; i < AMOUNT_OF_SIZE_CLASSES; i++)
+	{
+		retVal.sizeClasses[i].blockSize = classToSize(i);
+	}
+
+	std::lock_guard lg(registryMutex);
+	for (ThreadCache* cache = allCaches; cache; cache = cache->nextCache)
+	{
+		retVal.amountOfThreadCaches++;
+		for (size_t i = 0; i < AMOUNT_OF_SIZE_CLASSES; i++)
+		{
+			const SizeClassCache& scc = cache->classes[i];
+			SizeClassStats& stats = retVal.sizeClasses[i];
+			stats.hits   += scc.hits;
+			stats.misses += scc.misses;
+			stats.frees  += scc.frees;
+		}
+	}
+
+	for (size_t i = 0; i < AMOUNT_OF_SIZE_CLASSES; i++)
+	{
+		const SizeClassStats& stats = retVal.sizeClasses[i];
+		const uint64_t allocations = stats.hits + stats.misses;
+		// Blocks freed by another thread are counted once their owner took them back. Because the counters are
+		// read without stopping the world, a snapshot may briefly see more frees than allocations.
+		if (allocations > stats.frees)
+		{
+			retVal.smallLiveBytes += (allocations - stats.frees) * stats.blockSize;
+		}
+	}
+	retVal.largeLiveBytes = largeLiveBytes;
+	retVal.largeAllocations = largeAllocations;
+	retVal.largeFrees = largeFrees;
+	retVal.liveBytes = retVal.smallLiveBytes + retVal.largeLiveBytes;
+	return retVal;
 }
- 
-void operator delete[](void* ptr, std::size_t size) noexcept
+
+double bbe::SizeClassStats::getHitRate() const
 {
-    std::printf("6) delete[](void*, size_t), size = %zu\n", size);
-    std::free(ptr);
+	if (hits + misses == 0) return 0.0;
+	return (double)hits / (double)(hits + misses);
 }
-#endif
@@ -1,18 +1,61 @@
 #pragma once
 #include <stddef.h>
+#include <stdint.h>
 
 namespace bbe
 {
 	namespace INTERNAL
 	{
 		void allocCleanup();
+
+		constexpr size_t AMOUNT_OF_SIZE_CLASSES = 40;
 	}
 	struct AllocBlock
 	{
 		void* data = nullptr;
 		size_t size = 0;
+		// Set by allocators that hand out blocks of different origins, e.g. FrameAllocator, so that freeing needs no lookup.
+		const void* owner = nullptr;
 	};
 
+	// The returned block may be bigger than requested. Its size must stay untouched until it is given back via freeBlock.
 	AllocBlock allocateBlock(size_t size);
 	void freeBlock(AllocBlock& block);
+
+	// Default allocator of bbe::List. Allocators are stateless and only provide these two static functions.
+	struct HeapAllocator
+	{
+		static AllocBlock allocateBlock(size_t size)
+		{
+			return bbe::allocateBlock(size);
+		}
+
+		static void freeBlock(AllocBlock& block)
+		{
+			bbe::freeBlock(block);
+		}
+	};
+
+	struct SizeClassStats
+	{
+		size_t blockSize = 0;
+		uint64_t hits = 0;   // Allocations that were served by a free list of a thread cache.
+		uint64_t misses = 0; // Allocations that had to carve a new block out of a span.
+		uint64_t frees = 0;
+
+		double getHitRate() const;
+	};
+
+	struct AllocStats
+	{
+		uint64_t liveBytes = 0;
+		uint64_t smallLiveBytes = 0;
+		uint64_t largeLiveBytes = 0;
+		uint64_t largeAllocations = 0;
+		uint64_t largeFrees = 0;
+		size_t amountOfThreadCaches = 0;
+		SizeClassStats sizeClasses[INTERNAL::AMOUNT_OF_SIZE_CLASSES];
+	};
+
+	AllocStats getAllocStats();
 }
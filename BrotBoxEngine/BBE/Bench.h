@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "../BBE/List.h"
+#include "../BBE/String.h"
+#include "../BBE/Random.h"
+
+namespace bbe
+{
+	// Runs games headless with a fixed frame time and deterministically seeded bbe::Randoms and reports how long the
+	// individual phases of a frame took. Any game can be benchmarked without code changes by starting it with the
+	// BBE_BENCH environment variable set, e.g. BBE_BENCH="frames=600,warmup=60,seed=1337,out=result.json".
+	namespace bench
+	{
+		struct Config
+		{
+			bool enabled = false;
+			uint64_t frames = 600;
+			uint64_t warmupFrames = 60;
+			float fixedFrameTime = 1.f / 60.f;
+			uint32_t seed = 1337;
+			bbe::String outputPath;
+		};
+
+		// Keys: frames, warmup, frametime, seed, out. Unknown keys crash, as a typo would silently change the result.
+		Config parseConfig(const char* config);
+
+		// Parsed from BBE_BENCH once. Not enabled if the variable isn't set.
+		const Config& getEnvironmentConfig();
+
+		// Durations of one frame, in seconds.
+		struct FrameTimings
+		{
+			double update = 0;
+			double draw3D = 0;
+			double draw2D = 0;
+			double overhead = 0; // Everything else the engine did during the frame.
+			double frame = 0;
+		};
+
+		// In milliseconds.
+		struct PhaseStats
+		{
+			const char* name = "";
+			double mean = 0;
+			double p50 = 0;
+			double p90 = 0;
+			double p99 = 0;
+			double max = 0;
+		};
+
+		struct Result
+		{
+			bbe::String name;
+			Config config;
+			uint64_t measuredFrames = 0;
+			bbe::List<PhaseStats> phases;
+		};
+
+		PhaseStats computeStats(const char* name, const bbe::List<double>& samplesSeconds);
+		Result computeResult(const bbe::String& name, const Config& config, const bbe::List<FrameTimings>& frames);
+		bbe::String toJson(const Result& result);
+
+		// Constructs the game after the seed is set, so that Randoms that are members of the game are deterministic
+		// as well. Randoms with static storage duration can only be seeded through BBE_BENCH.
+		template<typename GameType>
+		Result run(const Config& config, const char* name)
+		{
+			Config enabledConfig = config;
+			enabledConfig.enabled = true;
+			bbe::Random::setDeterministicSeed(enabledConfig.seed);
+			std::unique_ptr<GameType> game = std::make_unique<GameType>();
+			game->setBenchConfig(enabledConfig);
+			game->start(1280, 720, name);
+			Result retVal = game->getBenchResult();
+			bbe::Random::clearDeterministicSeed();
+			return retVal;
+		}
+	}
+}
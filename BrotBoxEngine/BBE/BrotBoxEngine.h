@@ -2,15 +2,20 @@
 
 #include "../BBE/Array.h"
 #include "../BBE/Async.h"
+#include "../BBE/JobSystem.h"
+#include "../BBE/Bench.h"
+#include "../BBE/Profiler.h"
 #include "../BBE/DynamicArray.h"
 #include "../BBE/Hash.h"
 #include "../BBE/HashMap.h"
 #include "../BBE/List.h"
 #include "../BBE/UndoableObject.h"
+#include "../BBE/UndoableList.h"
 #include "../BBE/Queue.h"
 #include "../BBE/Span.h"
 #include "../BBE/Grid.h"
 #include "../BBE/EndlessGrid.h"
+#include "../BBE/SpatialHash.h"
 #include "../BBE/Stack.h"
 #include "../BBE/BrotTime.h"
 #include "../BBE/TrayIcon.h"
@@ -23,6 +28,7 @@
 #include "../BBE/Error.h"
 
 #include "../BBE/SimpleFile.h"
+#include "../BBE/MappedFile.h"
 #include "../BBE/SimpleUrlRequest.h"
 //#include "../BBE/Socket.h" // NOTE: NOT included because it would include way too much windows related stuff. Could be fixed, probably. TODO.
 
@@ -37,6 +43,11 @@
 #include "../BBE/Game.h"
 #include "../BBE/LightFalloffMode.h"
 #include "../BBE/PointLight.h"
+#include "../BBE/CommandBuffer2D.h"
+#include "../BBE/StreamRing.h"
+#include "../BBE/SkylinePacker.h"
+#include "../BBE/MaxRectsPacker.h"
+#include "../BBE/SeparatingAxis.h"
 #include "../BBE/PrimitiveBrush2D.h"
 #include "../BBE/PrimitiveBrush3D.h"
 #include "../BBE/RenderMode.h"
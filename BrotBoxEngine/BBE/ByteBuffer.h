@@ -74,17 +74,20 @@ namespace bbe
 	{
 	private:
 		bbe::List<bbe::byte>* m_bytes = nullptr; // List* instead of byte* to ensure we are safe when the list resizes.
+		const bbe::byte* m_raw = nullptr; // For memory that never moves, e.g. mapped files.
 		size_t m_start = 0;
 		size_t m_end = 0;
 		bool m_didErr = false;
 		bool m_endiannessFlipped = false;
 
 		void read(bbe::byte* bytes, const bbe::byte* default_, size_t length);
+		const bbe::byte* getData() const;
 
 	public:
 		ByteBufferSpan() = default;
 		explicit ByteBufferSpan(bbe::List<bbe::byte>& bytes);
 		ByteBufferSpan(bbe::List<bbe::byte>& bytes, size_t start, size_t end);
+		ByteBufferSpan(const bbe::byte* data, size_t length);
 
 		template<typename T>
 		void read(T& val, T default_)
@@ -169,6 +172,7 @@ namespace bbe
 
 		bool hasMore() const;
 		size_t getLength() const;
+		const bbe::byte* getRaw() const; // Points at the current read position.
 		void reduceLengthTo(size_t length);
 		void skipBytes(size_t bytes);
 
@@ -199,4 +199,7 @@ namespace bbe
 
 	using Color = Color_t<float, 1.0f>;
 	using Colori = Color_t<byte, 255>;
+
+	template<typename T, T maxValue>
+	struct IsTriviallyRelocatable<Color_t<T, maxValue>> : std::true_type {};
 }
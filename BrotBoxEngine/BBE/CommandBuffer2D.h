@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include "../BBE/List.h"
+#include "../BBE/Color.h"
+#include "../BBE/Vector2.h"
+#include "../BBE/AutoRefCountable.h"
+
+namespace bbe
+{
+	class Image;
+	class Circle;
+	template<typename Vec> class Rectangle_t;
+	using Rectangle = Rectangle_t<bbe::Vector2>;
+
+	// The order is the order in which the pipelines are drawn within a layer if reordering is allowed.
+	enum class DrawCommandType2D : uint8_t
+	{
+		RECT,
+		CIRCLE,
+		VERTEX_INDEX_LIST,
+		IMAGE,
+	};
+
+	struct DrawCommand2D
+	{
+		DrawCommandType2D type = DrawCommandType2D::RECT;
+		int32_t layer = 0;
+		bbe::Color color;
+		// For VERTEX_INDEX_LIST x/y is the offset and width/height the scale of the vertices.
+		float x = 0;
+		float y = 0;
+		float width = 0;
+		float height = 0;
+		float rotation = 0;
+		const bbe::Image* image = nullptr;
+		// What the backend draws the image from. Unlike the image it stays alive until the command is cleared.
+		bbe::AutoRef imageData;
+		// The part of the image that is drawn, in normalized coordinates.
+		float uvX = 0;
+		float uvY = 0;
+		float uvWidth = 1;
+		float uvHeight = 1;
+		uint32_t firstVertex = 0;
+		uint32_t amountOfVertices = 0;
+		uint32_t firstIndex = 0;
+		uint32_t amountOfIndices = 0;
+	};
+
+	// A run of commands that a backend can draw with a single draw call.
+	struct DrawBatch2D
+	{
+		DrawCommandType2D type = DrawCommandType2D::RECT;
+		const bbe::Image* image = nullptr;
+		const bbe::AutoRefCountable* imageData = nullptr;
+		size_t firstCommand = 0;
+		size_t amountOfCommands = 0;
+	};
+
+	// Backend neutral recording of everything PrimitiveBrush2D was asked to draw. The commands are sorted by layer
+	// before they are merged into batches. Within a layer the submission order is kept, unless reordering is allowed,
+	// in which case they are additionally sorted by pipeline and texture. Sorting is stable, so commands that share a
+	// batch are still drawn in the order in which they were recorded.
+	class CommandBuffer2D
+	{
+	private:
+		bbe::List<DrawCommand2D> m_commands;
+		bbe::List<bbe::Vector2> m_vertices;
+		bbe::List<uint32_t> m_indices;
+		bbe::List<DrawBatch2D> m_batches;
+		bool m_reorderWithinLayers = false;
+
+	public:
+		void addRect(int32_t layer, const bbe::Color& color, const bbe::Rectangle& rect, float rotation);
+		void addCircle(int32_t layer, const bbe::Color& color, const bbe::Circle& circle);
+		void addImage(int32_t layer, const bbe::Color& color, const bbe::Rectangle& rect, const bbe::Image& image, const bbe::AutoRef& imageData, float rotation);
+		void addImage(int32_t layer, const bbe::Color& color, const bbe::Rectangle& rect, const bbe::Image& image, const bbe::AutoRef& imageData, float rotation, const bbe::Rectangle& uv);
+		void addVertexIndexList(int32_t layer, const bbe::Color& color, const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, size_t amountOfVertices, const bbe::Vector2& pos, const bbe::Vector2& scale);
+
+		void setReorderWithinLayers(bool reorder);
+		bool isReorderWithinLayers() const;
+
+		// Sorts the commands and rebuilds the batches. The commands must not be modified until clear() is called.
+		void sortAndMerge();
+
+		const bbe::List<DrawCommand2D>& getCommands() const;
+		const bbe::List<DrawBatch2D>& getBatches() const;
+		const bbe::List<bbe::Vector2>& getVertices() const;
+		const bbe::List<uint32_t>& getIndices() const;
+
+		bool isEmpty() const;
+		void clear();
+	};
+}
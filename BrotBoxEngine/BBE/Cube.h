@@ -63,6 +63,9 @@ namespace bbe
 		using Shape3::getVertices;
 		virtual void getVertices(bbe::List<bbe::Vector3> &outVertices) const override;
 
+		// Takes the allocation free bbe::sat path if other is a Cube.
+		virtual bool intersects(const Shape<bbe::Vector3>& other) const override;
+
 		static bbe::List<bbe::PosNormalPair> getRenderVerticesDefault(FaceFlag ff = FaceFlag::ALL);
 		bbe::List<bbe::PosNormalPair> getRenderVertices(FaceFlag ff = FaceFlag::ALL) const;
 		static bbe::List<uint32_t> getRenderIndicesDefault(FaceFlag ff = FaceFlag::ALL);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include "../BBE/List.h"
+
+namespace bbe
+{
+	// Offline block processing for generated sounds. All stages work in place on one signal buffer.
+	namespace dsp
+	{
+		// Amount of samples every job processes at once. Small enough to stay in the cache while all fused stages run
+		// over it, big enough to make scheduling negligible.
+		constexpr size_t CHUNK_SIZE = 4096;
+
+		// Adds sin(phase + i * phaseStep) * mult to signal[i] for every i in [begin, end). Instead of calling sin for
+		// every sample, a few interleaved phasors are rotated. They are computed exactly at begin, so the error can't
+		// grow beyond a single chunk.
+		template<typename T>
+		void addSine(T* signal, size_t begin, size_t end, double phase, double phaseStep, double mult);
+
+		// Multiplies signal[i] with bias + sin(phase + i * phaseStep) * mult for every i in [begin, end).
+		template<typename T>
+		void multiplySine(T* signal, size_t begin, size_t end, double phase, double phaseStep, double bias, double mult);
+
+		// Divides the signal by its maximum absolute amplitude, if there is any.
+		template<typename T>
+		void normalize(bbe::List<T>& signal, bool parallel);
+
+		// One pole low pass: signal[i] = signal[i - 1] + alpha * (signal[i] - signal[i - 1]) for i >= 1. Every chunk is
+		// filtered on its own first, then the state at the end of each chunk is handed to the next one and its decaying
+		// influence is added in a second parallel pass.
+		template<typename T>
+		void lowPass(bbe::List<T>& signal, double alpha, bool parallel);
+
+		// signal[i] += signal[i - delay] * factor for i >= delay, in ascending order, so echos are echoed again.
+		template<typename T>
+		void feedbackDelay(bbe::List<T>& signal, size_t delay, double factor, bool parallel);
+
+		// For stages where sample i reads samples that are at least minDistance before it and were already processed.
+		// Calls func for [first, length) in ascending order, but hands out each block of minDistance samples in parallel
+		// chunks, as nothing inside such a block depends on the block itself.
+		void forEachIndependentBlock(size_t first, size_t length, size_t minDistance, bool parallel, const std::function<void(size_t, size_t)>& func);
+
+		template<typename T>
+		class Graph
+		{
+		public:
+			// Processes [begin, end) of the signal, independently of every other sample.
+			using PointwiseStage = std::function<void(T* signal, size_t begin, size_t end)>;
+			// Processes the whole signal and takes care of its own parallelism.
+			using WholeSignalStage = std::function<void(bbe::List<T>& signal, bool parallel)>;
+
+		private:
+			struct Stage
+			{
+				PointwiseStage pointwise;
+				WholeSignalStage wholeSignal;
+			};
+			bbe::List<Stage> m_stages;
+
+		public:
+			void addPointwise(PointwiseStage&& stage);
+			void addWholeSignal(WholeSignalStage&& stage);
+
+			size_t getAmountOfStages() const;
+			// Consecutive pointwise stages are fused into a single pass over the signal.
+			size_t getAmountOfPasses() const;
+
+			void render(bbe::List<T>& signal, bool parallel) const;
+		};
+	}
+}
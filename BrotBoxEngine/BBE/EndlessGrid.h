@@ -1,22 +1,25 @@
 #pragma once
 
-#include "../BBE/Grid.h"
+#include "../BBE/HashMap.h"
+#include "../BBE/List.h"
 #include "../BBE/Vector2.h"
+#include <bit>
+#include <functional>
 
 namespace bbe
 {
-	template<typename T> class EndlessGrid;
+	template<typename T, int64_t ChunkSize = 64> class EndlessGrid;
 
 
-	template<typename T>
+	template<typename T, int64_t ChunkSize = 64>
 	class EndlessGridColProxy
 	{
 	private:
-		bbe::EndlessGrid<T>& m_parent;
+		bbe::EndlessGrid<T, ChunkSize>& m_parent;
 		int64_t m_col = 0;
 
 	public:
-		EndlessGridColProxy(bbe::EndlessGrid<T>& parent, int64_t col)
+		EndlessGridColProxy(bbe::EndlessGrid<T, ChunkSize>& parent, int64_t col)
 			: m_parent(parent), m_col(col)
 		{}
 
@@ -26,74 +29,204 @@ namespace bbe
 		}
 	};
 
-	template<typename T>
+	// Stores the grid in square chunks of ChunkSize x ChunkSize cells that are created the first time one of their
+	// cells is accessed through get or operator[]. Growing in any direction therefore never copies existing cells and
+	// only the areas that were actually touched use memory. References to cells stay valid until their chunk is evicted.
+	template<typename T, int64_t ChunkSize>
 	class EndlessGrid
 	{
+		static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two.");
+
+	public:
+		// Called with the coordinate of the lowest cell of the chunk and its cells, where the cell (x, y) of the chunk
+		// is cells[x * ChunkSize + y]. Must not access the grid.
+		using EvictionCallback = std::function<void(const bbe::Vector2i64& chunkOrigin, bbe::List<T>& cells)>;
+
 	private:
-		bbe::Vector2i64 m_offset;
-		bbe::Grid<T> m_grid;
+		static constexpr int64_t chunkShift = std::countr_zero((uint64_t)ChunkSize);
+		static constexpr int64_t chunkMask = ChunkSize - 1;
+		static constexpr size_t noSlot = (size_t)-1;
+
+		struct Chunk
+		{
+			bbe::List<T> cells;
+			size_t lruSlot = noSlot;
+		};
+
+		// Links the chunks from the most to the least recently used one. The nodes live in slots instead of the chunks,
+		// because chunks move when the map rehashes.
+		struct LruNode
+		{
+			bbe::Vector2i64 chunkCoord;
+			size_t newer = noSlot;
+			size_t older = noSlot;
+		};
+
+		bbe::HashMap<bbe::Vector2i64, Chunk> m_chunks;
+		bbe::List<LruNode> m_lruNodes;
+		bbe::List<size_t> m_freeLruSlots;
+		size_t m_newestSlot = noSlot;
+		size_t m_oldestSlot = noSlot;
 		T m_defaultValue = {};
+		size_t m_maxAmountOfChunks = 0;
+		EvictionCallback m_evictionCallback;
+
+		// Painting and walking mostly stay within one chunk for a while, which skips the hash lookup. Points into the
+		// cells of a chunk, which don't move when the map rehashes. Only get updates it, so that concurrent calls of
+		// the const functions don't race.
+		bbe::Vector2i64 m_cachedChunkCoord;
+		T* m_cachedCells = nullptr;
 
-		bool isValidIndex(const bbe::Vector2i64& pos) const
+		static bbe::Vector2i64 toChunkCoord(int64_t x, int64_t y)
 		{
-			if(    pos.x >= 0 
-				&& pos.y >= 0 
-				&& pos.x < m_grid.getWidth() 
-				&& pos.y < m_grid.getHeight())
-			{
-				return true;
-			}
-			return false;
+			return { x >> chunkShift, y >> chunkShift };
 		}
 
-		void growIfNeeded(int64_t x_, int64_t y_)
+		static size_t toCellIndex(int64_t x, int64_t y)
 		{
-			const auto startCoord = toNativeCoord(x_, y_);
-			if(isValidIndex(startCoord))
+			return (size_t)((x & chunkMask) * ChunkSize + (y & chunkMask));
+		}
+
+		static bbe::Vector2i64 toChunkOrigin(const bbe::Vector2i64& chunkCoord)
+		{
+			return { chunkCoord.x * ChunkSize, chunkCoord.y * ChunkSize };
+		}
+
+		const T* findCells(const bbe::Vector2i64& chunkCoord) const
+		{
+			if (m_cachedCells != nullptr && m_cachedChunkCoord == chunkCoord) return m_cachedCells;
+			const Chunk* chunk = m_chunks.get(chunkCoord);
+			if (chunk == nullptr) return nullptr;
+			return chunk->cells.getRaw();
+		}
+
+		void unlinkLruSlot(size_t slot)
+		{
+			LruNode& node = m_lruNodes[slot];
+			if (node.newer != noSlot) m_lruNodes[node.newer].older = node.older;
+			else                      m_newestSlot = node.older;
+			if (node.older != noSlot) m_lruNodes[node.older].newer = node.newer;
+			else                      m_oldestSlot = node.newer;
+			node.newer = noSlot;
+			node.older = noSlot;
+		}
+
+		void linkLruSlotAsNewest(size_t slot)
+		{
+			LruNode& node = m_lruNodes[slot];
+			node.older = m_newestSlot;
+			if (m_newestSlot != noSlot) m_lruNodes[m_newestSlot].newer = slot;
+			else                        m_oldestSlot = slot;
+			m_newestSlot = slot;
+		}
+
+		size_t addLruSlot(const bbe::Vector2i64& chunkCoord)
+		{
+			size_t slot = noSlot;
+			if (m_freeLruSlots.isEmpty())
 			{
-				// No need to grow!
-				return;
+				slot = m_lruNodes.getLength();
+				m_lruNodes.add(LruNode{});
 			}
-			// TODO: Double size to minimize allocations. Careful though! It should extend the range in the negative indizes roughly (or exactly?) equally.
-			const int64_t growWidth  = bbe::Math::distanceToRange<int64_t>(0, m_grid.getWidth (), startCoord.x);
-			const int64_t growHeight = bbe::Math::distanceToRange<int64_t>(0, m_grid.getHeight(), startCoord.y);
+			else
+			{
+				slot = m_freeLruSlots.popBack();
+			}
+			m_lruNodes[slot].chunkCoord = chunkCoord;
+			linkLruSlotAsNewest(slot);
+			return slot;
+		}
 
-			const int64_t newGridOffsetX = startCoord.x < 0 ? startCoord.x : 0;
-			const int64_t newGridOffsetY = startCoord.y < 0 ? startCoord.y : 0;
+		void touch(const Chunk& chunk)
+		{
+			if (chunk.lruSlot == m_newestSlot) return;
+			unlinkLruSlot(chunk.lruSlot);
+			linkLruSlotAsNewest(chunk.lruSlot);
+		}
 
-			bbe::Grid<T> newGrid = bbe::Grid<T>(m_grid.getWidth() + growWidth, m_grid.getHeight() + growHeight);
-			newGrid.fill(m_defaultValue);
-			for (int64_t x = 0; x < m_grid.getWidth(); x++)
+		Chunk& addChunk(const bbe::Vector2i64& chunkCoord)
+		{
+			if (m_maxAmountOfChunks != 0 && m_chunks.getLength() >= m_maxAmountOfChunks)
 			{
-				for (int64_t y = 0; y < m_grid.getHeight(); y++)
-				{
-					newGrid[x - newGridOffsetX][y - newGridOffsetY] = m_grid[x][y];
-				}
+				evictLeastRecentlyUsed();
 			}
-			m_grid = std::move(newGrid);
-
-			m_offset.x += newGridOffsetX;
-			m_offset.y += newGridOffsetY;
+			Chunk chunk;
+			chunk.cells.add(m_defaultValue, ChunkSize * ChunkSize);
+			chunk.lruSlot = addLruSlot(chunkCoord);
+			bbe::Vector2i64 key = chunkCoord;
+			m_chunks.add(std::move(key), std::move(chunk));
+			return *m_chunks.get(chunkCoord);
 		}
 
-		bbe::Vector2i64 toNativeCoord(int64_t x, int64_t y) const
+		void evictLeastRecentlyUsed()
 		{
-			return { x - m_offset.x, y - m_offset.y };
+			if (m_oldestSlot != noSlot) evictChunk(m_lruNodes[m_oldestSlot].chunkCoord);
 		}
 
 	public:
 		EndlessGrid() = default;
 
+		EndlessGrid(const EndlessGrid& other) :
+			m_chunks(other.m_chunks),
+			m_lruNodes(other.m_lruNodes),
+			m_freeLruSlots(other.m_freeLruSlots),
+			m_newestSlot(other.m_newestSlot),
+			m_oldestSlot(other.m_oldestSlot),
+			m_defaultValue(other.m_defaultValue),
+			m_maxAmountOfChunks(other.m_maxAmountOfChunks),
+			m_evictionCallback(other.m_evictionCallback)
+		{
+		}
+
+		EndlessGrid(EndlessGrid&& other) noexcept :
+			m_chunks(std::move(other.m_chunks)),
+			m_lruNodes(std::move(other.m_lruNodes)),
+			m_freeLruSlots(std::move(other.m_freeLruSlots)),
+			m_newestSlot(other.m_newestSlot),
+			m_oldestSlot(other.m_oldestSlot),
+			m_defaultValue(std::move(other.m_defaultValue)),
+			m_maxAmountOfChunks(other.m_maxAmountOfChunks),
+			m_evictionCallback(std::move(other.m_evictionCallback))
+		{
+			other.m_newestSlot = noSlot;
+			other.m_oldestSlot = noSlot;
+			other.m_cachedCells = nullptr;
+		}
+
+		EndlessGrid& operator=(const EndlessGrid& other)
+		{
+			if (this == &other) return *this;
+			return *this = EndlessGrid(other);
+		}
+
+		EndlessGrid& operator=(EndlessGrid&& other) noexcept
+		{
+			if (this == &other) return *this;
+			m_chunks = std::move(other.m_chunks);
+			m_lruNodes = std::move(other.m_lruNodes);
+			m_freeLruSlots = std::move(other.m_freeLruSlots);
+			m_newestSlot = other.m_newestSlot;
+			m_oldestSlot = other.m_oldestSlot;
+			other.m_newestSlot = noSlot;
+			other.m_oldestSlot = noSlot;
+			m_defaultValue = std::move(other.m_defaultValue);
+			m_maxAmountOfChunks = other.m_maxAmountOfChunks;
+			m_evictionCallback = std::move(other.m_evictionCallback);
+			m_cachedCells = nullptr;
+			other.m_cachedCells = nullptr;
+			return *this;
+		}
+
 		const T& observe(int64_t x, int64_t y, const T& t) const
 		{
-			auto index = toNativeCoord(x, y);
-			if (!isValidIndex(index))
+			const T* cells = findCells(toChunkCoord(x, y));
+			if (cells == nullptr)
 			{
 				return t;
 			}
 			else
 			{
-				return m_grid[index.x][index.y];
+				return cells[toCellIndex(x, y)];
 			}
 		}
 
@@ -104,24 +237,109 @@ namespace bbe
 
 		T& get(int64_t x, int64_t y)
 		{
-			growIfNeeded(x, y);
-			auto index = toNativeCoord(x, y);
-			return m_grid[index.x][index.y];
+			const bbe::Vector2i64 chunkCoord = toChunkCoord(x, y);
+			if (m_cachedCells == nullptr || m_cachedChunkCoord != chunkCoord)
+			{
+				Chunk* chunk = m_chunks.get(chunkCoord);
+				if (chunk == nullptr) chunk = &addChunk(chunkCoord);
+				touch(*chunk);
+				m_cachedChunkCoord = chunkCoord;
+				m_cachedCells = chunk->cells.getRaw();
+			}
+			return m_cachedCells[toCellIndex(x, y)];
+		}
+
+		EndlessGridColProxy<T, ChunkSize> operator[](int64_t x)
+		{
+			return EndlessGridColProxy<T, ChunkSize>(*this, x);
+		}
+
+		// Calls f(x, y, cell) for every cell of the populated chunks, including the cells of them that were never written.
+		template<typename F>
+		void forEachCell(F&& f)
+		{
+			for (auto entry : m_chunks)
+			{
+				const bbe::Vector2i64 origin = toChunkOrigin(entry.key);
+				T* cells = entry.value.cells.getRaw();
+				for (int64_t x = 0; x < ChunkSize; x++)
+				{
+					for (int64_t y = 0; y < ChunkSize; y++)
+					{
+						f(origin.x + x, origin.y + y, cells[x * ChunkSize + y]);
+					}
+				}
+			}
+		}
+
+		template<typename F>
+		void forEachCell(F&& f) const
+		{
+			for (auto entry : m_chunks)
+			{
+				const bbe::Vector2i64 origin = toChunkOrigin(entry.key);
+				const T* cells = entry.value.cells.getRaw();
+				for (int64_t x = 0; x < ChunkSize; x++)
+				{
+					for (int64_t y = 0; y < ChunkSize; y++)
+					{
+						f(origin.x + x, origin.y + y, cells[x * ChunkSize + y]);
+					}
+				}
+			}
+		}
+
+		size_t getAmountOfChunks() const
+		{
+			return m_chunks.getLength();
+		}
+
+		static constexpr int64_t getChunkSize()
+		{
+			return ChunkSize;
+		}
+
+		// Removes the chunk that contains the cell (x, y). Its cells go back to the default value.
+		bool evict(int64_t x, int64_t y)
+		{
+			return evictChunk(toChunkCoord(x, y));
 		}
 
-		EndlessGridColProxy<T> operator[](int64_t x)
+		bool evictChunk(const bbe::Vector2i64& chunkCoord)
 		{
-			return EndlessGridColProxy<T>(*this, x);
+			Chunk* chunk = m_chunks.get(chunkCoord);
+			if (chunk == nullptr) return false;
+			if (m_cachedCells == chunk->cells.getRaw()) m_cachedCells = nullptr;
+			unlinkLruSlot(chunk->lruSlot);
+			m_freeLruSlots.add(chunk->lruSlot);
+			if (m_evictionCallback) m_evictionCallback(toChunkOrigin(chunkCoord), chunk->cells);
+			m_chunks.remove(chunkCoord);
+			return true;
+		}
+
+		// Once more chunks than this exist, the least recently used one is evicted. 0 means unbounded.
+		void setMaxAmountOfChunks(size_t amount)
+		{
+			m_maxAmountOfChunks = amount;
+			while (m_maxAmountOfChunks != 0 && m_chunks.getLength() > m_maxAmountOfChunks)
+			{
+				evictLeastRecentlyUsed();
+			}
 		}
 
-		size_t getNativeWidth() const
+		void setEvictionCallback(const EvictionCallback& callback)
 		{
-			return m_grid.getWidth();
+			m_evictionCallback = callback;
 		}
 
-		size_t getNativeHeight() const
+		void clear()
 		{
-			return m_grid.getHeight();
+			m_chunks.clear();
+			m_lruNodes.clear();
+			m_freeLruSlots.clear();
+			m_newestSlot = noSlot;
+			m_oldestSlot = noSlot;
+			m_cachedCells = nullptr;
 		}
 
 		void setDefaultValue(const T& t)
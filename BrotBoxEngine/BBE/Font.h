@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <map>
+#include <memory>
 #define STBTT_RASTERIZER_VERSION 1
 #include <stb_truetype.h>
 
@@ -8,7 +9,8 @@
 #include "../BBE/Image.h"
 #include "../BBE/Rectangle.h"
 #include "../BBE/Vector2.h"
-#include "../BBE/Rectangle.h"
+#include "../BBE/SkylinePacker.h"
+#include "../BBE/MappedFile.h"
 
 namespace bbe
 {
@@ -21,31 +23,72 @@ namespace bbe
 
 	class Font
 	{
+	public:
+		// Where a glyph lives inside one of the atlas pages. page is nullptr for glyphs without pixels, e.g. spaces.
+		struct AtlasRegion
+		{
+			const bbe::Image* page = nullptr;
+			bbe::Rectangle uv;
+		};
+
 	private:
 		static constexpr unsigned    DEFAULT_FONT_SIZE  = 20;
+		static constexpr int32_t     ATLAS_PAGE_SIZE    = 512;
+		static constexpr int32_t     ATLAS_PADDING      = 1;
+		static constexpr int32_t     NO_GLYPH           = -1;
 
 		bool isInit              = false;
 		bbe::String fontPath     = "";
 		uint32_t fontSize        = 0;
 		int32_t pixelsFromLineToLine = 0;
 		stbtt_fontinfo fontInfo = {};
-		bbe::ByteBuffer font;
+		// fontInfo points into the mapping, which is shared so that copies of a Font keep it alive as well.
+		std::shared_ptr<const bbe::MappedFile> fontFile;
 
 		int32_t fixedWidth = 0;
 		
-		struct CharData
+		struct Glyph
 		{
-			bbe::Image charImage;
+			int32_t codePoint = 0;
+			float scale = 1.0f;
 			int32_t advanceWidth = 0;
 			int32_t leftSideBearing = 0;
 			int32_t verticalOffset = 0;
+			int32_t width = 0;
+			int32_t height = 0;
+			int32_t page = NO_GLYPH;
+			bbe::Vector2i atlasPos;
 		};
 
-		mutable std::map<std::pair<int32_t, float>, CharData> charDatas;
+		struct AtlasPage
+		{
+			bbe::Image image;
+			bbe::SkylinePacker packer;
+		};
 
-		const CharData& loadCharData(int32_t c, float scale) const;
+		// Most text is ASCII, so codepoints below 256 skip the map and index a flat table per scale instead.
+		struct Latin1Table
+		{
+			float scale = 0.0f;
+			int32_t glyphs[256];
+		};
 
-		const CharData& getCharData(int32_t c, float scale) const;
+		mutable bbe::List<Glyph> glyphs;
+		mutable bbe::List<Latin1Table> latin1Tables;
+		mutable std::map<std::pair<int32_t, float>, int32_t> otherGlyphs;
+		// Glyphs are rasterized lazily into the pages. They are shared between copies of a Font so that pointers
+		// handed out by getAtlasRegion stay valid and the copies never pack into each others spots.
+		mutable bbe::List<std::shared_ptr<AtlasPage>> atlasPages;
+		// Standalone images for renderers that can't draw atlas regions, created on first use.
+		mutable std::map<std::pair<int32_t, float>, std::shared_ptr<bbe::Image>> standaloneImages;
+
+		int32_t& getGlyphSlot(int32_t c, float scale) const;
+		int32_t loadGlyph(int32_t c, float scale) const;
+		int32_t getGlyphIndex(int32_t c, float scale) const;
+		const Glyph& getGlyph(int32_t c, float scale) const;
+		void rasterize(const Glyph& glyph, bbe::List<byte>& outBitmap) const;
+		void addToAtlas(Glyph& glyph) const;
+		void initFontInfo(const bbe::byte* data, unsigned fontSize);
 
 	public:
 		Font();
@@ -54,12 +97,17 @@ namespace bbe
 
 		void load(const bbe::String& fontPath,
 		          unsigned fontSize = DEFAULT_FONT_SIZE);
+		void load(bbe::MappedFile&& file,
+		          unsigned fontSize = DEFAULT_FONT_SIZE);
 
 		const    bbe::String& getFontPath() const;
 		uint32_t getFontSize()              const;
 		int32_t  getPixelsFromLineToLine()  const;
 
 		const bbe::Image& getImage(int32_t c, float scale) const;
+		AtlasRegion getAtlasRegion(int32_t c, float scale) const;
+		size_t getAmountOfAtlasPages() const;
+		const bbe::Image& getAtlasPage(size_t index) const;
 		int32_t getLeftSideBearing(int32_t c) const;
 		int32_t getAdvanceWidth(int32_t c) const;
 		int32_t getVerticalOffset(int32_t c) const;
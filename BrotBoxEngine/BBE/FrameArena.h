@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include "../BBE/AllocBlock.h"
+#include "../BBE/List.h"
+
+namespace bbe
+{
+	// Bump allocator for memory that only lives until the end of the current frame. Allocating is a single atomic
+	// add (so jobs may use it concurrently), freeing does nothing and reset() gives everything back at once. When a
+	// chunk runs out another one is added, and the next reset() merges all chunks into one that fits a whole frame.
+	class FrameArena
+	{
+	private:
+		struct Chunk
+		{
+			bbe::AllocBlock block;
+			std::atomic<size_t> used = 0;
+			Chunk* previous = nullptr;
+		};
+
+		std::atomic<Chunk*> m_pcurrentChunk = nullptr;
+		std::mutex m_growMutex;
+		size_t m_initialCapacity = 0;
+		size_t m_highWaterMark = 0;
+
+		void freeChunks();
+
+	public:
+		explicit FrameArena(size_t initialCapacity = 1024 * 1024);
+		~FrameArena();
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena(FrameArena&&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+		FrameArena& operator=(FrameArena&&) = delete;
+
+		bbe::AllocBlock allocate(size_t size);
+		bool owns(const void* ptr) const;
+
+		// Invalidates every block handed out so far. Must not be called while other threads allocate.
+		void reset();
+
+		size_t getUsedBytes() const;
+		size_t getCapacity() const;
+		size_t getAmountOfChunks() const;
+		size_t getHighWaterMark() const;
+
+		// The active arena is per thread. Jobs start without one, parallelFor passes the arena of the calling thread on
+		// to its chunks.
+		static FrameArena* getActive();
+		static void setActive(FrameArena* arena);
+	};
+
+	// List allocator that takes its memory from the active FrameArena of the calling thread and falls back to the heap
+	// when there is none. Blocks may be freed on any thread and after the arena was deactivated.
+	struct FrameAllocator
+	{
+		static bbe::AllocBlock allocateBlock(size_t size);
+		static void freeBlock(bbe::AllocBlock& block);
+	};
+
+	// For temporaries that are created and destroyed within the same frame. Must not be kept across frames.
+	template<typename T>
+	using FrameList = bbe::List<T, FrameAllocator>;
+}
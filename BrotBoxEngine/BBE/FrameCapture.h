@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "../BBE/List.h"
+#include "../BBE/String.h"
+#include "../BBE/Image.h"
+
+namespace bbe
+{
+	enum class FrameCaptureFormat
+	{
+		PNG, // One file per frame, named path + frameNumber + ".png".
+		PPM, // All frames as binary PPMs (P6) in a single file, e.g. for ffmpeg -f image2pipe -c:v ppm.
+		Y4M, // A YUV4MPEG2 stream (4:4:4, full range BT.601) in a single file that every common encoder reads.
+	};
+
+	enum class FrameCaptureBackpressure
+	{
+		BLOCK, // submit waits until a frame in flight was written. No frame is lost.
+		DROP,  // submit discards the frame. Rendering never waits for the encoders.
+	};
+
+	struct FrameCaptureSettings
+	{
+		FrameCaptureFormat format = FrameCaptureFormat::PNG;
+		FrameCaptureBackpressure backpressure = FrameCaptureBackpressure::BLOCK;
+		size_t maxFramesInFlight = 8;
+		size_t amountOfEncoderThreads = 0; // 0 picks one per hardware thread, leaving one for the renderer.
+		uint32_t framesPerSecond = 60;     // Only written to the Y4M header.
+	};
+
+	// Encodes and writes captured frames on a bounded pool of encoder threads, so that rendering runs at render
+	// speed instead of encoder speed. Frames are encoded in parallel, but written in the order in which they were
+	// submitted, so the output only depends on the submitted frames and never on thread timing.
+	class FrameCapture
+	{
+	private:
+		struct Frame
+		{
+			uint64_t sequence = 0;
+			uint64_t frameNumber = 0;
+			bbe::Image image;
+			bbe::List<bbe::byte> encoded;
+			bool isEncoded = false;
+			bool failed = false;
+		};
+
+		bbe::String m_path;
+		FrameCaptureSettings m_settings;
+		FILE* m_stream = nullptr;
+		int32_t m_streamWidth = -1;
+		int32_t m_streamHeight = -1;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_workAvailable;
+		std::condition_variable m_frameWritten;
+		bbe::List<std::thread> m_encoders;
+		bbe::List<Frame*> m_pending;  // Submitted, not yet picked up by an encoder.
+		bbe::List<Frame*> m_inFlight; // Submitted and not yet written, sorted by sequence.
+		bool m_running = false;
+		bool m_writing = false;
+		uint64_t m_nextSequence = 0;
+		uint64_t m_amountOfWrittenFrames = 0;
+		uint64_t m_amountOfDroppedFrames = 0;
+		std::exception_ptr m_encoderException; // The first one since the last flush.
+
+		void encoderMain();
+		void encode(Frame& frame) const;
+		void writeEncodedFrames(std::unique_lock<std::mutex>& lock);
+
+	public:
+		FrameCapture() = default;
+		~FrameCapture();
+
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture(FrameCapture&&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+		FrameCapture& operator=(FrameCapture&&) = delete;
+
+		// For PNG, path is the prefix of every file. For the stream formats it's the file that is created.
+		void start(const bbe::String& path, const FrameCaptureSettings& settings = FrameCaptureSettings());
+		// Writes everything that is still in flight, then stops the encoder threads. Rethrows like flush, and throws if
+		// the stream could not be closed.
+		void stop();
+		bool isRunning() const;
+
+		// Returns false if the frame was dropped. A Y4M stream has the size of its first frame, frames of a different
+		// size (e.g. after the window was resized) are dropped.
+		bool submit(uint64_t frameNumber, bbe::Image&& image);
+		// Waits until every submitted frame is written. Rethrows the first exception that an encoder ran into or the
+		// first failed write, the frame it was encoding or writing counts as dropped.
+		void flush();
+
+		size_t getAmountOfFramesInFlight() const;
+		uint64_t getAmountOfWrittenFrames() const;
+		uint64_t getAmountOfDroppedFrames() const;
+		const FrameCaptureSettings& getSettings() const;
+	};
+}
@@ -19,6 +19,9 @@
 #include "../BBE/List.h"
 #include "../BBE/StopWatch.h"
 #include "../BBE/BrotTime.h"
+#include "../BBE/FrameArena.h"
+#include "../BBE/Bench.h"
+#include "../BBE/FrameCapture.h"
 
 namespace bbe
 {
@@ -32,6 +35,8 @@ namespace bbe
 	private:
 		const char* videoRenderingPath      = nullptr;
 		const char* screenshotRenderingPath = nullptr;
+		bbe::FrameCaptureSettings m_screenshotRecordingSettings;
+		bbe::FrameCapture m_frameCapture;
 		Window*     m_pwindow               = nullptr;
 		bool        m_started               = false;
 		bool        m_externallyManaged     = false;
@@ -48,10 +53,10 @@ namespace bbe
 		bbe::INTERNAL::SoundManager m_soundManager;
 #endif
 		const char* m_pcurrentPerformanceMeasurementTag = nullptr;
-		bbe::StopWatch m_performanceMeasurement;
+		int64_t m_performanceMeasurementStartNanos = 0;
+		bool m_performanceMeasurementForced = false;
 		struct PerformanceMeasurement
 		{
-			bbe::List<double> perFrame;
 			double max = 0.0;
 			double avg = 0.0;
 			double now = 0.0;
@@ -61,8 +66,11 @@ namespace bbe
 		};
 		bbe::TimePoint nextMinuteMaxMove;
 		std::map<const char*, PerformanceMeasurement> m_performanceMeasurements;
-		bool m_performanceMeasurementsRequired = false;
-		bool m_performanceMeasurementsForced = false;
+		bbe::FrameArena m_frameArena;
+		bbe::bench::Config m_benchConfig;
+		bbe::bench::FrameTimings m_currentFrameTimings;
+		bbe::List<bbe::bench::FrameTimings> m_benchFrames;
+		bbe::bench::Result m_benchResult;
 
 		void innerStart(int windowWidth, int windowHeight, const char* title);
 
@@ -145,9 +153,11 @@ namespace bbe
 
 		void screenshot(const bbe::String& path);
 		void setVideoRenderingMode(const char* path);
-		void setScreenshotRecordingMode(const char* path = "images/img");
+		void setScreenshotRecordingMode(const char* path = "images/img", const bbe::FrameCaptureSettings& settings = bbe::FrameCaptureSettings());
 		void setMaxFrame(uint64_t maxFrame);
 		void setFixedFrametime(float time);
+		void setBenchConfig(const bbe::bench::Config& config); // Must be called before start. Games also pick up BBE_BENCH.
+		const bbe::bench::Result& getBenchResult() const;
 		void setTargetFrametime(float time);
 		float getTargetFrametime() const;
 
@@ -162,7 +172,7 @@ namespace bbe
 		bool isWindowShow() const;
 
 		void endMeasure();
-		void beginMeasure(const char* tag, bool force = false); // CAREFUL: Static string assumed!
+		void beginMeasure(const char* tag, bool force = false); // CAREFUL: Static string assumed! Measures are also recorded as bbe::profiler zones, force records them even if the profiler is disabled.
 		bbe::String getMeasuresString();
 		void drawMeasurement();
 
@@ -176,8 +186,19 @@ namespace bbe
 		void setSoundListener(const bbe::Vector3& pos, const bbe::Vector3& lookDirection);
 		void restartSoundSystem();
 #endif
-#ifdef BBE_RENDERER_OPENGL
+#if defined(BBE_RENDERER_OPENGL) || defined(BBE_RENDERER_NULL)
 		uint32_t getAmountOfDrawcalls() const;
+#endif
+#ifdef BBE_RENDERER_OPENGL
+		// Bytes of per draw data that were streamed to the GPU in the previous frame.
+		size_t getAmountOfStreamedBytes() const;
+		// Cubes, spheres and models of the previous frame that were drawn or skipped by frustum culling.
+		uint32_t getAmountOfVisibleObjects3D() const;
+		uint32_t getAmountOfCulledObjects3D() const;
+#endif
+#ifdef BBE_RENDERER_SOFTWARE
+		// The pixels of the last frame.
+		bbe::Image getFramebuffer();
 #endif
 	};
 }
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <initializer_list>
 #include "../BBE/List.h"
 #include "../BBE/Span.h"
 #include "../BBE/Rectangle.h"
 #include "../BBE/Vector2.h"
+#include "../BBE/JobSystem.h"
+#include "../BBE/Error.h"
 
 namespace bbe
 {
@@ -47,12 +51,220 @@ namespace bbe
 	};
 	using GridIterator = GridIterator_t<bbe::Vector2>;
 
+	// Where the cells of a Grid live in its storage. Each layout maps (x, y) to an index into a storage that may be
+	// larger than width * height, if the layout needs padding.
+	namespace GridLayout
+	{
+		// The default. Each column is contiguous, so operator[](x) hands out a Span.
+		class ColumnMajor
+		{
+		private:
+			size_t m_width = 0;
+			size_t m_height = 0;
+
+		public:
+			static constexpr bool contiguousColumns = true;
+			static constexpr bool dense = true;
+
+			ColumnMajor() = default;
+			ColumnMajor(size_t width, size_t height) : m_width(width), m_height(height) {}
+
+			size_t getStorageSize() const { return m_width * m_height; }
+			size_t getIndex(size_t x, size_t y) const { return x * m_height + y; }
+		};
+
+		class RowMajor
+		{
+		private:
+			size_t m_width = 0;
+			size_t m_height = 0;
+
+		public:
+			static constexpr bool contiguousColumns = false;
+			static constexpr bool dense = true;
+
+			RowMajor() = default;
+			RowMajor(size_t width, size_t height) : m_width(width), m_height(height) {}
+
+			size_t getStorageSize() const { return m_width * m_height; }
+			size_t getIndex(size_t x, size_t y) const { return y * m_width + x; }
+		};
+
+		// Square tiles of TileSize x TileSize cells that are stored one after another, row major within a tile. Both
+		// horizontal and vertical neighbours are mostly in the same tile and therefore in the same few cache lines.
+		template<size_t TileSize = 8>
+		class Tiled
+		{
+			static_assert(TileSize > 0 && (TileSize & (TileSize - 1)) == 0, "TileSize must be a power of two.");
+
+		private:
+			static constexpr size_t shift = std::countr_zero(TileSize);
+			static constexpr size_t mask = TileSize - 1;
+			size_t m_tilesX = 0;
+			size_t m_tilesY = 0;
+
+		public:
+			static constexpr bool contiguousColumns = false;
+			static constexpr bool dense = false;
+
+			Tiled() = default;
+			Tiled(size_t width, size_t height) : m_tilesX((width + mask) >> shift), m_tilesY((height + mask) >> shift) {}
+
+			size_t getStorageSize() const { return m_tilesX * m_tilesY * TileSize * TileSize; }
+			size_t getIndex(size_t x, size_t y) const
+			{
+				return (((y >> shift) * m_tilesX + (x >> shift)) << (2 * shift)) + ((y & mask) << shift) + (x & mask);
+			}
+		};
+
+		// Morton order: the bits of x and y are interleaved, so every aligned power of two square is contiguous. Both
+		// sides are padded to the next power of two, which can make the storage up to four times as large as the grid.
+		class ZOrder
+		{
+		private:
+			size_t m_commonBits = 0;
+			size_t m_totalBits = 0;
+			bool m_empty = true;
+
+			static uint64_t spreadBits(uint64_t v)
+			{
+				v &= 0xFFFFFFFFull;
+				v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+				v = (v | (v <<  8)) & 0x00FF00FF00FF00FFull;
+				v = (v | (v <<  4)) & 0x0F0F0F0F0F0F0F0Full;
+				v = (v | (v <<  2)) & 0x3333333333333333ull;
+				v = (v | (v <<  1)) & 0x5555555555555555ull;
+				return v;
+			}
+
+			static size_t ceilLog2(size_t v)
+			{
+				return v <= 1 ? 0 : (size_t)std::bit_width(v - 1);
+			}
+
+		public:
+			static constexpr bool contiguousColumns = false;
+			static constexpr bool dense = false;
+
+			ZOrder() = default;
+			ZOrder(size_t width, size_t height)
+			{
+				const size_t bitsX = ceilLog2(width);
+				const size_t bitsY = ceilLog2(height);
+				m_commonBits = std::min(bitsX, bitsY);
+				m_totalBits = bitsX + bitsY;
+				m_empty = width == 0 || height == 0;
+			}
+
+			size_t getStorageSize() const { return m_empty ? 0 : (size_t)1 << m_totalBits; }
+			size_t getIndex(size_t x, size_t y) const
+			{
+				// Beyond the common bits only the longer side has bits left, which simply go on top.
+				const size_t commonMask = ((size_t)1 << m_commonBits) - 1;
+				const size_t morton = (size_t)(spreadBits(x & commonMask) | (spreadBits(y & commonMask) << 1));
+				return morton | (((x | y) >> m_commonBits) << (2 * m_commonBits));
+			}
+		};
+	}
+
+	// Column access for layouts whose columns aren't contiguous.
+	template<typename T, typename Layout>
+	class GridColumn
+	{
+	private:
+		T* m_pdata;
+		const Layout* m_layout;
+		size_t m_x;
+		size_t m_height;
+
+	public:
+		GridColumn(T* data, const Layout* layout, size_t x, size_t height) :
+			m_pdata(data),
+			m_layout(layout),
+			m_x(x),
+			m_height(height)
+		{}
+
+		T& operator[](size_t y) const
+		{
+			if (y >= m_height)
+			{
+				debugBreak();
+			}
+			return m_pdata[m_layout->getIndex(m_x, y)];
+		}
+
+		size_t getSize() const
+		{
+			return m_height;
+		}
+	};
+
 	template<typename T>
+	struct GridStencil
+	{
+		// weights[1 + dx][1 + dy] is the factor of the cell at (x + dx, y + dy).
+		T weights[3][3] = {};
+
+		static GridStencil fivePoint(T center, T neighbour)
+		{
+			GridStencil retVal;
+			retVal.weights[1][1] = center;
+			retVal.weights[0][1] = neighbour;
+			retVal.weights[2][1] = neighbour;
+			retVal.weights[1][0] = neighbour;
+			retVal.weights[1][2] = neighbour;
+			return retVal;
+		}
+
+		static GridStencil ninePoint(T center, T edge, T corner)
+		{
+			GridStencil retVal = fivePoint(center, edge);
+			retVal.weights[0][0] = corner;
+			retVal.weights[2][0] = corner;
+			retVal.weights[0][2] = corner;
+			retVal.weights[2][2] = corner;
+			return retVal;
+		}
+	};
+
+	namespace INTERNAL
+	{
+		constexpr size_t stencilBlockSize = 8;
+		constexpr size_t stencilBlockStride = stencilBlockSize + 2;
+
+		// in is a block with its one cell border, out the result for the block. Both are stored row by row.
+		template<typename T>
+		void applyStencilBlock(const T* in, T* out, const GridStencil<T>& stencil)
+		{
+			for (size_t y = 0; y < stencilBlockSize; y++)
+			{
+				for (size_t x = 0; x < stencilBlockSize; x++)
+				{
+					T sum = {};
+					for (size_t dy = 0; dy < 3; dy++)
+					{
+						const T* row = in + (y + dy) * stencilBlockStride + x;
+						sum += stencil.weights[0][dy] * row[0];
+						sum += stencil.weights[1][dy] * row[1];
+						sum += stencil.weights[2][dy] * row[2];
+					}
+					out[y * stencilBlockSize + x] = sum;
+				}
+			}
+		}
+		// SIMD versions.
+		void applyStencilBlock(const float* in, float* out, const GridStencil<float>& stencil);
+		void applyStencilBlock(const double* in, double* out, const GridStencil<double>& stencil);
+	}
+
+	template<typename T, typename Layout = GridLayout::ColumnMajor>
 	class Grid
 	{
 	private:
 		size_t m_width;
 		size_t m_height;
+		Layout m_layout;
 		bbe::List<T> m_pdata;
 
 
@@ -60,30 +272,34 @@ namespace bbe
 		Grid() :
 			m_width(0),
 			m_height(0),
+			m_layout(0, 0),
 			m_pdata()
 		{}
 
 		Grid(size_t width, size_t height) :
 			m_width(width),
 			m_height(height),
+			m_layout(width, height),
 			m_pdata()
 		{
-			m_pdata.resizeCapacityAndLength(m_width * m_height);
+			m_pdata.resizeCapacityAndLength(m_layout.getStorageSize());
 		}
 
 		explicit Grid(const bbe::Vector2i& dim) :
 			m_width(dim.x),
 			m_height(dim.y),
+			m_layout(dim.x, dim.y),
 			m_pdata()
 		{
-			m_pdata.resizeCapacityAndLength(m_width * m_height);
+			m_pdata.resizeCapacityAndLength(m_layout.getStorageSize());
 		}
 
 		/*nonexplicit*/ Grid(const std::initializer_list<std::initializer_list<T>>& il)
 		{
 			m_width = il.begin()->size();
 			m_height = il.size();
-			m_pdata.resizeCapacityAndLength(m_width * m_height);
+			m_layout = Layout(m_width, m_height);
+			m_pdata.resizeCapacityAndLength(m_layout.getStorageSize());
 
 			size_t x = 0;
 			size_t y = 0;
@@ -103,22 +319,47 @@ namespace bbe
 			}
 		}
 
-		bbe::Span<T> operator[](size_t x)
+		auto operator[](size_t x)
 		{
 			if (x >= m_width)
 			{
 				debugBreak();
 			}
-			return bbe::Span(m_pdata.getRaw() + x * m_height, m_height);
+			if constexpr (Layout::contiguousColumns)
+			{
+				return bbe::Span(m_pdata.getRaw() + x * m_height, m_height);
+			}
+			else
+			{
+				return GridColumn<T, Layout>(m_pdata.getRaw(), &m_layout, x, m_height);
+			}
 		}
 
-		bbe::Span<const T> operator[](size_t x) const
+		auto operator[](size_t x) const
 		{
 			if (x >= m_width)
 			{
 				debugBreak();
 			}
-			return bbe::Span(m_pdata.getRaw() + x * m_height, m_height);
+			if constexpr (Layout::contiguousColumns)
+			{
+				return bbe::Span(m_pdata.getRaw() + x * m_height, m_height);
+			}
+			else
+			{
+				return GridColumn<const T, Layout>(m_pdata.getRaw(), &m_layout, x, m_height);
+			}
+		}
+
+		// Unchecked access without going through a column.
+		T& get(size_t x, size_t y)
+		{
+			return m_pdata[m_layout.getIndex(x, y)];
+		}
+
+		const T& get(size_t x, size_t y) const
+		{
+			return m_pdata[m_layout.getIndex(x, y)];
 		}
 
 		T& operator[](const bbe::Vector2i& access)
@@ -153,7 +394,7 @@ namespace bbe
 
 		void fill(T val)
 		{
-			for (size_t i = 0; i < m_width * m_height; i++)
+			for (size_t i = 0; i < m_pdata.getLength(); i++)
 			{
 				m_pdata[i] = val;
 			}
@@ -162,19 +403,118 @@ namespace bbe
 		size_t count(T val) const
 		{
 			size_t retVal = 0;
-			for (size_t i = 0; i < m_width * m_height; i++)
+			if constexpr (Layout::dense)
 			{
-				if (m_pdata[i] == val)
+				for (size_t i = 0; i < m_width * m_height; i++)
 				{
-					retVal++;
+					if (m_pdata[i] == val)
+					{
+						retVal++;
+					}
+				}
+			}
+			else
+			{
+				// The padding must not be counted.
+				for (size_t x = 0; x < m_width; x++)
+				{
+					for (size_t y = 0; y < m_height; y++)
+					{
+						if (get(x, y) == val)
+						{
+							retVal++;
+						}
+					}
 				}
 			}
 			return retVal;
 		}
 
-		bbe::Grid<T> rotated() const
+		template<typename OtherLayout>
+		bbe::Grid<T, OtherLayout> withLayout() const
+		{
+			bbe::Grid<T, OtherLayout> retVal(m_width, m_height);
+			for (size_t x = 0; x < m_width; x++)
+			{
+				for (size_t y = 0; y < m_height; y++)
+				{
+					retVal.get(x, y) = get(x, y);
+				}
+			}
+			return retVal;
+		}
+
+		// Sets every cell of out to the weighted sum of the 3x3 neighbourhood of the same cell in this grid. Cells
+		// outside of the grid are clamped to the border. The grid is processed in 8x8 blocks: Each block is gathered
+		// with its border into a small buffer, computed with SIMD for float and double and written back to out. With
+		// parallel, the blocks are spread over the job system.
+		void stencil(const GridStencil<T>& kernel, Grid& out, bool parallel = false) const
+		{
+			if (&out == this)
+			{
+				bbe::Crash(bbe::Error::IllegalArgument);
+			}
+			if (out.getWidth() != m_width || out.getHeight() != m_height)
+			{
+				out = Grid(m_width, m_height);
+			}
+			if (m_width == 0 || m_height == 0) return;
+
+			constexpr size_t blockSize = INTERNAL::stencilBlockSize;
+			constexpr size_t stride = INTERNAL::stencilBlockStride;
+			const size_t blocksX = (m_width + blockSize - 1) / blockSize;
+			const size_t blocksY = (m_height + blockSize - 1) / blockSize;
+
+			auto processBlocks = [&](size_t begin, size_t end)
+			{
+				T in[stride * stride];
+				T result[blockSize * blockSize];
+				size_t xs[stride];
+				size_t ys[stride];
+				for (size_t block = begin; block < end; block++)
+				{
+					const size_t blockX = (block % blocksX) * blockSize;
+					const size_t blockY = (block / blocksX) * blockSize;
+					for (size_t i = 0; i < stride; i++)
+					{
+						xs[i] = (size_t)std::clamp<int64_t>((int64_t)(blockX + i) - 1, 0, (int64_t)m_width - 1);
+						ys[i] = (size_t)std::clamp<int64_t>((int64_t)(blockY + i) - 1, 0, (int64_t)m_height - 1);
+					}
+					for (size_t ly = 0; ly < stride; ly++)
+					{
+						for (size_t lx = 0; lx < stride; lx++)
+						{
+							in[ly * stride + lx] = get(xs[lx], ys[ly]);
+						}
+					}
+
+					INTERNAL::applyStencilBlock(in, result, kernel);
+
+					const size_t endX = std::min(blockSize, m_width - blockX);
+					const size_t endY = std::min(blockSize, m_height - blockY);
+					for (size_t ly = 0; ly < endY; ly++)
+					{
+						for (size_t lx = 0; lx < endX; lx++)
+						{
+							out.get(blockX + lx, blockY + ly) = result[ly * blockSize + lx];
+						}
+					}
+				}
+			};
+
+			if (parallel)
+			{
+				bbe::jobs::parallelFor(0, blocksX * blocksY, 0, processBlocks);
+			}
+			else
+			{
+				processBlocks(0, blocksX * blocksY);
+			}
+		}
+
+		bbe::Grid<T, Layout> rotated() const
 		{
-			bbe::Grid<T> retVal = bbe::Grid<T>(m_height, m_width);
+			bbe::Grid<T, Layout> retVal = bbe::Grid<T, Layout>(m_height, m_width);
 			for (size_t x = 0; x < m_width; x++)
 			{
 				for (size_t y = 0; y < m_height; y++)
@@ -185,9 +525,9 @@ namespace bbe
 			return retVal;
 		}
 
-		bbe::Grid<T> transposed() const
+		bbe::Grid<T, Layout> transposed() const
 		{
-			bbe::Grid<T> retVal = bbe::Grid<T>(m_height, m_width);
+			bbe::Grid<T, Layout> retVal = bbe::Grid<T, Layout>(m_height, m_width);
 			for (size_t x = 0; x < m_width; x++)
 			{
 				for (size_t y = 0; y < m_height; y++)
@@ -268,7 +608,7 @@ namespace bbe
 
 		bbe::List<bbe::Rectanglei> getAllBiggestRects(const T& value) const
 		{
-			Grid<T> copy = *this;
+			Grid<T, Layout> copy = *this;
 			bbe::List<bbe::Rectanglei> retVal;
 			for (size_t x = 0; x < getWidth(); x++)
 			{
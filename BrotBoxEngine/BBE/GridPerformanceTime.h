@@ -0,0 +1,111 @@
+#pragma once
+
+#include "../BBE/Grid.h"
+#include "../BBE/StopWatch.h"
+#include "../BBE/Logging.h"
+#include <algorithm>
+#include <functional>
+
+namespace bbe
+{
+	namespace test
+	{
+		struct GridLayoutBenchmarkResult
+		{
+			const char* name = "";
+			// Every cell plus its neighbour in the walking direction, with x respectively y as the inner loop.
+			double nanosPerCellWalkX = 0;
+			double nanosPerCellWalkY = 0;
+			double nanosPerCellStencil = 0;
+			double nanosPerCellStencilParallel = 0;
+		};
+
+		namespace INTERNAL
+		{
+			inline double measureGridNanosPerCell(size_t amountOfCells, int32_t runs, const std::function<float()>& func)
+			{
+				double best = 1e300;
+				float sink = 0;
+				for (int32_t i = 0; i < runs; i++)
+				{
+					bbe::StopWatch sw;
+					sink += func();
+					best = std::min(best, (double)sw.getTimeExpiredNanoseconds() / (double)amountOfCells);
+				}
+				volatile float discard = sink;
+				(void)discard;
+				return best;
+			}
+
+			template<typename Layout>
+			GridLayoutBenchmarkResult benchmarkGridLayout(const char* name, size_t size, int32_t runs)
+			{
+				bbe::Grid<float, Layout> grid(size, size);
+				for (size_t x = 0; x < size; x++)
+				{
+					for (size_t y = 0; y < size; y++)
+					{
+						grid.get(x, y) = (float)((x * 7 + y * 13) % 17);
+					}
+				}
+				bbe::Grid<float, Layout> out;
+				const size_t cells = size * size;
+
+				GridLayoutBenchmarkResult result;
+				result.name = name;
+				result.nanosPerCellWalkX = measureGridNanosPerCell(cells, runs, [&]() {
+					float sum = 0;
+					for (size_t y = 0; y < size; y++)
+					{
+						for (size_t x = 0; x + 1 < size; x++)
+						{
+							sum += grid.get(x, y) * grid.get(x + 1, y);
+						}
+					}
+					return sum;
+					});
+				result.nanosPerCellWalkY = measureGridNanosPerCell(cells, runs, [&]() {
+					float sum = 0;
+					for (size_t x = 0; x < size; x++)
+					{
+						for (size_t y = 0; y + 1 < size; y++)
+						{
+							sum += grid.get(x, y) * grid.get(x, y + 1);
+						}
+					}
+					return sum;
+					});
+				const bbe::GridStencil<float> kernel = bbe::GridStencil<float>::fivePoint(0.5f, 0.125f);
+				result.nanosPerCellStencil = measureGridNanosPerCell(cells, runs, [&]() {
+					grid.stencil(kernel, out);
+					return out.get(size / 2, size / 2);
+					});
+				result.nanosPerCellStencilParallel = measureGridNanosPerCell(cells, runs, [&]() {
+					grid.stencil(kernel, out, true);
+					return out.get(size / 2, size / 2);
+					});
+				return result;
+			}
+		}
+
+		// Walks a size x size grid of floats in every layout. A walk against the storage order touches a new cache
+		// line for almost every cell, so the difference between the two walking directions of a layout shows how many
+		// cache misses it avoids.
+		inline bbe::List<GridLayoutBenchmarkResult> gridLayoutPrintSpeed(size_t size = 2048, int32_t runs = 3)
+		{
+			bbe::List<GridLayoutBenchmarkResult> results;
+			results.add(INTERNAL::benchmarkGridLayout<bbe::GridLayout::ColumnMajor>("ColumnMajor", size, runs));
+			results.add(INTERNAL::benchmarkGridLayout<bbe::GridLayout::RowMajor>("RowMajor", size, runs));
+			results.add(INTERNAL::benchmarkGridLayout<bbe::GridLayout::Tiled<8>>("Tiled8", size, runs));
+			results.add(INTERNAL::benchmarkGridLayout<bbe::GridLayout::ZOrder>("ZOrder", size, runs));
+
+			BBELOGLN("Grid layouts, " << size << "x" << size << " floats, ns per cell:");
+			for (size_t i = 0; i < results.getLength(); i++)
+			{
+				const GridLayoutBenchmarkResult& r = results[i];
+				BBELOGLN(r.name << ": walk x " << r.nanosPerCellWalkX << ", walk y " << r.nanosPerCellWalkY << ", stencil " << r.nanosPerCellStencil << ", parallel stencil " << r.nanosPerCellStencilParallel);
+			}
+			return results;
+		}
+	}
+}
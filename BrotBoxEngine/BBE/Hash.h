@@ -2,6 +2,7 @@
 
 
 #include "../BBE/Array.h"
+#include <bit>
 #include <stdint.h>
 #include <type_traits>
 
@@ -11,10 +12,33 @@ namespace bbe
 	uint32_t hash(const T &t)
 	{
 		static_assert(std::is_fundamental<T>::value && !std::is_class<T>::value, "No valid hash function found.");
-		return static_cast<uint32_t>(t);
+		if constexpr (std::is_floating_point<T>::value)
+		{
+			// A plain cast would drop the fraction. 0.0 and -0.0 compare equal, so they have to hash equal.
+			if (t == 0) return 0;
+			if constexpr (sizeof(T) == sizeof(uint32_t)) return std::bit_cast<uint32_t>(t);
+			else if constexpr (sizeof(T) == sizeof(uint64_t))
+			{
+				const uint64_t bits = std::bit_cast<uint64_t>(t);
+				return static_cast<uint32_t>(bits ^ (bits >> 32));
+			}
+			else return hash(static_cast<double>(t));
+		}
+		else if constexpr (sizeof(T) > sizeof(uint32_t))
+		{
+			const uint64_t bits = static_cast<uint64_t>(t);
+			return static_cast<uint32_t>(bits ^ (bits >> 32));
+		}
+		else
+		{
+			return static_cast<uint32_t>(t);
+		}
 	}
 
-
+	// Allows hash containers with keys of type Key to be queried with a Lookup without converting it to a Key first.
+	// Specializations must make sure that bbe::hash and operator== agree between both types.
+	template<typename Key, typename Lookup>
+	struct IsTransparentKey : std::false_type {};
 
 
 
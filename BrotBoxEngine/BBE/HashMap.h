@@ -1,144 +1,486 @@
 #pragma once
 
-#include "../BBE/List.h"
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "../BBE/STLCapsule.h"
+#include "../BBE/AllocBlock.h"
 #include "../BBE/Hash.h"
 #include "../BBE/Error.h"
+#include "../BBE/List.h"
 
 namespace bbe
 {
+	// Open addressing hash map with Robin Hood probing. All entries live in one flat array. Next to it is an array
+	// with the probe distance of each slot, which is all a lookup touches until it finds a candidate with the same
+	// hash. Removing an entry shifts its successors back, so no tombstones are needed. Entries that would end up more
+	// than MAX_DISTANCE slots away from their home slot (only possible with very bad hashes) go to an overflow list
+	// that is searched linearly.
 	template<typename Key, typename Value>
 	class HashMap
 	{
 	private:
-		class HashMapNode
+		struct Entry
 		{
-			friend class HashMap<Key, Value>;
-		public:
-			HashMapNode() = default;
-		private:
-			Key      m_key = {};
-			Value    m_value = {};
-			uint32_t m_hash = 0;
+			uint32_t hash;
+			Key key;
+			Value value;
+		};
 
+		static constexpr size_t  MIN_CAPACITY = 16;
+		static constexpr uint8_t MAX_DISTANCE = 255;
 
-			HashMapNode(const Key &key, const Value &value, const uint32_t _hash)
-				: m_key(key), m_value(value), m_hash(_hash)
-			{
-				//do nothing
-			}
-		};
-		List<List<HashMapNode>> m_buckets;
+		bbe::AllocBlock m_entriesBlock;
+		bbe::AllocBlock m_distancesBlock;
+		bbe::List<Entry> m_overflow;
+		size_t m_capacity = 0;
+		size_t m_length = 0;
 
-	public:
-		HashMap()
+		Entry* getEntries() const
 		{
-			m_buckets.resizeCapacityAndLength(1 << 4);
+			return reinterpret_cast<Entry*>(m_entriesBlock.data);
 		}
 
-		HashMap(const HashMap&)                = default;
-		HashMap(HashMap&&) noexcept            = default;
-		HashMap& operator=(const HashMap&)     = default;
-		HashMap& operator=(HashMap&&) noexcept = default;
+		// 0 marks an empty slot. Otherwise it's the distance from the slot the hash points to, plus one.
+		uint8_t* getDistances() const
+		{
+			return reinterpret_cast<uint8_t*>(m_distancesBlock.data);
+		}
 
-		void clear()
+		// bbe::hash of fundamentals is the identity (and other hashes are often weak in the low bits), so the bits are
+		// mixed before they are used as index. This is the finalizer of MurmurHash3.
+		static uint32_t mixHash(uint32_t h)
 		{
-			m_buckets.clear();
-			m_buckets.resizeCapacityAndLength(1 << 4);
+			h ^= h >> 16;
+			h *= 0x85ebca6b;
+			h ^= h >> 13;
+			h *= 0xc2b2ae35;
+			h ^= h >> 16;
+			return h;
 		}
 
-		size_t getAmountOfBuckets() const
+		// Indices below m_capacity are slots of the table, the ones after it refer to m_overflow.
+		Entry& entryAt(size_t index)
+		{
+			return index < m_capacity ? getEntries()[index] : m_overflow[index - m_capacity];
+		}
+
+		const Entry& entryAt(size_t index) const
 		{
-			return m_buckets.getLength();
+			return index < m_capacity ? getEntries()[index] : m_overflow[index - m_capacity];
 		}
 
-		void add(const Key &key, const Value &value)
+		template<typename LookupKey>
+		size_t findIndex(const LookupKey& key) const
 		{
-			uint32_t _hash = hash(key);
-			uint32_t index = _hash % getAmountOfBuckets();
+			if (m_length == 0) return (size_t)-1;
 
-			for (size_t i = 0; i < m_buckets[index].getLength(); i++)
+			const uint32_t _hash = mixHash(hash(key));
+			const Entry* entries = getEntries();
+			const uint8_t* distances = getDistances();
+			const size_t mask = m_capacity - 1;
+			size_t index = _hash & mask;
+			// Entries are sorted by their distance, so the key can't be further away than the first entry that is
+			// closer to its home slot than we are to ours.
+			for (uint32_t distance = 1; distances[index] >= distance; distance++)
 			{
-				if (key == m_buckets[index][i].m_key)
+				if (distances[index] == distance && entries[index].hash == _hash && entries[index].key == key)
 				{
-					bbe::Crash(bbe::Error::KeyAlreadyUsed);
+					return index;
 				}
+				index = (index + 1) & mask;
 			}
-
-			if (m_buckets[index].getLength() > 4)
+			for (size_t i = 0; i < m_overflow.getLength(); i++)
 			{
-				uint32_t differentHashes = 0;
-				for (size_t i = 0; i < m_buckets[index].getLength(); i++)
+				if (m_overflow[i].hash == _hash && m_overflow[i].key == key)
 				{
-					if (m_buckets[index][i].m_hash != _hash)
-					{
-						differentHashes++;
-						if (differentHashes >= 3)
-						{
-							resize();
-							index = _hash % getAmountOfBuckets();
-							break;
-						}
-					}
+					return m_capacity + i;
 				}
 			}
-
-			m_buckets[index].add(HashMapNode(key, value, _hash));
+			return (size_t)-1;
 		}
 
-		bool contains(const Key &key) const
+		void allocate(size_t capacity)
 		{
-			return get(key) != nullptr;
+			m_capacity = capacity;
+			m_entriesBlock = bbe::allocateBlock(capacity * sizeof(Entry));
+			m_distancesBlock = bbe::allocateBlock(capacity);
+			memset(m_distancesBlock.data, 0, capacity);
 		}
 
-		const Value* get(const Key &key) const
+		void destroyEntries()
 		{
-			uint32_t _hash = hash(key);
-			uint32_t index = _hash % getAmountOfBuckets();
+			Entry* entries = getEntries();
+			uint8_t* distances = getDistances();
+			for (size_t i = 0; i < m_capacity; i++)
+			{
+				if (distances[i] != 0)
+				{
+					entries[i].~Entry();
+					distances[i] = 0;
+				}
+			}
+			m_overflow.clear();
+			m_length = 0;
+		}
 
-			for (size_t i = 0; i < m_buckets[index].getLength(); i++)
+		void insertNew(Entry&& entry)
+		{
+			Entry* entries = getEntries();
+			uint8_t* distances = getDistances();
+			const size_t mask = m_capacity - 1;
+			size_t index = entry.hash & mask;
+			uint8_t distance = 1;
+			while (true)
 			{
-				if (m_buckets[index][i].m_key == key)
+				if (distances[index] == 0)
+				{
+					new (bbe::addressOf(entries[index])) Entry(std::move(entry));
+					distances[index] = distance;
+					m_length++;
+					return;
+				}
+				if (distances[index] < distance)
 				{
-					return &(m_buckets[index][i].m_value);
+					// Robin Hood: The entry that is closer to its home slot has to make room.
+					std::swap(entry, entries[index]);
+					std::swap(distance, distances[index]);
+				}
+				index = (index + 1) & mask;
+				distance++;
+				if (distance == MAX_DISTANCE)
+				{
+					// Only happens with extremely bad hashes. Growing the table wouldn't help if the hashes are equal,
+					// so the entry we carry goes to the overflow list. growIfNeeded still accounts for it.
+					m_overflow.add(std::move(entry));
+					m_length++;
+					return;
 				}
 			}
-			return nullptr;
 		}
 
-		Value* get(const Key& key)
+		void rehash(size_t newCapacity)
 		{
-			uint32_t _hash = hash(key);
-			uint32_t index = _hash % getAmountOfBuckets();
+			Entry* oldEntries = getEntries();
+			uint8_t* oldDistances = getDistances();
+			bbe::AllocBlock oldEntriesBlock = m_entriesBlock;
+			bbe::AllocBlock oldDistancesBlock = m_distancesBlock;
+			const size_t oldCapacity = m_capacity;
+			bbe::List<Entry> oldOverflow = std::move(m_overflow);
 
-			for (size_t i = 0; i < m_buckets[index].getLength(); i++)
+			allocate(newCapacity);
+			m_length = 0;
+			for (size_t i = 0; i < oldCapacity; i++)
 			{
-				if (m_buckets[index][i].m_key == key)
+				if (oldDistances[i] != 0)
 				{
-					return &(m_buckets[index][i].m_value);
+					insertNew(std::move(oldEntries[i]));
+					oldEntries[i].~Entry();
 				}
 			}
-			return nullptr;
+			for (size_t i = 0; i < oldOverflow.getLength(); i++)
+			{
+				insertNew(std::move(oldOverflow[i]));
+			}
+
+			bbe::freeBlock(oldEntriesBlock);
+			bbe::freeBlock(oldDistancesBlock);
 		}
 
-	private:
-		void resize()
+		void growIfNeeded(size_t amountOfEntries)
 		{
-			const size_t newAmountOfContainers = getAmountOfBuckets() * 2;
-			List<List<HashMapNode>> newBuckets;
-			newBuckets.resizeCapacityAndLength(newAmountOfContainers);
+			// Keeps the load factor at or below 7/8.
+			size_t newCapacity = m_capacity == 0 ? MIN_CAPACITY : m_capacity;
+			while (amountOfEntries * 8 > newCapacity * 7)
+			{
+				newCapacity *= 2;
+			}
+			if (newCapacity != m_capacity)
+			{
+				rehash(newCapacity);
+			}
+		}
 
-			for (size_t i = 0; i < m_buckets.getLength(); i++)
+		void copyFrom(const HashMap& other)
+		{
+			if (other.m_capacity == 0) return;
+			allocate(other.m_capacity);
+			const Entry* otherEntries = other.getEntries();
+			Entry* entries = getEntries();
+			memcpy(m_distancesBlock.data, other.m_distancesBlock.data, m_capacity);
+			for (size_t i = 0; i < m_capacity; i++)
 			{
-				for (size_t k = 0; k < m_buckets[i].getLength(); k++)
+				if (getDistances()[i] != 0)
 				{
-					uint32_t _hash = m_buckets[i][k].m_hash;
-					uint32_t index = _hash % newAmountOfContainers;
+					new (bbe::addressOf(entries[i])) Entry(otherEntries[i]);
+				}
+			}
+			m_overflow = other.m_overflow;
+			m_length = other.m_length;
+		}
+
+		void release()
+		{
+			if (m_capacity == 0) return;
+			destroyEntries();
+			bbe::freeBlock(m_entriesBlock);
+			bbe::freeBlock(m_distancesBlock);
+			m_capacity = 0;
+		}
+
+		template<bool isConst>
+		class IteratorBase
+		{
+		private:
+			using MapType = std::conditional_t<isConst, const HashMap, HashMap>;
+			MapType* m_pmap = nullptr;
+			size_t m_index = 0;
 
-					newBuckets[index].add(std::move(m_buckets[i][k]));
+			void skipEmpty()
+			{
+				while (m_index < m_pmap->m_capacity && m_pmap->getDistances()[m_index] == 0)
+				{
+					m_index++;
 				}
 			}
 
-			m_buckets = newBuckets;
+		public:
+			struct KeyValue
+			{
+				const Key& key;
+				std::conditional_t<isConst, const Value&, Value&> value;
+			};
+
+			IteratorBase(MapType* map, size_t index)
+				: m_pmap(map), m_index(index)
+			{
+				skipEmpty();
+			}
+
+			KeyValue operator*() const
+			{
+				auto& entry = m_pmap->entryAt(m_index);
+				return KeyValue{ entry.key, entry.value };
+			}
+
+			IteratorBase& operator++()
+			{
+				m_index++;
+				skipEmpty();
+				return *this;
+			}
+
+			bool operator==(const IteratorBase& other) const
+			{
+				return m_index == other.m_index;
+			}
+
+			bool operator!=(const IteratorBase& other) const
+			{
+				return m_index != other.m_index;
+			}
+		};
+
+	public:
+		using Iterator = IteratorBase<false>;
+		using ConstIterator = IteratorBase<true>;
+
+		HashMap() = default;
+
+		HashMap(const HashMap& other)
+		{
+			copyFrom(other);
+		}
+
+		HashMap(HashMap&& other) noexcept
+			: m_entriesBlock(other.m_entriesBlock), m_distancesBlock(other.m_distancesBlock), m_overflow(std::move(other.m_overflow)), m_capacity(other.m_capacity), m_length(other.m_length)
+		{
+			other.m_entriesBlock = {};
+			other.m_distancesBlock = {};
+			other.m_capacity = 0;
+			other.m_length = 0;
+		}
+
+		HashMap& operator=(const HashMap& other)
+		{
+			if (this == &other) return *this;
+			release();
+			copyFrom(other);
+			return *this;
+		}
+
+		HashMap& operator=(HashMap&& other) noexcept
+		{
+			if (this == &other) return *this;
+			release();
+			std::swap(m_entriesBlock, other.m_entriesBlock);
+			std::swap(m_distancesBlock, other.m_distancesBlock);
+			std::swap(m_overflow, other.m_overflow);
+			std::swap(m_capacity, other.m_capacity);
+			std::swap(m_length, other.m_length);
+			return *this;
+		}
+
+		~HashMap()
+		{
+			release();
+		}
+
+		// Removes all entries but keeps the memory.
+		void clear()
+		{
+			if (m_capacity == 0) return;
+			destroyEntries();
+		}
+
+		void reserve(size_t amountOfEntries)
+		{
+			growIfNeeded(amountOfEntries);
+		}
+
+		size_t getLength() const
+		{
+			return m_length;
+		}
+
+		bool isEmpty() const
+		{
+			return m_length == 0;
+		}
+
+		size_t getAmountOfBuckets() const
+		{
+			return m_capacity;
+		}
+
+		void add(const Key& key, const Value& value)
+		{
+			if (contains(key))
+			{
+				bbe::Crash(bbe::Error::KeyAlreadyUsed);
+			}
+			growIfNeeded(m_length + 1);
+			insertNew(Entry{ mixHash(hash(key)), key, value });
+		}
+
+		void add(Key&& key, Value&& value)
+		{
+			if (contains(key))
+			{
+				bbe::Crash(bbe::Error::KeyAlreadyUsed);
+			}
+			growIfNeeded(m_length + 1);
+			const uint32_t _hash = mixHash(hash(key));
+			insertNew(Entry{ _hash, std::move(key), std::move(value) });
+		}
+
+		bool remove(const Key& key)
+		{
+			return removeImpl(key);
+		}
+
+		template<typename LookupKey>
+			requires IsTransparentKey<Key, std::decay_t<const LookupKey>>::value
+		bool remove(const LookupKey& key)
+		{
+			return removeImpl<std::decay_t<const LookupKey>>(key);
+		}
+
+		bool contains(const Key& key) const
+		{
+			return findIndex(key) != (size_t)-1;
+		}
+
+		template<typename LookupKey>
+			requires IsTransparentKey<Key, std::decay_t<const LookupKey>>::value
+		bool contains(const LookupKey& key) const
+		{
+			return findIndex<std::decay_t<const LookupKey>>(key) != (size_t)-1;
+		}
+
+		const Value* get(const Key& key) const
+		{
+			return getImpl(key);
+		}
+
+		Value* get(const Key& key)
+		{
+			return const_cast<Value*>(getImpl(key));
+		}
+
+		// Lookup without constructing a Key, e.g. by const char* in a map with bbe::String keys.
+		template<typename LookupKey>
+			requires IsTransparentKey<Key, std::decay_t<const LookupKey>>::value
+		const Value* get(const LookupKey& key) const
+		{
+			return getImpl<std::decay_t<const LookupKey>>(key);
+		}
+
+		template<typename LookupKey>
+			requires IsTransparentKey<Key, std::decay_t<const LookupKey>>::value
+		Value* get(const LookupKey& key)
+		{
+			return const_cast<Value*>(getImpl<std::decay_t<const LookupKey>>(key));
+		}
+
+		Iterator begin()
+		{
+			return Iterator(this, 0);
+		}
+
+		Iterator end()
+		{
+			return Iterator(this, m_capacity + m_overflow.getLength());
+		}
+
+		ConstIterator begin() const
+		{
+			return ConstIterator(this, 0);
+		}
+
+		ConstIterator end() const
+		{
+			return ConstIterator(this, m_capacity + m_overflow.getLength());
+		}
+
+	private:
+		template<typename LookupKey>
+		const Value* getImpl(const LookupKey& key) const
+		{
+			const size_t index = findIndex(key);
+			if (index == (size_t)-1) return nullptr;
+			return &entryAt(index).value;
+		}
+
+		template<typename LookupKey>
+		bool removeImpl(const LookupKey& key)
+		{
+			size_t index = findIndex(key);
+			if (index == (size_t)-1) return false;
+			if (index >= m_capacity)
+			{
+				m_overflow.removeIndex(index - m_capacity);
+				m_length--;
+				return true;
+			}
+
+			Entry* entries = getEntries();
+			uint8_t* distances = getDistances();
+			const size_t mask = m_capacity - 1;
+			entries[index].~Entry();
+			size_t next = (index + 1) & mask;
+			while (distances[next] > 1)
+			{
+				new (bbe::addressOf(entries[index])) Entry(std::move(entries[next]));
+				entries[next].~Entry();
+				distances[index] = distances[next] - 1;
+				index = next;
+				next = (next + 1) & mask;
+			}
+			distances[index] = 0;
+			m_length--;
+			return true;
 		}
 	};
 }
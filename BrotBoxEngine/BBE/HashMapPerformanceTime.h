@@ -2,56 +2,162 @@
 
 #include "../BBE/HashMap.h"
 #include "../BBE/String.h"
-#include "../BBE/CPUWatch.h"
+#include "../BBE/StopWatch.h"
+#include "../BBE/Random.h"
 #include "../BBE/Logging.h"
+#include <algorithm>
+#include <functional>
 #include <unordered_map>
-#include <iostream>
 
 
 namespace bbe
 {
 	namespace test
 	{
-		void hashMapPrintSpeed()
+		struct HashMapBenchmarkResult
 		{
-			{
-				HashMap<int, String> map;
+			const char* name = "";
+			double bbeNanosPerOp = 0;
+			double stdNanosPerOp = 0;
+		};
 
-				CPUWatch watchAdd;
-				for (int i = 0; i < 1024 * 1024; i++)
+		namespace INTERNAL
+		{
+			struct StringHasher
+			{
+				size_t operator()(const bbe::String& s) const
 				{
-					map.add(i, L"Hallo");
+					return bbe::hash(s);
 				}
-				BBELOGLN("BBE Hashmap add speed: " << watchAdd.getTimeExpiredSeconds());
+			};
 
-				CPUWatch watchGet;
-				for (int i = 0; i < 1024 * 1024; i++)
+			// Best of several runs, in nanoseconds per operation. The sink is accumulated by the measured code so that
+			// the compiler can't drop the lookups.
+			inline double measureNanosPerOp(size_t amountOfOps, int32_t runs, const std::function<void(uint64_t&)>& func)
+			{
+				double best = 1e300;
+				uint64_t sink = 0;
+				for (int32_t i = 0; i < runs; i++)
 				{
-					map.get(i);
+					bbe::StopWatch sw;
+					func(sink);
+					best = std::min(best, (double)sw.getTimeExpiredNanoseconds() / (double)amountOfOps);
 				}
-				BBELOGLN("BBE Hashmap get speed: " << watchGet.getTimeExpiredSeconds());
+				volatile uint64_t discard = sink;
+				(void)discard;
+				return best;
 			}
 
+			template<typename Key>
+			bbe::List<HashMapBenchmarkResult> benchmarkKeys(const char* keyName, const bbe::List<Key>& keys, const bbe::List<Key>& missingKeys, int32_t runs)
 			{
-				int a = 5;
-				std::hash<int> hasher;
-				hasher(a);
+				bbe::List<HashMapBenchmarkResult> retVal;
+				const size_t amount = keys.getLength();
+				using StdMap = std::conditional_t<std::is_same_v<Key, bbe::String>, std::unordered_map<Key, uint64_t, StringHasher>, std::unordered_map<Key, uint64_t>>;
+
+				HashMapBenchmarkResult insert;
+				insert.name = "insert";
+				insert.bbeNanosPerOp = measureNanosPerOp(amount, runs, [&](uint64_t& sink) {
+					bbe::HashMap<Key, uint64_t> map;
+					for (size_t i = 0; i < amount; i++) map.add(keys[i], i);
+					sink += map.getLength();
+					});
+				insert.stdNanosPerOp = measureNanosPerOp(amount, runs, [&](uint64_t& sink) {
+					StdMap map;
+					for (size_t i = 0; i < amount; i++) map.emplace(keys[i], i);
+					sink += map.size();
+					});
+				retVal.add(insert);
 
-				std::unordered_map<int, bbe::String> map;
-				CPUWatch watchAdd;
-				for (int i = 0; i < 1024 * 1024; i++)
+				bbe::HashMap<Key, uint64_t> bbeMap;
+				StdMap stdMap;
+				for (size_t i = 0; i < amount; i++)
 				{
-					map.insert(std::pair<int, bbe::String>(i, L"Hallo"));
+					bbeMap.add(keys[i], i);
+					stdMap.emplace(keys[i], i);
 				}
-				BBELOGLN("STD Hashmap add speed: " << watchAdd.getTimeExpiredSeconds());
 
-				CPUWatch watchGet;
-				for (int i = 0; i < 1024 * 1024; i++)
+				HashMapBenchmarkResult hit;
+				hit.name = "lookup hit";
+				hit.bbeNanosPerOp = measureNanosPerOp(amount, runs, [&](uint64_t& sink) {
+					for (size_t i = 0; i < amount; i++) sink += *bbeMap.get(keys[i]);
+					});
+				hit.stdNanosPerOp = measureNanosPerOp(amount, runs, [&](uint64_t& sink) {
+					for (size_t i = 0; i < amount; i++) sink += stdMap.find(keys[i])->second;
+					});
+				retVal.add(hit);
+
+				HashMapBenchmarkResult miss;
+				miss.name = "lookup miss";
+				miss.bbeNanosPerOp = measureNanosPerOp(missingKeys.getLength(), runs, [&](uint64_t& sink) {
+					for (size_t i = 0; i < missingKeys.getLength(); i++) sink += bbeMap.contains(missingKeys[i]);
+					});
+				miss.stdNanosPerOp = measureNanosPerOp(missingKeys.getLength(), runs, [&](uint64_t& sink) {
+					for (size_t i = 0; i < missingKeys.getLength(); i++) sink += stdMap.count(missingKeys[i]);
+					});
+				retVal.add(miss);
+
+				HashMapBenchmarkResult erase;
+				erase.name = "remove";
+				erase.bbeNanosPerOp = measureNanosPerOp(amount, runs, [&](uint64_t& sink) {
+					bbe::HashMap<Key, uint64_t> map = bbeMap;
+					for (size_t i = 0; i < amount; i++) sink += map.remove(keys[i]);
+					});
+				erase.stdNanosPerOp = measureNanosPerOp(amount, runs, [&](uint64_t& sink) {
+					StdMap map = stdMap;
+					for (size_t i = 0; i < amount; i++) sink += map.erase(keys[i]);
+					});
+				retVal.add(erase);
+
+				for (size_t i = 0; i < retVal.getLength(); i++)
 				{
-					map.find(i);
+					BBELOGLN(keyName << " " << retVal[i].name << ": bbe::HashMap " << retVal[i].bbeNanosPerOp << " ns/op, std::unordered_map " << retVal[i].stdNanosPerOp << " ns/op");
 				}
-				BBELOGLN("STD Hashmap get speed: " << watchGet.getTimeExpiredSeconds());
+				return retVal;
+			}
+		}
+
+		// Compares bbe::HashMap with std::unordered_map for sequential int keys (the case that used to cluster),
+		// random int keys and String keys. Every scenario is measured several times and the best run is reported.
+		inline bbe::List<HashMapBenchmarkResult> hashMapPrintSpeed(size_t amount = 1024 * 1024, int32_t runs = 5)
+		{
+			bbe::List<HashMapBenchmarkResult> retVal;
+			bbe::Random rand;
+			rand.setSeed(1337);
+
+			bbe::List<int32_t> sequential;
+			bbe::List<int32_t> sequentialMissing;
+			bbe::List<int32_t> random;
+			bbe::List<int32_t> randomMissing;
+			for (size_t i = 0; i < amount; i++)
+			{
+				sequential.add((int32_t)i);
+				sequentialMissing.add((int32_t)(i + amount));
+				// Even numbers are present, odd ones are missing.
+				random.add((int32_t)(rand.randomInt(0x3FFFFFFF) * 2));
+				randomMissing.add((int32_t)(rand.randomInt(0x3FFFFFFF) * 2 + 1));
 			}
+			random.sort();
+			random.removeAll([previous = (int32_t)-1](const int32_t& val) mutable {
+				const bool duplicate = val == previous;
+				previous = val;
+				return duplicate;
+				});
+			random.shuffle(42);
+
+			const size_t stringAmount = amount / 8;
+			bbe::List<bbe::String> strings;
+			bbe::List<bbe::String> stringsMissing;
+			for (size_t i = 0; i < stringAmount; i++)
+			{
+				strings.add(bbe::String("some/path/to/a/resource_") + (int32_t)i);
+				stringsMissing.add(bbe::String("some/other/path/resource_") + (int32_t)i);
+			}
+
+			retVal += INTERNAL::benchmarkKeys("sequential int", sequential, sequentialMissing, runs);
+			retVal += INTERNAL::benchmarkKeys("random int", random, randomMissing, runs);
+			retVal += INTERNAL::benchmarkKeys("String", strings, stringsMissing, runs);
+			return retVal;
 		}
 	}
-}
\ No newline at end of file
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include "../BBE/Matrix4.h"
 #include "../BBE/Vector3.h"
+#include "../BBE/List.h"
+#include "../BBE/PosNormalPair.h"
 
 namespace bbe
 {
@@ -42,5 +44,9 @@ namespace bbe
 		float getDepth() const;
 
 		const Matrix4& getTransform() const;
+
+		// Unit sphere with a diameter of 1, subdivided twice.
+		static bbe::List<bbe::PosNormalPair> getRenderVerticesDefault();
+		static bbe::List<uint32_t> getRenderIndicesDefault();
 	};
 }
@@ -5,6 +5,7 @@
 #include "../BBE/String.h"
 #include "../BBE/Vector2.h"
 #include "../BBE/AutoRefCountable.h"
+#include "../BBE/MappedFile.h"
 
 #ifdef _WIN32
 #ifndef _WINDEF_
@@ -35,6 +36,10 @@ namespace bbe
 			class OpenGLManager;
 			struct OpenGLImage;
 		}
+		namespace softwareRenderer
+		{
+			class Rasterizer;
+		}
 	}
 
 	enum class ImageFormat
@@ -67,6 +72,7 @@ namespace bbe
 		friend class INTERNAL::vulkan::VulkanDescriptorSet;
 		friend struct INTERNAL::openGl::OpenGLImage;
 		friend class INTERNAL::openGl::OpenGLManager;
+		friend class INTERNAL::softwareRenderer::Rasterizer;
 		friend class PrimitiveBrush2D;
 		friend class PrimitiveBrush3D;
 	private:
@@ -79,8 +85,13 @@ namespace bbe
 		bool keep = false;
 
 		mutable bbe::AutoRef m_prendererData;
+		// The region that setPixels changed since the renderer data was created. The max is exclusive.
+		mutable bbe::Vector2i m_dirtyMin;
+		mutable bbe::Vector2i m_dirtyMax;
 
 		void finishLoad(stbi_uc* pixels);
+		bool hasDirtyRegion() const;
+		void clearDirtyRegion() const;
 
 	public:
 		static const Image& white();
@@ -101,6 +112,7 @@ namespace bbe
 		void loadRaw(const bbe::ByteBuffer& buffer);
 		void loadRaw(const bbe::List<unsigned char>& rawData);
 		void loadRaw(const unsigned char* rawData, size_t dataLength);
+		void loadRaw(const bbe::MappedFile& file);
 		void load(const char* path);
 		void load(const bbe::String& path);
 		void load(int width, int height);
@@ -118,6 +130,11 @@ namespace bbe
 		Colori getPixel(size_t x, size_t y) const;
 		void setPixel(const bbe::Vector2i& pos, const bbe::Colori& c);
 		void setPixel(size_t x, size_t y, const Colori& c);
+		// Copies a block of tightly packed pixels in the format of the image to pos. Unlike setPixel it keeps what was
+		// already uploaded, renderers only update the changed region the next time the image is used.
+		void setPixels(const bbe::Vector2i& pos, int width, int height, const void* data);
+		// Copies a block of pixels at pos to tightly packed outData, the reverse of setPixels.
+		void getPixels(const bbe::Vector2i& pos, int width, int height, void* outData) const;
 		size_t getIndexForRawAccess(size_t x, size_t y) const;
 
 		ImageRepeatMode getRepeatMode() const;
@@ -132,8 +149,9 @@ namespace bbe
 
 		void floodFill(const bbe::Vector2i& pos, const bbe::Colori& to, bool fillDiagonal = false, bool tiled = false);
 
-		void writeToFile(const bbe::String& path) const;
-		void writeToFile(const char* path) const;
+		// Returns false if the file could not be written.
+		bool writeToFile(const bbe::String& path) const;
+		bool writeToFile(const char* path) const;
 
 		void flipHorizontally();
 
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "../BBE/List.h"
+
+namespace bbe
+{
+	namespace INTERNAL
+	{
+		struct Job
+		{
+			std::function<void()> func;
+			std::atomic<int32_t> pendingDependencies = 1; // Starts at 1 so that the job can't be run while its dependencies are still being registered.
+			std::atomic_bool done = false;
+			std::exception_ptr exception; // Set before done if func threw.
+			std::mutex continuationsMutex;
+			bbe::List<std::shared_ptr<Job>> continuations;
+		};
+	}
+
+	class JobHandle
+	{
+	private:
+		std::shared_ptr<INTERNAL::Job> m_job;
+
+	public:
+		JobHandle() = default;
+		explicit JobHandle(std::shared_ptr<INTERNAL::Job> job);
+
+		const std::shared_ptr<INTERNAL::Job>& INTERNAL_getJob() const;
+
+		bool isValid() const;
+		bool isDone() const;
+
+		// Executes other jobs on the calling thread until this job is done. Safe to call from within a job. Rethrows
+		// what the job threw, its continuations run nonetheless.
+		void wait() const;
+	};
+
+	namespace jobs
+	{
+		// Amount of persistent worker threads. The thread calling wait() or parallelFor() helps executing jobs as well.
+		size_t getAmountOfWorkers();
+		void stopWorkers();
+
+		JobHandle schedule(std::function<void()>&& func);
+		JobHandle schedule(std::function<void()>&& func, const JobHandle& dependency);
+		JobHandle schedule(std::function<void()>&& func, const bbe::List<JobHandle>& dependencies);
+		// Waits for all handles, even if one of them threw. Rethrows the first exception after that.
+		void waitAll(const bbe::List<JobHandle>& handles);
+
+		// Splits [begin, end) into chunks of at most grain elements and calls func(chunkBegin, chunkEnd) for each of them
+		// on the job system. Returns once all chunks are done. A grain of 0 picks a chunk size based on the amount of workers.
+		// The chunks see the FrameArena that is active on the calling thread, other jobs run without one.
+		void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& func);
+	}
+}
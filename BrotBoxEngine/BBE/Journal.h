@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../BBE/ByteBuffer.h"
+#include "../BBE/List.h"
+#include <cstdint>
+
+namespace bbe
+{
+	namespace INTERNAL
+	{
+		// File format of SerializableList. A header followed by records that are only ever appended. Every record
+		// carries a checksum, so a record that was torn by a crash is detected on load and everything from there on
+		// is ignored. A compacted file is simply the header followed by one ADD per element.
+		namespace journal
+		{
+			enum class RecordType : uint8_t
+			{
+				ADD    = 1, // Inserts the payload at a.
+				REMOVE = 2, // Removes the element at a.
+				UPDATE = 3, // Replaces the element at a with the payload.
+				SWAP   = 4, // Swaps the elements at a and b.
+			};
+
+			struct Record
+			{
+				RecordType type = RecordType::ADD;
+				uint64_t a = 0;
+				uint64_t b = 0;
+				bbe::ByteBufferSpan payload;
+			};
+
+			constexpr size_t headerSize = 8;
+			// type, a, b, payload size and checksum.
+			constexpr size_t recordOverhead = 1 + 8 + 8 + 8 + 4;
+
+			uint32_t crc32(const bbe::byte* data, size_t length, uint32_t crc = 0);
+
+			bool hasHeader(const bbe::ByteBufferSpan& file);
+			void writeHeader(bbe::ByteBuffer& out);
+			void writeRecord(bbe::ByteBuffer& out, RecordType type, uint64_t a, uint64_t b, const bbe::byte* payload, size_t payloadLength);
+
+			// Returns the length of the valid prefix of file. Everything behind it is either torn or corrupted.
+			size_t readRecords(const bbe::ByteBufferSpan& file, bbe::List<Record>& outRecords);
+		}
+	}
+}
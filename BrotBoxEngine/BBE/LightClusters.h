@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include "../BBE/List.h"
+#include "../BBE/Vector3.h"
+#include "../BBE/Matrix4.h"
+#include "../BBE/PointLight.h"
+
+namespace bbe
+{
+	// Assigns point lights to the cells of a view space grid of screen tiles and exponentially growing depth slices,
+	// so that a renderer only has to shade the lights of the cell that a pixel falls into. Lights are binned by their
+	// falloff radius. The binning is conservative: every light that reaches into a cluster is part of its list, but
+	// some that don't may be as well.
+	class LightClusters
+	{
+	public:
+		struct Cluster
+		{
+			uint32_t offset = 0; // Into getLightIndices().
+			uint32_t amountOfLights = 0;
+		};
+
+	private:
+		struct TileRange
+		{
+			uint32_t minX = 0;
+			uint32_t maxX = 0;
+			uint32_t minY = 0;
+			uint32_t maxY = 0;
+		};
+
+		uint32_t m_tilesX = 0;
+		uint32_t m_tilesY = 0;
+		uint32_t m_slices = 0;
+		float m_nearPlane = 0.01f;
+		float m_farPlane = 1.f;
+		float m_sliceScale = 0.f;
+		bbe::Matrix4 m_projection;
+
+		bbe::List<Cluster> m_clusters;
+		bbe::List<uint32_t> m_lightIndices;
+		bbe::List<bbe::Vector3> m_viewSpacePositions;
+		bbe::List<float> m_radii;
+
+		uint32_t getTile(float ndc, uint32_t amountOfTiles) const;
+		uint32_t getSlice(float depth) const;
+		bool getTileRange(const bbe::Vector3& center, float radius, uint32_t slice, TileRange& range) const;
+
+	public:
+		explicit LightClusters(uint32_t tilesX = 16, uint32_t tilesY = 9, uint32_t slices = 24);
+
+		// The projection has to be a perspective matrix as created by Matrix4::createPerspectiveMatrix.
+		void build(const bbe::List<bbe::PointLight>& lights, const bbe::Matrix4& view, const bbe::Matrix4& projection);
+
+		uint32_t getTilesX() const;
+		uint32_t getTilesY() const;
+		uint32_t getSlices() const;
+		float getNearPlane() const;
+		float getFarPlane() const;
+		// Slice of a view space depth d is floor(log(d / near) * sliceScale).
+		float getSliceScale() const;
+
+		// The cluster that a view space position in front of the camera belongs to. Clusters are stored x first,
+		// then y, then the slice.
+		uint32_t getClusterIndex(const bbe::Vector3& viewPos) const;
+		uint32_t getClusterIndex(uint32_t x, uint32_t y, uint32_t slice) const;
+		const bbe::List<Cluster>& getClusters() const;
+		const bbe::List<uint32_t>& getLightIndices() const;
+		// Same order as the lights that were passed to build.
+		const bbe::List<bbe::Vector3>& getViewSpaceLightPositions() const;
+	};
+}
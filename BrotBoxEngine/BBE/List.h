@@ -9,6 +9,7 @@
 #include "../BBE/Error.h"
 #include "../BBE/MersenneTwister.h"
 #include "../BBE/AllocBlock.h"
+#include "../BBE/TriviallyRelocatable.h"
 #include <initializer_list>
 #include <iostream>
 #include <cstring>
@@ -19,7 +20,7 @@
 
 namespace bbe
 {
-	template <typename T>
+	template <typename T, typename Allocator = bbe::HeapAllocator>
 	class List
 	{
 	public:
@@ -40,14 +41,24 @@ namespace bbe
 					newCapacity = getCapacity() * 2;
 				}
 
-				bbe::AllocBlock newData = bbe::allocateBlock(newCapacity * sizeof(T));
+				bbe::AllocBlock newData = Allocator::allocateBlock(newCapacity * sizeof(T));
 				T* newDataPtr = (T*)newData.data;
 				T* oldDataPtr = getRaw();
 
-				for (size_t i = 0; i < m_length; i++)
+				if constexpr (IsTriviallyRelocatable<T>::value)
+				{
+					if (m_length > 0)
+					{
+						memcpy((void*)newDataPtr, (const void*)oldDataPtr, m_length * sizeof(T));
+					}
+				}
+				else
 				{
-					new (bbe::addressOf(newDataPtr[i])) T(std::move(oldDataPtr[i]));
-					oldDataPtr[i].~T();
+					for (size_t i = 0; i < m_length; i++)
+					{
+						new (bbe::addressOf(newDataPtr[i])) T(std::move(oldDataPtr[i]));
+						oldDataPtr[i].~T();
+					}
 				}
 
 				retVal = m_allocBlock;
@@ -81,7 +92,7 @@ namespace bbe
 			}
 		}
 
-		List(const List<T>& other)
+		List(const List& other)
 		{
 			growIfNeeded(other.m_length);
 			m_length = other.m_length;
@@ -91,7 +102,7 @@ namespace bbe
 			}
 		}
 
-		List(List<T>&& other) noexcept
+		List(List&& other) noexcept
 			: m_length(other.m_length), m_allocBlock(std::move(other.m_allocBlock))
 		{
 			other.m_length = 0;
@@ -106,11 +117,11 @@ namespace bbe
 			}
 		}
 
-		List& operator=(const List<T>& other)
+		List& operator=(const List& other)
 		{
 			clear();
 
-			bbe::freeBlock(m_allocBlock);
+			Allocator::freeBlock(m_allocBlock);
 			m_length = 0;
 			growIfNeeded(other.getCapacity());
 			m_length = other.m_length;
@@ -123,11 +134,11 @@ namespace bbe
 			return *this;
 		}
 
-		List& operator=(List<T>&& other) noexcept
+		List& operator=(List&& other) noexcept
 		{
 			clear();
 
-			bbe::freeBlock(m_allocBlock);
+			Allocator::freeBlock(m_allocBlock);
 
 			m_length = other.m_length;
 			m_allocBlock = other.m_allocBlock;
@@ -142,7 +153,7 @@ namespace bbe
 		{
 			clear();
 
-			bbe::freeBlock(m_allocBlock);
+			Allocator::freeBlock(m_allocBlock);
 			m_length = 0;
 		}
 
@@ -195,7 +206,7 @@ namespace bbe
 			return getRaw()[index];
 		}
 
-		List<T>& operator+=(const List<T>& other)
+		List& operator+=(const List& other)
 		{
 			const T* optr = other.getRaw();
 			for (size_t i = 0; i < other.m_length; i++)
@@ -214,7 +225,7 @@ namespace bbe
 				new (bbe::addressOf(d[m_length + i])) T(val);
 			}
 			m_length += amount;
-			bbe::freeBlock(delVal);
+			Allocator::freeBlock(delVal);
 		}
 
 		void add(T&& val, size_t amount)
@@ -234,7 +245,7 @@ namespace bbe
 			}
 
 			m_length += amount;
-			bbe::freeBlock(delVal);
+			Allocator::freeBlock(delVal);
 		}
 
 		void add(T&& val)
@@ -243,7 +254,7 @@ namespace bbe
 			new (bbe::addressOf(getRaw()[m_length])) T(std::move(val));
 
 			m_length += 1;
-			bbe::freeBlock(delVal);
+			Allocator::freeBlock(delVal);
 		}
 
 		bool addUnique(const T& val)
@@ -265,7 +276,7 @@ namespace bbe
 			add(std::forward<U>(t));
 		}
 		
-		void addList(const List<T>& other)
+		void addList(const List& other)
 		{
 			const size_t len = other.getLength();
 			for (size_t i = 0; i < len; i++)
@@ -304,7 +315,7 @@ namespace bbe
 				new (bbe::addressOf(getRaw()[m_length])) T();
 				m_length += 1;
 			}
-			bbe::freeBlock(delVal);
+			Allocator::freeBlock(delVal);
 			return retVal;
 		}
 
@@ -352,7 +363,7 @@ namespace bbe
 			static_assert(std::is_same<dummyT, T>::value, "Do not specify dummyT!");
 			if (newCapacity == m_length) return;
 
-			bbe::freeBlock(m_allocBlock);
+			Allocator::freeBlock(m_allocBlock);
 			growIfNeeded(newCapacity);
 			m_length = newCapacity;
 		}
@@ -382,7 +393,7 @@ namespace bbe
 			}
 
 			auto delVal = growIfNeeded(newCapacity - getCapacity());
-			bbe::freeBlock(delVal);
+			Allocator::freeBlock(delVal);
 		}
 
 		size_t removeAll(const T& remover)
@@ -396,8 +407,37 @@ namespace bbe
 
 		size_t removeAll(std::function<bool(const T&)> predicate)
 		{
-			size_t moveRange = 0;
 			T* d = getRaw();
+			if constexpr (IsTriviallyRelocatable<T>::value)
+			{
+				// Elements that are kept are moved in runs instead of one by one.
+				size_t writeIndex = 0;
+				size_t runStart = 0;
+				for (size_t i = 0; i < m_length; i++)
+				{
+					if (predicate(d[i]))
+					{
+						if (writeIndex != runStart)
+						{
+							memmove((void*)(d + writeIndex), (const void*)(d + runStart), (i - runStart) * sizeof(T));
+						}
+						writeIndex += i - runStart;
+						d[i].~T();
+						runStart = i + 1;
+					}
+				}
+				if (writeIndex != runStart)
+				{
+					memmove((void*)(d + writeIndex), (const void*)(d + runStart), (m_length - runStart) * sizeof(T));
+				}
+				writeIndex += m_length - runStart;
+
+				const size_t removed = m_length - writeIndex;
+				m_length = writeIndex;
+				return removed;
+			}
+
+			size_t moveRange = 0;
 			for (size_t i = 0; i < m_length; i++)
 			{
 				if (predicate(d[i]))
@@ -420,11 +460,19 @@ namespace bbe
 			}
 
 			T* d = getRaw();
-			for (size_t i = index; i < m_length - 1; i++)
+			if constexpr (IsTriviallyRelocatable<T>::value)
 			{
-				d[i] = std::move(d[i + 1]);
+				d[index].~T();
+				memmove((void*)(d + index), (const void*)(d + index + 1), (m_length - index - 1) * sizeof(T));
+			}
+			else
+			{
+				for (size_t i = index; i < m_length - 1; i++)
+				{
+					d[i] = std::move(d[i + 1]);
+				}
+				d[m_length - 1].~T();
 			}
-			d[m_length - 1].~T();
 
 			m_length--;
 			return true;
@@ -464,14 +512,25 @@ namespace bbe
 			if (length == 0) return;
 
 			T* d = getRaw();
-			for (size_t i = start; i < m_length - length; i++)
+			if constexpr (IsTriviallyRelocatable<T>::value)
 			{
-				d[i] = d[i + length];
+				for (size_t i = start; i < start + length; i++)
+				{
+					d[i].~T();
+				}
+				memmove((void*)(d + start), (const void*)(d + start + length), (m_length - start - length) * sizeof(T));
 			}
-
-			for (size_t i = m_length - length; i < m_length; i++)
+			else
 			{
-				d[i].~T();
+				for (size_t i = start; i < m_length - length; i++)
+				{
+					d[i] = d[i + length];
+				}
+
+				for (size_t i = m_length - length; i < m_length; i++)
+				{
+					d[i].~T();
+				}
 			}
 
 			m_length -= length;
@@ -736,7 +795,7 @@ namespace bbe
 			return nullptr;
 		}
 
-		bool operator==(const List<T>& other) const
+		bool operator==(const List& other) const
 		{
 			if (m_length != other.m_length)
 			{
@@ -756,7 +815,7 @@ namespace bbe
 			return true;
 		}
 
-		bool operator!=(const List<T>& other) const
+		bool operator!=(const List& other) const
 		{
 			return !(operator==(other));
 		}
@@ -855,8 +914,8 @@ namespace bbe
 		}
 	};
 
-	template<typename T>
-	uint32_t hash(const List<T> &t)
+	template<typename T, typename Allocator>
+	uint32_t hash(const List<T, Allocator> &t)
 	{
 		//UNTESTED
 		size_t length = t.getLength();
@@ -875,9 +934,12 @@ namespace bbe
 		return _hash;
 	}
 
+	template<typename T, typename Allocator>
+	struct IsTriviallyRelocatable<bbe::List<T, Allocator>> : std::true_type {};
+
 	template<typename>
 	struct IsList : std::false_type {};
 
-	template<typename T>
-	struct IsList<bbe::List<T>> : std::true_type {};
+	template<typename T, typename Allocator>
+	struct IsList<bbe::List<T, Allocator>> : std::true_type {};
 }
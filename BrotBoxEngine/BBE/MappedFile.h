@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../BBE/ByteBuffer.h"
+#include "../BBE/String.h"
+#include <cstdint>
+
+namespace bbe
+{
+	// Read only view of a whole file that the OS pages in on demand instead of copying it into memory up front.
+	// Spans handed out by getSpan() are only valid as long as the MappedFile is open.
+	class MappedFile
+	{
+	public:
+		enum class AccessPattern
+		{
+			SEQUENTIAL, // Read front to back once, e.g. when deserializing. Pages are read ahead and dropped early.
+			RANDOM,     // Jumped around in for the whole lifetime, e.g. fonts. Pages are prefetched but read ahead is off.
+		};
+
+	private:
+		const bbe::byte* m_data = nullptr;
+		size_t m_length = 0;
+		bool m_open = false;
+#ifdef WIN32
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+#endif
+#ifdef __EMSCRIPTEN__
+		// No mmap here, so the file is simply read.
+		bbe::ByteBuffer m_fallback;
+#endif
+
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const bbe::String& path, AccessPattern accessPattern = AccessPattern::SEQUENTIAL);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		void open(const bbe::String& path, AccessPattern accessPattern = AccessPattern::SEQUENTIAL);
+		void close();
+		bool isOpen() const;
+
+		const bbe::byte* getRaw() const;
+		size_t getLength() const;
+		bbe::ByteBufferSpan getSpan() const;
+	};
+}
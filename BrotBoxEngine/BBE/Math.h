@@ -227,10 +227,10 @@ namespace bbe
 		const bbe::Vector2* getClosest(const bbe::Vector2& pos, const bbe::List<bbe::Vector2>& points);
 		      bbe::Vector2* getClosest(const bbe::Vector2& pos,       bbe::List<bbe::Vector2>& points);
 		
-		template<typename Vec>
-		bbe::List<Vec> project(const bbe::List<Vec>& points, const Vec& projection)
+		template<typename Vec, typename OutAllocator = bbe::HeapAllocator, typename InAllocator>
+		bbe::List<Vec, OutAllocator> project(const bbe::List<Vec, InAllocator>& points, const Vec& projection)
 		{
-			bbe::List<Vec> retVal;
+			bbe::List<Vec, OutAllocator> retVal;
 			retVal.resizeCapacityAndLength(points.getLength());
 
 			for (size_t i = 0; i < points.getLength(); i++)
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <limits>
+#include "../BBE/List.h"
+#include "../BBE/Vector2.h"
+#include "../BBE/Math.h"
+
+namespace bbe
+{
+	// Packs rectangles into an area of fixed size. Keeps the maximal free rectangles of the area, i.e. every free space
+	// that can't be grown in any direction, and puts every new rectangle into the one that leaves the shortest side over
+	// (best short side fit). Slower than a skyline, but it reuses the space below overhangs which makes it the better
+	// choice for rectangles of very different sizes.
+	template <typename Vec>
+	class MaxRectsPacker_t
+	{
+	public:
+		using SubType = typename Vec::SubType;
+
+	private:
+		struct FreeRect
+		{
+			SubType x = 0;
+			SubType y = 0;
+			SubType width = 0;
+			SubType height = 0;
+
+			bool contains(const FreeRect& other) const
+			{
+				return other.x >= x && other.y >= y
+					&& other.x + other.width <= x + width
+					&& other.y + other.height <= y + height;
+			}
+		};
+
+		bbe::List<FreeRect> m_freeRects;
+		bbe::List<FreeRect> m_scratch;
+		Vec m_dimensions;
+		Vec m_usedDimensions;
+		double m_usedArea = 0;
+		bool m_allowRotation = false;
+
+		void split(const FreeRect& freeRect, const FreeRect& used)
+		{
+			if (used.x >= freeRect.x + freeRect.width || used.x + used.width <= freeRect.x
+				|| used.y >= freeRect.y + freeRect.height || used.y + used.height <= freeRect.y)
+			{
+				m_scratch.add(freeRect);
+				return;
+			}
+
+			if (used.x > freeRect.x)
+			{
+				m_scratch.add(FreeRect{ freeRect.x, freeRect.y, used.x - freeRect.x, freeRect.height });
+			}
+			if (used.x + used.width < freeRect.x + freeRect.width)
+			{
+				m_scratch.add(FreeRect{ used.x + used.width, freeRect.y, freeRect.x + freeRect.width - (used.x + used.width), freeRect.height });
+			}
+			if (used.y > freeRect.y)
+			{
+				m_scratch.add(FreeRect{ freeRect.x, freeRect.y, freeRect.width, used.y - freeRect.y });
+			}
+			if (used.y + used.height < freeRect.y + freeRect.height)
+			{
+				m_scratch.add(FreeRect{ freeRect.x, used.y + used.height, freeRect.width, freeRect.y + freeRect.height - (used.y + used.height) });
+			}
+		}
+
+		void place(const FreeRect& used)
+		{
+			m_scratch.clear();
+			for (size_t i = 0; i < m_freeRects.getLength(); i++)
+			{
+				split(m_freeRects[i], used);
+			}
+
+			// Drop every free rect that lies within another one, keeping only the first of two equal ones.
+			m_freeRects.clear();
+			for (size_t i = 0; i < m_scratch.getLength(); i++)
+			{
+				bool redundant = false;
+				for (size_t k = 0; k < m_scratch.getLength() && !redundant; k++)
+				{
+					if (i == k || !m_scratch[k].contains(m_scratch[i])) continue;
+					redundant = !m_scratch[i].contains(m_scratch[k]) || k < i;
+				}
+				if (!redundant) m_freeRects.add(m_scratch[i]);
+			}
+
+			m_usedArea += (double)used.width * (double)used.height;
+			m_usedDimensions.x = bbe::Math::max(m_usedDimensions.x, used.x + used.width);
+			m_usedDimensions.y = bbe::Math::max(m_usedDimensions.y, used.y + used.height);
+		}
+
+	public:
+		MaxRectsPacker_t() = default;
+		MaxRectsPacker_t(const Vec& dimensions, bool allowRotation = false)
+		{
+			reset(dimensions, allowRotation);
+		}
+
+		void reset(const Vec& dimensions, bool allowRotation = false)
+		{
+			if (dimensions.x <= 0 || dimensions.y <= 0)
+			{
+				bbe::Crash(bbe::Error::IllegalArgument);
+			}
+			m_dimensions = dimensions;
+			m_usedDimensions = Vec(0, 0);
+			m_usedArea = 0;
+			m_allowRotation = allowRotation;
+			m_freeRects.clear();
+			m_freeRects.add(FreeRect{ 0, 0, dimensions.x, dimensions.y });
+		}
+
+		// Returns false and leaves the out parameters untouched if the rectangle doesn't fit anymore. If outRotated is
+		// set, the rectangle occupies height x width at outPos.
+		bool insert(const Vec& dimensions, Vec& outPos, bool& outRotated)
+		{
+			if (dimensions.x < 0 || dimensions.y < 0)
+			{
+				bbe::Crash(bbe::Error::IllegalArgument);
+			}
+			if (dimensions.x == 0 || dimensions.y == 0)
+			{
+				outPos = Vec(0, 0);
+				outRotated = false;
+				return true;
+			}
+
+			size_t bestIndex = (size_t)-1;
+			bool bestRotated = false;
+			SubType bestShortSide = std::numeric_limits<SubType>::max();
+			SubType bestLongSide = std::numeric_limits<SubType>::max();
+			auto score = [&](size_t index, SubType width, SubType height, bool rotated)
+				{
+					const FreeRect& freeRect = m_freeRects[index];
+					if (width > freeRect.width || height > freeRect.height) return;
+					const SubType leftoverX = freeRect.width - width;
+					const SubType leftoverY = freeRect.height - height;
+					const SubType shortSide = bbe::Math::min(leftoverX, leftoverY);
+					const SubType longSide = bbe::Math::max(leftoverX, leftoverY);
+					if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+					{
+						bestIndex = index;
+						bestRotated = rotated;
+						bestShortSide = shortSide;
+						bestLongSide = longSide;
+					}
+				};
+			for (size_t i = 0; i < m_freeRects.getLength(); i++)
+			{
+				score(i, dimensions.x, dimensions.y, false);
+				if (m_allowRotation && dimensions.x != dimensions.y)
+				{
+					score(i, dimensions.y, dimensions.x, true);
+				}
+			}
+			if (bestIndex == (size_t)-1) return false;
+
+			const FreeRect used = {
+				m_freeRects[bestIndex].x,
+				m_freeRects[bestIndex].y,
+				bestRotated ? dimensions.y : dimensions.x,
+				bestRotated ? dimensions.x : dimensions.y,
+			};
+			place(used);
+			outPos = Vec(used.x, used.y);
+			outRotated = bestRotated;
+			return true;
+		}
+
+		bool insert(const Vec& dimensions, Vec& outPos)
+		{
+			if (m_allowRotation) bbe::Crash(bbe::Error::IllegalState);
+			bool rotated = false;
+			return insert(dimensions, outPos, rotated);
+		}
+
+		const Vec& getDimensions() const
+		{
+			return m_dimensions;
+		}
+
+		// The bounding box of everything that was inserted so far, starting at (0, 0).
+		const Vec& getUsedDimensions() const
+		{
+			return m_usedDimensions;
+		}
+
+		// Packed area divided by the total area.
+		float getFillRatio() const
+		{
+			if (m_dimensions.x <= 0 || m_dimensions.y <= 0) return 0;
+			return (float)(m_usedArea / ((double)m_dimensions.x * (double)m_dimensions.y));
+		}
+	};
+
+	using MaxRectsPacker  = MaxRectsPacker_t<bbe::Vector2>;
+	using MaxRectsPackeri = MaxRectsPacker_t<bbe::Vector2i>;
+}
@@ -23,6 +23,8 @@ namespace bbe
 		{
 			bbe::Model model;
 			bbe::Vector2i uvDimensions;
+			// How much of the uv area is covered by quads. The rest is baked for nothing.
+			float uvFillRatio = 0;
 		};
 		ModelUvDimensionsPair getModel(uint32_t pixelsPerUnit);
 	};
@@ -15,6 +15,10 @@ namespace bbe
 			class OpenGLModel;
 			class OpenGLManager;
 		}
+		namespace softwareRenderer
+		{
+			class SoftwareRendererManager;
+		}
 	}
 	class MeshBuilder;
 
@@ -23,6 +27,7 @@ namespace bbe
 		friend class MeshBuilder;
 		friend class INTERNAL::openGl::OpenGLModel;
 		friend class INTERNAL::openGl::OpenGLManager;
+		friend class INTERNAL::softwareRenderer::SoftwareRendererManager;
 	private:
 		bbe::List<bbe::PosNormalPair> m_vertices;
 		bbe::List<uint32_t> m_indices;
@@ -17,6 +17,14 @@ namespace bbe
 				PrimitiveBrush3D m_primitiveBrush3D;
 
 				GLFWwindow* m_pwindow = nullptr;
+				uint32_t m_windowWidth = 0;
+				uint32_t m_windowHeight = 0;
+
+				bbe::FrameCapture* m_pframeCapture = nullptr;
+				uint64_t m_frameCaptureNumber = 0;
+
+				uint32_t m_amountOfDrawcalls = 0;
+				uint32_t m_amountOfDrawcallsPreviousFrame = 0;
 			public:
 				NullRendererManager();
 
@@ -45,11 +53,17 @@ namespace bbe
 				void screenshot(const bbe::String& path) override;
 				void setVideoRenderingMode(const char* path) override;
 
+				bool isFrameCaptureSupported() const override;
+				void captureFrame(bbe::FrameCapture& capture, uint64_t frameNumber) override;
+
 				virtual void setColor2D(const bbe::Color& color) override;
 				virtual void fillRect2D(const Rectangle& rect, float rotation, FragmentShader* shader) override;
 				virtual void fillCircle2D(const Circle& circle) override;
 				virtual void drawImage2D(const Rectangle& rect, const Image& image, float rotation) override;
 				virtual void fillVertexIndexList2D(const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, size_t amountOfVertices, const bbe::Vector2& pos, const bbe::Vector2& scale) override;
+				virtual void submit2D(const bbe::CommandBuffer2D& commandBuffer) override;
+				virtual bool isImageRegionSupported2D() const override;
+				virtual bool retainImage2D(const Image& image, bbe::AutoRef& imageData) override;
 
 				virtual void setColor3D(const bbe::Color& color) override;
 				virtual void setCamera3D(const bbe::Vector3& pos, const bbe::Matrix4& m_view, const bbe::Matrix4& m_projection) override;
@@ -62,6 +76,9 @@ namespace bbe
 				virtual void imguiStartFrame() override;
 				virtual void imguiEndFrame() override;
 
+				// Every 2D batch counts as the one draw call that a GPU backend would need for it.
+				// Note: It's the drawcalls of the PREVIOUS frame!
+				uint32_t getAmountOfDrawcalls() const;
 			};
 		}
 	}
@@ -13,11 +13,15 @@ namespace bbe
 			struct OpenGLImage : public AutoRefCountable
 			{
 				GLuint tex = 0;
+				bbe::ImageFormat imageFormat = bbe::ImageFormat::R8G8B8A8;
 
 				explicit OpenGLImage(const bbe::Image& image);
 				OpenGLImage(const bbe::Image& image, GLuint tex);
 				~OpenGLImage() override;
 
+				// Uploads what Image::setPixels changed since the last upload.
+				void uploadDirtyRegion(const bbe::Image& image);
+
 				OpenGLImage(const OpenGLImage&) = delete;
 				OpenGLImage(OpenGLImage&&) = delete;
 				OpenGLImage& operator =(const OpenGLImage&) = delete;
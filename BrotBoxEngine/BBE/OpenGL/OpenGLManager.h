@@ -7,8 +7,11 @@
 #include "../BBE/RenderMode.h"
 #include "../BBE/PosNormalPair.h"
 #include "../BBE/Model.h"
+#include "../BBE/ViewFrustum.h"
+#include "../BBE/LightClusters.h"
 #include "../BBE/Image.h"
 #include "../BBE/Future.h"
+#include "../BBE/StreamRing.h"
 
 struct ImFont;
 
@@ -98,6 +101,21 @@ namespace bbe
 				void setLightUniform(const bbe::PointLight& light, const bbe::Matrix4& view);
 			};
 
+			struct ClusteredLightProgram : public Program
+			{
+				GLint gPositionPos = 0;
+				GLint gNormalPos = 0;
+				GLint gAlbedoSpecPos = 0;
+				GLint gSpecularPos = 0;
+				GLint lightDataPos = 0;
+				GLint lightClustersPos = 0;
+				GLint lightIndicesPos = 0;
+				GLint projectionPos = 0;
+				GLint screenSizePos = 0;
+				GLint clusterGridPos = 0;
+				GLint sliceParamsPos = 0;
+			};
+
 			struct Framebuffer
 			{
 				GLuint framebuffer = 0;
@@ -119,6 +137,30 @@ namespace bbe
 				void setSamples(GLsizei samples);
 			};
 
+			// Per draw data is sub-allocated from a ring of one segment per frame in flight instead of creating a buffer
+			// object per draw. A segment is only written again once the fence of the frame that used it last signaled.
+			// Where GL_ARB_buffer_storage exists the buffer stays persistently mapped, otherwise it's filled with
+			// glBufferSubData and the driver takes care of the synchronization.
+			struct StreamBuffer
+			{
+				const char* label = nullptr;
+				GLenum target = 0;
+				GLuint buffer = 0;
+				bbe::byte* mapped = nullptr;
+				GLsync fences[bbe::StreamRing::amountOfSegments] = {};
+				bbe::StreamRing ring;
+
+				void create(const char* label, GLenum target, size_t segmentSize);
+				void createBuffer();
+				void destroy();
+				void beginFrame();
+				void endFrame();
+				// Makes sure that the next uploads with a total of length bytes end up in the same buffer.
+				void reserve(size_t length);
+				// Returns the offset of the data in buffer, which is left bound to target.
+				size_t upload(const void* data, size_t length);
+			};
+
 			struct InstanceData2D
 			{
 				bbe::Vector4 scalePosOffset;
@@ -126,6 +168,29 @@ namespace bbe
 				bbe::Vector4 color;
 			};
 
+			struct ImageVertex2D
+			{
+				bbe::Vector2 pos;
+				bbe::Vector2 uv;
+				bbe::Vector4 color;
+			};
+
+			struct InstanceData3D
+			{
+				bbe::Matrix4 model;
+				bbe::Vector4 color;
+			};
+
+			// All instances of one mesh that are drawn with the untextured default material.
+			struct InstanceBatch3D
+			{
+				bbe::AutoRef mesh; // Keeps models alive until the batch was drawn.
+				GLuint vbo = 0;
+				GLuint ibo = 0;
+				size_t amountOfIndices = 0;
+				bbe::List<InstanceData3D> instances;
+			};
+
 			class OpenGLManager 
 				: public RenderManager {
 			private:
@@ -138,10 +203,12 @@ namespace bbe
 				Program m_program2dTex;
 				MrtProgram m_program3dMrt;
 				MrtProgram m_program3dForwardNoLight;
+				MrtProgram m_program3dMrtInstanced;
+				MrtProgram m_program3dForwardNoLightInstanced;
 				Program m_program3dAmbient;
 				Program m_programPostProcessing;
 				Program m_programBakingGammaCorrection;
-				LightProgram m_program3dLight;
+				ClusteredLightProgram m_program3dLightClustered;
 
 				MrtProgram m_program3dMrtBaking;
 				LightProgram m_program3dLightBaking;
@@ -151,8 +218,6 @@ namespace bbe
 
 				Framebuffer postProcessingFb;
 
-				GLuint m_imageUvBuffer = 0;
-
 				uint32_t m_windowWidth = 0;
 				uint32_t m_windowHeight = 0;
 
@@ -163,12 +228,13 @@ namespace bbe
 
 				Program init2dShaders();
 				Program init2dTexShaders();
-				MrtProgram init3dShadersMrt(bool baking);
-				MrtProgram init3dForwardNoLight();
+				MrtProgram init3dShadersMrt(bool baking, bool instanced);
+				MrtProgram init3dForwardNoLight(bool instanced);
 				Program init3dShadersAmbient();
 				Program init3dPostProcessing();
 				Program initBakingGammaCorrection();
-				LightProgram init3dShadersLight(bool baking);
+				ClusteredLightProgram init3dShadersLightClustered();
+				LightProgram init3dShadersLightBaking();
 				Framebuffer getGeometryBuffer(const bbe::String& label, uint32_t width, uint32_t height, bool baking) const;
 				void initFrameBuffers();
 
@@ -197,12 +263,39 @@ namespace bbe
 				bbe::RenderMode m_renderMode = bbe::RenderMode::DEFERRED;
 
 				bbe::List<InstanceData2D> instanceDatas;
-				void addInstancedData2D(PreviousDrawCall2D type, float x, float y, float width, float height, float rotation);
+				void addInstancedData2D(PreviousDrawCall2D type, float x, float y, float width, float height, float rotation, const bbe::Color& color);
 				void flushInstanceData2D();
 
+				bbe::List<ImageVertex2D> imageVertices;
+				bbe::List<uint32_t> imageIndices;
+				void drawImages2D(const OpenGLImage& image, const bbe::DrawCommand2D* commands, size_t amountOfCommands);
+
+				// Untextured cubes, spheres and models are culled against the view frustum on submission and the
+				// survivors are drawn with one instanced draw call per mesh at the end of the 3D part of the frame.
+				bbe::ViewFrustum m_viewFrustum;
+				bbe::List<InstanceBatch3D> m_instanceBatches3D;
+				uint32_t m_amountOfVisibleObjects3D = 0;
+				uint32_t m_amountOfCulledObjects3D = 0;
+				uint32_t m_amountOfVisibleObjects3DPreviousFrame = 0;
+				uint32_t m_amountOfCulledObjects3DPreviousFrame = 0;
+				void addInstance3D(const bbe::Matrix4& transform, const bbe::Vector3& boundsCenter, const bbe::Vector3& boundsHalfExtent, GLuint vbo, GLuint ibo, size_t amountOfIndices, bbe::AutoRefCountable* mesh);
+				void flushInstances3D();
+
 				OpenGLImage* toRendererData(const bbe::Image& image) const;
 
-				void drawLight(const bbe::PointLight& light, bool baking, GLuint ibo = 0);
+				void drawLight(const bbe::PointLight& light, GLuint ibo);
+
+				// All lights of the deferred pass are shaded in a single full screen pass. Every pixel only loops
+				// over the lights of its cluster. The lights, the cluster lists and the light indices are uploaded
+				// as float textures because GLES 3.0 has no storage buffers.
+				bbe::LightClusters m_lightClusters;
+				GLuint m_lightDataTex = 0;
+				GLuint m_lightClustersTex = 0;
+				GLuint m_lightIndicesTex = 0;
+				bbe::List<float> m_lightDataTexels;
+				bbe::List<float> m_lightClustersTexels;
+				bbe::List<float> m_lightIndicesTexels;
+				void uploadLightClusters();
 
 				uint32_t amountOfDrawcallsBuffer[2] = { 0, 0 };
 				uint32_t* amountOfDrawcallsRead = amountOfDrawcallsBuffer;
@@ -213,6 +306,34 @@ namespace bbe
 				GLuint getModeFramebuffer();
 
 				GLuint quadIbo = 0;
+
+				StreamBuffer m_vertexStream;
+				StreamBuffer m_indexStream;
+				size_t m_amountOfStreamedBytesPreviousFrame = 0;
+
+				// Frames are read back into a ring of pixel pack buffers and only mapped once their fence signaled, so
+				// capturing doesn't stall the pipeline. Screenshots go the same way and are written once they arrive.
+				struct CaptureBuffer
+				{
+					GLuint pbo = 0;
+					size_t size = 0;
+					GLsync fence = nullptr;
+					uint32_t width = 0;
+					uint32_t height = 0;
+					uint64_t frameNumber = 0;
+					bbe::FrameCapture* capture = nullptr;
+					bbe::List<bbe::String> screenshotPaths;
+				};
+				constexpr static size_t m_amountOfCaptureBuffers = 3;
+				CaptureBuffer m_captureBuffers[m_amountOfCaptureBuffers];
+				size_t m_oldestCapture = 0;
+				size_t m_amountOfPendingCaptures = 0;
+				bbe::FrameCapture* m_pframeCapture = nullptr;
+				uint64_t m_frameCaptureNumber = 0;
+				bbe::List<bbe::String> m_pendingScreenshotPaths;
+				void startCapture();
+				bool finishOldestCapture(bool wait);
+				void destroyCaptureBuffers();
 			public:
 				OpenGLManager();
 
@@ -241,16 +362,25 @@ namespace bbe
 				void screenshot(const bbe::String& path) override;
 				void setVideoRenderingMode(const char* path) override;
 
+				bool isFrameCaptureSupported() const override;
+				void captureFrame(bbe::FrameCapture& capture, uint64_t frameNumber) override;
+				void flushFrameCapture() override;
+
 				virtual void setColor2D(const bbe::Color& color) override;
 				virtual void fillRect2D(const Rectangle& rect, float rotation, FragmentShader* shader) override;
 				virtual void fillCircle2D(const Circle& circle) override;
 				virtual void drawImage2D(const Rectangle& rect, const Image& image, float rotation) override;
 				virtual void fillVertexIndexList2D(const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, size_t amountOfVertices, const bbe::Vector2& pos, const bbe::Vector2& scale) override;
+				virtual void submit2D(const bbe::CommandBuffer2D& commandBuffer) override;
+				virtual bool isImageRegionSupported2D() const override;
+				virtual bool retainImage2D(const Image& image, bbe::AutoRef& imageData) override;
 
 				virtual void setColor3D(const bbe::Color& color) override;
 				virtual void setCamera3D(const Vector3& cameraPos, const bbe::Matrix4& view, const bbe::Matrix4& projection) override;
 				virtual void fillCube3D(const Cube& cube) override;
 				virtual void fillSphere3D(const IcoSphere& sphere) override;
+				// Bypasses batching and culling, e.g. for occlusion queries.
+				void fillCubeImmediately3D(const Cube& cube);
 				void fillModel(const bbe::Matrix4& transform, const Model& model, const Image* albedo, const Image* normals, const Image* emissions, const FragmentShader* shader);
 				bbe::Future<bool> isCubeVisible(const Cube& cube);
 				void setRenderMode(bbe::RenderMode renderMode);
@@ -270,7 +400,19 @@ namespace bbe
 
 				// Note: It's the drawcalls of the PREVIOUS frame!
 				uint32_t getAmountOfDrawcalls();
+				// Vertex, index and instance data that was streamed to the GPU. Also of the PREVIOUS frame.
+				size_t getAmountOfStreamedBytes() const;
+				// Cubes, spheres and models that were batched or dropped by frustum culling. Also of the PREVIOUS frame.
+				uint32_t getAmountOfVisibleObjects3D() const;
+				uint32_t getAmountOfCulledObjects3D() const;
 			};
 		}
 	}
+
+	template<>
+	struct IsTriviallyRelocatable<INTERNAL::openGl::InstanceData2D> : std::true_type {};
+	template<>
+	struct IsTriviallyRelocatable<INTERNAL::openGl::InstanceData3D> : std::true_type {};
+	template<>
+	struct IsTriviallyRelocatable<INTERNAL::openGl::ImageVertex2D> : std::true_type {};
 }
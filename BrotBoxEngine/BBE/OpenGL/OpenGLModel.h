@@ -17,6 +17,8 @@ namespace bbe
 				GLuint m_vbo = 0;
 				GLuint m_ibo = 0;
 				size_t m_amountOfIndices = 0;
+				bbe::Vector3 m_boundsCenter;
+				bbe::Vector3 m_boundsHalfExtent;
 			public:
 				explicit OpenGLModel(const bbe::Model& model);
 				virtual ~OpenGLModel() override;
@@ -25,6 +27,10 @@ namespace bbe
 				GLuint getIbo();
 
 				size_t getAmountOfIndices();
+
+				// Object space bounding box of the vertices.
+				const bbe::Vector3& getBoundsCenter() const;
+				const bbe::Vector3& getBoundsHalfExtent() const;
 			};
 		}
 	}
@@ -16,4 +16,7 @@ namespace bbe
 	};
 	static_assert(alignof(PosNormalPair) == alignof(float));
 	static_assert(sizeof(PosNormalPair) == (8 * sizeof(float)));
+
+	template<>
+	struct IsTriviallyRelocatable<PosNormalPair> : std::true_type {};
 }
\ No newline at end of file
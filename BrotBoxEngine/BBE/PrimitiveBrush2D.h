@@ -4,6 +4,7 @@
 #include "../BBE/Color.h"
 #include "../BBE/FillMode.h"
 #include "../BBE/Vector2.h"
+#include "../BBE/CommandBuffer2D.h"
 
 namespace bbe
 {
@@ -43,6 +44,10 @@ namespace bbe
 		{
 			class NullRendererManager;
 		}
+		namespace softwareRenderer
+		{
+			class SoftwareRendererManager;
+		}
 		namespace openGl
 		{
 			class OpenGLManager;
@@ -53,6 +58,7 @@ namespace bbe
 	{
 		friend class INTERNAL::vulkan::VulkanManager;
 		friend class INTERNAL::nullRenderer::NullRendererManager;
+		friend class INTERNAL::softwareRenderer::SoftwareRendererManager;
 		friend class INTERNAL::openGl::OpenGLManager;
 	private:
 
@@ -64,11 +70,14 @@ namespace bbe
 		Color m_color = Color(-1000, -1000, -1000);
 		Color m_outlineColor = Color(-1000, -1000, -1000);
 		bbe::Vector2 m_offset = {0, 0};
+		int32_t m_layer = 0;
 
 		bbe::RenderManager* m_prenderManager = nullptr;
+		bbe::CommandBuffer2D m_commandBuffer;
 
 		void INTERNAL_fillRect(const Rectangle &rect, float rotation, float outlineWidth, FragmentShader* shader);
 		void INTERNAL_drawImage(const Rectangle &rect, const Image &image, float rotation);
+		void INTERNAL_drawImage(const Rectangle &rect, const Image &image, float rotation, const Rectangle &uv);
 		void INTERNAL_fillCircle(const Circle &circle, float outlineWidth);
 		void INTERNAL_setColor(float r, float g, float b, float a);
 		void INTERNAL_beginDraw(
@@ -76,6 +85,8 @@ namespace bbe
 			int screenWidth, int screenHeight,
 			bbe::RenderManager *renderManager
 		);
+		void INTERNAL_endDraw();
+		void INTERNAL_flush();
 
 		void INTERNAL_destroy();
 
@@ -129,8 +140,13 @@ namespace bbe
 		void fillArrow(float x1, float y1, float x2, float y2, float tailWidth = 1, float spikeInnerLength = 20, float spikeOuterLength = 30, float spikeAngle = 0.35, bool dynamicSpikeLength = true);
 		void fillArrow(const Vector2& p1, const Vector2& p2,   float tailWidth = 1, float spikeInnerLength = 20, float spikeOuterLength = 30, float spikeAngle = 0.35, bool dynamicSpikeLength = true);
 
-		void fillLineStrip(const bbe::List<bbe::Vector2>& points, bool closed, float lineWidth = 1);
-		void fillLineStrip(const bbe::List<bbe::Vector2d>& points, bool closed, float lineWidth = 1);
+		void fillLineStrip(const bbe::Vector2* points, size_t amountOfPoints, bool closed, float lineWidth = 1);
+		void fillLineStrip(const bbe::Vector2d* points, size_t amountOfPoints, bool closed, float lineWidth = 1);
+		template<typename Vec, typename Allocator>
+		void fillLineStrip(const bbe::List<Vec, Allocator>& points, bool closed, float lineWidth = 1)
+		{
+			fillLineStrip(points.getRaw(), points.getLength(), closed, lineWidth);
+		}
 
 		void fillBezierCurve(const Vector2& startPoint, const Vector2& endPoint, const bbe::List<Vector2>& controlPoints);
 		void fillBezierCurve(const Vector2& startPoint, const Vector2& endPoint);
@@ -178,6 +194,17 @@ namespace bbe
 
 		void setOutlineWidth(float outlineWidht);
 
+		// Everything is drawn in the order of its layer, lower layers first. Within the same layer the draw calls keep
+		// their order, unless reordering is allowed. In that case they are grouped by pipeline and image, so that
+		// e.g. interleaved rects, circles and text are drawn with a handful of draw calls instead of one per primitive.
+		// Only allow it if the primitives of a layer don't overlap or if it doesn't matter which one is on top.
+		// Shaded rects can't be reordered, they are drawn immediately after everything that was recorded before them.
+		// Images must stay alive until draw2D returned.
+		void setLayer(int32_t layer);
+		int32_t getLayer() const;
+		void setReorderWithinLayers(bool reorder);
+		bool isReorderWithinLayers() const;
+
 		void setFillMode(FillMode fm);
 		FillMode getFillMode();
 
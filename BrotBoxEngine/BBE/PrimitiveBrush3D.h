@@ -29,6 +29,10 @@ namespace bbe
 		{
 			class NullRendererManager;
 		}
+		namespace softwareRenderer
+		{
+			class SoftwareRendererManager;
+		}
 		namespace openGl
 		{
 			class OpenGLManager;
@@ -39,6 +43,7 @@ namespace bbe
 	{
 		friend class INTERNAL::vulkan::VulkanManager;
 		friend class INTERNAL::nullRenderer::NullRendererManager;
+		friend class INTERNAL::softwareRenderer::SoftwareRendererManager;
 		friend class INTERNAL::openGl::OpenGLManager;
 	private:
 		int                                          m_screenWidth = -1;
@@ -88,6 +93,10 @@ namespace bbe
 		void bakeLightGammaCorrect(bbe::LightBaker& lightBaker);
 		bbe::Image bakeLightDetach(bbe::LightBaker& lightBaker);
 #endif
+#ifdef BBE_RENDERER_SOFTWARE
+		void fillRectangle(const bbe::Matrix4& transform);
+		void fillModel(const bbe::Matrix4& transform, const bbe::Model& model);
+#endif
 
 		void setColor(float r, float g, float b, float a);
 		void setColor(float r, float g, float b);
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "../BBE/List.h"
+#include "../BBE/String.h"
+
+namespace bbe
+{
+	// Hierarchical zone profiler. Every thread records into its own fixed size ring buffer without taking any locks,
+	// so the memory stays bounded no matter how long recording is active and workers, the sound thread and the IO
+	// thread can all be recorded into one timeline.
+	namespace profiler
+	{
+		namespace INTERNAL
+		{
+			// When a ring buffer is full, the oldest zones of that thread are overwritten. The slot that is written next
+			// is never collected, so at most ZONES_PER_THREAD - 1 zones per thread are returned.
+			constexpr size_t ZONES_PER_THREAD = 16 * 1024;
+			constexpr size_t MAX_AMOUNT_OF_THREADS = 64;
+			constexpr size_t MAX_DEPTH = 64;
+
+			inline std::atomic_bool enabled = false;
+		}
+
+		struct ZoneRecord
+		{
+			const char* name = nullptr;
+			int64_t startNanos = 0;
+			int64_t durationNanos = 0;
+			uint32_t depth = 0;
+			uint32_t threadIndex = 0;
+		};
+
+		void setEnabled(bool enabled);
+		bool isEnabled();
+
+		// Nanoseconds since the profiler was first used, the time base of all ZoneRecords.
+		int64_t getTimeNanos();
+
+		// Shows up in the trace instead of "Thread <index>". CAREFUL: Static string assumed!
+		void setThreadName(const char* name);
+
+		// Returns false if nothing was recorded, in which case endZone must not be called. force records the
+		// zone even if the profiler is disabled. CAREFUL: Static string assumed!
+		bool beginZone(const char* name, bool force = false);
+		void endZone();
+
+		// Records an already measured zone below the currently open zone of this thread.
+		void recordZone(const char* name, int64_t startNanos, int64_t endNanos, bool force = false);
+
+		// Forgets all recorded zones. Threads keep their buffers and names.
+		void clear();
+
+		// All zones that are still in the ring buffers, sorted by start time.
+		bbe::List<ZoneRecord> collectZones();
+
+		// Chrome trace event format. Can be opened in chrome://tracing or https://ui.perfetto.dev
+		bbe::String toChromeTrace();
+		void writeChromeTrace(const bbe::String& path);
+
+		class Zone
+		{
+		private:
+			bool m_recording;
+
+		public:
+			explicit Zone(const char* name)
+				: m_recording(INTERNAL::enabled.load(std::memory_order_relaxed) && beginZone(name))
+			{
+			}
+			~Zone()
+			{
+				if (m_recording) endZone();
+			}
+
+			Zone(const Zone&) = delete;
+			Zone(Zone&&) = delete;
+			Zone& operator=(const Zone&) = delete;
+			Zone& operator=(Zone&&) = delete;
+		};
+	}
+}
+
+#define BBE_PROFILER_CONCAT_INNER(a, b) a##b
+#define BBE_PROFILER_CONCAT(a, b) BBE_PROFILER_CONCAT_INNER(a, b)
+
+// Records the rest of the enclosing scope as a zone. Compiles to nothing with BBE_NO_PROFILER and costs a single
+// relaxed load while the profiler is disabled.
+#ifdef BBE_NO_PROFILER
+#define BBE_PROFILE_ZONE(name)
+#else
+#define BBE_PROFILE_ZONE(name) bbe::profiler::Zone BBE_PROFILER_CONCAT(bbeProfilerZone, __LINE__)(name)
+#endif
@@ -8,6 +8,11 @@
 #include "../BBE/Vector4.h"
 
 namespace bbe {
+	namespace INTERNAL
+	{
+		unsigned int getInitialRandomSeed(std::random_device& randomDevice);
+	}
+
 	class Random
 	{
 	private:
@@ -48,7 +53,7 @@ namespace bbe {
 
 	public:
 		explicit Random()
-			: m_ranDev(), m_mt(m_ranDev())
+			: m_ranDev(), m_mt(INTERNAL::getInitialRandomSeed(m_ranDev))
 		{
 			//DO NOTHING
 		}
@@ -255,6 +260,11 @@ namespace bbe {
 			m_mt.seed(seed);
 		}
 
+		// Randoms that are constructed afterwards are seeded with seed, seed + 1, seed + 2, ... instead of by the
+		// random device. Used for benchmarks and reproducible runs.
+		static void setDeterministicSeed(uint32_t seed);
+		static void clearDeterministicSeed();
+
 		template<typename Container>
 		auto sampleContainer(Container& container)
 		{
@@ -1,8 +1,12 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "../BBE/Vector2.h"
 #include "../BBE/Shape2.h"
 #include "../BBE/Circle.h"
 #include "../BBE/List.h"
+#include "../BBE/MaxRectsPacker.h"
 
 namespace bbe
 {
@@ -276,37 +280,187 @@ namespace bbe
 			return false;
 		}
 
-		static Vec pack(bbe::List<Rectangle_t<Vec>>& list)
+		struct PackSettings
 		{
-			// TODO pretty naive packing that only puts all the rectangles into one line, while stacking them if possible. Improve!
-			if (list.getLength() == 0) return Vec(0, 0);
-			bbe::List<Rectangle_t<Vec>*> ptrs;
-			ptrs.resizeCapacityAndLengthUninit(list.getLength());
+			// No page gets bigger than this. Rectangles that don't fit on the first page continue on the next one.
+			Vec maxPageSize = Vec(std::numeric_limits<SubType>::max(), std::numeric_limits<SubType>::max());
+			bool powerOfTwo = false;
+			bool allowRotation = false;
+		};
+
+		struct PackResult
+		{
+			bbe::List<Vec> pageSizes;
+			// Per rectangle of the packed list.
+			bbe::List<uint32_t> pages;
+			// Rotated rectangles had their width and height swapped.
+			bbe::List<bool> rotated;
+			// Packed area divided by the area of all pages.
+			float fillRatio = 0;
+		};
+
+	private:
+		struct PackPlacement
+		{
+			size_t index = 0;
+			Vec pos;
+			bool rotated = false;
+		};
+
+		static SubType growPackSize(SubType size, SubType maxSize, const PackSettings& settings)
+		{
+			const SubType grown = settings.powerOfTwo ? size * 2 : size + bbe::Math::max<SubType>(size / 10, 1);
+			return bbe::Math::min(grown, maxSize);
+		}
+
+		static SubType roundPackSize(SubType size, const PackSettings& settings)
+		{
+			if (!settings.powerOfTwo) return size;
+			SubType retVal = 1;
+			while (retVal < size) retVal *= 2;
+			return retVal;
+		}
+
+		static bool packPage(const bbe::List<Rectangle_t<Vec>>& list, const bbe::List<size_t>& remaining, const Vec& pageSize, const PackSettings& settings, bool allOrNothing, bbe::MaxRectsPacker_t<Vec>& packer, bbe::List<PackPlacement>& outPlaced, bbe::List<size_t>& outLeftOver)
+		{
+			packer.reset(pageSize, settings.allowRotation);
+			outPlaced.clear();
+			outLeftOver.clear();
+			for (size_t i = 0; i < remaining.getLength(); i++)
+			{
+				PackPlacement placement;
+				placement.index = remaining[i];
+				if (packer.insert(list[placement.index].getDim(), placement.pos, placement.rotated))
+				{
+					outPlaced.add(placement);
+				}
+				else
+				{
+					if (allOrNothing) return false;
+					outLeftOver.add(placement.index);
+				}
+			}
+			return true;
+		}
+
+	public:
+		// Places the rectangles without overlap onto as few and as small pages as possible.
+		static PackResult pack(bbe::List<Rectangle_t<Vec>>& list, const PackSettings& settings)
+		{
+			PackResult result;
+			if (list.getLength() == 0) return result;
+
+			result.pages.resizeCapacityAndLength(list.getLength());
+			result.rotated.resizeCapacityAndLength(list.getLength());
+
+			SubType maxWidth = settings.maxPageSize.x;
+			SubType maxHeight = settings.maxPageSize.y;
+			if (settings.powerOfTwo)
+			{
+				// Round down, so that rounding a page up never exceeds the max size.
+				SubType pot = 1;
+				while (pot <= maxWidth / 2) pot *= 2;
+				maxWidth = pot;
+				pot = 1;
+				while (pot <= maxHeight / 2) pot *= 2;
+				maxHeight = pot;
+			}
+
+			double packedArea = 0;
+			bbe::List<size_t> remaining;
 			for (size_t i = 0; i < list.getLength(); i++)
 			{
-				ptrs[i] = &(list[i]);
+				const Rectangle_t<Vec>& rect = list[i];
+				const bool fits = (rect.width <= maxWidth && rect.height <= maxHeight)
+					|| (settings.allowRotation && rect.height <= maxWidth && rect.width <= maxHeight);
+				if (rect.width < 0 || rect.height < 0 || !fits)
+				{
+					bbe::Crash(bbe::Error::IllegalArgument);
+				}
+				packedArea += (double)rect.width * (double)rect.height;
+				remaining.add(i);
 			}
-			ptrs.sort([](const Rectangle_t<Vec>* const& a, const Rectangle_t<Vec>* const& b) {
-				return a->height > b->height;
+			// Big rectangles first, the small ones fill the gaps between them.
+			std::stable_sort(remaining.begin(), remaining.end(), [&](size_t a, size_t b) {
+				const SubType longA = bbe::Math::max(list[a].width, list[a].height);
+				const SubType longB = bbe::Math::max(list[b].width, list[b].height);
+				if (longA != longB) return longA > longB;
+				return list[a].width * list[a].height > list[b].width * list[b].height;
 				});
-			const SubType height = ptrs[0]->height;
-			SubType currentX = 0;
-			SubType currentY = 0;
-			SubType biggestWidthInCurrentColumn = 0;
-			for (size_t i = 0; i < ptrs.getLength(); i++)
+
+			bbe::MaxRectsPacker_t<Vec> packer;
+			bbe::List<PackPlacement> placed;
+			bbe::List<size_t> leftOver;
+			double pagesArea = 0;
+			while (!remaining.isEmpty())
 			{
-				if (currentY + ptrs[i]->height > height)
+				double remainingArea = 0;
+				SubType widest = 0;
+				SubType highest = 0;
+				SubType longestShortSide = 0;
+				for (size_t i = 0; i < remaining.getLength(); i++)
+				{
+					const Rectangle_t<Vec>& rect = list[remaining[i]];
+					remainingArea += (double)rect.width * (double)rect.height;
+					widest = bbe::Math::max(widest, rect.width);
+					highest = bbe::Math::max(highest, rect.height);
+					longestShortSide = bbe::Math::max(longestShortSide, bbe::Math::min(rect.width, rect.height));
+				}
+
+				// Start with a square of the remaining area and grow it until everything fits or the max size is reached.
+				const SubType side = bbe::Math::max<SubType>((SubType)std::ceil(std::sqrt(remainingArea)), 1);
+				const Vec minSize = settings.allowRotation ? Vec(longestShortSide, longestShortSide) : Vec(widest, highest);
+				Vec pageSize(
+					bbe::Math::min(roundPackSize(bbe::Math::max(side, minSize.x), settings), maxWidth),
+					bbe::Math::min(roundPackSize(bbe::Math::max(side, minSize.y), settings), maxHeight));
+				while (true)
 				{
-					currentX += biggestWidthInCurrentColumn;
-					currentY = 0;
-					biggestWidthInCurrentColumn = 0;
+					const bool isMaxSize = pageSize.x == maxWidth && pageSize.y == maxHeight;
+					if (packPage(list, remaining, pageSize, settings, !isMaxSize, packer, placed, leftOver)) break;
+
+					// Grow the shorter side, so that the page stays roughly square.
+					if ((pageSize.x <= pageSize.y && pageSize.x < maxWidth) || pageSize.y == maxHeight)
+					{
+						pageSize.x = growPackSize(pageSize.x, maxWidth, settings);
+					}
+					else
+					{
+						pageSize.y = growPackSize(pageSize.y, maxHeight, settings);
+					}
 				}
-				ptrs[i]->x = currentX;
-				ptrs[i]->y = currentY;
-				currentY += ptrs[i]->height;
-				if (biggestWidthInCurrentColumn < ptrs[i]->width) biggestWidthInCurrentColumn = ptrs[i]->width;
+
+				const uint32_t page = (uint32_t)result.pageSizes.getLength();
+				for (size_t i = 0; i < placed.getLength(); i++)
+				{
+					const PackPlacement& placement = placed[i];
+					Rectangle_t<Vec>& rect = list[placement.index];
+					rect.x = placement.pos.x;
+					rect.y = placement.pos.y;
+					if (placement.rotated) std::swap(rect.width, rect.height);
+					result.pages[placement.index] = page;
+					result.rotated[placement.index] = placement.rotated;
+				}
+
+				// Cut off what stayed empty on the right and bottom.
+				const Vec used = packer.getUsedDimensions();
+				const Vec trimmed(
+					roundPackSize(bbe::Math::max<SubType>(used.x, 1), settings),
+					roundPackSize(bbe::Math::max<SubType>(used.y, 1), settings));
+				result.pageSizes.add(trimmed);
+				pagesArea += (double)trimmed.x * (double)trimmed.y;
+
+				std::swap(remaining, leftOver);
 			}
-			return Vec(currentX + biggestWidthInCurrentColumn, height);
+
+			result.fillRatio = (float)(packedArea / pagesArea);
+			return result;
+		}
+
+		// Packs everything onto a single page without rotation and returns its size.
+		static Vec pack(bbe::List<Rectangle_t<Vec>>& list)
+		{
+			if (list.getLength() == 0) return Vec(0, 0);
+			return pack(list, PackSettings()).pageSizes[0];
 		}
 	};
 
@@ -47,5 +47,9 @@ namespace bbe
 
 		using Shape2<Vector2>::getVertices;
 		virtual void getVertices(bbe::List<bbe::Vector2>& outVertices) const override;
+
+		// Take the allocation free bbe::sat path if other is a RectangleRotated or a Rectangle.
+		virtual bool intersects(const Shape<bbe::Vector2>& other) const override;
+		virtual bool resolveIntersection(const Shape<bbe::Vector2>& other) override;
 	};
 }
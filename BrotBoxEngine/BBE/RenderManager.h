@@ -27,6 +27,9 @@ namespace bbe
 	class Circle;
 	class Image;
 	class Matrix4;
+	class CommandBuffer2D;
+	class AutoRef;
+	class FrameCapture;
 
 	class RenderManager
 	{
@@ -54,6 +57,13 @@ namespace bbe
 		virtual void screenshot(const bbe::String& path) = 0;
 		virtual void setVideoRenderingMode(const char* path) = 0;
 
+		// Hands the next frame that is drawn to capture, right before it is presented. Backends may read it back
+		// asynchronously, so it can arrive at capture a few frames later. flushFrameCapture hands over everything that
+		// is still being read back. Backends that can't capture return false from isFrameCaptureSupported.
+		virtual bool isFrameCaptureSupported() const;
+		virtual void captureFrame(bbe::FrameCapture& capture, uint64_t frameNumber);
+		virtual void flushFrameCapture();
+
 		void setFillMode2D(bbe::FillMode fm);
 		bbe::FillMode getFillMode2D();
 		virtual void setColor2D(const bbe::Color& color) = 0;
@@ -61,6 +71,15 @@ namespace bbe
 		virtual void fillCircle2D(const Circle& circle) = 0;
 		virtual void drawImage2D(const Rectangle& rect, const Image& image, float rotation) = 0;
 		virtual void fillVertexIndexList2D(const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, size_t amountOfVertices, const bbe::Vector2& pos, const bbe::Vector2 &scale) = 0;
+		// Called with the sorted and merged commands that PrimitiveBrush2D recorded. The default implementation draws
+		// them one by one through the functions above, backends override it to draw every batch at once.
+		virtual void submit2D(const bbe::CommandBuffer2D& commandBuffer);
+		// Whether submit2D draws only the uv part of an image. If not, PrimitiveBrush2D records whole images only.
+		virtual bool isImageRegionSupported2D() const;
+		// Called when PrimitiveBrush2D records an image, which might be gone before the command is submitted. Backends
+		// that can draw it without the Image set imageData to what they need and return true. Otherwise the command is
+		// submitted right away.
+		virtual bool retainImage2D(const Image& image, bbe::AutoRef& imageData);
 
 		void setFillMode3D(bbe::FillMode fm);
 		bbe::FillMode getFillMode3D();
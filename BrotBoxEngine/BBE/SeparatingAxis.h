@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../BBE/Vector2.h"
+#include "../BBE/Vector3.h"
+
+namespace bbe
+{
+	class RectangleRotated;
+	class Cube;
+	template<typename Vec> class Rectangle_t;
+	using Rectangle = Rectangle_t<bbe::Vector2>;
+
+	// Separating axis tests for the shapes with a fixed amount of vertices. Unlike Shape::intersects they never touch
+	// the heap: the vertices are kept in stack arrays, one array per coordinate, so that four of them are projected
+	// onto an axis at once.
+	namespace sat
+	{
+		struct Hull2
+		{
+			alignas(16) float x[4];
+			alignas(16) float y[4];
+			// The edge normals. Opposite edges share a normal.
+			bbe::Vector2 axes[2];
+		};
+
+		struct Hull3
+		{
+			alignas(16) float x[8];
+			alignas(16) float y[8];
+			alignas(16) float z[8];
+			bbe::Vector3 axes[3];
+		};
+
+		Hull2 makeHull(const bbe::RectangleRotated& rect);
+		Hull2 makeHull(const bbe::Rectangle& rect);
+		Hull3 makeHull(const bbe::Cube& cube);
+
+		bool intersects(const Hull2& a, const Hull2& b);
+		bool intersects(const Hull3& a, const Hull3& b);
+
+		// Same as Shape2::resolveIntersection: If the hulls intersect, outTranslation is set to the smallest translation
+		// of a that separates them.
+		bool resolveIntersection(const Hull2& a, const Hull2& b, bbe::Vector2& outTranslation);
+
+		template<typename A, typename B>
+		bool intersects(const A& a, const B& b)
+		{
+			return intersects(makeHull(a), makeHull(b));
+		}
+
+		// Tests shape against every one of others and writes the results to outResults. Returns the amount of hits.
+		template<typename A, typename B>
+		size_t intersects(const A& shape, const B* others, size_t amountOfOthers, bool* outResults)
+		{
+			const auto hull = makeHull(shape);
+			size_t hits = 0;
+			for (size_t i = 0; i < amountOfOthers; i++)
+			{
+				outResults[i] = intersects(hull, makeHull(others[i]));
+				if (outResults[i]) hits++;
+			}
+			return hits;
+		}
+	}
+}
@@ -3,7 +3,10 @@
 #include "../BBE/List.h"
 #include "../BBE/String.h"
 #include "../BBE/SimpleFile.h"
-#include "../BBE/UndoableObject.h"
+#include "../BBE/UndoableList.h"
+#include "../BBE/Journal.h"
+#include "../BBE/MappedFile.h"
+#include <algorithm>
 #include <ctime>
 
 #define BBE_TEMPLATE_ESCAPE(...) __VA_ARGS__
@@ -247,56 +250,391 @@ namespace bbe
 	private:
 		bbe::String path;
 		bbe::String paranoiaPath;
-		bbe::UndoableObject<bbe::List<T>> data;
+		bbe::String paranoiaSegmentPath;
+		bbe::UndoableList<T> data;
+		// The serialized elements as the file currently describes them. Comparing against them finds the elements that
+		// were changed through operator[], getList() or undo/redo, and compaction writes them without serializing again.
+		bbe::List<bbe::List<bbe::byte>> written;
+		size_t writtenPayloadBytes = 0;
+		size_t fileBytes = 0;
+		float compactionRatio = 2.f;
+		// Elements that were handed out through operator[] since the last write, each one once. Only they have to be
+		// compared with written, unless the whole list was handed out through getList().
+		bbe::List<size_t> dirtyIndices;
+		bbe::List<bool> isDirty;
+		bool allDirty = false;
 
 		Undoable undoable = Undoable::NO;
 
+		constexpr static size_t minimumCompactionSize = 16 * 1024;
+
 		constexpr static bool hasSerialDescription = requires(T & t, bbe::SerializedDescription & desc) {
 			t.serialDescription(desc);
 		};
 
+		static T deserializeElement(bbe::ByteBufferSpan& span)
+		{
+			if constexpr (hasSerialDescription)
+			{
+				T t;
+				bbe::SerializedDescription desc;
+				t.serialDescription(desc);
+				desc.writeFromSpan(span);
+				return t;
+			}
+			else
+			{
+				return T::deserialize(span);
+			}
+		}
+
+		static bbe::List<bbe::byte> serializeElement(T& t)
+		{
+			bbe::ByteBuffer buffer;
+			buffer.write(t);
+			bbe::List<bbe::byte> retVal;
+			retVal.addArray(buffer.getRaw(), buffer.getLength());
+			return retVal;
+		}
+
 		void load(const bbe::String& path, const bbe::List<T>& data)
 		{
 			this->path = path;
+			bool requiresCompaction = true;
 			if (bbe::simpleFile::doesFileExist(path))
 			{
-				// TODO: Check if load is even required
-				bbe::ByteBuffer binary = bbe::simpleFile::readBinaryFile(path);
-				bbe::ByteBufferSpan span = binary.getSpan();
-				while (span.hasMore())
+				// Closed again at the end of this scope, before the compaction below replaces the file.
+				const bbe::MappedFile file(path);
+				const bbe::ByteBufferSpan binary = file.getSpan();
+				if (bbe::INTERNAL::journal::hasHeader(binary))
 				{
-					int64_t size;
-					span.read(size);
-					auto subSpan = span.readSpan(size);
-
-					if constexpr (hasSerialDescription)
-					{
-						T t;
-						bbe::SerializedDescription desc;
-						t.serialDescription(desc);
-						desc.writeFromSpan(subSpan);
-						this->data.get().add(t);
-					}
-					else
+					bbe::List<bbe::INTERNAL::journal::Record> records;
+					const size_t validLength = bbe::INTERNAL::journal::readRecords(binary, records);
+					// A torn or corrupted tail has to go before anything can be appended again.
+					requiresCompaction = !replay(records) || validLength != binary.getLength();
+					fileBytes = validLength;
+				}
+				else
+				{
+					// Files from before the journal were a plain list of size prefixed elements. The compaction below
+					// converts them.
+					bbe::ByteBufferSpan span = binary;
+					while (span.hasMore())
 					{
-						this->data.get().add(T::deserialize(subSpan));
+						int64_t size;
+						span.read(size);
+						auto subSpan = span.readSpan(size);
+						this->data.get().add(deserializeElement(subSpan));
 					}
 				}
 			}
 			else
 			{
 				this->data.get() = data;
-				writeToFile();
 			}
+
+			for (size_t i = 0; i < this->data.get().getLength(); i++)
+			{
+				written.add(serializeElement(this->data.get()[i]));
+				writtenPayloadBytes += written.last().getLength();
+			}
+			if (requiresCompaction) compact();
 			this->data.clearHistory();
 		}
 
+		// Stops at the first record that doesn't fit the list, which only happens for corrupted files.
+		bool replay(bbe::List<bbe::INTERNAL::journal::Record>& records)
+		{
+			using bbe::INTERNAL::journal::RecordType;
+			bbe::List<T>& list = this->data.get();
+			for (size_t i = 0; i < records.getLength(); i++)
+			{
+				bbe::INTERNAL::journal::Record& record = records[i];
+				const size_t length = list.getLength();
+				switch (record.type)
+				{
+				case RecordType::ADD:
+					if (record.a > length) return false;
+					list.add(deserializeElement(record.payload));
+					std::rotate(list.begin() + record.a, list.end() - 1, list.end());
+					break;
+				case RecordType::REMOVE:
+					if (record.a >= length) return false;
+					list.removeIndex(record.a);
+					break;
+				case RecordType::UPDATE:
+					if (record.a >= length) return false;
+					list[record.a] = deserializeElement(record.payload);
+					break;
+				case RecordType::SWAP:
+					if (record.a >= length || record.b >= length) return false;
+					list.swap(record.a, record.b);
+					break;
+				default:
+					return false;
+				}
+			}
+			return true;
+		}
+
+		T readWritten(size_t index)
+		{
+			bbe::ByteBufferSpan span(written[index]);
+			return deserializeElement(span);
+		}
+
+		void setWritten(size_t index, bbe::List<bbe::byte>&& bytes)
+		{
+			writtenPayloadBytes -= written[index].getLength();
+			writtenPayloadBytes += bytes.getLength();
+			written[index] = std::move(bytes);
+		}
+
+		void removeWritten(size_t index)
+		{
+			writtenPayloadBytes -= written[index].getLength();
+			written.removeIndex(index);
+		}
+
+		bbe::ByteBuffer buildCompacted()
+		{
+			bbe::ByteBuffer buffer;
+			bbe::INTERNAL::journal::writeHeader(buffer);
+			for (size_t i = 0; i < written.getLength(); i++)
+			{
+				bbe::INTERNAL::journal::writeRecord(buffer, bbe::INTERNAL::journal::RecordType::ADD, i, 0, written[i].getRaw(), written[i].getLength());
+			}
+			return buffer;
+		}
+
+		// Every compaction starts a new paranoia segment: a snapshot that all following records are appended to, so any
+		// backup can be replayed to every state it has seen.
+		void startParanoiaSegment(const bbe::ByteBuffer& snapshot)
+		{
+			time_t t;
+			time(&t);
+			bbe::simpleFile::backup::async::createDirectory(paranoiaPath);
+			paranoiaSegmentPath = paranoiaPath + "/" + path + t + ".bak";
+			bbe::simpleFile::backup::async::writeBinaryToFile(paranoiaSegmentPath, snapshot);
+		}
+
+		void compact()
+		{
+			const bbe::ByteBuffer buffer = buildCompacted();
+			bbe::simpleFile::backup::async::writeBinaryToFile(path, buffer);
+			fileBytes = buffer.getLength();
+			if (paranoiaPath.getLength() != 0)
+			{
+				startParanoiaSegment(buffer);
+			}
+		}
+
+		// written must already describe the state after the records.
+		void appendRecords(const bbe::ByteBuffer& records)
+		{
+			if (records.getLength() == 0) return;
+
+			const size_t compactedSize = bbe::INTERNAL::journal::headerSize + written.getLength() * bbe::INTERNAL::journal::recordOverhead + writtenPayloadBytes;
+			const size_t newFileBytes = fileBytes + records.getLength();
+			if (newFileBytes > minimumCompactionSize && (float)newFileBytes > compactionRatio * (float)compactedSize)
+			{
+				compact();
+				return;
+			}
+
+			bbe::simpleFile::backup::async::appendBinaryToFile(path, records);
+			fileBytes = newFileBytes;
+			if (paranoiaPath.getLength() != 0)
+			{
+				if (paranoiaSegmentPath.getLength() == 0)
+				{
+					startParanoiaSegment(buildCompacted());
+				}
+				else
+				{
+					bbe::simpleFile::backup::async::appendBinaryToFile(paranoiaSegmentPath, records);
+				}
+			}
+		}
+
+		void clearDirty()
+		{
+			for (size_t i = 0; i < dirtyIndices.getLength(); i++)
+			{
+				isDirty[dirtyIndices[i]] = false;
+			}
+			dirtyIndices.clear();
+		}
+
+		bool hasUntrackedEdits() const
+		{
+			return allDirty || !dirtyIndices.isEmpty() || written.getLength() != data.get().getLength();
+		}
+
+		// Appends records for every element that serializes differently than what the file describes. With
+		// updateHistory the previous state is recovered from the written bytes and becomes part of the history,
+		// otherwise the change just becomes the new baseline. Unless everything is dirty, only the elements that were
+		// handed out through operator[] are compared.
+		void persist(bool updateHistory)
+		{
+			using bbe::INTERNAL::journal::RecordType;
+			updateHistory = updateHistory && undoable == Undoable::YES;
+
+			const bool checkAll = allDirty || written.getLength() != data.get().getLength();
+			allDirty = false;
+			if (!checkAll)
+			{
+				bbe::ByteBuffer records;
+				for (size_t i = 0; i < dirtyIndices.getLength(); i++)
+				{
+					const size_t index = dirtyIndices[i];
+					bbe::List<bbe::byte> bytes = serializeElement(data.get()[index]);
+					if (bytes == written[index]) continue;
+					if (updateHistory) data.recordReplaced(index, readWritten(index));
+					bbe::INTERNAL::journal::writeRecord(records, RecordType::UPDATE, index, 0, bytes.getRaw(), bytes.getLength());
+					setWritten(index, std::move(bytes));
+				}
+				clearDirty();
+				appendRecords(records);
+				return;
+			}
+			clearDirty();
+
+			bbe::List<bbe::List<bbe::byte>> current;
+			for (size_t i = 0; i < data.get().getLength(); i++)
+			{
+				current.add(serializeElement(data.get()[i]));
+			}
+
+			const size_t oldLength = written.getLength();
+			const size_t newLength = current.getLength();
+			bbe::ByteBuffer records;
+			if (oldLength == newLength)
+			{
+				for (size_t i = 0; i < newLength; i++)
+				{
+					if (current[i] == written[i]) continue;
+					if (updateHistory) data.recordReplaced(i, readWritten(i));
+					bbe::INTERNAL::journal::writeRecord(records, RecordType::UPDATE, i, 0, current[i].getRaw(), current[i].getLength());
+					setWritten(i, std::move(current[i]));
+				}
+				appendRecords(records);
+				return;
+			}
+
+			if (updateHistory)
+			{
+				// Elements were added or removed through getList(), the only thing left is a full snapshot.
+				bbe::List<T> previous;
+				for (size_t i = 0; i < oldLength; i++)
+				{
+					previous.add(readWritten(i));
+				}
+				data.recordSnapshot(std::move(previous));
+			}
+
+			// Undoing an add or remove changes the length by one, which can still be described by a single record.
+			const size_t shorter = bbe::Math::min(oldLength, newLength);
+			size_t prefix = 0;
+			while (prefix < shorter && current[prefix] == written[prefix]) prefix++;
+			size_t suffix = 0;
+			while (suffix < shorter - prefix && current[newLength - 1 - suffix] == written[oldLength - 1 - suffix]) suffix++;
+
+			if (newLength == oldLength + 1 && prefix + suffix == oldLength)
+			{
+				bbe::INTERNAL::journal::writeRecord(records, RecordType::ADD, prefix, 0, current[prefix].getRaw(), current[prefix].getLength());
+				writtenPayloadBytes += current[prefix].getLength();
+				written.add(std::move(current[prefix]));
+				std::rotate(written.begin() + prefix, written.end() - 1, written.end());
+				appendRecords(records);
+			}
+			else if (newLength + 1 == oldLength && prefix + suffix == newLength)
+			{
+				bbe::INTERNAL::journal::writeRecord(records, RecordType::REMOVE, prefix, 0, nullptr, 0);
+				removeWritten(prefix);
+				appendRecords(records);
+			}
+			else
+			{
+				written = std::move(current);
+				writtenPayloadBytes = 0;
+				for (size_t i = 0; i < written.getLength(); i++)
+				{
+					writtenPayloadBytes += written[i].getLength();
+				}
+				compact();
+			}
+		}
+
+		// Puts changes that were made through operator[] or getList() into their own history step.
+		void submitUntrackedEdits()
+		{
+			if (!hasUntrackedEdits()) return;
+			persist(true);
+			pushUndoable();
+		}
+
+		// Mirrors what undo() or redo() did to the list in written and the file. Every reverted or reapplied edit
+		// becomes one record, only whole list snapshots need the full comparison.
+		template<typename Step>
+		void stepHistory(Step&& step)
+		{
+			using bbe::INTERNAL::journal::RecordType;
+			using Change = typename bbe::UndoableList<T>::Change;
+			bbe::ByteBuffer records;
+			bool replacedAll = false;
+			step([&](Change change, size_t a, size_t b)
+				{
+					if (replacedAll) return;
+					switch (change)
+					{
+					case Change::ADDED:
+					{
+						bbe::List<bbe::byte> bytes = serializeElement(data.get()[a]);
+						bbe::INTERNAL::journal::writeRecord(records, RecordType::ADD, a, 0, bytes.getRaw(), bytes.getLength());
+						writtenPayloadBytes += bytes.getLength();
+						written.add(std::move(bytes));
+						std::rotate(written.begin() + a, written.end() - 1, written.end());
+						break;
+					}
+					case Change::REMOVED:
+						bbe::INTERNAL::journal::writeRecord(records, RecordType::REMOVE, a, 0, nullptr, 0);
+						removeWritten(a);
+						break;
+					case Change::SWAPPED:
+						bbe::INTERNAL::journal::writeRecord(records, RecordType::SWAP, a, b, nullptr, 0);
+						written.swap(a, b);
+						break;
+					case Change::REPLACED:
+					{
+						bbe::List<bbe::byte> bytes = serializeElement(data.get()[a]);
+						bbe::INTERNAL::journal::writeRecord(records, RecordType::UPDATE, a, 0, bytes.getRaw(), bytes.getLength());
+						setWritten(a, std::move(bytes));
+						break;
+					}
+					case Change::REPLACED_ALL:
+						replacedAll = true;
+						break;
+					}
+				});
+			appendRecords(records);
+			if (replacedAll)
+			{
+				allDirty = true;
+				persist(false);
+			}
+		}
+
 		void pushUndoable()
 		{
 			if (undoable == Undoable::YES)
 			{
 				data.submit();
 			}
+			else
+			{
+				data.clearHistory();
+			}
 		}
 
 		SerializableList()
@@ -323,20 +661,29 @@ namespace bbe
 
 		void add(T /*copy*/ t)
 		{
-			data.get().add(std::move(t));
-			bbe::ByteBuffer buffer;
-			auto token = buffer.reserveSizeToken();
-			buffer.write(data.get().last());
-			buffer.fillSizeToken(token);
-			bbe::simpleFile::backup::async::appendBinaryToFile(path, buffer);
+			// The written elements have to line up with the list again before anything can be appended.
+			submitUntrackedEdits();
+			data.add(std::move(t));
+			const size_t index = data.get().getLength() - 1;
+			bbe::List<bbe::byte> bytes = serializeElement(data.get()[index]);
+			bbe::ByteBuffer records;
+			bbe::INTERNAL::journal::writeRecord(records, bbe::INTERNAL::journal::RecordType::ADD, index, 0, bytes.getRaw(), bytes.getLength());
+			writtenPayloadBytes += bytes.getLength();
+			written.add(std::move(bytes));
+			appendRecords(records);
 			pushUndoable();
 		}
 
 		bool removeIndex(size_t index)
 		{
-			if (data.get().removeIndex(index))
+			submitUntrackedEdits();
+			if (data.removeIndex(index))
 			{
-				writeToFile();
+				removeWritten(index);
+				bbe::ByteBuffer records;
+				bbe::INTERNAL::journal::writeRecord(records, bbe::INTERNAL::journal::RecordType::REMOVE, index, 0, nullptr, 0);
+				appendRecords(records);
+				pushUndoable();
 				return true;
 			}
 			return false;
@@ -344,8 +691,16 @@ namespace bbe
 
 		bool swap(size_t a, size_t b)
 		{
-			bool retVal = data.get().swap(a, b);
-			if(retVal) writeToFile();
+			submitUntrackedEdits();
+			bool retVal = data.swap(a, b);
+			if (retVal)
+			{
+				written.swap(a, b);
+				bbe::ByteBuffer records;
+				bbe::INTERNAL::journal::writeRecord(records, bbe::INTERNAL::journal::RecordType::SWAP, a, b, nullptr, 0);
+				appendRecords(records);
+				pushUndoable();
+			}
 			return retVal;
 		}
 
@@ -356,7 +711,14 @@ namespace bbe
 
 		T& operator[](size_t index)
 		{
-			return data.get()[index];
+			T& element = data.get()[index];
+			if (index >= isDirty.getLength()) isDirty.add(false, index + 1 - isDirty.getLength());
+			if (!isDirty[index])
+			{
+				isDirty[index] = true;
+				dirtyIndices.add(index);
+			}
+			return element;
 		}
 
 		const T& operator[](size_t index) const
@@ -364,25 +726,29 @@ namespace bbe
 			return data.get()[index];
 		}
 
+		// Only appends records for the elements that changed since the last write. Compares every element, so that
+		// changes through references that were kept from earlier calls to operator[] are found as well.
 		void writeToFile(bool updateHistory = true)
 		{
-			bbe::ByteBuffer buffer;
-			for (size_t i = 0; i < data.get().getLength(); i++)
-			{
-				auto token = buffer.reserveSizeToken();
-				buffer.write(data.get()[i]);
-				buffer.fillSizeToken(token);
-			}
-			bbe::simpleFile::backup::async::writeBinaryToFile(path, buffer);
-			if (paranoiaPath.getLength() != 0)
+			allDirty = true;
+			persist(updateHistory);
+			if(updateHistory) pushUndoable();
+		}
+
+		// 0 means unbounded. Only applies to lists that were created with Undoable::YES.
+		void setMaxHistoryDepth(size_t depth)
+		{
+			data.setMaxHistoryDepth(depth);
+		}
+
+		// The file is rewritten once it gets this many times larger than a freshly written one would be.
+		void setCompactionRatio(float ratio)
+		{
+			if (!(ratio > 1.f))
 			{
-				time_t t;
-				time(&t);
-				bbe::simpleFile::backup::async::createDirectory(paranoiaPath);
-				bbe::simpleFile::backup::async::writeBinaryToFile(paranoiaPath + "/" + path + t + ".bak", buffer);
+				bbe::Crash(bbe::Error::IllegalArgument);
 			}
-			
-			if(updateHistory) pushUndoable();
+			compactionRatio = ratio;
 		}
 
 		bool canUndo() const
@@ -392,8 +758,8 @@ namespace bbe
 
 		void undo()
 		{
-			data.undo();
-			writeToFile(false);
+			submitUntrackedEdits();
+			stepHistory([&](auto&& listener) { data.undo(listener); });
 		}
 
 		bool canRedo() const
@@ -403,8 +769,9 @@ namespace bbe
 
 		void redo()
 		{
-			data.redo();
-			writeToFile(false);
+			// A new history step would drop everything that can be redone, so untracked edits just become the baseline.
+			if (hasUntrackedEdits()) persist(false);
+			stepHistory([&](auto&& listener) { data.redo(listener); });
 		}
 
 		const bbe::List<T>& getList() const
@@ -414,6 +781,7 @@ namespace bbe
 
 		bbe::List<T>& getList()
 		{
+			allDirty = true;
 			return data.get();
 		}
 	};
@@ -2,6 +2,7 @@
 
 #include "../BBE/Vector2.h"
 #include "../BBE/Vector3.h"
+#include "../BBE/FrameArena.h"
 
 namespace bbe
 {
@@ -51,8 +52,10 @@ namespace bbe
 
 		virtual ProjectionResult project(const Vec& projection) const
 		{
-			const bbe::List<Vec> vertices = getVertices();
-			const bbe::List<Vec> projections = bbe::Math::project(vertices, projection);
+			// Called for every axis of every test, so the vertices go into a reused list instead of a new one.
+			static thread_local bbe::List<Vec> vertices;
+			getVertices(vertices);
+			const bbe::FrameList<Vec> projections = bbe::Math::project<Vec, bbe::FrameAllocator>(vertices, projection);
 
 			const float init = (float)(projections[0] * projection);
 			ProjectionResult retVal{ init, init };
@@ -7,6 +7,7 @@
 #include <fstream>
 #include <filesystem>
 #include <optional>
+#include <future>
 
 namespace bbe
 {
@@ -17,8 +18,17 @@ namespace bbe
 			namespace async
 			{
 				bool hasOpenIO();
+				// Queued and currently executing jobs. Superseded writes to the same path are merged into one job.
+				size_t getQueueDepth();
+				uint64_t getBytesWritten();
+				uint64_t getAmountOfCoalescedJobs();
+				// Ready once everything that was queued before the call is on the disk.
+				std::future<void> barrier();
+				void flush();
 				void stopIoThread();
 
+				// Writes go to a temporary file that replaces filePath once it is synced, so a crash never leaves a
+				// partially written file behind.
 				void writeBinaryToFile(const bbe::String& filePath, const bbe::ByteBuffer& buffer);
 				void createDirectory(const bbe::String& path);
 				void appendBinaryToFile(const bbe::String& filePath, const bbe::ByteBuffer& buffer);
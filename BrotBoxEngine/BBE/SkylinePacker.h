@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include "../BBE/List.h"
+#include "../BBE/Vector2.h"
+
+namespace bbe
+{
+	// Packs rectangles into an area of fixed size, as low as possible. Only the upper outline of everything packed so
+	// far is stored as a list of horizontal segments, so an insert costs O(segments) instead of O(rectangles). Space
+	// below an overhang is lost, which is fine for rectangles of similar height like glyphs.
+	class SkylinePacker
+	{
+	private:
+		struct Segment
+		{
+			int32_t x = 0;
+			int32_t y = 0;
+			int32_t width = 0;
+		};
+
+		bbe::List<Segment> m_skyline;
+		bbe::List<Segment> m_scratch;
+		int32_t m_width = 0;
+		int32_t m_height = 0;
+		int64_t m_usedArea = 0;
+
+	public:
+		SkylinePacker() = default;
+		SkylinePacker(int32_t width, int32_t height);
+
+		void reset(int32_t width, int32_t height);
+
+		// Returns false and leaves outPos untouched if the rectangle doesn't fit anymore.
+		bool insert(int32_t width, int32_t height, bbe::Vector2i& outPos);
+
+		int32_t getWidth() const;
+		int32_t getHeight() const;
+		// Packed area divided by the total area.
+		float getFillRatio() const;
+	};
+}
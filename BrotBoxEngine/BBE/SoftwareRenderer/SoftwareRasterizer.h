@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include "../BBE/List.h"
+#include "../BBE/Color.h"
+#include "../BBE/Vector2.h"
+#include "../BBE/Vector4.h"
+
+namespace bbe
+{
+	class Image;
+
+	namespace INTERNAL
+	{
+		namespace softwareRenderer
+		{
+			struct RasterVertex
+			{
+				float x = 0;    // In pixels.
+				float y = 0;    // In pixels.
+				float z = 0;    // Depth in [0, 1], only used by depth tested triangles.
+				float invW = 1; // 1 / clip space w, for perspective correct interpolation. 1 for 2D.
+				bbe::Color color;
+				float u = 0;
+				float v = 0;
+			};
+
+			// Everything that the rasterizer needs to know about a triangle, set up once when it is added.
+			struct RasterTriangle
+			{
+				RasterVertex vertices[3];
+				float edgeA[3] = {};
+				float edgeB[3] = {};
+				float edgeC[3] = {};
+				bool edgeInclusive[3] = {};
+				float area = 0;
+				int32_t minX = 0;
+				int32_t minY = 0;
+				int32_t maxX = 0; // Exclusive.
+				int32_t maxY = 0; // Exclusive.
+				const bbe::Image* image = nullptr;
+				bool depthTested = false;
+				// If set, only pixels within the ellipse are covered.
+				bool ellipse = false;
+				bbe::Vector2 ellipseCenter;
+				bbe::Vector2 ellipseInvRadius;
+			};
+
+			// Tiled triangle rasterizer. Triangles are collected and binned into screen tiles, and on flush() every tile is
+			// rasterized on its own by the job system. A tile draws its triangles in the order in which they were added, so
+			// the result doesn't depend on the amount of threads. Coverage is tested with edge functions for four pixels
+			// at once and follows the top left rule, so triangles that share an edge never both draw a pixel on it.
+			class Rasterizer
+			{
+			public:
+				static constexpr int32_t TILE_SIZE = 64;
+
+			private:
+				int32_t m_width = 0;
+				int32_t m_height = 0;
+				int32_t m_tilesX = 0;
+				int32_t m_tilesY = 0;
+				bbe::List<uint32_t> m_color; // RGBA8, same byte order as ImageFormat::R8G8B8A8.
+				bbe::List<float> m_depth;
+
+				bbe::List<RasterTriangle> m_triangles;
+				bbe::List<bbe::List<uint32_t>> m_tileBins;
+
+				uint64_t m_amountOfTrianglesDrawn = 0;
+
+				void rasterizeTile(int32_t tileX, int32_t tileY);
+				void rasterizeTriangle(const RasterTriangle& triangle, int32_t minX, int32_t minY, int32_t maxX, int32_t maxY);
+				void shadePixel(const RasterTriangle& triangle, int32_t x, int32_t y, float w0, float w1, float w2);
+				static bbe::Color sampleImage(const bbe::Image& image, float u, float v);
+
+			public:
+				void resize(int32_t width, int32_t height);
+				void clear(const bbe::Color& color);
+
+				// Alpha blended, no depth test.
+				void addTriangle2D(const RasterVertex& a, const RasterVertex& b, const RasterVertex& c, const bbe::Image* image);
+				void addEllipse2D(const bbe::Vector2& topLeft, const bbe::Vector2& size, const bbe::Color& color);
+				// Takes clip space positions. Depth tested and written, opaque. Clipped against the near plane.
+				void addTriangle3D(const bbe::Vector4& a, const bbe::Vector4& b, const bbe::Vector4& c, const bbe::Color& colorA, const bbe::Color& colorB, const bbe::Color& colorC);
+
+				// Rasterizes all triangles that were added since the last flush.
+				void flush(bool parallel = true);
+
+				int32_t getWidth() const;
+				int32_t getHeight() const;
+				const uint32_t* getColorBuffer() const;
+				uint32_t getPixel(int32_t x, int32_t y) const;
+				float getDepth(int32_t x, int32_t y) const;
+				size_t getAmountOfQueuedTriangles() const;
+				uint64_t getAmountOfTrianglesDrawn() const;
+
+				static uint32_t packColor(const bbe::Color& color);
+				static bbe::Color unpackColor(uint32_t color);
+			};
+		}
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "../BBE/PrimitiveBrush2D.h"
+#include "../BBE/PrimitiveBrush3D.h"
+#include "../BBE/RenderManager.h"
+#include "../BBE/Matrix4.h"
+#include "../BBE/Model.h"
+#include "../BBE/Image.h"
+#include "../BBE/SoftwareRenderer/SoftwareRasterizer.h"
+
+namespace bbe
+{
+	namespace INTERNAL
+	{
+		namespace softwareRenderer
+		{
+			// Renders everything on the CPU into an in memory framebuffer, so that headless builds can still produce
+			// pixels, e.g. for screenshots and golden image tests. Custom fragment shaders and imgui are not rasterized.
+			class SoftwareRendererManager
+				: public RenderManager {
+			private:
+				PrimitiveBrush2D m_primitiveBrush2D;
+				PrimitiveBrush3D m_primitiveBrush3D;
+
+				GLFWwindow* m_pwindow = nullptr;
+				uint32_t m_windowWidth = 0;
+				uint32_t m_windowHeight = 0;
+
+				Rasterizer m_rasterizer;
+				bool m_parallel = true;
+
+				bbe::Color m_color2D;
+				bbe::Color m_color3D;
+				bbe::Matrix4 m_view;
+				bbe::Matrix4 m_projection;
+				bbe::Vector3 m_cameraPos;
+				bbe::List<bbe::PointLight> m_pointLights;
+
+				// 3D meshes are only shaded once all lights of the frame are known.
+				struct Vertex3D
+				{
+					bbe::Vector3 worldPos;
+					bbe::Vector3 normal;
+					bbe::Vector4 clipPos;
+					bbe::Color albedo;
+				};
+				bbe::List<Vertex3D> m_vertices3D;
+				bbe::List<uint32_t> m_indices3D;
+
+				bbe::List<bbe::PosNormalPair> m_cubeVertices;
+				bbe::List<uint32_t> m_cubeIndices;
+				bbe::List<bbe::PosNormalPair> m_sphereVertices;
+				bbe::List<uint32_t> m_sphereIndices;
+
+				bbe::FrameCapture* m_pframeCapture = nullptr;
+				uint64_t m_frameCaptureNumber = 0;
+
+				uint32_t m_amountOfDrawcalls = 0;
+				uint32_t m_amountOfDrawcallsPreviousFrame = 0;
+
+				void addRect(const Rectangle& rect, float rotation, const bbe::Color& color, const bbe::Image* image, float uvX, float uvY, float uvWidth, float uvHeight);
+				void addVertexIndexList(const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, const bbe::Vector2& pos, const bbe::Vector2& scale, const bbe::Color& color);
+				bbe::Color shadeVertex(const Vertex3D& vertex) const;
+				void fillMesh3D(const bbe::Matrix4& transform, const bbe::List<bbe::PosNormalPair>& vertices, const bbe::List<uint32_t>& indices);
+				void flush3D();
+
+			public:
+				SoftwareRendererManager();
+
+				SoftwareRendererManager(const SoftwareRendererManager& other) = delete;
+				SoftwareRendererManager(SoftwareRendererManager&& other) = delete;
+				SoftwareRendererManager& operator=(const SoftwareRendererManager& other) = delete;
+				SoftwareRendererManager& operator=(SoftwareRendererManager&& other) = delete;
+
+				void init(const char *appName, uint32_t major, uint32_t minor, uint32_t patch, GLFWwindow *window, uint32_t initialWindowWidth, uint32_t initialWindowHeight) override;
+
+				void destroy() override;
+				void preDraw2D() override;
+				void preDraw3D() override;
+				void preDraw() override;
+				void postDraw() override;
+				void waitEndDraw() override;
+				void waitTillIdle() override;
+
+				bool isReadyToDraw() const override;
+
+				bbe::PrimitiveBrush2D &getBrush2D() override;
+				bbe::PrimitiveBrush3D &getBrush3D() override;
+
+				void resize(uint32_t width, uint32_t height) override;
+
+				void screenshot(const bbe::String& path) override;
+				void setVideoRenderingMode(const char* path) override;
+
+				bool isFrameCaptureSupported() const override;
+				void captureFrame(bbe::FrameCapture& capture, uint64_t frameNumber) override;
+
+				virtual void setColor2D(const bbe::Color& color) override;
+				virtual void fillRect2D(const Rectangle& rect, float rotation, FragmentShader* shader) override;
+				virtual void fillCircle2D(const Circle& circle) override;
+				virtual void drawImage2D(const Rectangle& rect, const Image& image, float rotation) override;
+				virtual void fillVertexIndexList2D(const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, size_t amountOfVertices, const bbe::Vector2& pos, const bbe::Vector2& scale) override;
+				virtual void submit2D(const bbe::CommandBuffer2D& commandBuffer) override;
+				virtual bool isImageRegionSupported2D() const override;
+
+				virtual void setColor3D(const bbe::Color& color) override;
+				virtual void setCamera3D(const bbe::Vector3& pos, const bbe::Matrix4& m_view, const bbe::Matrix4& m_projection) override;
+				virtual void fillCube3D(const Cube& cube) override;
+				virtual void fillSphere3D(const IcoSphere& sphere) override;
+				virtual void addLight(const bbe::Vector3& pos, float lightStrenght, const bbe::Color &lightColor, const bbe::Color &specularColor, LightFalloffMode falloffMode) override;
+				void fillModel3D(const bbe::Matrix4& transform, const bbe::Model& model);
+
+				virtual void imguiStart() override;
+				virtual void imguiStop() override;
+				virtual void imguiStartFrame() override;
+				virtual void imguiEndFrame() override;
+
+				// Rasterizes the tiles on the job system. Both ways produce exactly the same pixels.
+				void setParallel(bool parallel);
+				// Everything that was drawn so far. Only complete after postDraw.
+				bbe::Image getFramebuffer();
+
+				// Every 2D batch and every 3D mesh counts as one draw call.
+				// Note: It's the drawcalls of the PREVIOUS frame!
+				uint32_t getAmountOfDrawcalls() const;
+			};
+		}
+	}
+}
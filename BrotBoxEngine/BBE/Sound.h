@@ -4,6 +4,8 @@
 
 #include "../BBE/String.h"
 #include "../BBE/List.h"
+#include "../BBE/Span.h"
+#include "../BBE/MappedFile.h"
 #include "../BBE/SoundInstance.h"
 #include "../BBE/Vector2.h"
 #include "../BBE/BrotTime.h"
@@ -34,6 +36,11 @@ namespace bbe
 	{
 	public:
 		virtual float getSample(size_t i, uint32_t channel) const = 0;
+
+		// Writes frames interleaved frames, starting at firstFrame, into out. Called by the mixer on the sound thread
+		// instead of getSample. The default calls getSample for every sample, sources that can compute whole blocks
+		// at once should override it.
+		virtual void fillSamples(bbe::Span<float> out, size_t firstFrame, size_t frames, uint32_t channels) const;
 	};
 
 	class SoundDataSourceStatic : public SoundDataSource
@@ -60,8 +67,9 @@ namespace bbe
 		uint32_t         m_channels = 0;
 		uint32_t         m_hz       = 0;
 
-		void loadMp3(const bbe::ByteBuffer& data);
-		void loadRawMonoFloat44100(const bbe::ByteBuffer& data);
+		void loadMp3(const bbe::byte* data, size_t length);
+		void loadRawMonoFloat44100(const bbe::byte* data, size_t length);
+		void load(const bbe::byte* data, size_t length, SoundLoadFormat soundLoadFormat);
 
 	public:
 		Sound();
@@ -69,6 +77,7 @@ namespace bbe
 
 		void load(const bbe::String& path, SoundLoadFormat soundLoadFormat = SoundLoadFormat::AUTOMATIC);
 		void load(const bbe::ByteBuffer &data, SoundLoadFormat soundLoadFormat = SoundLoadFormat::AUTOMATIC);
+		void load(const bbe::MappedFile& file, SoundLoadFormat soundLoadFormat = SoundLoadFormat::AUTOMATIC);
 		void load(const bbe::List<char>& data, SoundLoadFormat soundLoadFormat = SoundLoadFormat::AUTOMATIC);
 		void load(const bbe::List<float>& data, SoundLoadFormat soundLoadFormat = SoundLoadFormat::RAW_MONO_FLOAT_44100);
 
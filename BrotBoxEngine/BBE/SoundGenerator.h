@@ -4,6 +4,7 @@
 #include "../BBE/BrotTime.h"
 #include "../BBE/Sound.h"
 #include "../BBE/List.h"
+#include "../BBE/DspGraph.h"
 
 namespace bbe
 {
@@ -97,8 +98,21 @@ namespace bbe
 		SoundGenerator(const bbe::Duration& duration);
 		SoundGenerator(double durationMilliseconds);
 
+		enum class Precision
+		{
+			FLOAT,
+			DOUBLE,
+		};
+
 		int64_t getAmountOfSamples() const;
 		bbe::Sound finalize() const;
+		bbe::Sound finalize(Precision precision, bool parallel = true) const;
+		bbe::List<float> render(Precision precision = Precision::DOUBLE, bool parallel = true) const;
+
+		// Turns the recipes into a DSP graph. Stages that only look at a single sample are fused and rendered chunk by
+		// chunk in parallel, the echo, chorus and low pass hand their state from chunk to chunk.
+		template<typename T>
+		bbe::dsp::Graph<T> compile() const;
 
 		void addRecipeSineWave(double offset = 0.0, double mult = 1.0, double frequency = 440.0);
 		void addRecipeSquareWave(double offset = 0.0, double mult = 1.0, double highDur = 0.01, double lowDur = 0.01, double highValue = 1.0, double lowValue = -1.0);
@@ -113,19 +127,5 @@ namespace bbe
 		void addRecipeFrequencyShifter(double offset = 0.0, double mult = 1.0, double frequencyShift = 100.0);
 		void addRecipeEcho(double offset = 0.0, double mult = 1.0, double delayTime = 0.3, double decayFactor = 0.5);
 
-	private:
-		void applyRecipes(bbe::List<double>& signal) const;
-		void applyRecipeSineWave(bbe::List<double>& signal, double offset, double mult, double frequency) const;
-		void applyRecipeSquareWave(bbe::List<double>& signal, double offset, double mult, double highDur, double lowDur, double highValue, double lowValue) const;
-		void applyRecipeSawtoothWave(bbe::List<double>& signal, double offset, double mult, double period) const;
-		void applyRecipeTriangleWave(bbe::List<double>& signal, double offset, double mult, double raiseDur, double fallDur, double upDur, double downDur) const;
-		void applyRecipeADSR(bbe::List<double>& signal, double attackDur, double decayDur, double sustainLevel, double releaseDur) const;
-		void applyRecipeNormalization(bbe::List<double>& signal) const;
-		void applyRecipeRingModulation(bbe::List<double>& signal, double offset, double mult, double frequency, double modDepth) const;
-		void applyRecipeChorusEffect(bbe::List<double>& signal, double offset, double mult, double delayTime, double depth, double rate) const;
-		void applyRecipeLowPassFilter(bbe::List<double>& signal, double offset, double mult, double cutoffFrequency) const;
-		void applyRecipeBitcrusher(bbe::List<double>& signal, double offset, double mult, int bitDepth) const;
-		void applyRecipeFrequencyShifter(bbe::List<double>& signal, double offset, double mult, double frequencyShift) const;
-		void applyRecipeEcho(bbe::List<double>& signal, double offset, double mult, double delayTime, double decayFactor) const;
 	};
 }
@@ -0,0 +1,105 @@
+#pragma once
+
+#ifndef BBE_NO_AUDIO
+
+#include <cstdint>
+#include "../BBE/Sound.h"
+#include "../BBE/List.h"
+#include "../BBE/Vector3.h"
+
+namespace bbe
+{
+	namespace INTERNAL
+	{
+		// Sums all playing SoundDataSourceDynamics into one interleaved stereo block. Lives entirely on the sound
+		// thread, everything that comes from other threads is handed over through the lock free queues of the
+		// SoundManager.
+		class SoundMixer
+		{
+		public:
+			static constexpr uint32_t HZ = 44100;
+			static constexpr size_t BLOCK_FRAMES = 1024;
+
+		private:
+			struct Gains
+			{
+				float left = 1.0f;
+				float right = 1.0f;
+			};
+
+			struct Voice
+			{
+				uint64_t id = 0;
+				const bbe::SoundDataSourceDynamic* source = nullptr;
+				uint32_t channels = 0;
+				size_t framesMixed = 0;
+				float volume = 1.0f;
+				bool posAvailable = false;
+				bbe::Vector3 pos;
+				bbe::Vector3 posPreviousMix;
+				bool stopRequested = false;
+			};
+
+			struct Listener
+			{
+				bbe::Vector3 pos = bbe::Vector3(0, 0, 0);
+				bbe::Vector3 dir = bbe::Vector3(0, 0, 1);
+			};
+
+			bbe::List<Voice> m_voices;
+			bbe::List<float> m_scratch;
+			Listener m_listener;
+			Listener m_listenerPreviousMix;
+
+			Voice* findVoice(uint64_t id);
+			Gains getGains(const Voice& voice, const Listener& listener, const bbe::Vector3& pos) const;
+
+		public:
+			void add(uint64_t id, const bbe::SoundDataSourceDynamic& source, float volume, const bbe::Vector3* pos);
+			// The voice fades out during the next block and is removed afterwards.
+			void stop(uint64_t id);
+			void setPosition(uint64_t id, const bbe::Vector3& pos);
+			void setListener(const bbe::Vector3& pos, const bbe::Vector3& lookDirection);
+			void clear();
+
+			bool isPlaying(uint64_t id) const;
+			size_t getAmountOfVoices() const;
+
+			// Overwrites out, which has to hold frames * 2 floats, with the next block of all voices. Positions and the
+			// listener are interpolated from where they were at the previous block.
+			void mix(float* out, size_t frames);
+		};
+
+		// A device that plays back nothing. Pulls blocks from a mixer just like the OpenAL stream does, which makes
+		// mixing throughput and latency measurable without any audio hardware.
+		class NullAudioOutput
+		{
+		private:
+			SoundMixer* m_pmixer = nullptr;
+			bbe::List<float> m_block;
+			uint64_t m_framesPlayed = 0;
+			int64_t m_lastMixNanoseconds = 0;
+
+		public:
+			explicit NullAudioOutput(SoundMixer& mixer, size_t blockFrames = SoundMixer::BLOCK_FRAMES);
+
+			// Mixes one block. Returns how long that took in nanoseconds.
+			int64_t pull();
+
+			const float* getLastBlock() const;
+			size_t getBlockFrames() const;
+			uint64_t getFramesPlayed() const;
+			int64_t getLastMixNanoseconds() const;
+		};
+
+		namespace mixer
+		{
+			// out += in * gain for interleaved stereo out, where the gain of each channel is ramped linearly from the
+			// first to the second value over the block. in is either mono, which is spread to both channels, or
+			// interleaved stereo.
+			void addRamped(float* out, const float* in, uint32_t inChannels, size_t frames, float leftFrom, float rightFrom, float leftTo, float rightTo);
+		}
+	}
+}
+
+#endif
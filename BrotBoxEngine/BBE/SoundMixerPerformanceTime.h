@@ -0,0 +1,122 @@
+#pragma once
+
+#ifndef BBE_NO_AUDIO
+
+#include "../BBE/SoundMixer.h"
+#include "../BBE/Bench.h"
+#include "../BBE/Logging.h"
+#include <cmath>
+
+namespace bbe
+{
+	namespace test
+	{
+		struct SoundMixerBenchmarkResult
+		{
+			const char* name = "";
+			size_t amountOfVoices = 0;
+			double nanosPerFrame = 0;          // For all voices together.
+			bbe::bench::PhaseStats blockMix;   // How long producing one block took, in milliseconds.
+			double blockDurationMs = 0;        // What a device plays per block. blockMix has to stay well below.
+		};
+
+		namespace INTERNAL
+		{
+			// A sine that is computed one sample at a time, like the sources that only implement getSample.
+			class PerSampleSine : public bbe::SoundDataSourceDynamic
+			{
+			public:
+				float frequency = 440.f;
+
+				virtual float getSample(size_t i, uint32_t channel) const override
+				{
+					return std::sin((float)i * frequency * 6.2831853f / (float)getHz()) * 0.1f;
+				}
+
+				virtual uint32_t getAmountOfChannels() const override
+				{
+					return 1;
+				}
+
+				virtual uint32_t getHz() const override
+				{
+					return bbe::INTERNAL::SoundMixer::HZ;
+				}
+			};
+
+			// The same sine, but filled block wise with a rotating phasor instead of a sin call per sample.
+			class BlockSine : public PerSampleSine
+			{
+			public:
+				virtual void fillSamples(bbe::Span<float> out, size_t firstFrame, size_t frames, uint32_t channels) const override
+				{
+					const double step = frequency * 6.283185307179586 / (double)getHz();
+					const double start = (double)firstFrame * step;
+					double re = std::cos(start) * 0.1;
+					double im = std::sin(start) * 0.1;
+					const double stepRe = std::cos(step);
+					const double stepIm = std::sin(step);
+					float* raw = out.getRaw();
+					for (size_t i = 0; i < frames; i++)
+					{
+						raw[i] = (float)im;
+						const double newRe = re * stepRe - im * stepIm;
+						im = re * stepIm + im * stepRe;
+						re = newRe;
+					}
+				}
+			};
+
+			template<typename Source>
+			SoundMixerBenchmarkResult benchmarkMixer(const char* name, size_t amountOfVoices, size_t blocks)
+			{
+				bbe::List<Source> sources;
+				sources.resizeCapacityAndLength(amountOfVoices);
+				bbe::INTERNAL::SoundMixer mixer;
+				for (size_t i = 0; i < amountOfVoices; i++)
+				{
+					sources[i].frequency = 220.f + (float)i;
+					// Every other voice is positional, which is the more expensive path.
+					const bbe::Vector3 pos((float)i, 1.f, 0.f);
+					mixer.add(i + 1, sources[i], 0.5f, i % 2 == 0 ? &pos : nullptr);
+				}
+
+				bbe::INTERNAL::NullAudioOutput output(mixer);
+				bbe::List<double> blockSeconds;
+				double totalNanos = 0;
+				for (size_t i = 0; i < blocks; i++)
+				{
+					const int64_t nanos = output.pull();
+					totalNanos += (double)nanos;
+					blockSeconds.add((double)nanos / 1e9);
+				}
+
+				SoundMixerBenchmarkResult result;
+				result.name = name;
+				result.amountOfVoices = amountOfVoices;
+				result.nanosPerFrame = totalNanos / (double)output.getFramesPlayed();
+				result.blockMix = bbe::bench::computeStats(name, blockSeconds);
+				result.blockDurationMs = (double)output.getBlockFrames() * 1000.0 / (double)bbe::INTERNAL::SoundMixer::HZ;
+				return result;
+			}
+		}
+
+		// Mixes amountOfVoices sines into a NullAudioOutput, once with sources that only provide single samples and once
+		// with sources that fill whole blocks.
+		inline bbe::List<SoundMixerBenchmarkResult> soundMixerPrintSpeed(size_t amountOfVoices = 64, size_t blocks = 200)
+		{
+			bbe::List<SoundMixerBenchmarkResult> results;
+			results.add(INTERNAL::benchmarkMixer<INTERNAL::PerSampleSine>("per sample", amountOfVoices, blocks));
+			results.add(INTERNAL::benchmarkMixer<INTERNAL::BlockSine>("block", amountOfVoices, blocks));
+
+			for (size_t i = 0; i < results.getLength(); i++)
+			{
+				const SoundMixerBenchmarkResult& r = results[i];
+				BBELOGLN(r.name << " (" << r.amountOfVoices << " voices): " << r.nanosPerFrame << " ns/frame, block mix p50 " << r.blockMix.p50 << " ms, p99 " << r.blockMix.p99 << " ms, max " << r.blockMix.max << " ms of " << r.blockDurationMs << " ms");
+			}
+			return results;
+		}
+	}
+}
+
+#endif
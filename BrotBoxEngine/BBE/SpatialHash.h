@@ -0,0 +1,354 @@
+#pragma once
+
+#include "../BBE/List.h"
+#include "../BBE/Vector2.h"
+#include "../BBE/Vector3.h"
+#include "../BBE/Error.h"
+#include "../BBE/Math.h"
+#include "../BBE/JobSystem.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace bbe
+{
+	// Uniform grid broadphase. Points are bucketed by the cell they fall into and the cells are hashed into a table,
+	// so unbounded worlds work without knowing their extent up front. A rebuild is a single counting sort into flat
+	// arrays, which makes it cheap enough to do every frame for moving points.
+	template<typename Vec, int Dimensions>
+	class SpatialHash_t
+	{
+		static_assert(Dimensions >= 1 && Dimensions <= 3);
+
+	public:
+		using Cell = std::array<int32_t, Dimensions>;
+
+	private:
+		struct Entry
+		{
+			Vec pos;
+			uint32_t index = 0;
+			Cell cell = {};
+		};
+
+		float m_cellSize = 1;
+		float m_invCellSize = 1;
+		uint32_t m_tableMask = 0;
+		bbe::List<uint32_t> m_bucketStarts;
+		bbe::List<Entry> m_entries;
+		bbe::List<uint32_t> m_scratchBuckets;
+		Vec m_min;
+		Vec m_max;
+
+		static uint32_t hashCell(const Cell& cell)
+		{
+			constexpr uint32_t primes[] = { 73856093u, 19349663u, 83492791u };
+			uint32_t h = 0;
+			for (int d = 0; d < Dimensions; d++)
+			{
+				h ^= (uint32_t)cell[d] * primes[d];
+			}
+			h ^= h >> 16;
+			h *= 0x7feb352du;
+			h ^= h >> 15;
+			return h;
+		}
+
+		int32_t cellCoord(float val) const
+		{
+			// Clamped so that far away or infinite query bounds degrade into a linear scan instead of overflowing.
+			return (int32_t)bbe::Math::clamp(std::floor(val * m_invCellSize), -1073741824.f, 1073741824.f);
+		}
+
+		Cell cellOf(const Vec& pos) const
+		{
+			Cell retVal;
+			for (int d = 0; d < Dimensions; d++)
+			{
+				retVal[d] = cellCoord(pos[d]);
+			}
+			return retVal;
+		}
+
+		template<typename Func>
+		void forEachEntryInCell(const Cell& cell, Func&& func) const
+		{
+			const uint32_t bucket = hashCell(cell) & m_tableMask;
+			const uint32_t end = m_bucketStarts[bucket + 1];
+			for (uint32_t i = m_bucketStarts[bucket]; i < end; i++)
+			{
+				// Different cells can share a bucket. Filtering them out also guarantees that visiting several colliding
+				// cells never reports an entry twice.
+				if (m_entries[i].cell == cell) func(m_entries[i]);
+			}
+		}
+
+		// Calls func for every entry whose cell lies in [lo, hi]. Huge ranges fall back to a linear scan, which is
+		// what lets the k nearest search grow its radius without worrying about the amount of cells.
+		template<typename Func>
+		void forEachEntryInCellRange(const Cell& lo, const Cell& hi, Func&& func) const
+		{
+			double amountOfCells = 1;
+			for (int d = 0; d < Dimensions; d++)
+			{
+				amountOfCells *= (double)hi[d] - (double)lo[d] + 1.0;
+			}
+			if (amountOfCells > (double)m_entries.getLength())
+			{
+				for (size_t i = 0; i < m_entries.getLength(); i++)
+				{
+					func(m_entries[i]);
+				}
+				return;
+			}
+
+			Cell cell = lo;
+			while (true)
+			{
+				forEachEntryInCell(cell, func);
+				int d = 0;
+				for (; d < Dimensions; d++)
+				{
+					if (cell[d] < hi[d])
+					{
+						cell[d]++;
+						break;
+					}
+					cell[d] = lo[d];
+				}
+				if (d == Dimensions) return;
+			}
+		}
+
+	public:
+		explicit SpatialHash_t(float cellSize = 1)
+		{
+			setCellSize(cellSize);
+		}
+
+		// Only takes effect with the next rebuild.
+		void setCellSize(float cellSize)
+		{
+			if (!(cellSize > 0))
+			{
+				bbe::Crash(bbe::Error::IllegalArgument);
+			}
+			m_cellSize = cellSize;
+			m_invCellSize = 1.f / cellSize;
+		}
+
+		float getCellSize() const
+		{
+			return m_cellSize;
+		}
+
+		size_t getLength() const
+		{
+			return m_entries.getLength();
+		}
+
+		bool isEmpty() const
+		{
+			return m_entries.isEmpty();
+		}
+
+		void clear()
+		{
+			m_entries.clear();
+			m_bucketStarts.clear();
+			m_tableMask = 0;
+		}
+
+		// Query results report the position of a point by its index in this array.
+		void rebuild(const Vec* positions, size_t amount)
+		{
+			// The table has at least twice as many buckets as there are points, and the mask has to fit 32 bits.
+			if (amount > (size_t)1 << 31)
+			{
+				bbe::Crash(bbe::Error::IllegalArgument);
+			}
+			clear();
+			if (amount == 0) return;
+
+			size_t tableSize = 1;
+			while (tableSize < amount * 2) tableSize *= 2;
+			m_tableMask = (uint32_t)(tableSize - 1);
+
+			m_bucketStarts.add(0u, tableSize + 1);
+			m_scratchBuckets.clear();
+			m_entries.add(Entry{}, amount);
+			m_min = positions[0];
+			m_max = positions[0];
+			for (size_t i = 0; i < amount; i++)
+			{
+				const Vec& pos = positions[i];
+				for (int d = 0; d < Dimensions; d++)
+				{
+					m_min[d] = bbe::Math::min(m_min[d], pos[d]);
+					m_max[d] = bbe::Math::max(m_max[d], pos[d]);
+				}
+				const uint32_t bucket = hashCell(cellOf(pos)) & m_tableMask;
+				m_scratchBuckets.add(bucket);
+				m_bucketStarts[bucket + 1]++;
+			}
+			for (size_t i = 0; i < tableSize; i++)
+			{
+				m_bucketStarts[i + 1] += m_bucketStarts[i];
+			}
+
+			// Scatter through a running cursor per bucket. m_bucketStarts[b] is used as the cursor of bucket b and ends up
+			// at the start of bucket b + 1, so shifting everything back by one restores the starts.
+			for (size_t i = 0; i < amount; i++)
+			{
+				const uint32_t slot = m_bucketStarts[m_scratchBuckets[i]]++;
+				m_entries[slot].pos = positions[i];
+				m_entries[slot].index = (uint32_t)i;
+				m_entries[slot].cell = cellOf(positions[i]);
+			}
+			for (size_t i = tableSize; i > 0; i--)
+			{
+				m_bucketStarts[i] = m_bucketStarts[i - 1];
+			}
+			m_bucketStarts[0] = 0;
+		}
+
+		void rebuild(const bbe::List<Vec>& positions)
+		{
+			rebuild(positions.getRaw(), positions.getLength());
+		}
+
+		// func(uint32_t index, const Vec& pos) for every point with a distance <= radius to center.
+		template<typename Func>
+		void forEachInRadius(const Vec& center, float radius, Func&& func) const
+		{
+			if (m_entries.isEmpty()) return;
+			Cell lo;
+			Cell hi;
+			for (int d = 0; d < Dimensions; d++)
+			{
+				lo[d] = cellCoord(center[d] - radius);
+				hi[d] = cellCoord(center[d] + radius);
+			}
+			const float radiusSq = radius * radius;
+			forEachEntryInCellRange(lo, hi, [&](const Entry& entry)
+				{
+					if ((entry.pos - center).getLengthSq() <= radiusSq) func(entry.index, entry.pos);
+				});
+		}
+
+		void queryRadius(const Vec& center, float radius, bbe::List<uint32_t>& outIndices) const
+		{
+			forEachInRadius(center, radius, [&](uint32_t index, const Vec&)
+				{
+					outIndices.add(index);
+				});
+		}
+
+		// func(uint32_t index, const Vec& pos) for every point inside the box, borders included.
+		template<typename Func>
+		void forEachInBox(const Vec& min, const Vec& max, Func&& func) const
+		{
+			if (m_entries.isEmpty()) return;
+			Cell lo;
+			Cell hi;
+			for (int d = 0; d < Dimensions; d++)
+			{
+				if (min[d] > max[d]) return;
+				lo[d] = cellCoord(min[d]);
+				hi[d] = cellCoord(max[d]);
+			}
+			forEachEntryInCellRange(lo, hi, [&](const Entry& entry)
+				{
+					for (int d = 0; d < Dimensions; d++)
+					{
+						if (entry.pos[d] < min[d] || entry.pos[d] > max[d]) return;
+					}
+					func(entry.index, entry.pos);
+				});
+		}
+
+		void queryBox(const Vec& min, const Vec& max, bbe::List<uint32_t>& outIndices) const
+		{
+			forEachInBox(min, max, [&](uint32_t index, const Vec&)
+				{
+					outIndices.add(index);
+				});
+		}
+
+		// Appends the k closest points, closest first. Equal distances are ordered by index.
+		void queryKNearest(const Vec& center, size_t k, bbe::List<uint32_t>& outIndices) const
+		{
+			k = bbe::Math::min(k, m_entries.getLength());
+			if (k == 0) return;
+
+			// Every point is inside this radius, so growing the search radius beyond it is pointless.
+			float maxDistSq = 0;
+			{
+				float sq = 0;
+				for (int d = 0; d < Dimensions; d++)
+				{
+					const float dist = bbe::Math::max(std::abs(center[d] - m_min[d]), std::abs(center[d] - m_max[d]));
+					sq += dist * dist;
+				}
+				maxDistSq = sq;
+			}
+
+			bbe::List<std::pair<float, uint32_t>> candidates;
+			float radius = m_cellSize;
+			while (true)
+			{
+				candidates.clear();
+				forEachInRadius(center, radius, [&](uint32_t index, const Vec& pos)
+					{
+						candidates.add({ (pos - center).getLengthSq(), index });
+					});
+				// Anything outside the radius is farther away than everything found, so k hits are the final answer.
+				if (candidates.getLength() >= k || radius * radius >= maxDistSq) break;
+				radius *= 2;
+			}
+
+			std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end());
+			for (size_t i = 0; i < k; i++)
+			{
+				outIndices.add(candidates[i].second);
+			}
+		}
+
+		// func(uint32_t a, uint32_t b) once for every pair of points with a distance <= radius, where a < b.
+		template<typename Func>
+		void forEachPair(float radius, Func&& func) const
+		{
+			for (size_t i = 0; i < m_entries.getLength(); i++)
+			{
+				const uint32_t own = m_entries[i].index;
+				forEachInRadius(m_entries[i].pos, radius, [&](uint32_t other, const Vec&)
+					{
+						if (other > own) func(own, other);
+					});
+			}
+		}
+
+		// Like forEachPair, but spread over the job system. func is called concurrently from several threads, and the
+		// pairs are reported in no particular order.
+		template<typename Func>
+		void forEachPairParallel(float radius, Func&& func, size_t grain = 256) const
+		{
+			bbe::jobs::parallelFor(0, m_entries.getLength(), grain, [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; i++)
+					{
+						const uint32_t own = m_entries[i].index;
+						forEachInRadius(m_entries[i].pos, radius, [&](uint32_t other, const Vec&)
+							{
+								if (other > own) func(own, other);
+							});
+					}
+				});
+		}
+	};
+
+	using SpatialHash2D = SpatialHash_t<bbe::Vector2, 2>;
+	using SpatialHash3D = SpatialHash_t<bbe::Vector3, 3>;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../BBE/SpatialHash.h"
+#include "../BBE/StopWatch.h"
+#include "../BBE/Random.h"
+#include "../BBE/Logging.h"
+#include <algorithm>
+#include <cmath>
+
+namespace bbe
+{
+	namespace test
+	{
+		struct SpatialHashBenchmarkResult
+		{
+			size_t amountOfPoints = 0;
+			double rebuildNanos = 0;
+			double hashNanosPerQuery = 0;
+			double bruteNanosPerQuery = 0;
+			uint64_t hashHits = 0;
+			uint64_t bruteHits = 0;
+		};
+
+		// Radius queries on uniformly distributed 2D points against the brute force loop that the examples use. The
+		// world grows with the amount of points so that every query finds roughly the same amount of neighbours. Brute
+		// force is quadratic, so only the first maxBruteQueries points are used as query centers for both sides.
+		inline bbe::List<SpatialHashBenchmarkResult> spatialHashPrintSpeed(const bbe::List<size_t>& amounts = { 1000, 10000, 100000, 1000000 }, size_t maxBruteQueries = 1000, int32_t runs = 3)
+		{
+			constexpr float radius = 10.f;
+			constexpr float neighboursPerQuery = 8.f;
+
+			bbe::List<SpatialHashBenchmarkResult> retVal;
+			bbe::Random rand;
+			rand.setSeed(1337);
+			for (size_t a = 0; a < amounts.getLength(); a++)
+			{
+				const size_t amount = amounts[a];
+				const float worldSize = std::sqrt((float)amount * 3.14159265f * radius * radius / neighboursPerQuery);
+				bbe::List<bbe::Vector2> points;
+				for (size_t i = 0; i < amount; i++)
+				{
+					points.add(bbe::Vector2(rand.randomFloat() * worldSize, rand.randomFloat() * worldSize));
+				}
+				const size_t amountOfQueries = bbe::Math::min(amount, maxBruteQueries);
+
+				SpatialHashBenchmarkResult result;
+				result.amountOfPoints = amount;
+				result.rebuildNanos = 1e300;
+				result.hashNanosPerQuery = 1e300;
+				result.bruteNanosPerQuery = 1e300;
+				bbe::SpatialHash2D hash(radius);
+				for (int32_t r = 0; r < runs; r++)
+				{
+					bbe::StopWatch rebuildWatch;
+					hash.rebuild(points);
+					result.rebuildNanos = std::min(result.rebuildNanos, (double)rebuildWatch.getTimeExpiredNanoseconds());
+
+					uint64_t hashHits = 0;
+					bbe::StopWatch hashWatch;
+					for (size_t i = 0; i < amountOfQueries; i++)
+					{
+						hash.forEachInRadius(points[i], radius, [&](uint32_t, const bbe::Vector2&) { hashHits++; });
+					}
+					result.hashNanosPerQuery = std::min(result.hashNanosPerQuery, (double)hashWatch.getTimeExpiredNanoseconds() / (double)amountOfQueries);
+					result.hashHits = hashHits;
+
+					uint64_t bruteHits = 0;
+					bbe::StopWatch bruteWatch;
+					for (size_t i = 0; i < amountOfQueries; i++)
+					{
+						for (size_t k = 0; k < amount; k++)
+						{
+							if ((points[k] - points[i]).getLengthSq() <= radius * radius) bruteHits++;
+						}
+					}
+					result.bruteNanosPerQuery = std::min(result.bruteNanosPerQuery, (double)bruteWatch.getTimeExpiredNanoseconds() / (double)amountOfQueries);
+					result.bruteHits = bruteHits;
+				}
+
+				BBELOGLN(amount << " points: rebuild " << result.rebuildNanos / 1000000.0 << " ms, radius query bbe::SpatialHash2D " << result.hashNanosPerQuery << " ns, brute force " << result.bruteNanosPerQuery << " ns");
+				retVal.add(result);
+			}
+			return retVal;
+		}
+	}
+}
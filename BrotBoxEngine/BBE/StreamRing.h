@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+namespace bbe
+{
+	// Sub-allocation bookkeeping of a buffer that is split into one segment per frame in flight. Every frame starts
+	// at the front of the next segment. The caller has to make sure that the GPU is done with a segment before it
+	// is written again, e.g. with a fence per segment.
+	class StreamRing
+	{
+	public:
+		constexpr static size_t amountOfSegments = 3;
+		// Enough for every vertex attribute and index type.
+		constexpr static size_t alignment = 16;
+
+	private:
+		size_t m_segmentSize = 0;
+		size_t m_segment = 0;
+		size_t m_offset = 0;
+		size_t m_amountOfStreamedBytes = 0;
+
+	public:
+		StreamRing() = default;
+		explicit StreamRing(size_t segmentSize);
+
+		// Moves on to the next segment and returns it.
+		size_t beginFrame();
+		// Whether length more bytes fit into the segment of the current frame.
+		bool fits(size_t length) const;
+		// The next power of two multiple of the segment size that fits length bytes into an empty segment.
+		size_t getGrownSegmentSize(size_t length) const;
+		// Starts over at the front of the first segment. The bytes streamed this frame are still counted.
+		void resize(size_t segmentSize);
+		// Returns the position of the bytes within the whole buffer. They have to fit.
+		size_t allocate(size_t length);
+
+		size_t getSegmentSize() const;
+		size_t getBufferSize() const;
+		size_t getSegment() const;
+		size_t getAmountOfStreamedBytes() const;
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <cwchar>
 #include <stdlib.h>
@@ -72,6 +73,7 @@ namespace bbe
 
 		bool operator==(const Utf8String& other) const;
 		bool operator==(const char*       other) const;
+		bool operator==(std::string_view  other) const;
 		friend bool operator==(const char* arr, const Utf8String& string);
 		bool operator!=(const Utf8String& other) const;
 		bool operator!=(const char*       other) const;
@@ -201,6 +203,19 @@ namespace bbe
 
 	typedef Utf8String String;
 
+	// The small buffer is addressed relative to the object, never through a pointer into itself.
+	template<>
+	struct IsTriviallyRelocatable<Utf8String> : std::true_type {};
+
 	template<>
 	uint32_t hash(const String &t);
+	template<>
+	uint32_t hash(const char* const &t);
+	template<>
+	uint32_t hash(const std::string_view &t);
+
+	template<>
+	struct IsTransparentKey<Utf8String, const char*> : std::true_type {};
+	template<>
+	struct IsTransparentKey<Utf8String, std::string_view> : std::true_type {};
 }
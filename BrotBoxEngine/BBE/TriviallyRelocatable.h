@@ -0,0 +1,13 @@
+#pragma once
+
+#include <type_traits>
+
+namespace bbe
+{
+	// A type is trivially relocatable if moving an object to a new address and ending the lifetime of the old one
+	// has the same effect as copying its bytes. Containers use this to move elements with memcpy/memmove. Types that
+	// are not trivially copyable but never point into themselves (e.g. containers that own heap memory) can opt in
+	// by specializing this trait.
+	template<typename T>
+	struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+}
@@ -0,0 +1,320 @@
+#pragma once
+
+#include "../BBE/List.h"
+#include "../BBE/Error.h"
+#include <algorithm>
+#include <utility>
+
+
+namespace bbe
+{
+	// Undo history for lists that records the edits themselves instead of copying the whole list after every change.
+	// Every edit stores just enough to be reverted (the removed or overwritten element), so undo and redo cost the same
+	// as the edit they revert. Edits are grouped into steps by submit(). Changes that can't be described as single
+	// element edits fall back to recordSnapshot().
+	template<typename T>
+	class UndoableList
+	{
+	public:
+		// What undo() and redo() did to the list, reported edit by edit in the order they were applied. REPLACED_ALL
+		// means that the whole list was exchanged.
+		enum class Change
+		{
+			ADDED,
+			REMOVED,
+			SWAPPED,
+			REPLACED,
+			REPLACED_ALL,
+		};
+
+	private:
+		enum class EditType
+		{
+			ADD,
+			REMOVE,
+			SWAP,
+			REPLACE,
+			SNAPSHOT,
+		};
+
+		struct Edit
+		{
+			EditType type = EditType::ADD;
+			bool endsStep = false;
+			size_t a = 0;
+			size_t b = 0;
+			// The element that is currently not in the list, i.e. the removed element or the other value of a replace.
+			T value = T();
+			bbe::List<T> snapshot;
+		};
+
+		bbe::List<T> current;
+		bbe::List<Edit> edits;
+		size_t firstEdit = 0;
+		size_t position = 0;
+		size_t amountOfSteps = 0;
+		size_t maxHistoryDepth = 0;
+
+		// Reverting and reapplying are the same operation for swaps, replaces and snapshots because the edit always holds
+		// the state that is currently not in the list.
+		template<typename Listener>
+		void revert(Edit& edit, Listener& listener)
+		{
+			switch (edit.type)
+			{
+			case EditType::ADD:
+				edit.value = current.popBack();
+				listener(Change::REMOVED, current.getLength(), 0);
+				break;
+			case EditType::REMOVE:
+				current.add(std::move(edit.value));
+				std::rotate(current.begin() + edit.a, current.end() - 1, current.end());
+				listener(Change::ADDED, edit.a, 0);
+				break;
+			default:
+				toggle(edit, listener);
+				break;
+			}
+		}
+
+		template<typename Listener>
+		void reapply(Edit& edit, Listener& listener)
+		{
+			switch (edit.type)
+			{
+			case EditType::ADD:
+				current.add(std::move(edit.value));
+				listener(Change::ADDED, current.getLength() - 1, 0);
+				break;
+			case EditType::REMOVE:
+				edit.value = std::move(current[edit.a]);
+				current.removeIndex(edit.a);
+				listener(Change::REMOVED, edit.a, 0);
+				break;
+			default:
+				toggle(edit, listener);
+				break;
+			}
+		}
+
+		template<typename Listener>
+		void toggle(Edit& edit, Listener& listener)
+		{
+			switch (edit.type)
+			{
+			case EditType::SWAP:
+				current.swap(edit.a, edit.b);
+				listener(Change::SWAPPED, edit.a, edit.b);
+				break;
+			case EditType::REPLACE:
+				std::swap(current[edit.a], edit.value);
+				listener(Change::REPLACED, edit.a, 0);
+				break;
+			case EditType::SNAPSHOT:
+				std::swap(current, edit.snapshot);
+				listener(Change::REPLACED_ALL, 0, 0);
+				break;
+			default:
+				bbe::Crash(bbe::Error::IllegalState);
+			}
+		}
+
+		Edit& record(EditType type)
+		{
+			// A new edit invalidates everything that could have been redone.
+			while (edits.getLength() > position)
+			{
+				if (edits.last().endsStep) amountOfSteps--;
+				edits.popBack();
+			}
+			edits.add(Edit());
+			position++;
+			Edit& edit = edits.last();
+			edit.type = type;
+			return edit;
+		}
+
+		bool hasOpenStep() const
+		{
+			return position > firstEdit && !edits[position - 1].endsStep;
+		}
+
+		void dropOldestSteps()
+		{
+			while (maxHistoryDepth != 0 && amountOfSteps > maxHistoryDepth)
+			{
+				size_t stepEnd = firstEdit;
+				while (!edits[stepEnd].endsStep) stepEnd++;
+				// Steps that are currently undone can't be dropped from the front.
+				if (stepEnd >= position) break;
+				for (; firstEdit <= stepEnd; firstEdit++)
+				{
+					edits[firstEdit] = Edit();
+				}
+				amountOfSteps--;
+			}
+			// Compacting only once half of the list is dead keeps dropping steps amortized O(1).
+			if (firstEdit > 16 && firstEdit * 2 > edits.getLength())
+			{
+				edits.removeRange(0, firstEdit);
+				position -= firstEdit;
+				firstEdit = 0;
+			}
+		}
+
+	public:
+		UndoableList()
+		{
+		}
+		explicit UndoableList(const bbe::List<T>& list) : current(list)
+		{
+		}
+
+		void add(T val)
+		{
+			current.add(std::move(val));
+			record(EditType::ADD);
+		}
+
+		bool removeIndex(size_t index)
+		{
+			if (index >= current.getLength()) return false;
+			Edit& edit = record(EditType::REMOVE);
+			edit.a = index;
+			edit.value = std::move(current[index]);
+			current.removeIndex(index);
+			return true;
+		}
+
+		bool swap(size_t a, size_t b)
+		{
+			if (!current.swap(a, b)) return false;
+			Edit& edit = record(EditType::SWAP);
+			edit.a = a;
+			edit.b = b;
+			return true;
+		}
+
+		bool replace(size_t index, T val)
+		{
+			if (index >= current.getLength()) return false;
+			Edit& edit = record(EditType::REPLACE);
+			edit.a = index;
+			edit.value = std::move(val);
+			std::swap(current[index], edit.value);
+			return true;
+		}
+
+		// For edits that were made through get(): the element at index was changed and previous is its old value.
+		void recordReplaced(size_t index, T previous)
+		{
+			if (index >= current.getLength())
+			{
+				bbe::Crash(bbe::Error::IllegalIndex);
+			}
+			Edit& edit = record(EditType::REPLACE);
+			edit.a = index;
+			edit.value = std::move(previous);
+		}
+
+		// For edits that were made through get() and can't be described element by element. Stores the whole previous
+		// list, so this is as expensive as the snapshots that UndoableObject takes.
+		void recordSnapshot(bbe::List<T> previous)
+		{
+			Edit& edit = record(EditType::SNAPSHOT);
+			edit.snapshot = std::move(previous);
+		}
+
+		// Closes the current step. Does nothing if nothing was edited since the last submit.
+		void submit()
+		{
+			if (!hasOpenStep()) return;
+			edits[position - 1].endsStep = true;
+			amountOfSteps++;
+			dropOldestSteps();
+		}
+
+		void clearHistory()
+		{
+			edits.clear();
+			firstEdit = 0;
+			position = 0;
+			amountOfSteps = 0;
+		}
+
+		// 0 means unbounded. Once exceeded the oldest steps are forgotten.
+		void setMaxHistoryDepth(size_t depth)
+		{
+			maxHistoryDepth = depth;
+			dropOldestSteps();
+		}
+
+		size_t getMaxHistoryDepth() const
+		{
+			return maxHistoryDepth;
+		}
+
+		void undo()
+		{
+			undo([](Change, size_t, size_t) {});
+		}
+
+		// listener(Change, size_t a, size_t b) is called for every edit that was reverted.
+		template<typename Listener>
+		void undo(Listener&& listener)
+		{
+			submit();
+			if (!isUndoable())
+			{
+				bbe::Crash(bbe::Error::IllegalState);
+			}
+			do
+			{
+				position--;
+				revert(edits[position], listener);
+			} while (position > firstEdit && !edits[position - 1].endsStep);
+		}
+
+		bool isUndoable() const
+		{
+			return position > firstEdit;
+		}
+
+		void redo()
+		{
+			redo([](Change, size_t, size_t) {});
+		}
+
+		// listener(Change, size_t a, size_t b) is called for every edit that was reapplied.
+		template<typename Listener>
+		void redo(Listener&& listener)
+		{
+			if (!isRedoable())
+			{
+				bbe::Crash(bbe::Error::IllegalState);
+			}
+			do
+			{
+				reapply(edits[position], listener);
+				position++;
+			} while (!edits[position - 1].endsStep);
+		}
+
+		bool isRedoable() const
+		{
+			return position < edits.getLength();
+		}
+
+		// Changes through this reference are not part of the history unless they are described with recordReplaced()
+		// or recordSnapshot() before the next edit.
+		bbe::List<T>& get()
+		{
+			return current;
+		}
+
+		const bbe::List<T>& get() const
+		{
+			return current;
+		}
+	};
+}
@@ -12,6 +12,16 @@ namespace bbe
 		T current;
 		bbe::List<T> history;
 		int64_t historyIndex = 0;
+		size_t maxHistoryDepth = 0;
+
+		void dropOldestSnapshots()
+		{
+			while (maxHistoryDepth != 0 && historyIndex > 0 && history.getLength() > maxHistoryDepth + 1)
+			{
+				history.removeIndex(0);
+				historyIndex--;
+			}
+		}
 
 	public:
 		UndoableObject()
@@ -31,6 +41,20 @@ namespace bbe
 			}
 			history.add(current);
 			historyIndex++;
+			dropOldestSnapshots();
+		}
+
+		// 0 means unbounded. Every step is a full copy of the object, so for large objects this is the only thing that
+		// keeps the memory in check.
+		void setMaxHistoryDepth(size_t depth)
+		{
+			maxHistoryDepth = depth;
+			dropOldestSnapshots();
+		}
+
+		size_t getMaxHistoryDepth() const
+		{
+			return maxHistoryDepth;
 		}
 
 		void clearHistory()
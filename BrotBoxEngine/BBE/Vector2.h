@@ -2,6 +2,7 @@
 
 #include "BBE/Math.h"
 #include "BBE/Error.h"
+#include "BBE/TriviallyRelocatable.h"
 
 namespace bbe
 {
@@ -389,10 +390,15 @@ namespace bbe
 	using Vector2i = Vector2_t<int32_t>;
 	using Vector2i64 = Vector2_t<int64_t>;
 
+	template<typename T>
+	struct IsTriviallyRelocatable<Vector2_t<T>> : std::true_type {};
+
 	template<>
 	uint32_t hash(const Vector2i& t);
 	template<>
 	uint32_t hash(const Vector2& t);
+	template<>
+	uint32_t hash(const Vector2i64& t);
 
 	class LineIterator
 	{
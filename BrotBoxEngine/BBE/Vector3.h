@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../BBE/TriviallyRelocatable.h"
 
 namespace bbe
 {
@@ -117,4 +118,7 @@ namespace bbe
 		Vector3 zzy() const;
 		Vector3 zzz() const;
 	};
-}
\ No newline at end of file
+
+	template<>
+	struct IsTriviallyRelocatable<Vector3> : std::true_type {};
+}
@@ -1,23 +1,40 @@
 #pragma once
 
+#include <cstddef>
+#include "../BBE/Vector3.h"
 #include "../BBE/Vector4.h"
 #include "../BBE/Matrix4.h"
 
 namespace bbe
 {
-	namespace INTERNAL
+	// The clip planes of a view projection matrix (clip space z from -w to w). Every plane points inwards and is
+	// normalized, so plane.xyz * p + plane.w is the signed distance of p to it. The planes are stored per component
+	// so that the visibility tests check four planes at once.
+	class ViewFrustum
 	{
-		namespace vulkan
-		{
-			class ViewFrustum
-			{
-			private:
-				bbe::Vector4 planes[5];
+	public:
+		constexpr static size_t amountOfPlanes = 6;
 
-			public:
-				void updatePlanes(const bbe::Matrix4 &mvpMatrix);
-				bbe::Vector4* getPlanes();
-			};
-		}
-	}
-}
\ No newline at end of file
+	private:
+		// Padded with planes that every point is in front of.
+		constexpr static size_t amountOfPaddedPlanes = 8;
+		alignas(16) float m_planesX[amountOfPaddedPlanes];
+		alignas(16) float m_planesY[amountOfPaddedPlanes];
+		alignas(16) float m_planesZ[amountOfPaddedPlanes];
+		alignas(16) float m_planesW[amountOfPaddedPlanes];
+
+	public:
+		ViewFrustum();
+		explicit ViewFrustum(const bbe::Matrix4& viewProjection);
+
+		void updatePlanes(const bbe::Matrix4& viewProjection);
+		// Left, right, bottom, top, near, far.
+		bbe::Vector4 getPlane(size_t index) const;
+
+		// Conservative: Objects that are close to a corner of the frustum may be reported as visible.
+		bool isSphereVisible(const bbe::Vector3& center, float radius) const;
+		bool isAabbVisible(const bbe::Vector3& center, const bbe::Vector3& halfExtent) const;
+		// Tests the world space bounding box of an object space box that is moved by transform.
+		bool isAabbVisible(const bbe::Matrix4& transform, const bbe::Vector3& center, const bbe::Vector3& halfExtent) const;
+	};
+}
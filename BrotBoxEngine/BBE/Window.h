@@ -99,6 +99,9 @@ namespace bbe
 
 		void screenshot(const bbe::String& path);
 		void setVideoRenderingMode(const char* path);
+		bool isFrameCaptureSupported() const;
+		void captureFrame(bbe::FrameCapture& capture, uint64_t frameNumber);
+		void flushFrameCapture();
 		void close();
 
 		void registerCloseListener(const std::function<void()>& listener);
@@ -109,8 +112,16 @@ namespace bbe
 
 		void* getNativeHandle();
 
-#ifdef BBE_RENDERER_OPENGL
+#if defined(BBE_RENDERER_OPENGL) || defined(BBE_RENDERER_NULL)
 		uint32_t getAmountOfDrawcalls() const;
+#endif
+#ifdef BBE_RENDERER_OPENGL
+		size_t getAmountOfStreamedBytes() const;
+		uint32_t getAmountOfVisibleObjects3D() const;
+		uint32_t getAmountOfCulledObjects3D() const;
+#endif
+#ifdef BBE_RENDERER_SOFTWARE
+		bbe::Image getFramebuffer();
 #endif
 	};
 
@@ -0,0 +1,142 @@
+#include "BBE/Bench.h"
+#include "BBE/Error.h"
+#include "BBE/Math.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+bbe::bench::Config bbe::bench::parseConfig(const char* config)
+{
+	Config retVal;
+	retVal.enabled = true;
+
+	const bbe::DynamicArray<bbe::String> tokens = bbe::String(config).split(",");
+	for (size_t i = 0; i < tokens.getLength(); i++)
+	{
+		// String::trim can't handle empty strings.
+		if (tokens[i].isEmpty()) continue;
+		const bbe::String token = tokens[i].trim();
+		if (token.isEmpty()) continue;
+		const int64_t equals = token.search("=");
+		if (equals < 0)
+		{
+			bbe::Crash(bbe::Error::IllegalArgument, "Bench config entries must look like key=value");
+		}
+		const bbe::String key = token.substring(0, equals).trim();
+		const bbe::String value = token.substring(equals + 1).trim();
+
+		if      (key == "frames")    retVal.frames         = (uint64_t)value.toLong();
+		else if (key == "warmup")    retVal.warmupFrames   = (uint64_t)value.toLong();
+		else if (key == "frametime") retVal.fixedFrameTime = value.toFloat();
+		else if (key == "seed")      retVal.seed           = (uint32_t)value.toLong();
+		else if (key == "out")       retVal.outputPath     = value;
+		else
+		{
+			bbe::Crash(bbe::Error::IllegalArgument, "Unknown bench config key");
+		}
+	}
+
+	if (retVal.frames == 0 || retVal.fixedFrameTime <= 0)
+	{
+		bbe::Crash(bbe::Error::IllegalArgument, "Bench needs at least one frame and a positive frame time");
+	}
+	return retVal;
+}
+
+const bbe::bench::Config& bbe::bench::getEnvironmentConfig()
+{
+	static const Config config = []()
+		{
+			const char* env = std::getenv("BBE_BENCH");
+			if (env == nullptr) return Config();
+			return parseConfig(env);
+		}();
+	return config;
+}
+
+bbe::bench::PhaseStats bbe::bench::computeStats(const char* name, const bbe::List<double>& samplesSeconds)
+{
+	PhaseStats retVal;
+	retVal.name = name;
+	if (samplesSeconds.isEmpty()) return retVal;
+
+	bbe::List<double> sorted = samplesSeconds;
+	sorted.sort();
+
+	double sum = 0;
+	for (size_t i = 0; i < sorted.getLength(); i++)
+	{
+		sum += sorted[i];
+	}
+
+	// Nearest rank method.
+	auto percentile = [&sorted](double p)
+		{
+			const size_t rank = (size_t)std::ceil(p / 100.0 * sorted.getLength());
+			return sorted[bbe::Math::clamp<size_t>(rank, 1, sorted.getLength()) - 1];
+		};
+
+	retVal.mean = sum / sorted.getLength() * 1000.0;
+	retVal.p50  = percentile(50) * 1000.0;
+	retVal.p90  = percentile(90) * 1000.0;
+	retVal.p99  = percentile(99) * 1000.0;
+	retVal.max  = sorted.last() * 1000.0;
+	return retVal;
+}
+
+bbe::bench::Result bbe::bench::computeResult(const bbe::String& name, const Config& config, const bbe::List<FrameTimings>& frames)
+{
+	Result retVal;
+	retVal.name = name;
+	retVal.config = config;
+	retVal.measuredFrames = frames.getLength();
+
+	bbe::List<double> samples;
+	samples.resizeCapacity(frames.getLength());
+	auto addPhase = [&](const char* phaseName, double FrameTimings::* member)
+		{
+			samples.clear();
+			for (size_t i = 0; i < frames.getLength(); i++)
+			{
+				samples.add(frames[i].*member);
+			}
+			retVal.phases.add(computeStats(phaseName, samples));
+		};
+	addPhase("update",   &FrameTimings::update);
+	addPhase("draw3D",   &FrameTimings::draw3D);
+	addPhase("draw2D",   &FrameTimings::draw2D);
+	addPhase("overhead", &FrameTimings::overhead);
+	addPhase("frame",    &FrameTimings::frame);
+	return retVal;
+}
+
+static void appendJsonString(bbe::String& out, const bbe::String& str)
+{
+	out += '"';
+	for (const char* c = str.getRaw(); *c; c++)
+	{
+		if (*c == '"' || *c == '\\') out += '\\';
+		if ((unsigned char)*c < 0x20) out += ' ';
+		else out += *c;
+	}
+	out += '"';
+}
+
+bbe::String bbe::bench::toJson(const Result& result)
+{
+	char buffer[256];
+	bbe::String retVal = "{\"name\":";
+	appendJsonString(retVal, result.name);
+	snprintf(buffer, sizeof(buffer), ",\"frames\":%llu,\"warmupFrames\":%llu,\"fixedFrameTime\":%.6f,\"seed\":%u,\"phases\":{",
+		(unsigned long long)result.measuredFrames, (unsigned long long)result.config.warmupFrames, result.config.fixedFrameTime, result.config.seed);
+	retVal += buffer;
+	for (size_t i = 0; i < result.phases.getLength(); i++)
+	{
+		const PhaseStats& phase = result.phases[i];
+		snprintf(buffer, sizeof(buffer), "%s\"%s\":{\"meanMs\":%.4f,\"p50Ms\":%.4f,\"p90Ms\":%.4f,\"p99Ms\":%.4f,\"maxMs\":%.4f}",
+			i == 0 ? "" : ",", phase.name, phase.mean, phase.p50, phase.p90, phase.p99, phase.max);
+		retVal += buffer;
+	}
+	retVal += "}}";
+	return retVal;
+}
@@ -15,16 +15,21 @@ void bbe::ByteBufferSpan::read(bbe::byte* bytes, const bbe::byte* default_, size
 	{
 		for (size_t i = 0; i < length; i++)
 		{
-			bytes[length - 1 - i] = m_bytes->getRaw()[m_start + i];
+			bytes[length - 1 - i] = getData()[m_start + i];
 		}
 	}
 	else
 	{
-		memcpy(bytes, m_bytes->getRaw() + m_start, length);
+		memcpy(bytes, getData() + m_start, length);
 	}
 	m_start += length;
 }
 
+const bbe::byte* bbe::ByteBufferSpan::getData() const
+{
+	return m_bytes != nullptr ? m_bytes->getRaw() : m_raw;
+}
+
 bbe::ByteBufferSpan::ByteBufferSpan(bbe::List<bbe::byte>& bytes) :
 	m_bytes(&bytes),
 	m_start(0),
@@ -39,6 +44,13 @@ bbe::ByteBufferSpan::ByteBufferSpan(bbe::List<bbe::byte>& bytes, size_t start, s
 {
 }
 
+bbe::ByteBufferSpan::ByteBufferSpan(const bbe::byte* data, size_t length) :
+	m_raw(data),
+	m_start(0),
+	m_end(length)
+{
+}
+
 bbe::ByteBufferSpan bbe::ByteBufferSpan::readSpan(size_t size)
 {
 	size_t subSpanStart = m_start;
@@ -52,15 +64,19 @@ bbe::ByteBufferSpan bbe::ByteBufferSpan::readSpan(size_t size)
 	{
 		m_start += size;
 	}
-	ByteBufferSpan span(*m_bytes, subSpanStart, subSpanEnd);
+	ByteBufferSpan span;
+	span.m_bytes = m_bytes;
+	span.m_raw = m_raw;
+	span.m_start = subSpanStart;
+	span.m_end = subSpanEnd;
 	return span;
 }
 
 const char* bbe::ByteBufferSpan::readNullString()
 {
 	if (m_start == m_end) return "";
-	const char* retVal = (const char*)m_bytes->getRaw() + m_start;
-	while ((*m_bytes)[m_start])
+	const char* retVal = (const char*)getData() + m_start;
+	while (getData()[m_start])
 	{
 		if (m_start == m_end - 1)
 		{
@@ -83,6 +99,11 @@ size_t bbe::ByteBufferSpan::getLength() const
 	return m_end - m_start;
 }
 
+const bbe::byte* bbe::ByteBufferSpan::getRaw() const
+{
+	return getData() + m_start;
+}
+
 void bbe::ByteBufferSpan::reduceLengthTo(size_t length)
 {
 	if (getLength() < length) bbe::Crash(bbe::Error::IllegalArgument);
@@ -97,7 +118,7 @@ void bbe::ByteBufferSpan::skipBytes(size_t bytes)
 
 bool bbe::ByteBufferSpan::valid() const
 {
-	return m_bytes != nullptr;
+	return m_bytes != nullptr || m_raw != nullptr;
 }
 
 void bbe::ByteBufferSpan::flipEndianness()
@@ -0,0 +1,167 @@
+#include "BBE/CommandBuffer2D.h"
+#include "BBE/Rectangle.h"
+#include "BBE/Circle.h"
+#include <algorithm>
+
+static bool isLayerLess(const bbe::DrawCommand2D& a, const bbe::DrawCommand2D& b)
+{
+	return a.layer < b.layer;
+}
+
+static bool isLayerPipelineTextureLess(const bbe::DrawCommand2D& a, const bbe::DrawCommand2D& b)
+{
+	if (a.layer != b.layer) return a.layer < b.layer;
+	if (a.type  != b.type ) return a.type  < b.type;
+	if (a.imageData.get() != b.imageData.get()) return (uintptr_t)a.imageData.get() < (uintptr_t)b.imageData.get();
+	return (uintptr_t)a.image < (uintptr_t)b.image;
+}
+
+static bool canMerge(const bbe::DrawBatch2D& batch, const bbe::DrawCommand2D& command)
+{
+	// Every vertex index list has its own geometry, so they can't share a draw call.
+	if (command.type == bbe::DrawCommandType2D::VERTEX_INDEX_LIST) return false;
+	return batch.type == command.type && batch.image == command.image && batch.imageData == command.imageData.get();
+}
+
+void bbe::CommandBuffer2D::addRect(int32_t layer, const bbe::Color& color, const bbe::Rectangle& rect, float rotation)
+{
+	DrawCommand2D command;
+	command.type = DrawCommandType2D::RECT;
+	command.layer = layer;
+	command.color = color;
+	command.x = rect.x;
+	command.y = rect.y;
+	command.width = rect.width;
+	command.height = rect.height;
+	command.rotation = rotation;
+	m_commands.add(command);
+}
+
+void bbe::CommandBuffer2D::addCircle(int32_t layer, const bbe::Color& color, const bbe::Circle& circle)
+{
+	DrawCommand2D command;
+	command.type = DrawCommandType2D::CIRCLE;
+	command.layer = layer;
+	command.color = color;
+	command.x = circle.getX();
+	command.y = circle.getY();
+	command.width = circle.getWidth();
+	command.height = circle.getHeight();
+	m_commands.add(command);
+}
+
+void bbe::CommandBuffer2D::addImage(int32_t layer, const bbe::Color& color, const bbe::Rectangle& rect, const bbe::Image& image, const bbe::AutoRef& imageData, float rotation)
+{
+	DrawCommand2D command;
+	command.type = DrawCommandType2D::IMAGE;
+	command.layer = layer;
+	command.color = color;
+	command.x = rect.x;
+	command.y = rect.y;
+	command.width = rect.width;
+	command.height = rect.height;
+	command.rotation = rotation;
+	command.image = &image;
+	command.imageData = imageData;
+	m_commands.add(command);
+}
+
+void bbe::CommandBuffer2D::addImage(int32_t layer, const bbe::Color& color, const bbe::Rectangle& rect, const bbe::Image& image, const bbe::AutoRef& imageData, float rotation, const bbe::Rectangle& uv)
+{
+	addImage(layer, color, rect, image, imageData, rotation);
+	DrawCommand2D& command = m_commands.last();
+	command.uvX = uv.x;
+	command.uvY = uv.y;
+	command.uvWidth = uv.width;
+	command.uvHeight = uv.height;
+}
+
+void bbe::CommandBuffer2D::addVertexIndexList(int32_t layer, const bbe::Color& color, const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, size_t amountOfVertices, const bbe::Vector2& pos, const bbe::Vector2& scale)
+{
+	DrawCommand2D command;
+	command.type = DrawCommandType2D::VERTEX_INDEX_LIST;
+	command.layer = layer;
+	command.color = color;
+	command.x = pos.x;
+	command.y = pos.y;
+	command.width = scale.x;
+	command.height = scale.y;
+	command.firstVertex = (uint32_t)m_vertices.getLength();
+	command.amountOfVertices = (uint32_t)amountOfVertices;
+	command.firstIndex = (uint32_t)m_indices.getLength();
+	command.amountOfIndices = (uint32_t)amountOfIndices;
+	m_vertices.addArray(vertices, amountOfVertices);
+	m_indices.addArray(indices, amountOfIndices);
+	m_commands.add(command);
+}
+
+void bbe::CommandBuffer2D::setReorderWithinLayers(bool reorder)
+{
+	m_reorderWithinLayers = reorder;
+}
+
+bool bbe::CommandBuffer2D::isReorderWithinLayers() const
+{
+	return m_reorderWithinLayers;
+}
+
+void bbe::CommandBuffer2D::sortAndMerge()
+{
+	auto less = m_reorderWithinLayers ? isLayerPipelineTextureLess : isLayerLess;
+	// Most frames never touch the layers, in which case there is nothing to sort.
+	if (!std::is_sorted(m_commands.begin(), m_commands.end(), less))
+	{
+		std::stable_sort(m_commands.begin(), m_commands.end(), less);
+	}
+
+	m_batches.clear();
+	for (size_t i = 0; i < m_commands.getLength(); i++)
+	{
+		const DrawCommand2D& command = m_commands[i];
+		if (!m_batches.isEmpty() && canMerge(m_batches.last(), command))
+		{
+			m_batches.last().amountOfCommands++;
+			continue;
+		}
+		DrawBatch2D batch;
+		batch.type = command.type;
+		batch.image = command.image;
+		batch.imageData = command.imageData.get();
+		batch.firstCommand = i;
+		batch.amountOfCommands = 1;
+		m_batches.add(batch);
+	}
+}
+
+const bbe::List<bbe::DrawCommand2D>& bbe::CommandBuffer2D::getCommands() const
+{
+	return m_commands;
+}
+
+const bbe::List<bbe::DrawBatch2D>& bbe::CommandBuffer2D::getBatches() const
+{
+	return m_batches;
+}
+
+const bbe::List<bbe::Vector2>& bbe::CommandBuffer2D::getVertices() const
+{
+	return m_vertices;
+}
+
+const bbe::List<uint32_t>& bbe::CommandBuffer2D::getIndices() const
+{
+	return m_indices;
+}
+
+bool bbe::CommandBuffer2D::isEmpty() const
+{
+	return m_commands.isEmpty();
+}
+
+void bbe::CommandBuffer2D::clear()
+{
+	m_commands.clear();
+	m_vertices.clear();
+	m_indices.clear();
+	m_batches.clear();
+}
@@ -1,6 +1,7 @@
 #include "BBE/Cube.h"
 #include "BBE/List.h"
 #include "BBE/Math.h"
+#include "BBE/SeparatingAxis.h"
 #include "string.h"
 
 bbe::Cube::Cube()
@@ -175,6 +176,15 @@ void bbe::Cube::getVertices(bbe::List<bbe::Vector3>& outVertices) const
 	outVertices.add(m_transform * bbe::Vector3(-0.5f, -0.5f, -0.5f));
 }
 
+bool bbe::Cube::intersects(const Shape<bbe::Vector3>& other) const
+{
+	if (const bbe::Cube* cube = dynamic_cast<const bbe::Cube*>(&other))
+	{
+		return bbe::sat::intersects(*this, *cube);
+	}
+	return Shape3::intersects(other);
+}
+
 bbe::Vector2 normalPos(int32_t face, int32_t sub, bbe::Vector2& maxPos)
 {
 	const bbe::Vector2i basePosi = bbe::Math::squareCantor(face);
@@ -0,0 +1,277 @@
+#include "BBE/DspGraph.h"
+#include "BBE/JobSystem.h"
+#include "BBE/Math.h"
+#include <cmath>
+
+template<typename Func>
+static void forEachChunk(size_t begin, size_t end, bool parallel, Func&& func)
+{
+	if (begin >= end) return;
+	const size_t amountOfChunks = (end - begin + bbe::dsp::CHUNK_SIZE - 1) / bbe::dsp::CHUNK_SIZE;
+	auto processChunks = [&](size_t firstChunk, size_t lastChunk)
+		{
+			for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+			{
+				const size_t chunkBegin = begin + chunk * bbe::dsp::CHUNK_SIZE;
+				func(chunk, chunkBegin, bbe::Math::min(chunkBegin + bbe::dsp::CHUNK_SIZE, end));
+			}
+		};
+	if (parallel && amountOfChunks > 1)
+	{
+		bbe::jobs::parallelFor(0, amountOfChunks, 1, processChunks);
+	}
+	else
+	{
+		processChunks(0, amountOfChunks);
+	}
+}
+
+// Calls func(i, sin(phase + i * phaseStep)) for every i in [begin, end).
+template<typename Func>
+static void forEachSine(size_t begin, size_t end, double phase, double phaseStep, Func&& func)
+{
+	constexpr size_t lanes = 4;
+	double sines[lanes];
+	double cosines[lanes];
+	for (size_t k = 0; k < lanes; k++)
+	{
+		const double angle = phase + (double)(begin + k) * phaseStep;
+		sines[k] = std::sin(angle);
+		cosines[k] = std::cos(angle);
+	}
+	const double stepSine = std::sin(lanes * phaseStep);
+	const double stepCosine = std::cos(lanes * phaseStep);
+
+	size_t i = begin;
+	for (; i + lanes <= end; i += lanes)
+	{
+		for (size_t k = 0; k < lanes; k++)
+		{
+			func(i + k, sines[k]);
+		}
+		for (size_t k = 0; k < lanes; k++)
+		{
+			const double sine = sines[k] * stepCosine + cosines[k] * stepSine;
+			cosines[k] = cosines[k] * stepCosine - sines[k] * stepSine;
+			sines[k] = sine;
+		}
+	}
+	for (; i < end; i++)
+	{
+		func(i, std::sin(phase + (double)i * phaseStep));
+	}
+}
+
+template<typename T>
+void bbe::dsp::addSine(T* signal, size_t begin, size_t end, double phase, double phaseStep, double mult)
+{
+	forEachSine(begin, end, phase, phaseStep, [&](size_t i, double sine)
+		{
+			signal[i] += (T)(sine * mult);
+		});
+}
+
+template<typename T>
+void bbe::dsp::multiplySine(T* signal, size_t begin, size_t end, double phase, double phaseStep, double bias, double mult)
+{
+	forEachSine(begin, end, phase, phaseStep, [&](size_t i, double sine)
+		{
+			signal[i] *= (T)(bias + sine * mult);
+		});
+}
+
+template<typename T>
+void bbe::dsp::normalize(bbe::List<T>& signal, bool parallel)
+{
+	const size_t length = signal.getLength();
+	bbe::List<T> maxima;
+	maxima.resizeCapacityAndLength((length + CHUNK_SIZE - 1) / CHUNK_SIZE);
+	forEachChunk(0, length, parallel, [&](size_t chunk, size_t begin, size_t end)
+		{
+			T maxAmplitude = 0;
+			for (size_t i = begin; i < end; i++)
+			{
+				maxAmplitude = bbe::Math::max(maxAmplitude, (T)std::fabs(signal[i]));
+			}
+			maxima[chunk] = maxAmplitude;
+		});
+
+	T maxAmplitude = 0;
+	for (size_t i = 0; i < maxima.getLength(); i++)
+	{
+		maxAmplitude = bbe::Math::max(maxAmplitude, maxima[i]);
+	}
+	if (maxAmplitude <= 0) return;
+
+	forEachChunk(0, length, parallel, [&](size_t, size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				signal[i] /= maxAmplitude;
+			}
+		});
+}
+
+template<typename T>
+void bbe::dsp::lowPass(bbe::List<T>& signal, double alpha, bool parallel)
+{
+	const size_t length = signal.getLength();
+	if (length < 2) return;
+	const T a = (T)alpha;
+	const T decay = (T)(1.0 - alpha);
+	T* data = signal.getRaw();
+
+	// Pass 1: Every chunk on its own, as if everything before it was silent.
+	forEachChunk(1, length, parallel, [&](size_t, size_t begin, size_t end)
+		{
+			T previous = 0;
+			for (size_t i = begin; i < end; i++)
+			{
+				previous = previous + a * (data[i] - previous);
+				data[i] = previous;
+			}
+		});
+
+	// Handoff: The true state before each chunk. The state at the end of the previous chunk decays by the same factor
+	// for every sample of a chunk, so it's enough to know the chunk's first and last value.
+	const size_t amountOfChunks = (length - 1 + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	bbe::List<T> carries;
+	carries.resizeCapacityAndLength(amountOfChunks);
+	T carry = data[0];
+	for (size_t chunk = 0; chunk < amountOfChunks; chunk++)
+	{
+		carries[chunk] = carry;
+		const size_t begin = 1 + chunk * CHUNK_SIZE;
+		const size_t end = bbe::Math::min(begin + CHUNK_SIZE, length);
+		carry = data[end - 1] + (T)std::pow((double)decay, (double)(end - begin)) * carry;
+	}
+
+	// Pass 2: Add the decaying influence of everything that came before the chunk.
+	forEachChunk(1, length, parallel, [&](size_t chunk, size_t begin, size_t end)
+		{
+			T influence = carries[chunk];
+			for (size_t i = begin; i < end; i++)
+			{
+				influence *= decay;
+				data[i] += influence;
+			}
+		});
+}
+
+void bbe::dsp::forEachIndependentBlock(size_t first, size_t length, size_t minDistance, bool parallel, const std::function<void(size_t, size_t)>& func)
+{
+	if (first >= length) return;
+	if (!parallel || minDistance < CHUNK_SIZE)
+	{
+		// Blocks this small would cost more in scheduling than they gain.
+		func(first, length);
+		return;
+	}
+	for (size_t blockBegin = first; blockBegin < length; blockBegin += minDistance)
+	{
+		const size_t blockEnd = bbe::Math::min(blockBegin + minDistance, length);
+		forEachChunk(blockBegin, blockEnd, true, [&](size_t, size_t begin, size_t end)
+			{
+				func(begin, end);
+			});
+	}
+}
+
+template<typename T>
+void bbe::dsp::feedbackDelay(bbe::List<T>& signal, size_t delay, double factor, bool parallel)
+{
+	T* data = signal.getRaw();
+	const T f = (T)factor;
+	if (delay == 0)
+	{
+		forEachChunk(0, signal.getLength(), parallel, [&](size_t, size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					data[i] += data[i] * f;
+				}
+			});
+		return;
+	}
+	forEachIndependentBlock(delay, signal.getLength(), delay, parallel, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				data[i] += data[i - delay] * f;
+			}
+		});
+}
+
+template<typename T>
+void bbe::dsp::Graph<T>::addPointwise(PointwiseStage&& stage)
+{
+	m_stages.add({ std::move(stage), nullptr });
+}
+
+template<typename T>
+void bbe::dsp::Graph<T>::addWholeSignal(WholeSignalStage&& stage)
+{
+	m_stages.add({ nullptr, std::move(stage) });
+}
+
+template<typename T>
+size_t bbe::dsp::Graph<T>::getAmountOfStages() const
+{
+	return m_stages.getLength();
+}
+
+template<typename T>
+size_t bbe::dsp::Graph<T>::getAmountOfPasses() const
+{
+	size_t retVal = 0;
+	for (size_t i = 0; i < m_stages.getLength(); i++)
+	{
+		if (m_stages[i].wholeSignal || i == 0 || m_stages[i - 1].wholeSignal)
+		{
+			retVal++;
+		}
+	}
+	return retVal;
+}
+
+template<typename T>
+void bbe::dsp::Graph<T>::render(bbe::List<T>& signal, bool parallel) const
+{
+	size_t i = 0;
+	while (i < m_stages.getLength())
+	{
+		if (m_stages[i].wholeSignal)
+		{
+			m_stages[i].wholeSignal(signal, parallel);
+			i++;
+			continue;
+		}
+
+		// All pointwise stages up to the next whole signal stage run chunk by chunk while the chunk is in the cache.
+		size_t fusedEnd = i;
+		while (fusedEnd < m_stages.getLength() && !m_stages[fusedEnd].wholeSignal)
+		{
+			fusedEnd++;
+		}
+		T* data = signal.getRaw();
+		forEachChunk(0, signal.getLength(), parallel, [&](size_t, size_t begin, size_t end)
+			{
+				for (size_t k = i; k < fusedEnd; k++)
+				{
+					m_stages[k].pointwise(data, begin, end);
+				}
+			});
+		i = fusedEnd;
+	}
+}
+
+#define BBE_DSP_INSTANTIATE(T) \
+	template void bbe::dsp::addSine<T>(T*, size_t, size_t, double, double, double); \
+	template void bbe::dsp::multiplySine<T>(T*, size_t, size_t, double, double, double, double); \
+	template void bbe::dsp::normalize<T>(bbe::List<T>&, bool); \
+	template void bbe::dsp::lowPass<T>(bbe::List<T>&, double, bool); \
+	template void bbe::dsp::feedbackDelay<T>(bbe::List<T>&, size_t, double, bool); \
+	template class bbe::dsp::Graph<T>;
+
+BBE_DSP_INSTANTIATE(float)
+BBE_DSP_INSTANTIATE(double)
@@ -4,54 +4,130 @@
 #include <stb_truetype.h>
 #include <filesystem>
 #include <iostream>
-#include "BBE/SimpleFile.h"
 #include "EmbeddedFonts.h"
 #include "BBE/Logging.h"
+#include "BBE/FrameArena.h"
+#include "BBE/Math.h"
+#include <algorithm>
 
-const bbe::Font::CharData& bbe::Font::loadCharData(const int32_t codePoint, float scale_) const
+int32_t& bbe::Font::getGlyphSlot(int32_t c, float scale) const
 {
-	if (!isInit) bbe::Crash(bbe::Error::NotInitialized);
+	if (c >= 0 && c < 256)
+	{
+		for (size_t i = 0; i < latin1Tables.getLength(); i++)
+		{
+			if (latin1Tables[i].scale == scale) return latin1Tables[i].glyphs[c];
+		}
+		Latin1Table table;
+		table.scale = scale;
+		std::fill(std::begin(table.glyphs), std::end(table.glyphs), NO_GLYPH);
+		latin1Tables.add(table);
+		return latin1Tables.last().glyphs[c];
+	}
+
+	auto it = otherGlyphs.find({ c, scale });
+	if (it == otherGlyphs.end())
+	{
+		it = otherGlyphs.emplace(std::make_pair(c, scale), NO_GLYPH).first;
+	}
+	return it->second;
+}
 
-	if (charDatas.find({ codePoint, scale_ }) != charDatas.end()) bbe::Crash(bbe::Error::IllegalArgument); // A char was passed twice.
+int32_t bbe::Font::loadGlyph(const int32_t codePoint, float scale_) const
+{
+	Glyph glyph;
+	glyph.codePoint = codePoint;
+	glyph.scale = scale_;
 
-	CharData cd;
+	if (codePoint != '\n')
+	{
+		const float scale = stbtt_ScaleForPixelHeight(&fontInfo, static_cast<float>(fontSize * scale_));
+
+		stbtt_GetCodepointHMetrics(&fontInfo, codePoint, &glyph.advanceWidth, &glyph.leftSideBearing);
+		glyph.advanceWidth = static_cast<int>(glyph.advanceWidth * scale / scale_);
+		glyph.leftSideBearing = static_cast<int>(glyph.leftSideBearing * scale / scale_);
+
+		int32_t y1 = 0;
+		stbtt_GetCodepointBox(&fontInfo, codePoint, nullptr, nullptr, nullptr, &y1);
+		glyph.verticalOffset = static_cast<int>((-y1) * scale / scale_);
+
+		int32_t boxX0 = 0;
+		int32_t boxY0 = 0;
+		int32_t boxX1 = 0;
+		int32_t boxY1 = 0;
+		stbtt_GetCodepointBitmapBox(&fontInfo, codePoint, scale, scale, &boxX0, &boxY0, &boxX1, &boxY1);
+		glyph.width = boxX1 - boxX0;
+		glyph.height = boxY1 - boxY0;
+	}
 
-	const float scale = stbtt_ScaleForPixelHeight(&fontInfo, static_cast<float>(fontSize * scale_));
+	glyphs.add(glyph);
+	return static_cast<int32_t>(glyphs.getLength() - 1);
+}
 
-	stbtt_GetCodepointHMetrics(&fontInfo, codePoint, &cd.advanceWidth, &cd.leftSideBearing);
-	cd.advanceWidth = static_cast<int>(cd.advanceWidth * scale / scale_);
-	cd.leftSideBearing = static_cast<int>(cd.leftSideBearing * scale / scale_);
+int32_t bbe::Font::getGlyphIndex(int32_t c, float scale) const
+{
+	if (!isInit) bbe::Crash(bbe::Error::NotInitialized);
+	if (c == ' ' || c == '\n') scale = 1.0f;
 
-	int32_t y1 = 0;
-	stbtt_GetCodepointBox(&fontInfo, codePoint, nullptr, nullptr, nullptr, &y1);
-	cd.verticalOffset = static_cast<int>((-y1) * scale / scale_);
+	int32_t& slot = getGlyphSlot(c, scale);
+	if (slot == NO_GLYPH)
+	{
+		slot = loadGlyph(c, scale);
+	}
+	return slot;
+}
 
-	int width = 0;
-	int height = 0;
-	int xoff = 0;
-	int yoff = 0;
-	unsigned char* bitmap = stbtt_GetCodepointBitmap(&fontInfo, 0, scale, codePoint, &width, &height, &xoff, &yoff);
-	if (bitmap == nullptr) bbe::Crash(bbe::Error::NullPointer);
+const bbe::Font::Glyph& bbe::Font::getGlyph(int32_t c, float scale) const
+{
+	return glyphs[getGlyphIndex(c, scale)];
+}
 
-	//TODO: Currently this is a very wasteful approach to rendering text as we create a separate image for every distinct
-	//      char. It would be much more efficient to implement some form of texture atlas and use that here instead.
-	cd.charImage = bbe::Image(width, height, bitmap, bbe::ImageFormat::R8);
-	stbtt_FreeBitmap(bitmap, nullptr);
-	cd.charImage.setRepeatMode(bbe::ImageRepeatMode::CLAMP_TO_EDGE);
-	charDatas[{codePoint, scale_}] = std::move(cd);
-	return charDatas[{codePoint, scale_}];
+void bbe::Font::rasterize(const Glyph& glyph, bbe::List<byte>& outBitmap) const
+{
+	const float scale = stbtt_ScaleForPixelHeight(&fontInfo, static_cast<float>(fontSize * glyph.scale));
+	outBitmap.clear();
+	outBitmap.add(0, static_cast<size_t>(glyph.width) * glyph.height);
+	stbtt_MakeCodepointBitmap(&fontInfo, outBitmap.getRaw(), glyph.width, glyph.height, glyph.width, scale, scale, glyph.codePoint);
 }
 
-const bbe::Font::CharData& bbe::Font::getCharData(int32_t c, float scale) const
+void bbe::Font::addToAtlas(Glyph& glyph) const
 {
-	if (c == ' ' || c == '\n') scale = 1.0f;
-	auto keyVal = charDatas.find({ c, scale });
-	if (keyVal == charDatas.end())
+	// The padding keeps linear filtering from bleeding the neighbours into the glyph.
+	const int32_t paddedWidth = glyph.width + ATLAS_PADDING;
+	const int32_t paddedHeight = glyph.height + ATLAS_PADDING;
+
+	for (size_t i = 0; i < atlasPages.getLength(); i++)
+	{
+		if (atlasPages[i]->packer.insert(paddedWidth, paddedHeight, glyph.atlasPos))
+		{
+			glyph.page = static_cast<int32_t>(i);
+			break;
+		}
+	}
+
+	if (glyph.page == NO_GLYPH)
 	{
-		return loadCharData(c, scale);
+		// Glyphs that are bigger than a page get a page of their own.
+		const int32_t pageWidth = bbe::Math::max(ATLAS_PAGE_SIZE, paddedWidth);
+		const int32_t pageHeight = bbe::Math::max(ATLAS_PAGE_SIZE, paddedHeight);
+
+		bbe::List<byte> emptyPixels;
+		emptyPixels.add(0, static_cast<size_t>(pageWidth) * pageHeight);
+
+		std::shared_ptr<AtlasPage> page = std::make_shared<AtlasPage>();
+		page->image = bbe::Image(pageWidth, pageHeight, emptyPixels.getRaw(), bbe::ImageFormat::R8);
+		page->image.keepAfterUpload();
+		page->image.setRepeatMode(bbe::ImageRepeatMode::CLAMP_TO_EDGE);
+		page->packer.reset(pageWidth, pageHeight);
+		if (!page->packer.insert(paddedWidth, paddedHeight, glyph.atlasPos)) bbe::Crash(bbe::Error::IllegalState);
+
+		glyph.page = static_cast<int32_t>(atlasPages.getLength());
+		atlasPages.add(std::move(page));
 	}
 
-	return keyVal->second;
+	bbe::List<byte> bitmap;
+	rasterize(glyph, bitmap);
+	atlasPages[glyph.page]->image.setPixels(glyph.atlasPos, glyph.width, glyph.height, bitmap.getRaw());
 }
 
 bbe::Font::Font()
@@ -73,7 +149,7 @@ void bbe::Font::load(const bbe::String& fontPath, unsigned fontSize)
 
 	if (fontPath == "OpenSansRegular.ttf")
 	{
-		font = OpenSansRegular;
+		initFontInfo(OpenSansRegular.getRaw(), fontSize);
 	}
 	else
 	{
@@ -110,13 +186,31 @@ void bbe::Font::load(const bbe::String& fontPath, unsigned fontSize)
 				bbe::Crash(bbe::Error::NullPointer);
 			}
 		}
-		
-		font = bbe::simpleFile::readBinaryFile(this->fontPath);
+
+		fontFile = std::make_shared<const bbe::MappedFile>(this->fontPath, bbe::MappedFile::AccessPattern::RANDOM);
+		initFontInfo(fontFile->getRaw(), fontSize);
 	}
+}
 
+void bbe::Font::load(bbe::MappedFile&& file, unsigned fontSize)
+{
+	if (isInit)
+	{
+		bbe::Crash(bbe::Error::AlreadyCreated);
+	}
+
+	fontFile = std::make_shared<const bbe::MappedFile>(std::move(file));
+	initFontInfo(fontFile->getRaw(), fontSize);
+}
+
+void bbe::Font::initFontInfo(const bbe::byte* data, unsigned fontSize)
+{
 	this->fontSize   = fontSize;
 
-	stbtt_InitFont(&fontInfo, font.getRaw(), stbtt_GetFontOffsetForIndex(font.getRaw(), 0));
+	if (data == nullptr || !stbtt_InitFont(&fontInfo, data, stbtt_GetFontOffsetForIndex(data, 0)))
+	{
+		bbe::Crash(bbe::Error::IllegalArgument);
+	}
 	const float scale = stbtt_ScaleForPixelHeight(&fontInfo, static_cast<float>(fontSize));
 
 	int32_t ascent = 0;
@@ -125,22 +219,6 @@ void bbe::Font::load(const bbe::String& fontPath, unsigned fontSize)
 	stbtt_GetFontVMetrics(&fontInfo, &ascent, &descent, &lineGap);
 	pixelsFromLineToLine = static_cast<int>((ascent - descent + lineGap) * scale);
 
-	int32_t spaceAdvance = 0;
-	int32_t spaceLeftSideBearing = 0;
-	stbtt_GetCodepointHMetrics(&fontInfo, ' ', &spaceAdvance, &spaceLeftSideBearing);
-
-	{
-		CharData space;
-		space.advanceWidth = static_cast<int>(spaceAdvance * scale);
-		space.leftSideBearing = static_cast<int>(spaceLeftSideBearing * scale);
-		charDatas[{' ', 1.0f}] = std::move(space);
-	}
-
-	{
-		CharData empty;
-		charDatas[{'\n', 1.0f}] = std::move(empty);
-	}
-
 	isInit = true;
 }
 
@@ -164,7 +242,49 @@ int32_t bbe::Font::getPixelsFromLineToLine() const
 
 const bbe::Image& bbe::Font::getImage(int32_t c, float scale) const
 {
-	return getCharData(c, scale).charImage;
+	if (c == ' ' || c == '\n') scale = 1.0f;
+	const Glyph& glyph = getGlyph(c, scale);
+	if (glyph.width == 0 || glyph.height == 0)
+	{
+		static const bbe::Image empty;
+		return empty;
+	}
+
+	std::shared_ptr<bbe::Image>& image = standaloneImages[{ c, scale }];
+	if (!image)
+	{
+		bbe::List<byte> bitmap;
+		rasterize(glyph, bitmap);
+		image = std::make_shared<bbe::Image>(glyph.width, glyph.height, bitmap.getRaw(), bbe::ImageFormat::R8);
+		image->setRepeatMode(bbe::ImageRepeatMode::CLAMP_TO_EDGE);
+	}
+	return *image;
+}
+
+bbe::Font::AtlasRegion bbe::Font::getAtlasRegion(int32_t c, float scale) const
+{
+	Glyph& glyph = glyphs[getGlyphIndex(c, scale)];
+	AtlasRegion region;
+	if (glyph.width == 0 || glyph.height == 0) return region;
+
+	if (glyph.page == NO_GLYPH) addToAtlas(glyph);
+
+	const bbe::Image& page = atlasPages[glyph.page]->image;
+	const float pageWidth = static_cast<float>(page.getWidth());
+	const float pageHeight = static_cast<float>(page.getHeight());
+	region.page = &page;
+	region.uv = bbe::Rectangle(glyph.atlasPos.x / pageWidth, glyph.atlasPos.y / pageHeight, glyph.width / pageWidth, glyph.height / pageHeight);
+	return region;
+}
+
+size_t bbe::Font::getAmountOfAtlasPages() const
+{
+	return atlasPages.getLength();
+}
+
+const bbe::Image& bbe::Font::getAtlasPage(size_t index) const
+{
+	return atlasPages[index]->image;
 }
 
 int32_t bbe::Font::getLeftSideBearing(int32_t c) const
@@ -176,7 +296,7 @@ int32_t bbe::Font::getLeftSideBearing(int32_t c) const
 	}
 	else
 	{
-		return getCharData(c, 1.0f).leftSideBearing;
+		return getGlyph(c, 1.0f).leftSideBearing;
 	}
 }
 
@@ -189,19 +309,20 @@ int32_t bbe::Font::getAdvanceWidth(int32_t c) const
 	}
 	else
 	{
-		return getCharData(c, 1.0f).advanceWidth;
+		return getGlyph(c, 1.0f).advanceWidth;
 	}
 }
 
 int32_t bbe::Font::getVerticalOffset(int32_t c) const
 {
 	if (!isInit) bbe::Crash(bbe::Error::NotInitialized);
-	return getCharData(c, 1.0f).verticalOffset;
+	return getGlyph(c, 1.0f).verticalOffset;
 }
 
 bbe::Vector2i bbe::Font::getDimensions(int32_t c) const
 {
-	return getImage(c, 1.f).getDimensions();
+	const Glyph& glyph = getGlyph(c, 1.0f);
+	return bbe::Vector2i(glyph.width, glyph.height);
 }
 
 void bbe::Font::setFixedWidth(int32_t val)
@@ -214,13 +335,12 @@ int32_t bbe::Font::getFixedWidth() const
 	return fixedWidth;
 }
 
-bbe::List<bbe::Vector2> bbe::Font::getRenderPositions(const Vector2& p, const char* text, float rotation, bool verticalCorrection) const
+template<typename Allocator>
+static void fillRenderPositions(const bbe::Font& font, bbe::List<bbe::Vector2, Allocator>& retVal, const bbe::Vector2& p, const char* text, float rotation, bool verticalCorrection)
 {
-	bbe::List<bbe::Vector2> retVal;
-
 	const float lineStart = p.x;
 
-	Vector2 currentPosition = p;
+	bbe::Vector2 currentPosition = p;
 
 	const bbe::String string = text;
 	for (auto it = string.getIterator(); it.valid(); ++it)
@@ -230,29 +350,34 @@ bbe::List<bbe::Vector2> bbe::Font::getRenderPositions(const Vector2& p, const ch
 		{
 			retVal.add(currentPosition);
 			currentPosition.x = lineStart;
-			currentPosition.y += getPixelsFromLineToLine();
+			currentPosition.y += font.getPixelsFromLineToLine();
 		}
 		else if (codePoint == ' ')
 		{
 			retVal.add(currentPosition);
-			currentPosition.x += getLeftSideBearing(codePoint) + getAdvanceWidth(codePoint);
+			currentPosition.x += font.getLeftSideBearing(codePoint) + font.getAdvanceWidth(codePoint);
 		}
 		else
 		{
-			currentPosition.x += getLeftSideBearing(codePoint);
-			const bbe::Image& charImage = getImage(codePoint, 1.0f);
+			currentPosition.x += font.getLeftSideBearing(codePoint);
+			const bbe::Vector2 dimensions = font.getDimensions(codePoint).as<float>();
 			if (verticalCorrection)
 			{
-				retVal.add((bbe::Vector2(currentPosition.x, currentPosition.y + getVerticalOffset(codePoint)) + charImage.getDimensions().as<float>() / 2).rotate(rotation, p) - charImage.getDimensions().as<float>() / 2);
+				retVal.add((bbe::Vector2(currentPosition.x, currentPosition.y + font.getVerticalOffset(codePoint)) + dimensions / 2).rotate(rotation, p) - dimensions / 2);
 			}
 			else
 			{
 				retVal.add(currentPosition.rotate(rotation, p));
 			}
-			currentPosition.x += getAdvanceWidth(codePoint);
+			currentPosition.x += font.getAdvanceWidth(codePoint);
 		}
 	}
+}
 
+bbe::List<bbe::Vector2> bbe::Font::getRenderPositions(const Vector2& p, const char* text, float rotation, bool verticalCorrection) const
+{
+	bbe::List<bbe::Vector2> retVal;
+	fillRenderPositions(*this, retVal, p, text, rotation, verticalCorrection);
 	return retVal;
 }
 
@@ -265,7 +390,8 @@ bbe::Rectangle bbe::Font::getBoundingBox(const bbe::String& text) const
 {
 	if (text.isEmpty()) return bbe::Rectangle();
 
-	bbe::List<bbe::Vector2> renderPositions = getRenderPositions(bbe::Vector2(0, 0), text);
+	bbe::FrameList<bbe::Vector2> renderPositions;
+	fillRenderPositions(*this, renderPositions, bbe::Vector2(0, 0), text.getRaw(), 0, true);
 
 	bbe::Rectangle retVal = bbe::Rectangle(renderPositions[0], getDimensions(text.getCodepoint(0)).as<float>());
 	retVal.width = (float)getAdvanceWidth(text.getCodepoint(0));
@@ -0,0 +1,149 @@
+#include "BBE/FrameArena.h"
+#include "BBE/Math.h"
+
+static constexpr size_t FRAME_ARENA_ALIGNMENT = 16;
+static thread_local bbe::FrameArena* activeArena = nullptr;
+
+bbe::FrameArena::FrameArena(size_t initialCapacity)
+	: m_initialCapacity(bbe::Math::max<size_t>(initialCapacity, FRAME_ARENA_ALIGNMENT))
+{
+}
+
+bbe::FrameArena::~FrameArena()
+{
+	if (activeArena == this) activeArena = nullptr;
+	freeChunks();
+}
+
+void bbe::FrameArena::freeChunks()
+{
+	Chunk* chunk = m_pcurrentChunk.exchange(nullptr);
+	while (chunk)
+	{
+		Chunk* previous = chunk->previous;
+		bbe::freeBlock(chunk->block);
+		delete chunk;
+		chunk = previous;
+	}
+}
+
+bbe::AllocBlock bbe::FrameArena::allocate(size_t size)
+{
+	if (size == 0) return AllocBlock{ nullptr, 0 };
+	size = (size + FRAME_ARENA_ALIGNMENT - 1) & ~(FRAME_ARENA_ALIGNMENT - 1);
+
+	while (true)
+	{
+		Chunk* chunk = m_pcurrentChunk.load(std::memory_order_acquire);
+		if (chunk)
+		{
+			const size_t offset = chunk->used.fetch_add(size, std::memory_order_relaxed);
+			if (offset + size <= chunk->block.size)
+			{
+				return AllocBlock{ (char*)chunk->block.data + offset, size, this };
+			}
+		}
+
+		std::lock_guard lg(m_growMutex);
+		if (m_pcurrentChunk.load(std::memory_order_relaxed) != chunk) continue; // Someone else already added a chunk.
+
+		Chunk* newChunk = new Chunk();
+		newChunk->block = bbe::allocateBlock(bbe::Math::max(size, chunk ? chunk->block.size * 2 : m_initialCapacity));
+		newChunk->previous = chunk;
+		m_pcurrentChunk.store(newChunk, std::memory_order_release);
+	}
+}
+
+bool bbe::FrameArena::owns(const void* ptr) const
+{
+	for (const Chunk* chunk = m_pcurrentChunk.load(std::memory_order_acquire); chunk; chunk = chunk->previous)
+	{
+		const char* begin = (const char*)chunk->block.data;
+		if (ptr >= begin && ptr < begin + chunk->block.size) return true;
+	}
+	return false;
+}
+
+void bbe::FrameArena::reset()
+{
+	m_highWaterMark = bbe::Math::max(m_highWaterMark, getUsedBytes());
+
+	Chunk* chunk = m_pcurrentChunk.load();
+	if (!chunk) return;
+	if (chunk->previous)
+	{
+		// The frame didn't fit into a single chunk. Replace all chunks by one that is big enough for next time.
+		const size_t capacity = getCapacity();
+		freeChunks();
+		Chunk* merged = new Chunk();
+		merged->block = bbe::allocateBlock(capacity);
+		m_pcurrentChunk.store(merged);
+	}
+	else
+	{
+		chunk->used = 0;
+	}
+}
+
+size_t bbe::FrameArena::getUsedBytes() const
+{
+	size_t retVal = 0;
+	for (const Chunk* chunk = m_pcurrentChunk.load(std::memory_order_acquire); chunk; chunk = chunk->previous)
+	{
+		// Failed allocations push used past the end of a chunk.
+		retVal += bbe::Math::min(chunk->used.load(std::memory_order_relaxed), chunk->block.size);
+	}
+	return retVal;
+}
+
+size_t bbe::FrameArena::getCapacity() const
+{
+	size_t retVal = 0;
+	for (const Chunk* chunk = m_pcurrentChunk.load(std::memory_order_acquire); chunk; chunk = chunk->previous)
+	{
+		retVal += chunk->block.size;
+	}
+	return retVal;
+}
+
+size_t bbe::FrameArena::getAmountOfChunks() const
+{
+	size_t retVal = 0;
+	for (const Chunk* chunk = m_pcurrentChunk.load(std::memory_order_acquire); chunk; chunk = chunk->previous)
+	{
+		retVal++;
+	}
+	return retVal;
+}
+
+size_t bbe::FrameArena::getHighWaterMark() const
+{
+	return bbe::Math::max(m_highWaterMark, getUsedBytes());
+}
+
+bbe::FrameArena* bbe::FrameArena::getActive()
+{
+	return activeArena;
+}
+
+void bbe::FrameArena::setActive(FrameArena* arena)
+{
+	activeArena = arena;
+}
+
+bbe::AllocBlock bbe::FrameAllocator::allocateBlock(size_t size)
+{
+	FrameArena* arena = FrameArena::getActive();
+	if (arena) return arena->allocate(size);
+	return bbe::allocateBlock(size);
+}
+
+void bbe::FrameAllocator::freeBlock(AllocBlock& block)
+{
+	// Arena memory is given back as a whole at the end of the frame. The arena itself may already be gone.
+	if (block.owner == nullptr)
+	{
+		bbe::freeBlock(block);
+	}
+	block = {};
+}
@@ -0,0 +1,313 @@
+#include "BBE/FrameCapture.h"
+#include "BBE/Error.h"
+#include "BBE/Math.h"
+#include <algorithm>
+#include <stdexcept>
+
+bbe::FrameCapture::~FrameCapture()
+{
+	try
+	{
+		stop();
+	}
+	catch (...)
+	{
+		// Nobody is left to report the error to, everything else was written.
+	}
+}
+
+void bbe::FrameCapture::start(const bbe::String& path, const FrameCaptureSettings& settings)
+{
+	stop();
+	if (settings.maxFramesInFlight == 0) bbe::Crash(bbe::Error::IllegalArgument);
+
+	m_path = path;
+	m_settings = settings;
+	m_streamWidth = -1;
+	m_streamHeight = -1;
+	m_nextSequence = 0;
+	m_amountOfWrittenFrames = 0;
+	m_amountOfDroppedFrames = 0;
+	m_encoderException = nullptr;
+	if (m_settings.format != FrameCaptureFormat::PNG)
+	{
+		m_stream = fopen(path.getRaw(), "wb");
+		if (!m_stream)
+		{
+			throw std::runtime_error("Could not open file for frame capture");
+		}
+	}
+
+	size_t amountOfEncoders = m_settings.amountOfEncoderThreads;
+	if (amountOfEncoders == 0)
+	{
+		const size_t hardwareThreads = std::thread::hardware_concurrency();
+		amountOfEncoders = hardwareThreads > 2 ? hardwareThreads - 1 : 1;
+	}
+	// More encoders than frames in flight would only ever wait.
+	amountOfEncoders = bbe::Math::min(amountOfEncoders, m_settings.maxFramesInFlight);
+
+	m_running = true;
+	for (size_t i = 0; i < amountOfEncoders; i++)
+	{
+		m_encoders.add(std::thread(&FrameCapture::encoderMain, this));
+	}
+}
+
+void bbe::FrameCapture::stop()
+{
+	if (!isRunning()) return;
+	std::exception_ptr exception;
+	try
+	{
+		flush();
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+	}
+	{
+		std::unique_lock lock(m_mutex);
+		m_running = false;
+	}
+	m_workAvailable.notify_all();
+	for (size_t i = 0; i < m_encoders.getLength(); i++)
+	{
+		m_encoders[i].join();
+	}
+	m_encoders.clear();
+	if (m_stream)
+	{
+		// Whatever is still buffered is only written here, e.g. a full disk may only show up now.
+		if (fclose(m_stream) != 0 && !exception)
+		{
+			exception = std::make_exception_ptr(std::runtime_error("Could not finish writing the frame capture stream"));
+		}
+		m_stream = nullptr;
+	}
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+bool bbe::FrameCapture::isRunning() const
+{
+	std::unique_lock lock(m_mutex);
+	return m_running;
+}
+
+bool bbe::FrameCapture::submit(uint64_t frameNumber, bbe::Image&& image)
+{
+	std::unique_lock lock(m_mutex);
+	if (!m_running) bbe::Crash(bbe::Error::IllegalState);
+
+	if (m_inFlight.getLength() >= m_settings.maxFramesInFlight)
+	{
+		if (m_settings.backpressure == FrameCaptureBackpressure::DROP)
+		{
+			m_amountOfDroppedFrames++;
+			return false;
+		}
+		m_frameWritten.wait(lock, [&]() { return m_inFlight.getLength() < m_settings.maxFramesInFlight; });
+	}
+
+	if (m_streamWidth == -1)
+	{
+		m_streamWidth = image.getWidth();
+		m_streamHeight = image.getHeight();
+		if (m_settings.format == FrameCaptureFormat::Y4M)
+		{
+			// Nothing is in flight yet, so no encoder is writing to the stream.
+			const bbe::String header = bbe::String("YUV4MPEG2 W") + m_streamWidth + " H" + m_streamHeight + " F" + m_settings.framesPerSecond + ":1 Ip A1:1 C444 XCOLORRANGE=FULL\n";
+			if (fwrite(header.getRaw(), 1, header.getLength(), m_stream) != header.getLength() && !m_encoderException)
+			{
+				m_encoderException = std::make_exception_ptr(std::runtime_error("Could not write frame capture stream"));
+			}
+		}
+	}
+	else if (m_settings.format == FrameCaptureFormat::Y4M && (image.getWidth() != m_streamWidth || image.getHeight() != m_streamHeight))
+	{
+		// A y4m stream has a single resolution.
+		m_amountOfDroppedFrames++;
+		return false;
+	}
+
+	Frame* frame = new Frame();
+	frame->sequence = m_nextSequence++;
+	frame->frameNumber = frameNumber;
+	frame->image = std::move(image);
+	m_inFlight.add(frame);
+	m_pending.add(frame);
+	lock.unlock();
+	m_workAvailable.notify_one();
+	return true;
+}
+
+void bbe::FrameCapture::flush()
+{
+	std::unique_lock lock(m_mutex);
+	m_frameWritten.wait(lock, [&]() { return m_inFlight.getLength() == 0; });
+	if (m_encoderException)
+	{
+		std::exception_ptr exception = m_encoderException;
+		m_encoderException = nullptr;
+		std::rethrow_exception(exception);
+	}
+}
+
+void bbe::FrameCapture::encoderMain()
+{
+	std::unique_lock lock(m_mutex);
+	while (true)
+	{
+		m_workAvailable.wait(lock, [&]() { return !m_running || m_pending.getLength() > 0; });
+		if (m_pending.getLength() == 0)
+		{
+			// Only reachable once stop() flushed everything.
+			return;
+		}
+		Frame* frame = m_pending[0];
+		m_pending.removeIndex(0);
+
+		lock.unlock();
+		std::exception_ptr exception;
+		try
+		{
+			encode(*frame);
+		}
+		catch (...)
+		{
+			// Escaping the thread would terminate the process. flush() reports it instead.
+			exception = std::current_exception();
+		}
+		lock.lock();
+
+		if (exception)
+		{
+			if (!m_encoderException) m_encoderException = exception;
+			frame->failed = true;
+			frame->encoded.clear();
+		}
+		frame->isEncoded = true;
+		writeEncodedFrames(lock);
+	}
+}
+
+void bbe::FrameCapture::encode(Frame& frame) const
+{
+	const bbe::Image& image = frame.image;
+	const size_t width = (size_t)image.getWidth();
+	const size_t height = (size_t)image.getHeight();
+	if (m_settings.format == FrameCaptureFormat::PNG)
+	{
+		// Every frame is its own file, so they don't have to wait for each other.
+		if (!image.writeToFile(m_path + frame.frameNumber + ".png"))
+		{
+			throw std::runtime_error("Could not write frame capture image");
+		}
+		frame.image = bbe::Image();
+		return;
+	}
+
+	bbe::List<bbe::byte>& out = frame.encoded;
+	if (m_settings.format == FrameCaptureFormat::PPM)
+	{
+		const bbe::String header = bbe::String("P6\n") + width + " " + height + "\n255\n";
+		out.resizeCapacity(header.getLength() + width * height * 3);
+		for (size_t i = 0; i < header.getLength(); i++)
+		{
+			out.add((bbe::byte)header.getRaw()[i]);
+		}
+		for (size_t y = 0; y < height; y++)
+		{
+			for (size_t x = 0; x < width; x++)
+			{
+				const bbe::Colori pixel = image.getPixel(x, y);
+				out.add(pixel.r);
+				out.add(pixel.g);
+				out.add(pixel.b);
+			}
+		}
+	}
+	else
+	{
+		const char* header = "FRAME\n";
+		const size_t headerLength = strlen(header);
+		const size_t planeSize = width * height;
+		out.resizeCapacityAndLength(headerLength + planeSize * 3);
+		memcpy(out.getRaw(), header, headerLength);
+		bbe::byte* yPlane = out.getRaw() + headerLength;
+		bbe::byte* uPlane = yPlane + planeSize;
+		bbe::byte* vPlane = uPlane + planeSize;
+		for (size_t y = 0; y < height; y++)
+		{
+			for (size_t x = 0; x < width; x++)
+			{
+				const bbe::Colori pixel = image.getPixel(x, y);
+				const float r = pixel.r;
+				const float g = pixel.g;
+				const float b = pixel.b;
+				const size_t index = y * width + x;
+				yPlane[index] = (bbe::byte)bbe::Math::clamp(0.299f * r + 0.587f * g + 0.114f * b + 0.5f, 0.f, 255.f);
+				uPlane[index] = (bbe::byte)bbe::Math::clamp(128.f - 0.168736f * r - 0.331264f * g + 0.5f * b + 0.5f, 0.f, 255.f);
+				vPlane[index] = (bbe::byte)bbe::Math::clamp(128.f + 0.5f * r - 0.418688f * g - 0.081312f * b + 0.5f, 0.f, 255.f);
+			}
+		}
+	}
+	frame.image = bbe::Image();
+}
+
+void bbe::FrameCapture::writeEncodedFrames(std::unique_lock<std::mutex>& lock)
+{
+	// Only one thread writes at a time. Whoever finishes the oldest frame in flight writes it, together with every
+	// frame after it that is already encoded.
+	if (m_writing) return;
+	m_writing = true;
+	while (m_inFlight.getLength() > 0 && m_inFlight[0]->isEncoded)
+	{
+		Frame* frame = m_inFlight[0];
+		lock.unlock();
+		bool writeFailed = false;
+		if (m_stream)
+		{
+			writeFailed = fwrite(frame->encoded.getRaw(), 1, frame->encoded.getLength(), m_stream) != frame->encoded.getLength();
+		}
+		lock.lock();
+		if (writeFailed)
+		{
+			// E.g. a full disk or a closed pipe. Reported by flush like an exception of an encoder.
+			if (!m_encoderException) m_encoderException = std::make_exception_ptr(std::runtime_error("Could not write frame capture stream"));
+			frame->failed = true;
+		}
+		m_inFlight.removeIndex(0);
+		if (frame->failed) m_amountOfDroppedFrames++;
+		else               m_amountOfWrittenFrames++;
+		delete frame;
+		m_frameWritten.notify_all();
+	}
+	m_writing = false;
+}
+
+size_t bbe::FrameCapture::getAmountOfFramesInFlight() const
+{
+	std::unique_lock lock(m_mutex);
+	return m_inFlight.getLength();
+}
+
+uint64_t bbe::FrameCapture::getAmountOfWrittenFrames() const
+{
+	std::unique_lock lock(m_mutex);
+	return m_amountOfWrittenFrames;
+}
+
+uint64_t bbe::FrameCapture::getAmountOfDroppedFrames() const
+{
+	std::unique_lock lock(m_mutex);
+	return m_amountOfDroppedFrames;
+}
+
+const bbe::FrameCaptureSettings& bbe::FrameCapture::getSettings() const
+{
+	return m_settings;
+}
@@ -6,6 +6,8 @@
 #include "BBE/Math.h"
 #include "BBE/StopWatch.h"
 #include "BBE/SimpleFile.h"
+#include "BBE/JobSystem.h"
+#include "BBE/Profiler.h"
 #include <iostream>
 #include "implot.h"
 #include "BBE/ImGuiExtensions.h"
@@ -31,9 +33,14 @@
 void bbe::Game::mainLoop()
 {
 	m_frameNumber++;
+	const bool capturing = m_frameCapture.isRunning();
+	if (capturing)
+	{
+		m_pwindow->captureFrame(m_frameCapture, m_frameNumber);
+	}
 	frame(false);
 
-	if (screenshotRenderingPath)
+	if (screenshotRenderingPath && !capturing)
 	{
 		screenshot((bbe::String(screenshotRenderingPath) + m_frameNumber + ".png").getRaw());
 	}
@@ -53,13 +60,37 @@ void bbe::Game::restartSoundSystem()
 }
 #endif
 
-#ifdef BBE_RENDERER_OPENGL
+#if defined(BBE_RENDERER_OPENGL) || defined(BBE_RENDERER_NULL)
 uint32_t bbe::Game::getAmountOfDrawcalls() const
 {
 	return m_pwindow->getAmountOfDrawcalls();
 }
 #endif
 
+#ifdef BBE_RENDERER_OPENGL
+size_t bbe::Game::getAmountOfStreamedBytes() const
+{
+	return m_pwindow->getAmountOfStreamedBytes();
+}
+
+uint32_t bbe::Game::getAmountOfVisibleObjects3D() const
+{
+	return m_pwindow->getAmountOfVisibleObjects3D();
+}
+
+uint32_t bbe::Game::getAmountOfCulledObjects3D() const
+{
+	return m_pwindow->getAmountOfCulledObjects3D();
+}
+#endif
+
+#ifdef BBE_RENDERER_SOFTWARE
+bbe::Image bbe::Game::getFramebuffer()
+{
+	return m_pwindow->getFramebuffer();
+}
+#endif
+
 static void staticMainLoop(void* gamePtr)
 {
 	((bbe::Game*)gamePtr)->mainLoop();
@@ -237,6 +268,18 @@ void bbe::Game::innerStart(int windowWidth, int windowHeight, const char* title)
 	}
 	m_started = true;
 
+	if (!m_benchConfig.enabled)
+	{
+		m_benchConfig = bbe::bench::getEnvironmentConfig();
+	}
+	if (m_benchConfig.enabled)
+	{
+		BBELOGLN("Running as benchmark");
+		m_benchFrames.resizeCapacity(m_benchConfig.frames);
+		m_benchResult.name = title;
+	}
+	bbe::profiler::setThreadName("Main Thread");
+
 	BBELOGLN("Creating window");
 	m_pwindow = new Window(windowWidth, windowHeight, title, this);
 
@@ -251,9 +294,30 @@ void bbe::Game::innerStart(int windowWidth, int windowHeight, const char* title)
 	BBELOGLN("Calling onStart()");
 	onStart();
 
+	if (m_benchConfig.enabled)
+	{
+		// Set after onStart, so that games can't override them.
+		setFixedFrametime(m_benchConfig.fixedFrameTime);
+		setTargetFrametime(0);
+		setMaxFrame(m_benchConfig.warmupFrames + m_benchConfig.frames);
+	}
+
 	if (videoRenderingPath)
 	{
-		m_pwindow->setVideoRenderingMode(videoRenderingPath);
+		if (m_pwindow->isFrameCaptureSupported())
+		{
+			bbe::FrameCaptureSettings settings;
+			settings.format = bbe::FrameCaptureFormat::Y4M;
+			m_frameCapture.start(videoRenderingPath, settings);
+		}
+		else
+		{
+			m_pwindow->setVideoRenderingMode(videoRenderingPath);
+		}
+	}
+	else if (screenshotRenderingPath && m_pwindow->isFrameCaptureSupported())
+	{
+		m_frameCapture.start(screenshotRenderingPath, m_screenshotRecordingSettings);
 	}
 
 	if (!isExternallyManaged())
@@ -278,13 +342,11 @@ void bbe::Game::innerStart(int windowWidth, int windowHeight, const char* title)
 bool bbe::Game::keepAlive()
 {
 #ifdef BBE_RENDERER_NULL
-	// The null renderer keeps games alive for 128 frames and then closes them.
-	static int callCount = 0;
-	if (callCount >= 128)
+	// Unless told otherwise via setMaxFrame, the null renderer keeps games alive for 128 frames and then closes them.
+	if (m_maxFrameNumber == 0 && m_frameNumber >= 128)
 	{
 		return false;
 	}
-	callCount++;
 #endif
 	return m_pwindow->keepAlive();
 }
@@ -292,8 +354,19 @@ bool bbe::Game::keepAlive()
 void bbe::Game::frame(bool dragging)
 {
 	StopWatch sw;
+	m_currentFrameTimings = {};
+	FrameArena::setActive(&m_frameArena);
 	frameUpdate();
 	frameDraw(dragging);
+	FrameArena::setActive(nullptr);
+	m_frameArena.reset();
+	if (m_benchConfig.enabled && m_frameNumber > m_benchConfig.warmupFrames)
+	{
+		bbe::bench::FrameTimings& timings = m_currentFrameTimings;
+		timings.frame = sw.getTimeExpiredNanoseconds() / 1000.0 / 1000.0 / 1000.0;
+		timings.overhead = bbe::Math::max(0.0, timings.frame - timings.update - timings.draw3D - timings.draw2D);
+		m_benchFrames.add(timings);
+	}
 	if (m_targetFrameTime > 0)
 	{
 		std::this_thread::sleep_for(std::chrono::microseconds((int32_t)(m_targetFrameTime * 1000000.f) - sw.getTimeExpiredMicroseconds()));
@@ -324,7 +397,9 @@ void bbe::Game::frameUpdate()
 	m_soundManager.update();
 #endif
 	endMeasure();
+	StopWatch phase;
 	update(timeSinceLastFrame);
+	m_currentFrameTimings.update = phase.getTimeExpiredNanoseconds() / 1000.0 / 1000.0 / 1000.0;
 
 	beginMeasure("INTERNAL - MinuteMaxMove");
 	if (nextMinuteMaxMove.hasPassed())
@@ -355,11 +430,15 @@ void bbe::Game::frameDraw(bool dragging)
 	m_pwindow->preDraw();
 	m_pwindow->preDraw3D();
 	endMeasure();
+	StopWatch phase;
 	draw3D(m_pwindow->getBrush3D());
+	m_currentFrameTimings.draw3D = phase.getTimeExpiredNanoseconds() / 1000.0 / 1000.0 / 1000.0;
 	beginMeasure("INTERNAL - Pre Draw 2D");
 	m_pwindow->preDraw2D();
 	endMeasure();
+	phase.start();
 	draw2D(m_pwindow->getBrush2D());
+	m_currentFrameTimings.draw2D = phase.getTimeExpiredNanoseconds() / 1000.0 / 1000.0 / 1000.0;
 	beginMeasure("INTERNAL - Overhead (wait)");
 	m_pwindow->postDraw();
 	m_pwindow->waitEndDraw(dragging);
@@ -369,14 +448,28 @@ void bbe::Game::frameDraw(bool dragging)
 void bbe::Game::shutdown()
 {
 	m_pwindow->waitTillIdle();
+	m_pwindow->flushFrameCapture();
+	m_frameCapture.stop();
 
 	onEnd();
 
+	if (m_benchConfig.enabled)
+	{
+		m_benchResult = bbe::bench::computeResult(m_benchResult.name, m_benchConfig, m_benchFrames);
+		const bbe::String json = bbe::bench::toJson(m_benchResult);
+		BBELOGLN(json);
+		if (!m_benchConfig.outputPath.isEmpty())
+		{
+			bbe::simpleFile::writeStringToFile(m_benchConfig.outputPath, json);
+		}
+	}
+
 	m_pwindow->executeCloseListeners();
 
 #ifndef BBE_NO_AUDIO
 	m_soundManager.destroy();
 #endif
+	bbe::jobs::stopWorkers();
 	INTERNAL::allocCleanup();
 	bbe::simpleFile::backup::async::stopIoThread();
 #ifdef WIN32
@@ -630,18 +723,23 @@ void bbe::Game::setVideoRenderingMode(const char* path)
 	setFixedFrametime(1.f / 60.f);
 }
 
-void bbe::Game::setScreenshotRecordingMode(const char* path)
+void bbe::Game::setScreenshotRecordingMode(const char* path, const bbe::FrameCaptureSettings& settings)
 {
 	// If you want to make a movie out of these screenshots,
 	// you can use ffmpeg with the following command:
 	// 
 	// ffmpeg -framerate 60 -f image2 -i 'img%d.png' out.mp4
+	//
+	// With FrameCaptureFormat::Y4M, path is a single stream that ffmpeg reads directly:
+	//
+	// ffmpeg -i path out.mp4
 	if (m_started)
 	{
 		// Screenshot Recording must be enabled before start()!
 		bbe::Crash(bbe::Error::IllegalState);
 	}
 	screenshotRenderingPath = path;
+	m_screenshotRecordingSettings = settings;
 	setFixedFrametime(1.f / 60.f);
 }
 
@@ -655,6 +753,20 @@ void bbe::Game::setFixedFrametime(float time)
 	m_fixedFrameTime = time;
 }
 
+void bbe::Game::setBenchConfig(const bbe::bench::Config& config)
+{
+	if (m_started)
+	{
+		bbe::Crash(bbe::Error::AlreadyCreated);
+	}
+	m_benchConfig = config;
+}
+
+const bbe::bench::Result& bbe::Game::getBenchResult() const
+{
+	return m_benchResult;
+}
+
 void bbe::Game::setTargetFrametime(float time)
 {
 	m_targetFrameTime = time;
@@ -699,7 +811,8 @@ void bbe::Game::endMeasure()
 {
 	if (m_pcurrentPerformanceMeasurementTag)
 	{
-		auto passedTimeSeconds = m_performanceMeasurement.getTimeExpiredNanoseconds() / 1000.0 / 1000.0 / 1000.0;
+		const int64_t endNanos = bbe::profiler::getTimeNanos();
+		auto passedTimeSeconds = (endNanos - m_performanceMeasurementStartNanos) / 1000.0 / 1000.0 / 1000.0;
 		const bool firstMeasurement = !m_performanceMeasurements.count(m_pcurrentPerformanceMeasurementTag);
 		PerformanceMeasurement& pm = m_performanceMeasurements[m_pcurrentPerformanceMeasurementTag];
 		pm.now = passedTimeSeconds;
@@ -714,10 +827,7 @@ void bbe::Game::endMeasure()
 
 			pm.avg = 0.999 * pm.avg + 0.001 * passedTimeSeconds;
 		}
-		if (m_performanceMeasurementsRequired || m_performanceMeasurementsForced)
-		{
-			pm.perFrame.add(passedTimeSeconds);
-		}
+		bbe::profiler::recordZone(m_pcurrentPerformanceMeasurementTag, m_performanceMeasurementStartNanos, endNanos, m_performanceMeasurementForced);
 	}
 	m_pcurrentPerformanceMeasurementTag = nullptr;
 }
@@ -726,8 +836,8 @@ void bbe::Game::beginMeasure(const char* tag, bool force)
 {
 	endMeasure();
 	m_pcurrentPerformanceMeasurementTag = tag;
-	m_performanceMeasurement.start();
-	m_performanceMeasurementsForced = force;
+	m_performanceMeasurementStartNanos = bbe::profiler::getTimeNanos();
+	m_performanceMeasurementForced = force;
 }
 
 bbe::String bbe::Game::getMeasuresString()
@@ -781,6 +891,17 @@ void bbe::Game::drawMeasurement()
 		maxMinuteMax = bbe::Math::max(maxMinuteMax, it->second.minuteMax2);
 	}
 
+	bool profilerEnabled = bbe::profiler::isEnabled();
+	if (ImGui::Checkbox("Record Profiler", &profilerEnabled))
+	{
+		bbe::profiler::setEnabled(profilerEnabled);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Save Chrome Trace"))
+	{
+		bbe::profiler::writeChromeTrace("bbeTrace.json");
+	}
+
 	bbe::String header = bbe::String(" ") * maxLen;
 	header += "  MAX      AVG      NOW      MINUTEMAX\n";
 	ImGui::Text(header);
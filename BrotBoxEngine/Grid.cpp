@@ -0,0 +1,68 @@
+#include "BBE/Grid.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BBE_GRID_SSE
+#include <emmintrin.h>
+#endif
+
+void bbe::INTERNAL::applyStencilBlock(const float* in, float* out, const GridStencil<float>& stencil)
+{
+#ifdef BBE_GRID_SSE
+	__m128 weights[3][3];
+	for (size_t dx = 0; dx < 3; dx++)
+	{
+		for (size_t dy = 0; dy < 3; dy++)
+		{
+			weights[dx][dy] = _mm_set1_ps(stencil.weights[dx][dy]);
+		}
+	}
+	for (size_t y = 0; y < stencilBlockSize; y++)
+	{
+		for (size_t x = 0; x < stencilBlockSize; x += 4)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (size_t dy = 0; dy < 3; dy++)
+			{
+				const float* row = in + (y + dy) * stencilBlockStride + x;
+				sum = _mm_add_ps(sum, _mm_mul_ps(weights[0][dy], _mm_loadu_ps(row + 0)));
+				sum = _mm_add_ps(sum, _mm_mul_ps(weights[1][dy], _mm_loadu_ps(row + 1)));
+				sum = _mm_add_ps(sum, _mm_mul_ps(weights[2][dy], _mm_loadu_ps(row + 2)));
+			}
+			_mm_storeu_ps(out + y * stencilBlockSize + x, sum);
+		}
+	}
+#else
+	applyStencilBlock<float>(in, out, stencil);
+#endif
+}
+
+void bbe::INTERNAL::applyStencilBlock(const double* in, double* out, const GridStencil<double>& stencil)
+{
+#ifdef BBE_GRID_SSE
+	__m128d weights[3][3];
+	for (size_t dx = 0; dx < 3; dx++)
+	{
+		for (size_t dy = 0; dy < 3; dy++)
+		{
+			weights[dx][dy] = _mm_set1_pd(stencil.weights[dx][dy]);
+		}
+	}
+	for (size_t y = 0; y < stencilBlockSize; y++)
+	{
+		for (size_t x = 0; x < stencilBlockSize; x += 2)
+		{
+			__m128d sum = _mm_setzero_pd();
+			for (size_t dy = 0; dy < 3; dy++)
+			{
+				const double* row = in + (y + dy) * stencilBlockStride + x;
+				sum = _mm_add_pd(sum, _mm_mul_pd(weights[0][dy], _mm_loadu_pd(row + 0)));
+				sum = _mm_add_pd(sum, _mm_mul_pd(weights[1][dy], _mm_loadu_pd(row + 1)));
+				sum = _mm_add_pd(sum, _mm_mul_pd(weights[2][dy], _mm_loadu_pd(row + 2)));
+			}
+			_mm_storeu_pd(out + y * stencilBlockSize + x, sum);
+		}
+	}
+#else
+	applyStencilBlock<double>(in, out, stencil);
+#endif
+}
@@ -70,3 +70,108 @@ const bbe::Matrix4& bbe::IcoSphere::getTransform() const
 {
 	return m_transform;
 }
+
+static uint32_t getHalfPointIndex(bbe::List<bbe::Vector3>& vertices, const bbe::Vector3& a, const bbe::Vector3& b)
+{
+	bbe::Vector3 halfPoint = (a + b).normalize() / 2;
+	for (uint32_t i = 0; i < vertices.getLength(); i++)
+	{
+		if (halfPoint == vertices[i])
+		{
+			return i;
+		}
+	}
+
+	vertices.add(halfPoint);
+	return static_cast<uint32_t>(vertices.getLength() - 1);
+}
+
+static void createSphere(bbe::List<bbe::Vector3>& positions, bbe::List<uint32_t>& indices)
+{
+	const float x = (1 + bbe::Math::sqrt(5)) / 4;
+	positions = {
+		bbe::Vector3(-0.5,  x,  0).normalize() / 2,
+		bbe::Vector3( 0.5,  x,  0).normalize() / 2,
+		bbe::Vector3(-0.5, -x,  0).normalize() / 2,
+		bbe::Vector3( 0.5, -x,  0).normalize() / 2,
+
+		bbe::Vector3(0, -0.5,  x).normalize() / 2,
+		bbe::Vector3(0,  0.5,  x).normalize() / 2,
+		bbe::Vector3(0, -0.5, -x).normalize() / 2,
+		bbe::Vector3(0,  0.5, -x).normalize() / 2,
+
+		bbe::Vector3( x, 0, -0.5).normalize() / 2,
+		bbe::Vector3( x, 0,  0.5).normalize() / 2,
+		bbe::Vector3(-x, 0, -0.5).normalize() / 2,
+		bbe::Vector3(-x, 0,  0.5).normalize() / 2,
+	};
+	indices = {
+		5,  11, 0,
+		1,  5,  0,
+		7,  1,  0,
+		10, 7,  0,
+		11, 10, 0,
+
+		9, 5,  1,
+		4, 11, 5,
+		2, 10, 11,
+		6, 7,  10,
+		8, 1,  7,
+
+		4, 9, 3,
+		2, 4, 3,
+		6, 2, 3,
+		8, 6, 3,
+		9, 8, 3,
+
+		5,  9, 4,
+		11, 4, 2,
+		10, 2, 6,
+		7,  6, 8,
+		1,  8, 9,
+	};
+
+	constexpr int iterations = 2;
+	for (int i = 0; i < iterations; i++)
+	{
+		bbe::List<uint32_t> newIndices;
+
+		for (size_t k = 0; k < indices.getLength(); k += 3)
+		{
+			uint32_t a = getHalfPointIndex(positions, positions[indices[k + 0]], positions[indices[k + 1]]);
+			uint32_t b = getHalfPointIndex(positions, positions[indices[k + 1]], positions[indices[k + 2]]);
+			uint32_t c = getHalfPointIndex(positions, positions[indices[k + 2]], positions[indices[k + 0]]);
+
+			newIndices.addAll(
+				c, a, indices[k + 0],
+				a, b, indices[k + 1],
+				b, c, indices[k + 2],
+				c, b, a
+			);
+		}
+
+		indices = std::move(newIndices);
+	}
+}
+
+bbe::List<bbe::PosNormalPair> bbe::IcoSphere::getRenderVerticesDefault()
+{
+	bbe::List<bbe::Vector3> positions;
+	bbe::List<uint32_t> indices;
+	createSphere(positions, indices);
+
+	bbe::List<bbe::PosNormalPair> retVal;
+	for (const bbe::Vector3& pos : positions)
+	{
+		retVal.add(bbe::PosNormalPair{ pos, pos });
+	}
+	return retVal;
+}
+
+bbe::List<uint32_t> bbe::IcoSphere::getRenderIndicesDefault()
+{
+	bbe::List<bbe::Vector3> positions;
+	bbe::List<uint32_t> indices;
+	createSphere(positions, indices);
+	return indices;
+}
@@ -1,6 +1,8 @@
 #include "BBE/Image.h"
 #include "BBE/Error.h"
 #include "BBE/Math.h"
+#include "BBE/MappedFile.h"
+#include <stdexcept>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -76,12 +78,24 @@ void bbe::Image::loadRaw(const unsigned char* rawData, size_t dataLength)
 	finishLoad(pixels);
 }
 
+void bbe::Image::loadRaw(const bbe::MappedFile& file)
+{
+	loadRaw(file.getRaw(), file.getLength());
+}
+
 void bbe::Image::load(const char * path)
 {
-	m_prendererData = nullptr;
-	int texChannels = 0;
-	stbi_uc *pixels = stbi_load(path, &m_width, &m_height, &texChannels, STBI_rgb_alpha);
-	finishLoad(pixels);
+	bbe::MappedFile file;
+	try
+	{
+		file.open(path);
+	}
+	catch (const std::runtime_error&)
+	{
+		// Same as when stbi couldn't read the file itself.
+		bbe::Crash(bbe::Error::IllegalState);
+	}
+	loadRaw(file);
 }
 
 void bbe::Image::load(const bbe::String& path)
@@ -239,6 +253,71 @@ void bbe::Image::setPixel(size_t x, size_t y, const bbe::Colori& c)
 	m_prendererData = nullptr;
 }
 
+void bbe::Image::setPixels(const bbe::Vector2i& pos, int width, int height, const void* data)
+{
+	if (!isLoadedCpu())
+	{
+		bbe::Crash(bbe::Error::NotInitialized);
+	}
+	if (pos.x < 0 || pos.y < 0 || width < 0 || height < 0 || pos.x + width > m_width || pos.y + height > m_height)
+	{
+		bbe::Crash(bbe::Error::IllegalArgument);
+	}
+
+	// getIndexForRawAccess counts channels, not bytes.
+	const size_t rowSize = width * getBytesPerPixel();
+	const byte* src = static_cast<const byte*>(data);
+	for (int i = 0; i < height; i++)
+	{
+		memcpy(m_pdata.getRaw() + getIndexForRawAccess(pos.x, pos.y + i) * getBytesPerChannel(), src + i * rowSize, rowSize);
+	}
+
+	if (m_prendererData != nullptr && width > 0 && height > 0)
+	{
+		const bbe::Vector2i max(pos.x + width, pos.y + height);
+		if (hasDirtyRegion())
+		{
+			m_dirtyMin = bbe::Vector2i(bbe::Math::min(m_dirtyMin.x, pos.x), bbe::Math::min(m_dirtyMin.y, pos.y));
+			m_dirtyMax = bbe::Vector2i(bbe::Math::max(m_dirtyMax.x, max.x), bbe::Math::max(m_dirtyMax.y, max.y));
+		}
+		else
+		{
+			m_dirtyMin = pos;
+			m_dirtyMax = max;
+		}
+	}
+}
+
+void bbe::Image::getPixels(const bbe::Vector2i& pos, int width, int height, void* outData) const
+{
+	if (!isLoadedCpu())
+	{
+		bbe::Crash(bbe::Error::NotInitialized);
+	}
+	if (pos.x < 0 || pos.y < 0 || width < 0 || height < 0 || pos.x + width > m_width || pos.y + height > m_height)
+	{
+		bbe::Crash(bbe::Error::IllegalArgument);
+	}
+
+	const size_t rowSize = width * getBytesPerPixel();
+	byte* dst = static_cast<byte*>(outData);
+	for (int i = 0; i < height; i++)
+	{
+		memcpy(dst + i * rowSize, m_pdata.getRaw() + getIndexForRawAccess(pos.x, pos.y + i) * getBytesPerChannel(), rowSize);
+	}
+}
+
+bool bbe::Image::hasDirtyRegion() const
+{
+	return m_dirtyMax.x > m_dirtyMin.x && m_dirtyMax.y > m_dirtyMin.y;
+}
+
+void bbe::Image::clearDirtyRegion() const
+{
+	m_dirtyMin = bbe::Vector2i();
+	m_dirtyMax = bbe::Vector2i();
+}
+
 size_t bbe::Image::getIndexForRawAccess(size_t x, size_t y) const
 {
 	return (y * m_width + x) * getAmountOfChannels();
@@ -467,24 +546,24 @@ HICON bbe::Image::toIcon() const
 }
 #endif
 
-void bbe::Image::writeToFile(const char* path) const
+bool bbe::Image::writeToFile(const char* path) const
 {
 	const bbe::String lowerPath = bbe::String(path).toLowerCase();
 	if (lowerPath.endsWith(".png"))
 	{
-		stbi_write_png(path, m_width, m_height, (int)getAmountOfChannels(), m_pdata.getRaw(), 0);
+		return stbi_write_png(path, m_width, m_height, (int)getAmountOfChannels(), m_pdata.getRaw(), 0) != 0;
 	}
 	else if (lowerPath.endsWith(".bmp"))
 	{
-		stbi_write_bmp(path, m_width, m_height, (int)getAmountOfChannels(), m_pdata.getRaw());
+		return stbi_write_bmp(path, m_width, m_height, (int)getAmountOfChannels(), m_pdata.getRaw()) != 0;
 	}
 	else if (lowerPath.endsWith(".tga"))
 	{
-		stbi_write_tga(path, m_width, m_height, (int)getAmountOfChannels(), m_pdata.getRaw());
+		return stbi_write_tga(path, m_width, m_height, (int)getAmountOfChannels(), m_pdata.getRaw()) != 0;
 	}
 	else if (lowerPath.endsWith(".jpg"))
 	{
-		stbi_write_jpg(path, m_width, m_height, (int)getAmountOfChannels(), m_pdata.getRaw(), 90);
+		return stbi_write_jpg(path, m_width, m_height, (int)getAmountOfChannels(), m_pdata.getRaw(), 90) != 0;
 	}
 	else
 	{
@@ -492,9 +571,9 @@ void bbe::Image::writeToFile(const char* path) const
 	}
 }
 
-void bbe::Image::writeToFile(const bbe::String& path) const
+bool bbe::Image::writeToFile(const bbe::String& path) const
 {
-	writeToFile(path.getRaw());
+	return writeToFile(path.getRaw());
 }
 
 static void floodFillStep(bbe::Image& image, bbe::List<bbe::Vector2i>& posToCheck, bbe::Vector2i /*copy*/ pos, const bbe::Colori& from, const bbe::Colori& to, bool tiled)
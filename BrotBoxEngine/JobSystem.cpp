@@ -0,0 +1,373 @@
+#include "BBE/JobSystem.h"
+#include "BBE/Error.h"
+#include "BBE/String.h"
+#include "BBE/Math.h"
+#include "BBE/Profiler.h"
+#include "BBE/FrameArena.h"
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <vector>
+
+using JobPtr = std::shared_ptr<bbe::INTERNAL::Job>;
+
+struct WorkQueue
+{
+	std::mutex mutex;
+	std::deque<JobPtr> jobs;
+};
+
+// Every worker owns one queue. The additional last queue receives jobs scheduled by threads that are not workers
+// (e.g. the main thread). Workers pop the newest job of their own queue and steal the oldest jobs of other queues.
+static std::vector<std::unique_ptr<WorkQueue>> queues;
+static std::vector<std::thread> workers;
+static std::mutex startStopMutex;
+static std::atomic_bool workersRunning = false;
+static std::atomic<int64_t> queuedJobs = 0;
+static std::mutex sleepMutex;
+static std::condition_variable sleepCondition;
+static thread_local size_t currentWorkerIndex = (size_t)-1;
+
+static bool isWorkerThread()
+{
+	return currentWorkerIndex != (size_t)-1;
+}
+
+static void pushJob(JobPtr&& job)
+{
+	const size_t index = isWorkerThread() ? currentWorkerIndex : queues.size() - 1;
+	{
+		std::lock_guard lg(queues[index]->mutex);
+		queues[index]->jobs.push_back(std::move(job));
+	}
+	{
+		// Taking the lock makes sure that a worker can't miss the notification between checking the
+		// predicate and going to sleep.
+		std::lock_guard lg(sleepMutex);
+		queuedJobs++;
+	}
+	sleepCondition.notify_one();
+}
+
+static JobPtr popFront(WorkQueue& queue)
+{
+	std::lock_guard lg(queue.mutex);
+	if (queue.jobs.empty()) return nullptr;
+	JobPtr retVal = std::move(queue.jobs.front());
+	queue.jobs.pop_front();
+	return retVal;
+}
+
+static JobPtr tryPopJob()
+{
+	if (queuedJobs.load() <= 0) return nullptr;
+
+	const size_t amountOfQueues = queues.size();
+	size_t startIndex = amountOfQueues - 1;
+	if (isWorkerThread())
+	{
+		WorkQueue& own = *queues[currentWorkerIndex];
+		std::unique_lock lock(own.mutex);
+		if (!own.jobs.empty())
+		{
+			JobPtr retVal = std::move(own.jobs.back());
+			own.jobs.pop_back();
+			lock.unlock();
+			queuedJobs--;
+			return retVal;
+		}
+		startIndex = currentWorkerIndex + 1;
+	}
+
+	for (size_t i = 0; i < amountOfQueues; i++)
+	{
+		const size_t index = (startIndex + i) % amountOfQueues;
+		if (index == currentWorkerIndex) continue;
+		JobPtr retVal = popFront(*queues[index]);
+		if (retVal)
+		{
+			queuedJobs--;
+			return retVal;
+		}
+	}
+	return nullptr;
+}
+
+// A thread that helps out while waiting must not lend its frame arena to unrelated jobs.
+struct ActiveArenaGuard
+{
+	bbe::FrameArena* previousArena = bbe::FrameArena::getActive();
+
+	ActiveArenaGuard()
+	{
+		bbe::FrameArena::setActive(nullptr);
+	}
+
+	~ActiveArenaGuard()
+	{
+		bbe::FrameArena::setActive(previousArena);
+	}
+};
+
+static void executeJob(JobPtr& job)
+{
+	{
+		BBE_PROFILE_ZONE("Job");
+		ActiveArenaGuard arenaGuard;
+		try
+		{
+			job->func();
+		}
+		catch (...)
+		{
+			// Handed to whoever waits, the job still counts as done so that waiting and continuations go on.
+			job->exception = std::current_exception();
+		}
+	}
+	job->func = nullptr;
+
+	bbe::List<JobPtr> continuations;
+	{
+		std::lock_guard lg(job->continuationsMutex);
+		job->done = true;
+		continuations = std::move(job->continuations);
+	}
+	for (size_t i = 0; i < continuations.getLength(); i++)
+	{
+		if (--continuations[i]->pendingDependencies == 0)
+		{
+			pushJob(std::move(continuations[i]));
+		}
+	}
+}
+
+static void innerWorkerMain(size_t index)
+{
+	currentWorkerIndex = index;
+	bbe::profiler::setThreadName("Job Worker");
+	while (true)
+	{
+		JobPtr job = tryPopJob();
+		if (job)
+		{
+			executeJob(job);
+			continue;
+		}
+
+		std::unique_lock lock(sleepMutex);
+		sleepCondition.wait(lock, [] {
+			return queuedJobs.load() > 0 || !workersRunning;
+			});
+		if (!workersRunning && queuedJobs.load() <= 0) break;
+	}
+}
+
+static void workerMain(size_t index)
+{
+	BBE_TRY_RELEASE
+	{
+		innerWorkerMain(index);
+	}
+	BBE_CATCH_RELEASE(Job Worker)
+}
+
+static void startWorkers()
+{
+	if (workersRunning) return;
+	std::lock_guard lg(startStopMutex);
+	if (workersRunning) return;
+
+#ifdef __EMSCRIPTEN__
+	// Same reasoning as in bbe::async: Jobs are executed by whoever waits for them.
+	const size_t amountOfWorkers = 0;
+#else
+	// The thread that waits for jobs helps executing them, so one core is left for it.
+	const size_t hardwareThreads = std::thread::hardware_concurrency();
+	const size_t amountOfWorkers = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+#endif
+	queues.clear();
+	for (size_t i = 0; i < amountOfWorkers + 1; i++)
+	{
+		queues.push_back(std::make_unique<WorkQueue>());
+	}
+	workersRunning = true;
+	for (size_t i = 0; i < amountOfWorkers; i++)
+	{
+		workers.emplace_back(workerMain, i);
+	}
+}
+
+// Games stop the workers in Game::shutdown. This is a safety net for everyone else (e.g. tests), as destroying
+// joinable std::threads terminates the process.
+struct WorkerStopper
+{
+	~WorkerStopper()
+	{
+		bbe::jobs::stopWorkers();
+	}
+};
+static WorkerStopper workerStopper;
+
+bbe::JobHandle::JobHandle(std::shared_ptr<INTERNAL::Job> job)
+	: m_job(std::move(job))
+{
+}
+
+const std::shared_ptr<bbe::INTERNAL::Job>& bbe::JobHandle::INTERNAL_getJob() const
+{
+	return m_job;
+}
+
+bool bbe::JobHandle::isValid() const
+{
+	return m_job != nullptr;
+}
+
+bool bbe::JobHandle::isDone() const
+{
+	if (!m_job) return true;
+	return m_job->done;
+}
+
+void bbe::JobHandle::wait() const
+{
+	while (!isDone())
+	{
+		JobPtr job = tryPopJob();
+		if (job)
+		{
+			executeJob(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	if (m_job && m_job->exception)
+	{
+		std::rethrow_exception(m_job->exception);
+	}
+}
+
+size_t bbe::jobs::getAmountOfWorkers()
+{
+	startWorkers();
+	return workers.size();
+}
+
+void bbe::jobs::stopWorkers()
+{
+	std::lock_guard lg(startStopMutex);
+	{
+		std::lock_guard sleepLock(sleepMutex);
+		workersRunning = false;
+	}
+	sleepCondition.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	workers.clear();
+
+	// Nobody is left to execute jobs that were scheduled from outside of the workers and never waited for.
+	if (!queues.empty())
+	{
+		while (JobPtr job = popFront(*queues.back()))
+		{
+			queuedJobs--;
+			executeJob(job);
+		}
+	}
+	queues.clear();
+}
+
+bbe::JobHandle bbe::jobs::schedule(std::function<void()>&& func)
+{
+	return schedule(std::move(func), bbe::List<JobHandle>());
+}
+
+bbe::JobHandle bbe::jobs::schedule(std::function<void()>&& func, const JobHandle& dependency)
+{
+	return schedule(std::move(func), bbe::List<JobHandle>{ dependency });
+}
+
+bbe::JobHandle bbe::jobs::schedule(std::function<void()>&& func, const bbe::List<JobHandle>& dependencies)
+{
+	startWorkers();
+
+	JobPtr job = std::make_shared<INTERNAL::Job>();
+	job->func = std::move(func);
+
+	for (size_t i = 0; i < dependencies.getLength(); i++)
+	{
+		const JobPtr& dependency = dependencies[i].INTERNAL_getJob();
+		if (!dependency) continue;
+
+		std::lock_guard lg(dependency->continuationsMutex);
+		if (!dependency->done)
+		{
+			job->pendingDependencies++;
+			dependency->continuations.add(job);
+		}
+	}
+
+	JobHandle retVal(job);
+	if (--job->pendingDependencies == 0)
+	{
+		pushJob(std::move(job));
+	}
+	return retVal;
+}
+
+void bbe::jobs::waitAll(const bbe::List<JobHandle>& handles)
+{
+	// Jobs of parallelFor reference its stack, so returning early would leave them dangling.
+	std::exception_ptr firstException;
+	for (size_t i = 0; i < handles.getLength(); i++)
+	{
+		try
+		{
+			handles[i].wait();
+		}
+		catch (...)
+		{
+			if (!firstException) firstException = std::current_exception();
+		}
+	}
+	if (firstException)
+	{
+		std::rethrow_exception(firstException);
+	}
+}
+
+void bbe::jobs::parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& func)
+{
+	if (begin >= end) return;
+
+	const size_t length = end - begin;
+	if (grain == 0)
+	{
+		grain = bbe::Math::max<size_t>(1, length / ((getAmountOfWorkers() + 1) * 4));
+	}
+	if (length <= grain)
+	{
+		func(begin, end);
+		return;
+	}
+
+	bbe::FrameArena* arena = bbe::FrameArena::getActive();
+	bbe::List<JobHandle> handles;
+	handles.resizeCapacity((length + grain - 1) / grain);
+	size_t chunkBegin = begin;
+	while (chunkBegin < end)
+	{
+		const size_t chunkEnd = chunkBegin + bbe::Math::min(grain, end - chunkBegin);
+		handles.add(schedule([&func, arena, chunkBegin, chunkEnd]()
+			{
+				bbe::FrameArena::setActive(arena);
+				func(chunkBegin, chunkEnd);
+			}));
+		chunkBegin = chunkEnd;
+	}
+	waitAll(handles);
+}
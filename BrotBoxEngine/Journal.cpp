@@ -0,0 +1,90 @@
+#include "BBE/Journal.h"
+#include <array>
+#include <cstring>
+
+static constexpr bbe::byte magic[bbe::INTERNAL::journal::headerSize] = { 'B', 'B', 'E', 'J', 'R', 'N', 'L', '1' };
+
+static constexpr std::array<uint32_t, 256> crcTable = []()
+	{
+		std::array<uint32_t, 256> table = {};
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++)
+			{
+				c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+			}
+			table[i] = c;
+		}
+		return table;
+	}();
+
+uint32_t bbe::INTERNAL::journal::crc32(const bbe::byte* data, size_t length, uint32_t crc)
+{
+	crc = ~crc;
+	for (size_t i = 0; i < length; i++)
+	{
+		crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+bool bbe::INTERNAL::journal::hasHeader(const bbe::ByteBufferSpan& file)
+{
+	return file.getLength() >= headerSize && memcmp(file.getRaw(), magic, headerSize) == 0;
+}
+
+void bbe::INTERNAL::journal::writeHeader(bbe::ByteBuffer& out)
+{
+	for (size_t i = 0; i < headerSize; i++)
+	{
+		uint8_t b = magic[i];
+		out.write(b);
+	}
+}
+
+void bbe::INTERNAL::journal::writeRecord(bbe::ByteBuffer& out, RecordType type, uint64_t a, uint64_t b, const bbe::byte* payload, size_t payloadLength)
+{
+	const size_t start = out.getLength();
+	uint8_t t = (uint8_t)type;
+	uint64_t length = payloadLength;
+	out.write(t);
+	out.write(a);
+	out.write(b);
+	out.write(length);
+	for (size_t i = 0; i < payloadLength; i++)
+	{
+		uint8_t p = payload[i];
+		out.write(p);
+	}
+	uint32_t crc = crc32(out.getRaw() + start, out.getLength() - start);
+	out.write(crc);
+}
+
+size_t bbe::INTERNAL::journal::readRecords(const bbe::ByteBufferSpan& file, bbe::List<Record>& outRecords)
+{
+	if (!hasHeader(file)) return 0;
+
+	const size_t fileLength = file.getLength();
+	bbe::ByteBufferSpan span = file;
+	span.skipBytes(headerSize);
+	size_t validEnd = headerSize;
+	while (span.getLength() >= recordOverhead)
+	{
+		const size_t start = fileLength - span.getLength();
+		Record record;
+		record.type = (RecordType)span.readU8();
+		record.a = span.readU64();
+		record.b = span.readU64();
+		const uint64_t payloadLength = span.readU64();
+		if (payloadLength > span.getLength() - sizeof(uint32_t)) break;
+		record.payload = span.readSpan(payloadLength);
+		const uint32_t crc = span.readU32();
+		if (crc != crc32(file.getRaw() + start, recordOverhead - sizeof(uint32_t) + payloadLength)) break;
+		if (record.type < RecordType::ADD || record.type > RecordType::SWAP) break;
+
+		outRecords.add(record);
+		validEnd = fileLength - span.getLength();
+	}
+	return validEnd;
+}
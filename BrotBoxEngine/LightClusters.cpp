@@ -0,0 +1,205 @@
+#include "BBE/LightClusters.h"
+#include "BBE/Math.h"
+#include "BBE/Error.h"
+#include "BBE/Vector4.h"
+#include <cmath>
+
+bbe::LightClusters::LightClusters(uint32_t tilesX, uint32_t tilesY, uint32_t slices)
+	: m_tilesX(tilesX), m_tilesY(tilesY), m_slices(slices)
+{
+	if (tilesX == 0 || tilesY == 0 || slices == 0)
+	{
+		bbe::Crash(bbe::Error::IllegalArgument);
+	}
+	m_clusters.resizeCapacityAndLength(tilesX * tilesY * slices);
+}
+
+uint32_t bbe::LightClusters::getTile(float ndc, uint32_t amountOfTiles) const
+{
+	const float tile = bbe::Math::floor((ndc * 0.5f + 0.5f) * (float)amountOfTiles);
+	if (tile <= 0) return 0;
+	if (tile >= (float)(amountOfTiles - 1)) return amountOfTiles - 1;
+	return (uint32_t)tile;
+}
+
+uint32_t bbe::LightClusters::getSlice(float depth) const
+{
+	if (depth <= m_nearPlane) return 0;
+	const float slice = bbe::Math::floor(std::log(depth / m_nearPlane) * m_sliceScale);
+	if (slice <= 0) return 0;
+	if (slice >= (float)(m_slices - 1)) return m_slices - 1;
+	return (uint32_t)slice;
+}
+
+bool bbe::LightClusters::getTileRange(const bbe::Vector3& center, float radius, uint32_t slice, TileRange& range) const
+{
+	// Only the part of the light's bounding box that lies within the depth range of the slice matters. It's in
+	// front of the camera, so the projection of its corners bounds the projection of the light sphere there. The
+	// range is widened a little so that rounding differences of the per pixel slice lookup don't matter.
+	const float sliceStart = m_nearPlane * std::exp((float)slice / m_sliceScale) * 0.99f;
+	const float sliceEnd = m_nearPlane * std::exp((float)(slice + 1) / m_sliceScale) * 1.01f;
+	const float depth = -center.z;
+	const float minDepth = bbe::Math::max(bbe::Math::max(depth - radius, sliceStart), m_nearPlane);
+	const float maxDepth = bbe::Math::min(depth + radius, sliceEnd);
+	if (minDepth > maxDepth) return false;
+
+	float minX = 1e30f;
+	float maxX = -1e30f;
+	float minY = 1e30f;
+	float maxY = -1e30f;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		const bbe::Vector4 cornerPos(
+			center.x + ((corner & 1) ? radius : -radius),
+			center.y + ((corner & 2) ? radius : -radius),
+			(corner & 4) ? -minDepth : -maxDepth,
+			1.f);
+		const bbe::Vector4 clip = m_projection * cornerPos;
+		const float x = clip.x / clip.w;
+		const float y = clip.y / clip.w;
+		minX = bbe::Math::min(minX, x);
+		maxX = bbe::Math::max(maxX, x);
+		minY = bbe::Math::min(minY, y);
+		maxY = bbe::Math::max(maxY, y);
+	}
+	if (maxX < -1.f || minX > 1.f || maxY < -1.f || minY > 1.f) return false;
+
+	range.minX = getTile(minX, m_tilesX);
+	range.maxX = getTile(maxX, m_tilesX);
+	range.minY = getTile(minY, m_tilesY);
+	range.maxY = getTile(maxY, m_tilesY);
+	return true;
+}
+
+void bbe::LightClusters::build(const bbe::List<bbe::PointLight>& lights, const bbe::Matrix4& view, const bbe::Matrix4& projection)
+{
+	m_projection = projection;
+	const float p22 = projection.get(2, 2);
+	const float p23 = projection.get(2, 3);
+	m_nearPlane = p23 / (p22 - 1.f);
+	m_farPlane = p23 / (p22 + 1.f);
+	m_sliceScale = (float)m_slices / std::log(m_farPlane / m_nearPlane);
+
+	m_viewSpacePositions.clear();
+	m_radii.clear();
+	for (size_t i = 0; i < m_clusters.getLength(); i++)
+	{
+		m_clusters[i] = Cluster();
+	}
+
+	// First pass: Count the lights per cluster.
+	for (size_t i = 0; i < lights.getLength(); i++)
+	{
+		const bbe::Vector4 viewPos = view * bbe::Vector4(lights[i].pos, 1.f);
+		const bbe::Vector3 center(viewPos.x, viewPos.y, viewPos.z);
+		const float radius = lights[i].getLightRadius();
+		m_viewSpacePositions.add(center);
+		m_radii.add(radius);
+
+		const float depth = -center.z;
+		if (depth + radius < m_nearPlane || depth - radius > m_farPlane) continue;
+		const uint32_t maxSlice = getSlice(bbe::Math::min(depth + radius, m_farPlane));
+		for (uint32_t slice = getSlice(bbe::Math::max(depth - radius, m_nearPlane)); slice <= maxSlice; slice++)
+		{
+			TileRange range;
+			if (!getTileRange(center, radius, slice, range)) continue;
+			for (uint32_t y = range.minY; y <= range.maxY; y++)
+			{
+				for (uint32_t x = range.minX; x <= range.maxX; x++)
+				{
+					m_clusters[getClusterIndex(x, y, slice)].amountOfLights++;
+				}
+			}
+		}
+	}
+
+	uint32_t offset = 0;
+	for (size_t i = 0; i < m_clusters.getLength(); i++)
+	{
+		m_clusters[i].offset = offset;
+		offset += m_clusters[i].amountOfLights;
+		m_clusters[i].amountOfLights = 0;
+	}
+
+	// Second pass: Write the light lists. Goes through exactly the same clusters as the first one.
+	m_lightIndices.clear();
+	m_lightIndices.resizeCapacityAndLength(offset);
+	for (size_t i = 0; i < m_viewSpacePositions.getLength(); i++)
+	{
+		const bbe::Vector3& center = m_viewSpacePositions[i];
+		const float radius = m_radii[i];
+		const float depth = -center.z;
+		if (depth + radius < m_nearPlane || depth - radius > m_farPlane) continue;
+		const uint32_t maxSlice = getSlice(bbe::Math::min(depth + radius, m_farPlane));
+		for (uint32_t slice = getSlice(bbe::Math::max(depth - radius, m_nearPlane)); slice <= maxSlice; slice++)
+		{
+			TileRange range;
+			if (!getTileRange(center, radius, slice, range)) continue;
+			for (uint32_t y = range.minY; y <= range.maxY; y++)
+			{
+				for (uint32_t x = range.minX; x <= range.maxX; x++)
+				{
+					Cluster& cluster = m_clusters[getClusterIndex(x, y, slice)];
+					m_lightIndices[cluster.offset + cluster.amountOfLights] = (uint32_t)i;
+					cluster.amountOfLights++;
+				}
+			}
+		}
+	}
+}
+
+uint32_t bbe::LightClusters::getTilesX() const
+{
+	return m_tilesX;
+}
+
+uint32_t bbe::LightClusters::getTilesY() const
+{
+	return m_tilesY;
+}
+
+uint32_t bbe::LightClusters::getSlices() const
+{
+	return m_slices;
+}
+
+float bbe::LightClusters::getNearPlane() const
+{
+	return m_nearPlane;
+}
+
+float bbe::LightClusters::getFarPlane() const
+{
+	return m_farPlane;
+}
+
+float bbe::LightClusters::getSliceScale() const
+{
+	return m_sliceScale;
+}
+
+uint32_t bbe::LightClusters::getClusterIndex(const bbe::Vector3& viewPos) const
+{
+	const bbe::Vector4 clip = m_projection * bbe::Vector4(viewPos, 1.f);
+	return getClusterIndex(getTile(clip.x / clip.w, m_tilesX), getTile(clip.y / clip.w, m_tilesY), getSlice(-viewPos.z));
+}
+
+uint32_t bbe::LightClusters::getClusterIndex(uint32_t x, uint32_t y, uint32_t slice) const
+{
+	return (slice * m_tilesY + y) * m_tilesX + x;
+}
+
+const bbe::List<bbe::LightClusters::Cluster>& bbe::LightClusters::getClusters() const
+{
+	return m_clusters;
+}
+
+const bbe::List<uint32_t>& bbe::LightClusters::getLightIndices() const
+{
+	return m_lightIndices;
+}
+
+const bbe::List<bbe::Vector3>& bbe::LightClusters::getViewSpaceLightPositions() const
+{
+	return m_viewSpacePositions;
+}
@@ -0,0 +1,167 @@
+#include "BBE/MappedFile.h"
+#include "BBE/Error.h"
+#include "BBE/SimpleFile.h"
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#ifdef WIN32
+#define NOMINMAX
+#include "windows.h"
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bbe::MappedFile::MappedFile(const bbe::String& path, AccessPattern accessPattern)
+{
+	open(path, accessPattern);
+}
+
+bbe::MappedFile::~MappedFile()
+{
+	close();
+}
+
+bbe::MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+bbe::MappedFile& bbe::MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this == &other) return *this;
+	close();
+	m_data = std::exchange(other.m_data, nullptr);
+	m_length = std::exchange(other.m_length, 0);
+	m_open = std::exchange(other.m_open, false);
+#ifdef WIN32
+	m_fileHandle = std::exchange(other.m_fileHandle, nullptr);
+	m_mappingHandle = std::exchange(other.m_mappingHandle, nullptr);
+#endif
+#ifdef __EMSCRIPTEN__
+	m_fallback = std::move(other.m_fallback);
+	m_data = m_fallback.getRaw();
+#endif
+	return *this;
+}
+
+void bbe::MappedFile::open(const bbe::String& path, AccessPattern accessPattern)
+{
+	if (m_open)
+	{
+		bbe::Crash(bbe::Error::AlreadyCreated);
+	}
+	if (std::filesystem::is_directory(path.getRaw()))
+	{
+		bbe::Crash(bbe::Error::IllegalArgument);
+	}
+
+#if defined(__EMSCRIPTEN__)
+	m_fallback = bbe::simpleFile::readBinaryFile(path);
+	m_data = m_fallback.getRaw();
+	m_length = m_fallback.getLength();
+#elif defined(WIN32)
+	const DWORD flags = accessPattern == AccessPattern::SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+	HANDLE file = CreateFileA(path.getRaw(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("Failed to open file!");
+	}
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		throw std::runtime_error("Couldn't determin file size.");
+	}
+	m_fileHandle = file;
+	m_length = (size_t)size.QuadPart;
+	if (m_length > 0)
+	{
+		// Mappings of empty files are not allowed, those simply stay without data.
+		m_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mappingHandle != nullptr)
+		{
+			m_data = (const bbe::byte*)MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		}
+		if (m_data == nullptr)
+		{
+			m_open = true;
+			close();
+			throw std::runtime_error("Failed to map file!");
+		}
+	}
+#else
+	const int fd = ::open(path.getRaw(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Failed to open file!");
+	}
+	struct stat info = {};
+	if (fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error("Couldn't determin file size.");
+	}
+	m_length = (size_t)info.st_size;
+	if (m_length > 0)
+	{
+		// Mappings of empty files are not allowed, those simply stay without data.
+		void* data = mmap(nullptr, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED)
+		{
+			::close(fd);
+			m_length = 0;
+			throw std::runtime_error("Failed to map file!");
+		}
+		madvise(data, m_length, accessPattern == AccessPattern::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+		madvise(data, m_length, MADV_WILLNEED);
+		m_data = (const bbe::byte*)data;
+	}
+	// The mapping keeps the file alive on its own.
+	::close(fd);
+#endif
+	m_open = true;
+}
+
+void bbe::MappedFile::close()
+{
+	if (!m_open) return;
+
+#if defined(__EMSCRIPTEN__)
+	m_fallback = bbe::ByteBuffer();
+#elif defined(WIN32)
+	if (m_data != nullptr) UnmapViewOfFile(m_data);
+	if (m_mappingHandle != nullptr) CloseHandle(m_mappingHandle);
+	if (m_fileHandle != nullptr) CloseHandle(m_fileHandle);
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+#else
+	if (m_data != nullptr) munmap((void*)m_data, m_length);
+#endif
+	m_data = nullptr;
+	m_length = 0;
+	m_open = false;
+}
+
+bool bbe::MappedFile::isOpen() const
+{
+	return m_open;
+}
+
+const bbe::byte* bbe::MappedFile::getRaw() const
+{
+	return m_data;
+}
+
+size_t bbe::MappedFile::getLength() const
+{
+	return m_length;
+}
+
+bbe::ByteBufferSpan bbe::MappedFile::getSpan() const
+{
+	return bbe::ByteBufferSpan(m_data, m_length);
+}
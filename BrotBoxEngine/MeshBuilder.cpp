@@ -56,6 +56,7 @@ bbe::MeshBuilder::ModelUvDimensionsPair bbe::MeshBuilder::getModel(uint32_t pixe
 			(int32_t)bbe::Math::max(1.0f, scale.y * (float)pixelsPerUnit)
 		));
 	}
+	bbe::Rectanglei::PackResult packed;
 	if (rects.getLength() == 0)
 	{
 		// Create a dummy dimension so that the caller can blindly use it without getting issues that a texture was impossible to create etc.
@@ -63,7 +64,11 @@ bbe::MeshBuilder::ModelUvDimensionsPair bbe::MeshBuilder::getModel(uint32_t pixe
 	}
 	else
 	{
-		retVal.uvDimensions = bbe::Rectanglei::pack(rects);
+		bbe::Rectanglei::PackSettings settings;
+		settings.allowRotation = true;
+		packed = bbe::Rectanglei::pack(rects, settings);
+		retVal.uvDimensions = packed.pageSizes[0];
+		retVal.uvFillRatio = packed.fillRatio;
 	}
 
 	for (size_t i = 0; i < quads.getLength(); i++)
@@ -71,17 +76,31 @@ bbe::MeshBuilder::ModelUvDimensionsPair bbe::MeshBuilder::getModel(uint32_t pixe
 		const bbe::Matrix4& quad = quads[i];
 		const bbe::Rectanglei& uvRect = rects[i];
 
+		// The uv corners in the order of the vertices. Rotated rects are mapped transposed, the lightmap doesn't mind.
+		const bool rotated = packed.rotated[i];
+		const bbe::Vector2i uvCorners[] = {
+			bbe::Vector2i(uvRect.getLeft(), uvRect.getTop()),
+			rotated ? bbe::Vector2i(uvRect.getRight(), uvRect.getTop()) : bbe::Vector2i(uvRect.getLeft(), uvRect.getBottom()),
+			rotated ? bbe::Vector2i(uvRect.getLeft(), uvRect.getBottom()) : bbe::Vector2i(uvRect.getRight(), uvRect.getTop()),
+			bbe::Vector2i(uvRect.getRight(), uvRect.getBottom()),
+		};
+		auto texelCenter = [&](const bbe::Vector2i& corner) {
+			return bbe::Vector2(
+				corner.x + (corner.x == uvRect.getLeft() ? 0.5f : -0.5f),
+				corner.y + (corner.y == uvRect.getTop()  ? 0.5f : -0.5f));
+		};
+
 		bbe::List<PosNormalPair> vertices =
 		{
-			bbe::PosNormalPair{bbe::Vector3(-0.5, -0.5, 0), bbe::Vector3(0, 0, 1), bbe::Vector2(uvRect.getLeft()  + 0.5f, uvRect.getTop()    + 0.5f)},
-			bbe::PosNormalPair{bbe::Vector3(-0.5,  0.5, 0), bbe::Vector3(0, 0, 1), bbe::Vector2(uvRect.getLeft()  + 0.5f, uvRect.getBottom() - 0.5f)},
-			bbe::PosNormalPair{bbe::Vector3( 0.5, -0.5, 0), bbe::Vector3(0, 0, 1), bbe::Vector2(uvRect.getRight() - 0.5f, uvRect.getTop()    + 0.5f)},
-			bbe::PosNormalPair{bbe::Vector3( 0.5,  0.5, 0), bbe::Vector3(0, 0, 1), bbe::Vector2(uvRect.getRight() - 0.5f, uvRect.getBottom() - 0.5f)},
+			bbe::PosNormalPair{bbe::Vector3(-0.5, -0.5, 0), bbe::Vector3(0, 0, 1), texelCenter(uvCorners[0])},
+			bbe::PosNormalPair{bbe::Vector3(-0.5,  0.5, 0), bbe::Vector3(0, 0, 1), texelCenter(uvCorners[1])},
+			bbe::PosNormalPair{bbe::Vector3( 0.5, -0.5, 0), bbe::Vector3(0, 0, 1), texelCenter(uvCorners[2])},
+			bbe::PosNormalPair{bbe::Vector3( 0.5,  0.5, 0), bbe::Vector3(0, 0, 1), texelCenter(uvCorners[3])},
 		};
-		retVal.model.m_bakingUvs.add(bbe::Vector2((float)uvRect.getLeft() , (float)uvRect.getTop()   ));
-		retVal.model.m_bakingUvs.add(bbe::Vector2((float)uvRect.getLeft() , (float)uvRect.getBottom()));
-		retVal.model.m_bakingUvs.add(bbe::Vector2((float)uvRect.getRight(), (float)uvRect.getTop()   ));
-		retVal.model.m_bakingUvs.add(bbe::Vector2((float)uvRect.getRight(), (float)uvRect.getBottom()));
+		for (const bbe::Vector2i& corner : uvCorners)
+		{
+			retVal.model.m_bakingUvs.add(corner.as<float>());
+		}
 		bbe::PosNormalPair::transform(vertices, quad);
 		const bbe::List<uint32_t> indices = { 
 			0 + 4 * (uint32_t)i,
@@ -1,4 +1,6 @@
 #include "BBE/NullRenderer/NullRendererManager.h"
+#include "BBE/CommandBuffer2D.h"
+#include "BBE/FrameCapture.h"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 
@@ -9,11 +11,14 @@ bbe::INTERNAL::nullRenderer::NullRendererManager::NullRendererManager()
 void bbe::INTERNAL::nullRenderer::NullRendererManager::init(const char* appName, uint32_t major, uint32_t minor, uint32_t patch, GLFWwindow* window, uint32_t initialWindowWidth, uint32_t initialWindowHeight)
 {
 	m_pwindow = window;
+	m_windowWidth = initialWindowWidth;
+	m_windowHeight = initialWindowHeight;
 	imguiStart();
 }
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::destroy()
 {
+	imguiStop();
 }
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::preDraw2D()
@@ -28,12 +33,22 @@ void bbe::INTERNAL::nullRenderer::NullRendererManager::preDraw3D()
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::preDraw()
 {
+	m_amountOfDrawcallsPreviousFrame = m_amountOfDrawcalls;
+	m_amountOfDrawcalls = 0;
 	imguiStartFrame();
 }
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::postDraw()
 {
+	m_primitiveBrush2D.INTERNAL_endDraw();
 	imguiEndFrame();
+
+	if (m_pframeCapture)
+	{
+		// Nothing is rasterized, but the frames still have to arrive so that recordings have the right length.
+		m_pframeCapture->submit(m_frameCaptureNumber, bbe::Image(m_windowWidth, m_windowHeight, bbe::Color(0, 0, 0, 1)));
+		m_pframeCapture = nullptr;
+	}
 }
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::waitEndDraw()
@@ -56,6 +71,8 @@ bbe::PrimitiveBrush3D& bbe::INTERNAL::nullRenderer::NullRendererManager::getBrus
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::resize(uint32_t width, uint32_t height)
 {
+	m_windowWidth = width;
+	m_windowHeight = height;
 }
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::screenshot(const bbe::String& path)
@@ -66,12 +83,25 @@ void bbe::INTERNAL::nullRenderer::NullRendererManager::setVideoRenderingMode(con
 {
 }
 
+bool bbe::INTERNAL::nullRenderer::NullRendererManager::isFrameCaptureSupported() const
+{
+	return true;
+}
+
+void bbe::INTERNAL::nullRenderer::NullRendererManager::captureFrame(bbe::FrameCapture& capture, uint64_t frameNumber)
+{
+	m_pframeCapture = &capture;
+	m_frameCaptureNumber = frameNumber;
+}
+
 void bbe::INTERNAL::nullRenderer::NullRendererManager::setColor2D(const bbe::Color& color)
 {
 }
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::fillRect2D(const Rectangle& rect, float rotation, FragmentShader* shader)
 {
+	// Only shaded rects end up here, everything else is submitted through the command buffer.
+	m_amountOfDrawcalls++;
 }
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::fillCircle2D(const Circle& circle)
@@ -86,6 +116,17 @@ void bbe::INTERNAL::nullRenderer::NullRendererManager::fillVertexIndexList2D(con
 {
 }
 
+bool bbe::INTERNAL::nullRenderer::NullRendererManager::retainImage2D(const bbe::Image&, bbe::AutoRef&)
+{
+	// Nothing is drawn, so nothing has to be kept alive.
+	return true;
+}
+
+void bbe::INTERNAL::nullRenderer::NullRendererManager::submit2D(const bbe::CommandBuffer2D& commandBuffer)
+{
+	m_amountOfDrawcalls += (uint32_t)commandBuffer.getBatches().getLength();
+}
+
 void bbe::INTERNAL::nullRenderer::NullRendererManager::setColor3D(const bbe::Color& color)
 {
 }
@@ -111,6 +152,7 @@ void bbe::INTERNAL::nullRenderer::NullRendererManager::imguiStart()
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
 	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
 	ImFontConfig fontConfig;
 	io.Fonts->AddFontDefault(&fontConfig);
 
@@ -121,6 +163,7 @@ void bbe::INTERNAL::nullRenderer::NullRendererManager::imguiStart()
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::imguiStop()
 {
+	ImGui::DestroyContext();
 }
 
 void bbe::INTERNAL::nullRenderer::NullRendererManager::imguiStartFrame()
@@ -135,7 +178,17 @@ void bbe::INTERNAL::nullRenderer::NullRendererManager::imguiEndFrame()
 	ImGui::Render();
 }
 
+bool bbe::INTERNAL::nullRenderer::NullRendererManager::isImageRegionSupported2D() const
+{
+	return true;
+}
+
 bool bbe::INTERNAL::nullRenderer::NullRendererManager::isReadyToDraw() const
 {
 	return true;
 }
+
+uint32_t bbe::INTERNAL::nullRenderer::NullRendererManager::getAmountOfDrawcalls() const
+{
+	return m_amountOfDrawcallsPreviousFrame;
+}
@@ -13,6 +13,8 @@ bbe::INTERNAL::openGl::OpenGLImage::OpenGLImage(const bbe::Image& image)
 	}
 
 	image.m_prendererData = this;
+	image.clearDirtyRegion();
+	imageFormat = image.m_format;
 
 	glGenTextures(1, &tex);
 	glBindTexture(GL_TEXTURE_2D, tex);
@@ -55,9 +57,30 @@ bbe::INTERNAL::openGl::OpenGLImage::OpenGLImage(const bbe::Image& image, GLuint
 	}
 
 	image.m_prendererData = this;
+	imageFormat = image.m_format;
 	this->tex = tex;
 }
 
+void bbe::INTERNAL::openGl::OpenGLImage::uploadDirtyRegion(const bbe::Image& image)
+{
+	if (!image.hasDirtyRegion()) return;
+	if (!image.isLoadedCpu())
+	{
+		bbe::Crash(bbe::Error::NotInitialized);
+	}
+
+	const bbe::Vector2i size = image.m_dirtyMax - image.m_dirtyMin;
+	glBindTexture(GL_TEXTURE_2D, tex);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, image.getWidth());
+	const byte* pixels = image.m_pdata.getRaw() + image.getIndexForRawAccess(image.m_dirtyMin.x, image.m_dirtyMin.y) * image.getBytesPerChannel();
+	glTexSubImage2D(GL_TEXTURE_2D, 0, image.m_dirtyMin.x, image.m_dirtyMin.y, size.x, size.y, format(image), type(image), pixels);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	image.clearDirtyRegion();
+}
+
 bbe::INTERNAL::openGl::OpenGLImage::~OpenGLImage()
 {
 	if (tex)
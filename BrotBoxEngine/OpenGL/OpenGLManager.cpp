@@ -1,4 +1,5 @@
 #include "BBE/OpenGL/OpenGLManager.h"
+#include "BBE/CommandBuffer2D.h"
 #include "BBE/OpenGL/OpenGLImage.h"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -17,6 +18,7 @@
 #include "BBE/OpenGL/OpenGLFragmentShader.h"
 #include "BBE/OpenGL/OpenGLLightBaker.h"
 #include "BBE/Logging.h"
+#include "BBE/FrameCapture.h"
 #include <iostream>
 
 // TODO: Is every OpenGL Resource properly freed? How can we find that out?
@@ -66,6 +68,100 @@ static GLuint genBuffer(const char* label, BufferTarget target, size_t length, c
 	return buffer;
 }
 
+void bbe::INTERNAL::openGl::StreamBuffer::create(const char* label, GLenum target, size_t segmentSize)
+{
+	this->label = label;
+	this->target = target;
+	ring = bbe::StreamRing(segmentSize);
+	createBuffer();
+}
+
+void bbe::INTERNAL::openGl::StreamBuffer::createBuffer()
+{
+	const size_t size = ring.getBufferSize();
+	glGenBuffers(1, &buffer);
+	glBindBuffer(target, buffer);
+#ifndef __EMSCRIPTEN__
+	if (GLEW_ARB_buffer_storage)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(target, size, nullptr, flags);
+		mapped = (bbe::byte*)glMapBufferRange(target, 0, size, flags);
+	}
+	else
+#endif
+	{
+		glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+	}
+	addLabel(GL_BUFFER, buffer, label);
+}
+
+void bbe::INTERNAL::openGl::StreamBuffer::destroy()
+{
+	for (size_t i = 0; i < bbe::StreamRing::amountOfSegments; i++)
+	{
+		if (fences[i])
+		{
+			glDeleteSync(fences[i]);
+			fences[i] = nullptr;
+		}
+	}
+	if (mapped)
+	{
+		glBindBuffer(target, buffer);
+		glUnmapBuffer(target);
+		mapped = nullptr;
+	}
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+void bbe::INTERNAL::openGl::StreamBuffer::beginFrame()
+{
+	const size_t segment = ring.beginFrame();
+	if (fences[segment])
+	{
+		// The segment was last used amountOfSegments frames ago, so this practically never waits.
+		glClientWaitSync(fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		glDeleteSync(fences[segment]);
+		fences[segment] = nullptr;
+	}
+}
+
+void bbe::INTERNAL::openGl::StreamBuffer::endFrame()
+{
+	if (mapped)
+	{
+		fences[ring.getSegment()] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
+
+void bbe::INTERNAL::openGl::StreamBuffer::reserve(size_t length)
+{
+	if (ring.fits(length)) return;
+
+	// Deleting is fine even if draws of previous frames still read the old buffer, GL keeps it alive until they're done.
+	destroy();
+	ring.resize(ring.getGrownSegmentSize(length));
+	createBuffer();
+}
+
+size_t bbe::INTERNAL::openGl::StreamBuffer::upload(const void* data, size_t length)
+{
+	reserve(length);
+	const size_t position = ring.allocate(length);
+	glBindBuffer(target, buffer);
+	if (mapped)
+	{
+		memcpy(mapped + position, data, length);
+	}
+	else
+	{
+		glBufferSubData(target, position, length, data);
+	}
+	return position;
+}
+
 static GLuint createShader(const char* label, GLenum shaderType)
 {
 	GLuint shader = glCreateShader(shaderType);
@@ -400,7 +496,6 @@ bbe::INTERNAL::openGl::Program bbe::INTERNAL::openGl::OpenGLManager::init2dShade
 
 static GLint screenSizePos2dTex = 0;
 static GLint scalePos2dTex = 0;
-static GLint inColorPos2dTex = 0;
 static GLint texPos2dTex = 0;
 static GLint swizzleModePos = 0;
 bbe::INTERNAL::openGl::Program bbe::INTERNAL::openGl::OpenGLManager::init2dTexShaders()
@@ -409,10 +504,13 @@ bbe::INTERNAL::openGl::Program bbe::INTERNAL::openGl::OpenGLManager::init2dTexSh
 	char const* vertexShaderSrc =
 		"in vec2 position;\n"
 		"in vec2 uv;"
+		"in vec4 color;"
 		"out vec2 uvPassOn;"
+		"out vec4 colorPassOn;"
 		"void main()\n"
 		"{\n"
 		"   uvPassOn = uv;"
+		"   colorPassOn = color;"
 		"	vec2 pos = (position / screenSize * vec2(2, -2) * scale) + vec2(-1, +1);\n"
 		"	gl_Position = vec4(pos, 0.0, 1.0);\n"
 		"}";
@@ -423,6 +521,7 @@ bbe::INTERNAL::openGl::Program bbe::INTERNAL::openGl::OpenGLManager::init2dTexSh
 		"#define SWIZZL_MODE_RGBA 0\n"
 		"#define SWIZZL_MODE_RRRR 1\n"
 		"in vec2 uvPassOn;"
+		"in vec4 colorPassOn;"
 		"out vec4 outColor;"
 		"void main()"
 		"{"
@@ -431,45 +530,76 @@ bbe::INTERNAL::openGl::Program bbe::INTERNAL::openGl::OpenGLManager::init2dTexSh
 		"   {"
 		"      texColor = vec4(1, 1, 1, texColor[0]);"
 		"   }"
-		"	outColor = inColor * texColor;\n"
+		"	outColor = colorPassOn * texColor;\n"
 		"}";
 	program.addShaders("2dTex", vertexShaderSrc, fragmentShaderSource,
 		{
 			{UT::UT_int      , "swizzleMode", &swizzleModePos    },
 			{UT::UT_vec2     , "screenSize" , &screenSizePos2dTex},
 			{UT::UT_vec2     , "scale"      , &scalePos2dTex     },
-			{UT::UT_vec4     , "inColor"    , &inColorPos2dTex   },
 			{UT::UT_sampler2D, "tex"        , &texPos2dTex       }
 		});
 
 	program.uniform1i(swizzleModePos, 0);
 	program.uniform2f(screenSizePos2dTex, (float)m_windowWidth, (float)m_windowHeight);
 	program.uniform2f(scalePos2dTex, 1.f, 1.f);
-	program.uniform4f(inColorPos2dTex, 1.f, 1.f, 1.f, 1.f);
-
-	bbe::List<float> uvCoordinates = {
-		0.0f, 0.0f,
-		0.0f, 1.0f,
-		1.0f, 1.0f,
-		1.0f, 0.0f,
-	};
-	m_imageUvBuffer = genBuffer("TexShadersUvBuffer", BufferTarget::ARRAY_BUFFER, sizeof(float) * uvCoordinates.getLength(), uvCoordinates.getRaw());
 
 	return program;
 }
 
-bbe::INTERNAL::openGl::MrtProgram bbe::INTERNAL::openGl::OpenGLManager::init3dShadersMrt(bool baking)
+// Instanced variants take the model matrix and the color per instance instead of as uniforms.
+static bbe::String get3dVertexShaderHeader(bool instanced)
 {
-	MrtProgram program;
-	bbe::String vertexShaderSrc =
+	bbe::String src =
 		"in vec3 inPos;"
 		"in vec3 inNormal;"
 		"in vec2 inUvCoord;"
 		"out vec4 passPos;"
 		"out vec4 passNormal;"
-		"out vec2 passUvCoord;"
+		"out vec2 passUvCoord;";
+	if (instanced)
+	{
+		src +=
+			"in mat4 inModel;"
+			"in vec4 inInstanceColor;"
+			"out vec4 passColor;";
+	}
+	return src;
+}
+
+static bbe::List<bbe::INTERNAL::openGl::UniformVariable> get3dUniformVariables(bbe::INTERNAL::openGl::MrtProgram& program, bool instanced)
+{
+	using bbe::INTERNAL::openGl::UT;
+	bbe::List<bbe::INTERNAL::openGl::UniformVariable> uniformVariables =
+		{
+			{UT::UT_mat4,      "view"      , &program.viewPos3dMrt	    },
+			{UT::UT_mat4,      "projection", &program.projectionPos3dMrt},
+			{UT::UT_sampler2D, "albedo"    , &program.albedoTexMrt      },
+			{UT::UT_sampler2D, "normals"   , &program.normalsTexMrt     },
+			{UT::UT_sampler2D, "emissions" , &program.emissionsTexMrt   },
+		};
+	if (!instanced)
+	{
+		uniformVariables.add({ UT::UT_vec4, "inColor", &program.inColorPos3dMrt });
+		uniformVariables.add({ UT::UT_mat4, "model"  , &program.modelPos3dMrt   });
+	}
+	return uniformVariables;
+}
+
+bbe::INTERNAL::openGl::MrtProgram bbe::INTERNAL::openGl::OpenGLManager::init3dShadersMrt(bool baking, bool instanced)
+{
+	MrtProgram program;
+	bbe::String vertexShaderSrc = get3dVertexShaderHeader(instanced);
+	vertexShaderSrc +=
 		"void main()"
-		"{"
+		"{";
+	if (instanced)
+	{
+		vertexShaderSrc +=
+			"   mat4 model = inModel;"
+			"   passColor = inInstanceColor;";
+	}
+	vertexShaderSrc +=
 		"   vec4 worldPos = model * vec4(inPos, 1.0);";
 	if (!baking)
 	{
@@ -492,7 +622,9 @@ bbe::INTERNAL::openGl::MrtProgram bbe::INTERNAL::openGl::OpenGLManager::init3dSh
 	bbe::String fragmentShaderSource =
 		"in vec4 passPos;"
 		"in vec4 passNormal;"
-		"in vec2 passUvCoord;"
+		"in vec2 passUvCoord;";
+	if (instanced) fragmentShaderSource += "in vec4 passColor;";
+	fragmentShaderSource +=
 		"layout (location = 0) out vec4 outPos;"
 		"layout (location = 1) out vec4 outNormal;"
 		"layout (location = 2) out vec4 outAlbedo;"
@@ -501,31 +633,25 @@ bbe::INTERNAL::openGl::MrtProgram bbe::INTERNAL::openGl::OpenGLManager::init3dSh
 		"void main()"
 		"{"
 		"   outPos    = passPos;";
-	if (!baking)
+	if (instanced)
+		fragmentShaderSource += "   outNormal = vec4(normalize(passNormal.xyz), 1.0);"; // Instances are never normal mapped.
+	else if (!baking)
 		fragmentShaderSource += "   outNormal = vec4(normalize(passNormal.xyz + (view * model * vec4(texture(normals, passUvCoord).xyz, 0.0)).xyz), 1.0);"; // TODO HACK: Setting the alpha component to 1 to avoid it being discarded from the Texture. Can we do better?
 	else
 		fragmentShaderSource += "   outNormal = vec4(normalize(passNormal.xyz + (       model * vec4(texture(normals, passUvCoord).xyz, 0.0)).xyz), 1.0);"; // TODO HACK: Setting the alpha component to 1 to avoid it being discarded from the Texture. Can we do better?
 
+	fragmentShaderSource += instanced ? "   outAlbedo = passColor * texture(albedo, passUvCoord);" : "   outAlbedo = inColor * texture(albedo, passUvCoord);";
 	fragmentShaderSource +=
-		"   outAlbedo = inColor * texture(albedo, passUvCoord);"
 		"   outSpecular = vec4(10.0, 1.0, 0.0, 1.0);"
 		"   outEmission = texture(emissions, passUvCoord);"
 		"}";
 
 	bbe::String label;
 	if (baking) label = "3dMrtBaking";
+	else if (instanced) label = "3dMrtInstanced";
 	else label = "3dMrt";
 
-	program.addShaders(label, vertexShaderSrc.getRaw(), fragmentShaderSource.getRaw(),
-		{
-			{UT::UT_vec4,      "inColor"   , &program.inColorPos3dMrt   },
-			{UT::UT_mat4,      "view"      , &program.viewPos3dMrt	    },
-			{UT::UT_mat4,      "projection", &program.projectionPos3dMrt},
-			{UT::UT_mat4,      "model"	   , &program.modelPos3dMrt	    },
-			{UT::UT_sampler2D, "albedo"    , &program.albedoTexMrt      },
-			{UT::UT_sampler2D, "normals"   , &program.normalsTexMrt     },
-			{UT::UT_sampler2D, "emissions" , &program.emissionsTexMrt   },
-		});
+	program.addShaders(label, vertexShaderSrc.getRaw(), fragmentShaderSource.getRaw(), get3dUniformVariables(program, instanced));
 
 	bbe::Matrix4 identity;
 	program.uniformMatrix4fv(program.viewPos3dMrt, false, identity);
@@ -534,18 +660,20 @@ bbe::INTERNAL::openGl::MrtProgram bbe::INTERNAL::openGl::OpenGLManager::init3dSh
 	return program;
 }
 
-bbe::INTERNAL::openGl::MrtProgram bbe::INTERNAL::openGl::OpenGLManager::init3dForwardNoLight()
+bbe::INTERNAL::openGl::MrtProgram bbe::INTERNAL::openGl::OpenGLManager::init3dForwardNoLight(bool instanced)
 {
 	MrtProgram program;
-	bbe::String vertexShaderSrc =
-		"in vec3 inPos;"
-		"in vec3 inNormal;"
-		"in vec2 inUvCoord;"
-		"out vec4 passPos;"
-		"out vec4 passNormal;"
-		"out vec2 passUvCoord;"
+	bbe::String vertexShaderSrc = get3dVertexShaderHeader(instanced);
+	vertexShaderSrc +=
 		"void main()"
-		"{"
+		"{";
+	if (instanced)
+	{
+		vertexShaderSrc +=
+			"   mat4 model = inModel;"
+			"   passColor = inInstanceColor;";
+	}
+	vertexShaderSrc +=
 		"   vec4 worldPos = model * vec4(inPos, 1.0);"
 		"   gl_Position = projection * view * worldPos * vec4(1.0, -1.0, 1.0, 1.0);"
 		"   passPos = view * worldPos;"
@@ -556,23 +684,18 @@ bbe::INTERNAL::openGl::MrtProgram bbe::INTERNAL::openGl::OpenGLManager::init3dFo
 	bbe::String fragmentShaderSource =
 		"in vec4 passPos;"
 		"in vec4 passNormal;"
-		"in vec2 passUvCoord;"
+		"in vec2 passUvCoord;";
+	if (instanced) fragmentShaderSource += "in vec4 passColor;";
+	fragmentShaderSource +=
 		"layout (location = 0) out vec4 outAlbedo;"
 		"void main()"
-		"{"
-		"   outAlbedo = inColor * texture(albedo, passUvCoord) * texture(emissions, passUvCoord);"
-		"}";
+		"{";
+	fragmentShaderSource += instanced
+		? "   outAlbedo = passColor * texture(albedo, passUvCoord) * texture(emissions, passUvCoord);"
+		: "   outAlbedo = inColor * texture(albedo, passUvCoord) * texture(emissions, passUvCoord);";
+	fragmentShaderSource += "}";
 
-	program.addShaders("ForwardNoLight", vertexShaderSrc.getRaw(), fragmentShaderSource.getRaw(),
-		{
-			{UT::UT_vec4,      "inColor"   , &program.inColorPos3dMrt   },
-			{UT::UT_mat4,      "view"      , &program.viewPos3dMrt	    },
-			{UT::UT_mat4,      "projection", &program.projectionPos3dMrt},
-			{UT::UT_mat4,      "model"	   , &program.modelPos3dMrt	    },
-			{UT::UT_sampler2D, "albedo"    , &program.albedoTexMrt      },
-			{UT::UT_sampler2D, "normals"   , &program.normalsTexMrt     },
-			{UT::UT_sampler2D, "emissions" , &program.emissionsTexMrt   },
-		});
+	program.addShaders(instanced ? "ForwardNoLightInstanced" : "ForwardNoLight", vertexShaderSrc.getRaw(), fragmentShaderSource.getRaw(), get3dUniformVariables(program, instanced));
 
 	return program;
 }
@@ -717,44 +840,138 @@ bbe::INTERNAL::openGl::Program bbe::INTERNAL::openGl::OpenGLManager::initBakingG
 	return program;
 }
 
-bbe::INTERNAL::openGl::LightProgram bbe::INTERNAL::openGl::OpenGLManager::init3dShadersLight(bool baking)
+static const char* fullScreenVertexShaderSrc =
+	"void main()"
+	"{"
+	"   if(gl_VertexID == 0)"
+	"   {"
+	"       gl_Position = vec4(-1.0, -1.0, 0.0, 1.0);"
+	"   }"
+	"   if(gl_VertexID == 1)"
+	"   {"
+	"       gl_Position = vec4(-1.0, 1.0, 0.0, 1.0);"
+	"   }"
+	"   if(gl_VertexID == 2)"
+	"   {"
+	"       gl_Position = vec4(1.0, 1.0, 0.0, 1.0);"
+	"   }"
+	"   if(gl_VertexID == 3)"
+	"   {"
+	"       gl_Position = vec4(1.0, -1.0, 0.0, 1.0);"
+	"   }"
+	"}";
+
+// Light textures are filled row by row, so that they stay below the maximum texture size for any amount of lights.
+static constexpr GLsizei lightTextureWidth = 1024;
+
+bbe::INTERNAL::openGl::ClusteredLightProgram bbe::INTERNAL::openGl::OpenGLManager::init3dShadersLightClustered()
+{
+	ClusteredLightProgram program;
+
+	const bbe::String fragmentShaderSource = bbe::String(
+		"#define FALLOFF_NONE    0\n"
+		"#define FALLOFF_LINEAR  1\n"
+		"#define FALLOFF_SQUARED 2\n"
+		"#define FALLOFF_CUBIC   3\n"
+		"#define FALLOFF_SQRT    4\n"
+		"#define LIGHT_TEXTURE_WIDTH ") + (int32_t)lightTextureWidth + "\n"
+		"out vec4 outColor;"
+		"vec4 fetchTexel(sampler2D tex, int i)"
+		"{"
+		"   return texelFetch(tex, ivec2(i % LIGHT_TEXTURE_WIDTH, i / LIGHT_TEXTURE_WIDTH), 0);"
+		"}"
+		"void main()"
+		"{"
+		"   vec2 uvCoord = gl_FragCoord.xy / screenSize;"
+		"   vec3 normal = texture(gNormal, uvCoord).xyz;"
+		"   if(length(normal) == 0.0) { discard; }"
+		"   vec3 pos = texture(gPosition, uvCoord).xyz;"
+		"   vec3 albedo = texture(gAlbedoSpec, uvCoord).xyz;"
+		"   vec3 specStats = texture(gSpecular, uvCoord).xyz;"
+		"   vec3 V = normalize(-pos);"
+
+		// Must find the same cluster as bbe::LightClusters::getClusterIndex.
+		"   vec4 clipPos = projection * vec4(pos, 1.0);"
+		"   ivec2 tile = clamp(ivec2(floor((clipPos.xy / clipPos.w * 0.5 + 0.5) * clusterGrid.xy)), ivec2(0), ivec2(clusterGrid.xy) - 1);"
+		"   int slice = clamp(int(floor(log(max(-pos.z, sliceParams.x) / sliceParams.x) * sliceParams.y)), 0, int(clusterGrid.z) - 1);"
+		"   vec4 cluster = fetchTexel(lightClusters, (slice * int(clusterGrid.y) + tile.y) * int(clusterGrid.x) + tile.x);"
+		"   int offset = int(cluster.x);"
+		"   int amountOfLights = int(cluster.y);"
+
+		"   vec3 color = vec3(0.0);"
+		"   for(int i = 0; i < amountOfLights; i++)"
+		"   {"
+		"       int light = int(fetchTexel(lightIndices, offset + i).x);"
+		"       vec4 lightPos      = fetchTexel(lightData, light * 4 + 0);"
+		"       vec4 lightColor    = fetchTexel(lightData, light * 4 + 1);"
+		"       vec4 specularColor = fetchTexel(lightData, light * 4 + 2);"
+		"       vec4 lightParams   = fetchTexel(lightData, light * 4 + 3);"
+		"       vec3 toLight = lightPos.xyz - pos;"
+		"       float distToLight = length(toLight);"
+		"       if(distToLight > lightParams.y) continue;"
+		"       float lightPower = lightPos.w;"
+		"       if(distToLight > 0.0)"
+		"       {"
+		"           switch (int(lightParams.x))"
+		"           {"
+		"           case FALLOFF_NONE:"
+		"               break;"
+		"           case FALLOFF_LINEAR:"
+		"               lightPower = lightPower / distToLight;"
+		"               break;"
+		"           case FALLOFF_SQUARED:"
+		"               lightPower = lightPower / distToLight / distToLight;"
+		"               break;"
+		"           case FALLOFF_CUBIC:"
+		"               lightPower = lightPower / distToLight / distToLight / distToLight;"
+		"               break;"
+		"           case FALLOFF_SQRT:"
+		"               lightPower = lightPower / sqrt(distToLight);"
+		"               break;"
+		"           }"
+		"       }"
+		"       if(lightPower < 0.001) continue;"
+		"       vec3 L = normalize(toLight);"
+		"       vec3 diffuse = max(dot(normal, L), 0.0) * (albedo * lightColor.xyz) * lightPower;"
+		"       vec3 R = reflect(-L, normal);"
+		"       vec3 specular = pow(max(dot(R, V), 0.0), specStats.x) * specularColor.xyz * lightPower * specStats.y;"
+		"       color += diffuse + specular * 0.1;"
+		"   }"
+		"   outColor = vec4(color, 1.0);"
+		"}";
+
+	program.addShaders("3dLightClustered", fullScreenVertexShaderSrc, fragmentShaderSource.getRaw(),
+		{
+			{UT::UT_sampler2D, "gPosition"    , &program.gPositionPos    },
+			{UT::UT_sampler2D, "gNormal"      , &program.gNormalPos      },
+			{UT::UT_sampler2D, "gAlbedoSpec"  , &program.gAlbedoSpecPos  },
+			{UT::UT_sampler2D, "gSpecular"    , &program.gSpecularPos    },
+			{UT::UT_sampler2D, "lightData"    , &program.lightDataPos    },
+			{UT::UT_sampler2D, "lightClusters", &program.lightClustersPos},
+			{UT::UT_sampler2D, "lightIndices" , &program.lightIndicesPos },
+			{UT::UT_mat4     , "projection"   , &program.projectionPos   },
+			{UT::UT_vec2     , "screenSize"   , &program.screenSizePos   },
+			{UT::UT_vec3     , "clusterGrid"  , &program.clusterGridPos  },
+			{UT::UT_vec2     , "sliceParams"  , &program.sliceParamsPos  },
+		});
+
+	program.uniform1i(program.gPositionPos, 0);
+	program.uniform1i(program.gNormalPos, 1);
+	program.uniform1i(program.gAlbedoSpecPos, 2);
+	program.uniform1i(program.gSpecularPos, 3);
+	program.uniform1i(program.lightDataPos, 5);
+	program.uniform1i(program.lightClustersPos, 6);
+	program.uniform1i(program.lightIndicesPos, 7);
+	program.uniform2f(program.screenSizePos, (float)m_windowWidth, (float)m_windowHeight);
+
+	bbe::Matrix4 identity;
+	program.uniformMatrix4fv(program.projectionPos, false, identity);
+	return program;
+}
+
+bbe::INTERNAL::openGl::LightProgram bbe::INTERNAL::openGl::OpenGLManager::init3dShadersLightBaking()
 {
 	LightProgram program;
-	char const* vertexShaderSrc;
-
-	if(!baking)
-	{
-		vertexShaderSrc =
-			"in vec3 inPos;"
-			"void main()"
-			"{"
-			"   vec4 worldPos = vec4(lightPos.xyz, 1.0) + lightRadius * vec4(inPos, 0.0);"
-			"   gl_Position = projection * worldPos * vec4(1.0, -1.0, 1.0, 1.0);"
-			"}";
-	}
-	else
-	{
-		vertexShaderSrc =
-			"void main()"
-			"{"
-			"   if(gl_VertexID == 0)"
-			"   {"
-			"       gl_Position = vec4(-1.0, -1.0, 0.0, 1.0);"
-			"   }"
-			"   if(gl_VertexID == 1)"
-			"   {"
-			"       gl_Position = vec4(-1.0, 1.0, 0.0, 1.0);"
-			"   }"
-			"   if(gl_VertexID == 2)"
-			"   {"
-			"       gl_Position = vec4(1.0, 1.0, 0.0, 1.0);"
-			"   }"
-			"   if(gl_VertexID == 3)"
-			"   {"
-			"       gl_Position = vec4(1.0, -1.0, 0.0, 1.0);"
-			"   }"
-			"}";
-	}
 
 	bbe::String fragmentShaderSource =
 		"#define FALLOFF_NONE    0\n"
@@ -794,33 +1011,12 @@ bbe::INTERNAL::openGl::LightProgram bbe::INTERNAL::openGl::OpenGLManager::init3d
 		"       }																							 "
 		"   }"
 		"   if(lightPower < 0.001) discard;"
-		"   vec3 L = normalize(toLight);";
-	if(!baking)
-	{
-		fragmentShaderSource +=
-			"   vec3 albedo = texture(gAlbedoSpec, uvCoord).xyz;"
-			"   vec3 diffuse = max(dot(normal, L), 0.0) * (albedo * lightColor.xyz) * lightPower;"
-			"   vec3 R = reflect(-L, normal);"
-			"   vec3 toCamera = -pos;"
-			"   vec3 V = normalize(toCamera);"
-			"   vec3 specStats = texture(gSpecular, uvCoord).xyz;"
-			"   vec3 specular = pow(max(dot(R, V), 0.0), specStats.x) * specularColor.xyz * lightPower * specStats.y;"
-			"   outColor = vec4(diffuse + specular * 0.1, 1.0);"
-			"}";
-	}
-	else
-	{
-		fragmentShaderSource +=
-			"   vec3 diffuse = max(dot(normal, L), 0.0) * (lightColor.xyz) * lightPower;"
-			"   outColor = vec4(diffuse, 1.0);"
-			"}";
-	}
-
-	bbe::String label;
-	if (baking) label = "3dLightBaking";
-	else label = "3dLight";
+		"   vec3 L = normalize(toLight);"
+		"   vec3 diffuse = max(dot(normal, L), 0.0) * (lightColor.xyz) * lightPower;"
+		"   outColor = vec4(diffuse, 1.0);"
+		"}";
 
-	program.addShaders(label, vertexShaderSrc, fragmentShaderSource.getRaw(),
+	program.addShaders("3dLightBaking", fullScreenVertexShaderSrc, fragmentShaderSource.getRaw(),
 		{
 			{UT::UT_sampler2D, "gPosition"	  , &program.gPositionPos3dLight     },
 			{UT::UT_sampler2D, "gNormal"	  , &program.gNormalPos3dLight       },
@@ -1039,7 +1235,7 @@ void bbe::INTERNAL::openGl::OpenGLManager::fillInternalMesh(const float* modelMa
 	glDrawElements(GL_TRIANGLES, (GLsizei)amountOfIndices, GL_UNSIGNED_INT, 0); addDrawcallStat();
 }
 
-void bbe::INTERNAL::openGl::OpenGLManager::addInstancedData2D(PreviousDrawCall2D type, float x, float y, float width, float height, float rotation)
+void bbe::INTERNAL::openGl::OpenGLManager::addInstancedData2D(PreviousDrawCall2D type, float x, float y, float width, float height, float rotation, const bbe::Color& color)
 {
 	if (type != previousDrawCall2d)
 	{
@@ -1052,10 +1248,10 @@ void bbe::INTERNAL::openGl::OpenGLManager::addInstancedData2D(PreviousDrawCall2D
 	instanceData.scalePosOffset.z = x;
 	instanceData.scalePosOffset.w = y;
 	instanceData.rotation = rotation;
-	instanceData.color.x = m_color2d.r;
-	instanceData.color.y = m_color2d.g;
-	instanceData.color.z = m_color2d.b;
-	instanceData.color.w = m_color2d.a;
+	instanceData.color.x = color.r;
+	instanceData.color.y = color.g;
+	instanceData.color.z = color.b;
+	instanceData.color.w = color.a;
 	instanceDatas.add(instanceData);
 }
 
@@ -1099,26 +1295,25 @@ void bbe::INTERNAL::openGl::OpenGLManager::flushInstanceData2D()
 	glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, 0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	GLuint instanceVBO = genBuffer("FlushInstanceVBO", BufferTarget::ARRAY_BUFFER, sizeof(InstanceData2D) * instanceDatas.getLength(), instanceDatas.getRaw());
+	const size_t instanceOffset = m_vertexStream.upload(instanceDatas.getRaw(), sizeof(InstanceData2D) * instanceDatas.getLength());
 
 	GLint pos = 1;
 	glEnableVertexAttribArray(pos);
-	glVertexAttribPointer(pos, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(0 * sizeof(float)));
+	glVertexAttribPointer(pos, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(instanceOffset + 0 * sizeof(float)));
 	glVertexAttribDivisor(pos, 1);
 	pos = 2;
 	glEnableVertexAttribArray(pos);
-	glVertexAttribPointer(pos, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(4 * sizeof(float)));
+	glVertexAttribPointer(pos, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(instanceOffset + 4 * sizeof(float)));
 	glVertexAttribDivisor(pos, 1);
 	pos = 3;
 	glEnableVertexAttribArray(pos);
-	glVertexAttribPointer(pos, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(5 * sizeof(float)));
+	glVertexAttribPointer(pos, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(instanceOffset + 5 * sizeof(float)));
 	glVertexAttribDivisor(pos, 1);
 
 
 	glDrawElementsInstanced(mode, size, GL_UNSIGNED_INT, 0, (GLsizei)instanceDatas.getLength()); addDrawcallStat();
 	instanceDatas.clear();
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glDeleteBuffers(1, &instanceVBO);
 }
 
 bbe::INTERNAL::openGl::OpenGLImage* bbe::INTERNAL::openGl::OpenGLManager::toRendererData(const bbe::Image& image) const
@@ -1129,32 +1324,72 @@ bbe::INTERNAL::openGl::OpenGLImage* bbe::INTERNAL::openGl::OpenGLManager::toRend
 	}
 	else
 	{
-		return (bbe::INTERNAL::openGl::OpenGLImage*)image.m_prendererData.get();
+		bbe::INTERNAL::openGl::OpenGLImage* ogi = (bbe::INTERNAL::openGl::OpenGLImage*)image.m_prendererData.get();
+		ogi->uploadDirtyRegion(image);
+		return ogi;
 	}
 }
 
-void bbe::INTERNAL::openGl::OpenGLManager::drawLight(const bbe::PointLight& light, bool baking, GLuint ibo)
+void bbe::INTERNAL::openGl::OpenGLManager::drawLight(const bbe::PointLight& light, GLuint ibo)
 {
-	if (!baking)
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	m_program3dLightBaking.setLightUniform(light, bbe::Matrix4());
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0); addDrawcallStat();
+}
+
+// Pads the texels to full rows of lightTextureWidth. Empty textures still get a row, so that they are complete.
+static void uploadLightTexels(GLuint texture, GLint internalFormat, GLenum format, bbe::List<float>& texels, size_t componentsPerTexel)
+{
+	const size_t rowLength = (size_t)lightTextureWidth * componentsPerTexel;
+	size_t height = (texels.getLength() + rowLength - 1) / rowLength;
+	if (height == 0) height = 1;
+	texels.resizeCapacityAndLength(height * rowLength);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, lightTextureWidth, (GLsizei)height, 0, format, GL_FLOAT, texels.getRaw());
+}
+
+void bbe::INTERNAL::openGl::OpenGLManager::uploadLightClusters()
+{
+	m_lightClusters.build(pointLights, m_view, m_projection);
+
+	// Four texels per light: view space position and strength, color, specular color, falloff mode and radius.
+	m_lightDataTexels.clear();
+	const bbe::List<bbe::Vector3>& viewSpacePositions = m_lightClusters.getViewSpaceLightPositions();
+	for (size_t i = 0; i < pointLights.getLength(); i++)
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, openGl::OpenGLSphere::getIbo());
-		glBindBuffer(GL_ARRAY_BUFFER, openGl::OpenGLSphere::getVbo());
-		GLint positionAttribute = glGetAttribLocation(m_program3dLight.program, "inPos");
-		glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 0);
-		glEnableVertexAttribArray(positionAttribute);
-		glVertexAttribDivisor(positionAttribute, 0);
+		const bbe::PointLight& light = pointLights[i];
+		m_lightDataTexels.addAll(
+			viewSpacePositions[i].x, viewSpacePositions[i].y, viewSpacePositions[i].z, light.lightStrength,
+			light.lightColor.r, light.lightColor.g, light.lightColor.b, light.lightColor.a,
+			light.specularColor.r, light.specularColor.g, light.specularColor.b, light.specularColor.a,
+			(float)light.falloffMode, light.getLightRadius(), 0.f, 0.f);
+	}
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	m_lightClustersTexels.clear();
+	const bbe::List<bbe::LightClusters::Cluster>& clusters = m_lightClusters.getClusters();
+	for (size_t i = 0; i < clusters.getLength(); i++)
+	{
+		m_lightClustersTexels.addAll((float)clusters[i].offset, (float)clusters[i].amountOfLights);
 	}
-	else
+
+	m_lightIndicesTexels.clear();
+	const bbe::List<uint32_t>& lightIndices = m_lightClusters.getLightIndices();
+	for (size_t i = 0; i < lightIndices.getLength(); i++)
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+		m_lightIndicesTexels.add((float)lightIndices[i]);
 	}
 
-	LightProgram& program = baking ? m_program3dLightBaking : m_program3dLight;
-	program.setLightUniform(light, baking ? bbe::Matrix4() : m_view);
+	glActiveTexture(GL_TEXTURE0 + 5);
+	uploadLightTexels(m_lightDataTex, GL_RGBA32F, GL_RGBA, m_lightDataTexels, 4);
+	glActiveTexture(GL_TEXTURE0 + 6);
+	uploadLightTexels(m_lightClustersTex, GL_RG32F, GL_RG, m_lightClustersTexels, 2);
+	glActiveTexture(GL_TEXTURE0 + 7);
+	uploadLightTexels(m_lightIndicesTex, GL_R32F, GL_RED, m_lightIndicesTexels, 1);
+	glActiveTexture(GL_TEXTURE0);
 
-	glDrawElements(GL_TRIANGLES, baking ? 6 : (GLsizei)openGl::OpenGLSphere::getAmountOfIndices(), GL_UNSIGNED_INT, 0); addDrawcallStat();
+	m_program3dLightClustered.uniformMatrix4fv(m_program3dLightClustered.projectionPos, GL_FALSE, m_projection);
+	m_program3dLightClustered.uniform3f(m_program3dLightClustered.clusterGridPos, (float)m_lightClusters.getTilesX(), (float)m_lightClusters.getTilesY(), (float)m_lightClusters.getSlices());
+	m_program3dLightClustered.uniform2f(m_program3dLightClustered.sliceParamsPos, m_lightClusters.getNearPlane(), m_lightClusters.getSliceScale());
 }
 
 static bbe::Vector2i getPos(size_t i, uint32_t width)
@@ -1219,6 +1454,21 @@ uint32_t bbe::INTERNAL::openGl::OpenGLManager::getAmountOfDrawcalls()
 	return *amountOfDrawcallsRead;
 }
 
+size_t bbe::INTERNAL::openGl::OpenGLManager::getAmountOfStreamedBytes() const
+{
+	return m_amountOfStreamedBytesPreviousFrame;
+}
+
+uint32_t bbe::INTERNAL::openGl::OpenGLManager::getAmountOfVisibleObjects3D() const
+{
+	return m_amountOfVisibleObjects3DPreviousFrame;
+}
+
+uint32_t bbe::INTERNAL::openGl::OpenGLManager::getAmountOfCulledObjects3D() const
+{
+	return m_amountOfCulledObjects3DPreviousFrame;
+}
+
 void bbe::INTERNAL::openGl::OpenGLManager::addDrawcallStat()
 {
 	(*amountOfDrawcallsWrite)++;
@@ -1304,15 +1554,17 @@ void bbe::INTERNAL::openGl::OpenGLManager::init(const char* appName, uint32_t ma
 
 	m_program2d = init2dShaders();
 	m_program2dTex = init2dTexShaders();
-	m_program3dMrt = init3dShadersMrt(false);
-	m_program3dForwardNoLight = init3dForwardNoLight();
+	m_program3dMrt = init3dShadersMrt(false, false);
+	m_program3dForwardNoLight = init3dForwardNoLight(false);
+	m_program3dMrtInstanced = init3dShadersMrt(false, true);
+	m_program3dForwardNoLightInstanced = init3dForwardNoLight(true);
 	m_program3dAmbient = init3dShadersAmbient();
 	m_programPostProcessing = init3dPostProcessing();
 	m_programBakingGammaCorrection = initBakingGammaCorrection();
-	m_program3dLight = init3dShadersLight(false);
+	m_program3dLightClustered = init3dShadersLightClustered();
 
-	m_program3dMrtBaking = init3dShadersMrt(true);
-	m_program3dLightBaking = init3dShadersLight(true);
+	m_program3dMrtBaking = init3dShadersMrt(true, false);
+	m_program3dLightBaking = init3dShadersLightBaking();
 	initFrameBuffers();
 
 	OpenGLRectangle::init();
@@ -1331,10 +1583,20 @@ void bbe::INTERNAL::openGl::OpenGLManager::init(const char* appName, uint32_t ma
 
 	const uint32_t indices[] = { 0, 3, 1, 1, 3, 2 };
 	quadIbo = genBuffer("quadIbo", BufferTarget::ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * 6, indices);
+
+	m_vertexStream.create("vertexStream", GL_ARRAY_BUFFER, 1024 * 1024);
+	m_indexStream.create("indexStream", GL_ELEMENT_ARRAY_BUFFER, 256 * 1024);
+
+	m_lightDataTex = genTexture("lightData");
+	m_lightClustersTex = genTexture("lightClusters");
+	m_lightIndicesTex = genTexture("lightIndices");
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::destroy()
 {
+	destroyCaptureBuffers();
+	m_vertexStream.destroy();
+	m_indexStream.destroy();
 	glDeleteBuffers(1, &quadIbo);
 	imguiStop();
 
@@ -1346,19 +1608,25 @@ void bbe::INTERNAL::openGl::OpenGLManager::destroy()
 	mrtFb                         .destroy();
 	forwardNoLightFb              .destroy();
 	postProcessingFb              .destroy();
+	m_instanceBatches3D.clear();
+	glDeleteTextures(1, &m_lightIndicesTex);
+	glDeleteTextures(1, &m_lightClustersTex);
+	glDeleteTextures(1, &m_lightDataTex);
 	m_program3dMrt                .destroy();
+	m_program3dMrtInstanced       .destroy();
+	m_program3dForwardNoLightInstanced.destroy();
 	m_programPostProcessing       .destroy();
 	m_programBakingGammaCorrection.destroy();
-	m_program3dLight              .destroy();
+	m_program3dLightClustered     .destroy();
 	m_program3dMrtBaking          .destroy();
 	m_program3dLightBaking        .destroy();
-	glDeleteBuffers(1, &m_imageUvBuffer);
 	m_program2dTex.destroy();
 	m_program2d   .destroy();
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::preDraw2D()
 {
+	flushInstances3D();
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
 	glFrontFace(GL_CCW);
@@ -1379,15 +1647,16 @@ void bbe::INTERNAL::openGl::OpenGLManager::preDraw2D()
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, OpenGLRectangle::getIbo());
 	glDrawElements(GL_TRIANGLE_STRIP, (GLsizei)OpenGLRectangle::getAmountOfIndices(), GL_UNSIGNED_INT, 0); addDrawcallStat();
 
-	m_program3dLight.use();
-	mrtFb.useAsInput();
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_ONE, GL_ONE);
-	for (size_t i = 0; i < pointLights.getLength(); i++)
+	if (pointLights.getLength() > 0)
 	{
-		const bbe::PointLight& l = pointLights[i];
-		drawLight(l, false);
+		m_program3dLightClustered.use();
+		mrtFb.useAsInput();
+		uploadLightClusters();
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIbo);
+		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0); addDrawcallStat();
 	}
 
 	m_programPostProcessing.use();
@@ -1427,6 +1696,13 @@ void bbe::INTERNAL::openGl::OpenGLManager::preDraw3D()
 void bbe::INTERNAL::openGl::OpenGLManager::preDraw()
 {
 	flipDrawcallStats();
+	m_amountOfStreamedBytesPreviousFrame = m_vertexStream.ring.getAmountOfStreamedBytes() + m_indexStream.ring.getAmountOfStreamedBytes();
+	m_amountOfVisibleObjects3DPreviousFrame = m_amountOfVisibleObjects3D;
+	m_amountOfCulledObjects3DPreviousFrame = m_amountOfCulledObjects3D;
+	m_amountOfVisibleObjects3D = 0;
+	m_amountOfCulledObjects3D = 0;
+	m_vertexStream.beginFrame();
+	m_indexStream.beginFrame();
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	imguiStartFrame();
 	pointLights.clear();
@@ -1438,9 +1714,22 @@ void bbe::INTERNAL::openGl::OpenGLManager::preDraw()
 
 void bbe::INTERNAL::openGl::OpenGLManager::postDraw()
 {
+	m_primitiveBrush2D.INTERNAL_endDraw();
 	flushInstanceData2D();
 	imguiEndFrame();
+	// The back buffer is undefined after the swap, so it has to be read back before.
+	if (m_pframeCapture || !m_pendingScreenshotPaths.isEmpty())
+	{
+		startCapture();
+	}
+	m_vertexStream.endFrame();
+	m_indexStream.endFrame();
 	glfwSwapBuffers(m_pwindow);
+
+	// Whatever the GPU already finished is handed over without waiting.
+	while (m_amountOfPendingCaptures > 0 && finishOldestCapture(false))
+	{
+	}
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::waitEndDraw()
@@ -1466,7 +1755,7 @@ void bbe::INTERNAL::openGl::OpenGLManager::resize(uint32_t width, uint32_t heigh
 	m_program2d.uniform2f(screenSizePos2d, (float)width, (float)height);
 	m_program2dTex.uniform2f(screenSizePos2dTex, (float)width, (float)height);
 	m_program3dAmbient.uniform2f(screenSizeAmbient, (float)width, (float)height);
-	m_program3dLight.uniform2f(m_program3dLight.screenSize3dLight, (float)width, (float)height);
+	m_program3dLightClustered.uniform2f(m_program3dLightClustered.screenSizePos, (float)width, (float)height);
 	m_programPostProcessing.uniform2f(screenSizePostProcessing, (float)width, (float)height);
 
 	m_windowWidth = width;
@@ -1479,12 +1768,135 @@ void bbe::INTERNAL::openGl::OpenGLManager::resize(uint32_t width, uint32_t heigh
 
 void bbe::INTERNAL::openGl::OpenGLManager::screenshot(const bbe::String& path)
 {
-	// TODO
+	// Taken from the back buffer at the end of the frame that is currently drawn, see postDraw.
+	m_pendingScreenshotPaths.add(path);
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::setVideoRenderingMode(const char* path)
 {
-	// TODO
+	// Unused, Game records videos through captureFrame.
+}
+
+bool bbe::INTERNAL::openGl::OpenGLManager::isFrameCaptureSupported() const
+{
+	return true;
+}
+
+void bbe::INTERNAL::openGl::OpenGLManager::captureFrame(bbe::FrameCapture& capture, uint64_t frameNumber)
+{
+	m_pframeCapture = &capture;
+	m_frameCaptureNumber = frameNumber;
+}
+
+void bbe::INTERNAL::openGl::OpenGLManager::flushFrameCapture()
+{
+	while (m_amountOfPendingCaptures > 0)
+	{
+		finishOldestCapture(true);
+	}
+}
+
+void bbe::INTERNAL::openGl::OpenGLManager::startCapture()
+{
+	if (m_amountOfPendingCaptures == m_amountOfCaptureBuffers)
+	{
+		// The GPU is more than a whole ring behind. Waiting here is what keeps the amount of readbacks bounded.
+		finishOldestCapture(true);
+	}
+
+	CaptureBuffer& buffer = m_captureBuffers[(m_oldestCapture + m_amountOfPendingCaptures) % m_amountOfCaptureBuffers];
+	const size_t size = (size_t)m_windowWidth * m_windowHeight * 4;
+	if (buffer.pbo == 0)
+	{
+		glGenBuffers(1, &buffer.pbo);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+	if (buffer.size != size)
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+		buffer.size = size;
+	}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	// With a pack buffer bound, this only queues the copy and returns immediately.
+	glReadPixels(0, 0, m_windowWidth, m_windowHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	buffer.width = m_windowWidth;
+	buffer.height = m_windowHeight;
+	buffer.frameNumber = m_frameCaptureNumber;
+	buffer.capture = m_pframeCapture;
+	buffer.screenshotPaths = std::move(m_pendingScreenshotPaths);
+	m_amountOfPendingCaptures++;
+
+	m_pframeCapture = nullptr;
+}
+
+bool bbe::INTERNAL::openGl::OpenGLManager::finishOldestCapture(bool wait)
+{
+	CaptureBuffer& buffer = m_captureBuffers[m_oldestCapture];
+	const GLenum result = glClientWaitSync(buffer.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GL_TIMEOUT_IGNORED : 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		return false;
+	}
+	glDeleteSync(buffer.fence);
+	buffer.fence = nullptr;
+
+	bbe::List<bbe::byte> pixels;
+	pixels.resizeCapacityAndLengthUninit(buffer.size);
+	const size_t rowSize = (size_t)buffer.width * 4;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+#ifdef __EMSCRIPTEN__
+	glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, buffer.size, pixels.getRaw());
+	bbe::List<bbe::byte> row;
+	row.resizeCapacityAndLengthUninit(rowSize);
+	for (size_t y = 0; y < buffer.height / 2; y++)
+	{
+		bbe::byte* top = pixels.getRaw() + y * rowSize;
+		bbe::byte* bottom = pixels.getRaw() + (buffer.height - 1 - y) * rowSize;
+		memcpy(row.getRaw(), top, rowSize);
+		memcpy(top, bottom, rowSize);
+		memcpy(bottom, row.getRaw(), rowSize);
+	}
+#else
+	const bbe::byte* mapped = (const bbe::byte*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, buffer.size, GL_MAP_READ_BIT);
+	// GL rows start at the bottom, images at the top.
+	for (size_t y = 0; y < buffer.height; y++)
+	{
+		memcpy(pixels.getRaw() + y * rowSize, mapped + (buffer.height - 1 - y) * rowSize, rowSize);
+	}
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+#endif
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	bbe::Image image(buffer.width, buffer.height, pixels.getRaw(), bbe::ImageFormat::R8G8B8A8);
+	for (size_t i = 0; i < buffer.screenshotPaths.getLength(); i++)
+	{
+		image.writeToFile(buffer.screenshotPaths[i]);
+	}
+	buffer.screenshotPaths.clear();
+	if (buffer.capture)
+	{
+		buffer.capture->submit(buffer.frameNumber, std::move(image));
+		buffer.capture = nullptr;
+	}
+	m_oldestCapture = (m_oldestCapture + 1) % m_amountOfCaptureBuffers;
+	m_amountOfPendingCaptures--;
+	return true;
+}
+
+void bbe::INTERNAL::openGl::OpenGLManager::destroyCaptureBuffers()
+{
+	flushFrameCapture();
+	for (size_t i = 0; i < m_amountOfCaptureBuffers; i++)
+	{
+		if (m_captureBuffers[i].pbo != 0)
+		{
+			glDeleteBuffers(1, &m_captureBuffers[i].pbo);
+		}
+		m_captureBuffers[i] = CaptureBuffer();
+	}
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::setColor2D(const bbe::Color& color)
@@ -1496,7 +1908,7 @@ void bbe::INTERNAL::openGl::OpenGLManager::fillRect2D(const Rectangle& rect, flo
 {
 	if (!shader)
 	{
-		addInstancedData2D(PreviousDrawCall2D::RECT, rect.x, rect.y, rect.width, rect.height, rotation);
+		addInstancedData2D(PreviousDrawCall2D::RECT, rect.x, rect.y, rect.width, rect.height, rotation, m_color2d);
 		return;
 	}
 
@@ -1540,24 +1952,30 @@ void bbe::INTERNAL::openGl::OpenGLManager::fillRect2D(const Rectangle& rect, flo
 
 void bbe::INTERNAL::openGl::OpenGLManager::fillCircle2D(const Circle& circle)
 {
-	addInstancedData2D(PreviousDrawCall2D::CIRCLE, circle.getX(), circle.getY(), circle.getWidth(), circle.getHeight(), 0);
+	addInstancedData2D(PreviousDrawCall2D::CIRCLE, circle.getX(), circle.getY(), circle.getWidth(), circle.getHeight(), 0, m_color2d);
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::drawImage2D(const Rectangle& rect, const Image& image, float rotation)
 {
-	// TODO make proper implementation
+	bbe::DrawCommand2D command;
+	command.type = bbe::DrawCommandType2D::IMAGE;
+	command.color = m_color2d;
+	command.x = rect.x;
+	command.y = rect.y;
+	command.width = rect.width;
+	command.height = rect.height;
+	command.rotation = rotation;
+	command.image = &image;
+	drawImages2D(*toRendererData(image), &command, 1);
+}
+
+void bbe::INTERNAL::openGl::OpenGLManager::drawImages2D(const OpenGLImage& image, const bbe::DrawCommand2D* commands, size_t amountOfCommands)
+{
 	flushInstanceData2D();
 	m_program2dTex.use();
-	m_program2dTex.uniform4f(inColorPos2dTex, m_color2d);
 	previousDrawCall2d = PreviousDrawCall2D::IMAGE;
-	bbe::List<bbe::Vector2> vertices;
-	rect.getVertices(vertices);
-	for (bbe::Vector2& v : vertices)
-	{
-		v = v.rotate(rotation, rect.getCenter());
-	}
 
-	if (image.m_format == ImageFormat::R8)
+	if (image.imageFormat == ImageFormat::R8)
 	{
 		m_program2dTex.uniform1i(swizzleModePos, 1);
 	}
@@ -1566,35 +1984,64 @@ void bbe::INTERNAL::openGl::OpenGLManager::drawImage2D(const Rectangle& rect, co
 		m_program2dTex.uniform1i(swizzleModePos, 0);
 	}
 
-	GLuint vbo = genBuffer("drawImageVBO", BufferTarget::ARRAY_BUFFER, sizeof(bbe::Vector2) * vertices.getLength(), vertices.getRaw());
-	constexpr uint32_t indices[] = { 0, 1, 3, 1, 2, 3 };
-	static GLuint ibo = genBuffer("drawImageIBO", BufferTarget::ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * 6, indices);
-	glBindBuffer((GLenum)BufferTarget::ELEMENT_ARRAY_BUFFER, ibo);
-	//TODO: The ibo is never freed - is that actually bad or does OpenGL clean it up when we remove the context?
+	// All images share the texture, so every quad of the batch goes into one vertex buffer and is drawn at once.
+	constexpr float uvs[] = { 0, 0, 0, 1, 1, 1, 1, 0 };
+	constexpr uint32_t quadIndices[] = { 0, 1, 3, 1, 2, 3 };
+	imageVertices.clear();
+	imageIndices.clear();
+	for (size_t i = 0; i < amountOfCommands; i++)
+	{
+		const bbe::DrawCommand2D& command = commands[i];
+		const bbe::Vector2 corners[] = {
+			{ command.x,                 command.y                  },
+			{ command.x,                 command.y + command.height },
+			{ command.x + command.width, command.y + command.height },
+			{ command.x + command.width, command.y                  },
+		};
+		const bbe::Vector2 center(command.x + command.width / 2, command.y + command.height / 2);
+		const uint32_t firstVertex = (uint32_t)imageVertices.getLength();
+		for (size_t k = 0; k < 4; k++)
+		{
+			ImageVertex2D vertex;
+			vertex.pos = command.rotation == 0 ? corners[k] : corners[k].rotate(command.rotation, center);
+			vertex.uv = bbe::Vector2(command.uvX + uvs[k * 2] * command.uvWidth, command.uvY + uvs[k * 2 + 1] * command.uvHeight);
+			vertex.color = bbe::Vector4(command.color.r, command.color.g, command.color.b, command.color.a);
+			imageVertices.add(vertex);
+		}
+		for (uint32_t index : quadIndices)
+		{
+			imageIndices.add(firstVertex + index);
+		}
+	}
+
+	const size_t vertexOffset = m_vertexStream.upload(imageVertices.getRaw(), sizeof(ImageVertex2D) * imageVertices.getLength());
+	const size_t indexOffset = m_indexStream.upload(imageIndices.getRaw(), sizeof(uint32_t) * imageIndices.getLength());
 
 	glUniform2f(scalePos2dTex, 1.0f, 1.0f);
 
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexStream.buffer);
 	GLint positionAttribute = glGetAttribLocation(m_program2dTex.program, "position");
 	glEnableVertexAttribArray(positionAttribute);
-
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, 0);
+	glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(ImageVertex2D), (const void*)(vertexOffset + 0 * sizeof(float)));
+	glVertexAttribDivisor(positionAttribute, 0);
 
 	GLint uvPosition = glGetAttribLocation(m_program2dTex.program, "uv");
 	glEnableVertexAttribArray(uvPosition);
-	glBindBuffer(GL_ARRAY_BUFFER, m_imageUvBuffer);
-	glVertexAttribPointer(uvPosition, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), 0);
+	glVertexAttribPointer(uvPosition, 2, GL_FLOAT, GL_FALSE, sizeof(ImageVertex2D), (const void*)(vertexOffset + 2 * sizeof(float)));
 	glVertexAttribDivisor(uvPosition, 0);
 
+	GLint colorPosition = glGetAttribLocation(m_program2dTex.program, "color");
+	glEnableVertexAttribArray(colorPosition);
+	glVertexAttribPointer(colorPosition, 4, GL_FLOAT, GL_FALSE, sizeof(ImageVertex2D), (const void*)(vertexOffset + 4 * sizeof(float)));
+	glVertexAttribDivisor(colorPosition, 0);
+
 	glUniform1i(texPos2dTex, 0);
 	glActiveTexture(GL_TEXTURE0);
-	bbe::INTERNAL::openGl::OpenGLImage* ogi = toRendererData(image);
-	glBindTexture(GL_TEXTURE_2D, ogi->tex);
+	glBindTexture(GL_TEXTURE_2D, image.tex);
 
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0); addDrawcallStat();
+	glDrawElements(GL_TRIANGLES, (GLsizei)imageIndices.getLength(), GL_UNSIGNED_INT, (const void*)indexOffset); addDrawcallStat();
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glDeleteBuffers(1, &vbo);
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::fillVertexIndexList2D(const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, size_t amountOfVertices, const bbe::Vector2& p, const bbe::Vector2& scale)
@@ -1603,8 +2050,10 @@ void bbe::INTERNAL::openGl::OpenGLManager::fillVertexIndexList2D(const uint32_t*
 	m_program2d.use();
 
 	previousDrawCall2d = PreviousDrawCall2D::VERTEX_INDEX_LIST;
-	GLuint vbo = genBuffer("fillVertexIndexList2DVBO", BufferTarget::ARRAY_BUFFER, sizeof(bbe::Vector2) * amountOfVertices, vertices);
-	GLuint ibo = genBuffer("fillVertexIndexList2DIBO", BufferTarget::ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * amountOfIndices, indices);
+	// Both uploads have to end up in the same buffer, even if it has to grow.
+	m_vertexStream.reserve(sizeof(bbe::Vector2) * amountOfVertices + sizeof(InstanceData2D) + 16);
+	const size_t vertexOffset = m_vertexStream.upload(vertices, sizeof(bbe::Vector2) * amountOfVertices);
+	const size_t indexOffset = m_indexStream.upload(indices, sizeof(uint32_t) * amountOfIndices);
 
 	InstanceData2D instanceData2D;
 	instanceData2D.scalePosOffset.x = scale.x;
@@ -1617,36 +2066,75 @@ void bbe::INTERNAL::openGl::OpenGLManager::fillVertexIndexList2D(const uint32_t*
 	instanceData2D.color.z = m_color2d.b;
 	instanceData2D.color.w = m_color2d.a;
 
-	GLuint instanceVBO = genBuffer("fillVertexIndexList2DInstanceVBO", BufferTarget::ARRAY_BUFFER, sizeof(InstanceData2D), &instanceData2D);
+	const size_t instanceOffset = m_vertexStream.upload(&instanceData2D, sizeof(InstanceData2D));
 
 	GLint pos = 1;
 	glEnableVertexAttribArray(pos);
-	glVertexAttribPointer(pos, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(0 * sizeof(float)));
+	glVertexAttribPointer(pos, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(instanceOffset + 0 * sizeof(float)));
 	glVertexAttribDivisor(pos, 1);
 	pos = 2;
 	glEnableVertexAttribArray(pos);
-	glVertexAttribPointer(pos, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(4 * sizeof(float)));
+	glVertexAttribPointer(pos, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(instanceOffset + 4 * sizeof(float)));
 	glVertexAttribDivisor(pos, 1);
 	pos = 3;
 	glEnableVertexAttribArray(pos);
-	glVertexAttribPointer(pos, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(5 * sizeof(float)));
+	glVertexAttribPointer(pos, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData2D), (const void*)(instanceOffset + 5 * sizeof(float)));
 	glVertexAttribDivisor(pos, 1);
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
 	GLint positionAttribute = glGetAttribLocation(m_program2d.program, "position");
 	glEnableVertexAttribArray(positionAttribute);
 
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, 0);
+	glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, (const void*)vertexOffset);
 	glVertexAttribDivisor(positionAttribute, 0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)amountOfIndices, GL_UNSIGNED_INT, 0, 1); addDrawcallStat();
+	glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)amountOfIndices, GL_UNSIGNED_INT, (const void*)indexOffset, 1); addDrawcallStat();
+}
 
-	glDeleteBuffers(1, &instanceVBO);
-	glDeleteBuffers(1, &ibo);
-	glDeleteBuffers(1, &vbo);
+bool bbe::INTERNAL::openGl::OpenGLManager::isImageRegionSupported2D() const
+{
+	return true;
+}
+
+bool bbe::INTERNAL::openGl::OpenGLManager::retainImage2D(const bbe::Image& image, bbe::AutoRef& imageData)
+{
+	// The texture is uploaded right away and outlives the image until the command is cleared.
+	imageData = toRendererData(image);
+	return true;
+}
+
+void bbe::INTERNAL::openGl::OpenGLManager::submit2D(const bbe::CommandBuffer2D& commandBuffer)
+{
+	const bbe::List<bbe::DrawCommand2D>& commands = commandBuffer.getCommands();
+	const bbe::List<bbe::DrawBatch2D>& batches = commandBuffer.getBatches();
+	for (size_t i = 0; i < batches.getLength(); i++)
+	{
+		const bbe::DrawBatch2D& batch = batches[i];
+		const bbe::DrawCommand2D* batchCommands = commands.getRaw() + batch.firstCommand;
+		if (batch.type == bbe::DrawCommandType2D::RECT || batch.type == bbe::DrawCommandType2D::CIRCLE)
+		{
+			const PreviousDrawCall2D type = batch.type == bbe::DrawCommandType2D::RECT ? PreviousDrawCall2D::RECT : PreviousDrawCall2D::CIRCLE;
+			for (size_t k = 0; k < batch.amountOfCommands; k++)
+			{
+				const bbe::DrawCommand2D& command = batchCommands[k];
+				addInstancedData2D(type, command.x, command.y, command.width, command.height, command.rotation, command.color);
+			}
+		}
+		else if (batch.type == bbe::DrawCommandType2D::IMAGE)
+		{
+			drawImages2D(*(const bbe::INTERNAL::openGl::OpenGLImage*)batch.imageData, batchCommands, batch.amountOfCommands);
+		}
+		else if (batch.type == bbe::DrawCommandType2D::VERTEX_INDEX_LIST)
+		{
+			const bbe::DrawCommand2D& command = batchCommands[0];
+			m_color2d = command.color;
+			fillVertexIndexList2D(
+				commandBuffer.getIndices().getRaw() + command.firstIndex, command.amountOfIndices,
+				commandBuffer.getVertices().getRaw() + command.firstVertex, command.amountOfVertices,
+				bbe::Vector2(command.x, command.y), bbe::Vector2(command.width, command.height));
+		}
+	}
+	flushInstanceData2D();
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::setColor3D(const bbe::Color& color)
@@ -1664,27 +2152,205 @@ void bbe::INTERNAL::openGl::OpenGLManager::setCamera3D(const Vector3& cameraPos,
 	m_program3dMrt.uniformMatrix4fv(m_program3dMrt.projectionPos3dMrt, GL_FALSE, projection);
 	m_program3dForwardNoLight.uniformMatrix4fv(m_program3dForwardNoLight.viewPos3dMrt, GL_FALSE, view);
 	m_program3dForwardNoLight.uniformMatrix4fv(m_program3dForwardNoLight.projectionPos3dMrt, GL_FALSE, projection);
-	m_program3dLight.uniformMatrix4fv(m_program3dLight.projectionPos3dLight, GL_FALSE, projection);
 	m_view = view;
 	m_projection = projection;
 	m_cameraPos = cameraPos;
+
+	// Everything that was batched so far was submitted for the previous camera.
+	flushInstances3D();
+	m_program3dMrtInstanced.uniformMatrix4fv(m_program3dMrtInstanced.viewPos3dMrt, GL_FALSE, view);
+	m_program3dMrtInstanced.uniformMatrix4fv(m_program3dMrtInstanced.projectionPos3dMrt, GL_FALSE, projection);
+	m_program3dForwardNoLightInstanced.uniformMatrix4fv(m_program3dForwardNoLightInstanced.viewPos3dMrt, GL_FALSE, view);
+	m_program3dForwardNoLightInstanced.uniformMatrix4fv(m_program3dForwardNoLightInstanced.projectionPos3dMrt, GL_FALSE, projection);
+	m_viewFrustum.updatePlanes(projection * view);
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::fillCube3D(const Cube& cube)
+{
+	addInstance3D(cube.getTransform(), bbe::Vector3(0), bbe::Vector3(0.5f), OpenGLCube::getVbo(), OpenGLCube::getIbo(), OpenGLCube::getAmountOfIndices(), nullptr);
+}
+
+void bbe::INTERNAL::openGl::OpenGLManager::fillCubeImmediately3D(const Cube& cube)
 {
 	fillInternalMesh(&cube.getTransform()[0], OpenGLCube::getIbo(), OpenGLCube::getVbo(), OpenGLCube::getAmountOfIndices(), nullptr, nullptr, nullptr, nullptr, getModeFramebuffer(), false, bbe::Color::white());
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::fillSphere3D(const IcoSphere& sphere)
 {
-	fillInternalMesh(&sphere.getTransform()[0], OpenGLSphere::getIbo(), OpenGLSphere::getVbo(), OpenGLSphere::getAmountOfIndices(), nullptr, nullptr, nullptr, nullptr, getModeFramebuffer(), false, bbe::Color::white());
+	addInstance3D(sphere.getTransform(), bbe::Vector3(0), bbe::Vector3(0.5f), OpenGLSphere::getVbo(), OpenGLSphere::getIbo(), OpenGLSphere::getAmountOfIndices(), nullptr);
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::fillModel(const bbe::Matrix4& transform, const Model& model, const Image* albedo, const Image* normals, const Image* emissions, const FragmentShader* shader)
 {
+	if (albedo == nullptr && normals == nullptr && emissions == nullptr && shader == nullptr)
+	{
+		bbe::INTERNAL::openGl::OpenGLModel* ogm = nullptr;
+		if (model.m_prendererData == nullptr)
+		{
+			ogm = new bbe::INTERNAL::openGl::OpenGLModel(model);
+		}
+		else
+		{
+			ogm = (bbe::INTERNAL::openGl::OpenGLModel*)model.m_prendererData.get();
+		}
+		addInstance3D(transform, ogm->getBoundsCenter(), ogm->getBoundsHalfExtent(), ogm->getVbo(), ogm->getIbo(), ogm->getAmountOfIndices(), ogm);
+		return;
+	}
 	fillModel(transform, model, albedo, normals, emissions, shader, getModeFramebuffer(), false, bbe::Color::white());
 }
 
+void bbe::INTERNAL::openGl::OpenGLManager::addInstance3D(const bbe::Matrix4& transform, const bbe::Vector3& boundsCenter, const bbe::Vector3& boundsHalfExtent, GLuint vbo, GLuint ibo, size_t amountOfIndices, bbe::AutoRefCountable* mesh)
+{
+	if (!m_viewFrustum.isAabbVisible(transform, boundsCenter, boundsHalfExtent))
+	{
+		m_amountOfCulledObjects3D++;
+		return;
+	}
+	m_amountOfVisibleObjects3D++;
+
+	// Batches are kept over frames so that their instance lists don't have to be reallocated. Empty ones are free.
+	InstanceBatch3D* batch = nullptr;
+	InstanceBatch3D* unusedBatch = nullptr;
+	for (size_t i = 0; i < m_instanceBatches3D.getLength(); i++)
+	{
+		InstanceBatch3D& b = m_instanceBatches3D[i];
+		if (b.instances.isEmpty())
+		{
+			if (unusedBatch == nullptr) unusedBatch = &b;
+		}
+		else if (b.vbo == vbo)
+		{
+			batch = &b;
+			break;
+		}
+	}
+	if (batch == nullptr)
+	{
+		if (unusedBatch == nullptr)
+		{
+			m_instanceBatches3D.add(InstanceBatch3D());
+			unusedBatch = &m_instanceBatches3D.last();
+		}
+		batch = unusedBatch;
+		batch->mesh = mesh;
+		batch->vbo = vbo;
+		batch->ibo = ibo;
+		batch->amountOfIndices = amountOfIndices;
+	}
+
+	InstanceData3D instance;
+	instance.model = transform;
+	instance.color = bbe::Vector4(m_color3d.r, m_color3d.g, m_color3d.b, m_color3d.a);
+	batch->instances.add(instance);
+}
+
+void bbe::INTERNAL::openGl::OpenGLManager::flushInstances3D()
+{
+	MrtProgram* program = nullptr;
+	     if (m_renderMode == bbe::RenderMode::DEFERRED)          program = &m_program3dMrtInstanced;
+	else if (m_renderMode == bbe::RenderMode::FORWARD_NO_LIGHTS) program = &m_program3dForwardNoLightInstanced;
+	else bbe::Crash(bbe::Error::IllegalState);
+
+	bool prepared = false;
+	GLint modelAttribute = -1;
+	GLint colorAttribute = -1;
+	for (size_t i = 0; i < m_instanceBatches3D.getLength(); i++)
+	{
+		InstanceBatch3D& batch = m_instanceBatches3D[i];
+		if (batch.instances.isEmpty()) continue;
+
+		if (!prepared)
+		{
+			prepared = true;
+			program->use();
+			glBindFramebuffer(GL_FRAMEBUFFER, getModeFramebuffer());
+
+			glUniform1i(program->albedoTexMrt, 0);
+			glActiveTexture(GL_TEXTURE0 + 0);
+			glBindTexture(GL_TEXTURE_2D, toRendererData(bbe::Image::white())->tex);
+
+			glUniform1i(program->normalsTexMrt, 1);
+			glActiveTexture(GL_TEXTURE0 + 1);
+			glBindTexture(GL_TEXTURE_2D, toRendererData(bbe::Image::black())->tex);
+
+			glUniform1i(program->emissionsTexMrt, 2);
+			glActiveTexture(GL_TEXTURE0 + 2);
+			glBindTexture(GL_TEXTURE_2D, toRendererData(bbe::Image::black())->tex);
+
+			modelAttribute = glGetAttribLocation(program->program, "inModel");
+			colorAttribute = glGetAttribLocation(program->program, "inInstanceColor");
+		}
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.ibo);
+		glBindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+		GLint positionAttribute = glGetAttribLocation(program->program, "inPos");
+		if (positionAttribute != -1)
+		{
+			glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 0);
+			glEnableVertexAttribArray(positionAttribute);
+			glVertexAttribDivisor(positionAttribute, 0);
+		}
+
+		GLint normalPosition = glGetAttribLocation(program->program, "inNormal");
+		if (normalPosition != -1)
+		{
+			glVertexAttribPointer(normalPosition, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)(3 * sizeof(float)));
+			glEnableVertexAttribArray(normalPosition);
+			glVertexAttribDivisor(normalPosition, 0);
+		}
+
+		GLint uvPosition = glGetAttribLocation(program->program, "inUvCoord");
+		if (uvPosition != -1)
+		{
+			glVertexAttribPointer(uvPosition, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)(6 * sizeof(float)));
+			glEnableVertexAttribArray(uvPosition);
+			glVertexAttribDivisor(uvPosition, 0);
+		}
+
+		const size_t offset = m_vertexStream.upload(batch.instances.getRaw(), sizeof(InstanceData3D) * batch.instances.getLength());
+		if (modelAttribute != -1)
+		{
+			// A mat4 attribute takes up one location per column.
+			for (GLint column = 0; column < 4; column++)
+			{
+				glVertexAttribPointer(modelAttribute + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData3D), (const void*)(offset + offsetof(InstanceData3D, model) + column * sizeof(bbe::Vector4)));
+				glEnableVertexAttribArray(modelAttribute + column);
+				glVertexAttribDivisor(modelAttribute + column, 1);
+			}
+		}
+		if (colorAttribute != -1)
+		{
+			glVertexAttribPointer(colorAttribute, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData3D), (const void*)(offset + offsetof(InstanceData3D, color)));
+			glEnableVertexAttribArray(colorAttribute);
+			glVertexAttribDivisor(colorAttribute, 1);
+		}
+
+		glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)batch.amountOfIndices, GL_UNSIGNED_INT, 0, (GLsizei)batch.instances.getLength()); addDrawcallStat();
+
+		batch.instances.clear();
+		batch.mesh = nullptr;
+	}
+
+	if (prepared)
+	{
+		// Other programs must not see the per instance arrays.
+		if (modelAttribute != -1)
+		{
+			for (GLint column = 0; column < 4; column++)
+			{
+				glVertexAttribDivisor(modelAttribute + column, 0);
+				glDisableVertexAttribArray(modelAttribute + column);
+			}
+		}
+		if (colorAttribute != -1)
+		{
+			glVertexAttribDivisor(colorAttribute, 0);
+			glDisableVertexAttribArray(colorAttribute);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
 struct OcclusionQuery : public bbe::DataProvider<bool>
 {
 	GLuint id = 0;
@@ -1695,7 +2361,7 @@ struct OcclusionQuery : public bbe::DataProvider<bool>
 		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
 		glDepthMask(GL_FALSE);
 		glStencilMask(GL_FALSE);
-		manager->fillCube3D(cube);
+		manager->fillCubeImmediately3D(cube);
 		glStencilMask(GL_TRUE);
 		glDepthMask(GL_TRUE);
 		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
@@ -1723,11 +2389,17 @@ struct OcclusionQuery : public bbe::DataProvider<bool>
 
 bbe::Future<bool> bbe::INTERNAL::openGl::OpenGLManager::isCubeVisible(const Cube& cube)
 {
+	// The query has to be tested against everything that was submitted before it.
+	flushInstances3D();
 	return bbe::Future<bool>(new OcclusionQuery(this, cube));
 }
 
 void bbe::INTERNAL::openGl::OpenGLManager::setRenderMode(bbe::RenderMode renderMode)
 {
+	if (renderMode != m_renderMode)
+	{
+		flushInstances3D();
+	}
 	m_renderMode = renderMode;
 }
 
@@ -1865,7 +2537,7 @@ void bbe::INTERNAL::openGl::OpenGLManager::bakeLight(bbe::LightBaker& lightBaker
 	glBlendFunc(GL_ONE, GL_ONE);
 	PointLight copy = light;
 	copy.pos -= lightBaker.m_lightOffset;
-	drawLight(copy, true, quadIbo);
+	drawLight(copy, quadIbo);
 	lightBaker.m_amountOfBakedLights++;
 
 	glViewport(0, 0, m_windowWidth, m_windowHeight);
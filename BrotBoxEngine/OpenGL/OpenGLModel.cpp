@@ -1,4 +1,5 @@
 #include "BBE/OpenGL/OpenGLModel.h"
+#include "BBE/Math.h"
 
 bbe::INTERNAL::openGl::OpenGLModel::OpenGLModel(const bbe::Model& model)
 {
@@ -17,6 +18,20 @@ bbe::INTERNAL::openGl::OpenGLModel::OpenGLModel(const bbe::Model& model)
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
 	m_amountOfIndices = indices.getLength();
+
+	if (vertices.getLength() > 0)
+	{
+		bbe::Vector3 min = vertices[0].pos;
+		bbe::Vector3 max = vertices[0].pos;
+		for (size_t i = 1; i < vertices.getLength(); i++)
+		{
+			const bbe::Vector3& pos = vertices[i].pos;
+			min = bbe::Vector3(bbe::Math::min(min.x, pos.x), bbe::Math::min(min.y, pos.y), bbe::Math::min(min.z, pos.z));
+			max = bbe::Vector3(bbe::Math::max(max.x, pos.x), bbe::Math::max(max.y, pos.y), bbe::Math::max(max.z, pos.z));
+		}
+		m_boundsCenter = (min + max) * 0.5f;
+		m_boundsHalfExtent = (max - min) * 0.5f;
+	}
 }
 
 bbe::INTERNAL::openGl::OpenGLModel::~OpenGLModel()
@@ -39,3 +54,13 @@ size_t bbe::INTERNAL::openGl::OpenGLModel::getAmountOfIndices()
 {
 	return m_amountOfIndices;
 }
+
+const bbe::Vector3& bbe::INTERNAL::openGl::OpenGLModel::getBoundsCenter() const
+{
+	return m_boundsCenter;
+}
+
+const bbe::Vector3& bbe::INTERNAL::openGl::OpenGLModel::getBoundsHalfExtent() const
+{
+	return m_boundsHalfExtent;
+}
@@ -22,36 +22,80 @@ void bbe::PrimitiveBrush2D::INTERNAL_beginDraw(
 	m_screenWidth = width;
 	m_screenHeight = height;
 	m_prenderManager = renderManager;
+	m_commandBuffer.clear();
 
 	setColorRGB(1.0f, 1.0f, 1.0f, 1.0f);
 	setOutlineRGB(1.0f, 1.0f, 1.0f, 1.0f);
 	setOutlineWidth(0.f);
+	setLayer(0);
+	setReorderWithinLayers(false);
 
 	glfwWrapper::glfwGetWindowContentScale(window, &m_windowXScale, &m_windowYScale);
 }
 
+void bbe::PrimitiveBrush2D::INTERNAL_endDraw()
+{
+	INTERNAL_flush();
+}
+
+void bbe::PrimitiveBrush2D::INTERNAL_flush()
+{
+	if (m_commandBuffer.isEmpty()) return;
+	m_commandBuffer.sortAndMerge();
+	m_prenderManager->submit2D(m_commandBuffer);
+	m_commandBuffer.clear();
+}
+
 void bbe::PrimitiveBrush2D::INTERNAL_fillRect(const Rectangle &rect, float rotation, float outlineWidth, FragmentShader* shader)
 {
 	const Rectangle localRect = rect.offset(m_offset).stretchedSpace(m_windowXScale, m_windowYScale);
 
+	if (shader)
+	{
+		// The uniforms of the shader are set right away, so the rect can't wait for the command buffer.
+		INTERNAL_flush();
+		if (outlineWidth > 0)
+		{
+			m_prenderManager->setColor2D(m_outlineColor);
+			m_prenderManager->fillRect2D(localRect, rotation, shader);
+			m_prenderManager->setColor2D(m_color);
+			m_prenderManager->fillRect2D(localRect.shrinked(outlineWidth), rotation, shader);
+		}
+		else
+		{
+			m_prenderManager->setColor2D(m_color);
+			m_prenderManager->fillRect2D(localRect, rotation, shader);
+		}
+		return;
+	}
+
 	if (outlineWidth > 0)
 	{
-		Color oldColor = m_color;
-		setColorRGB(m_outlineColor);
-		m_prenderManager->fillRect2D(localRect, rotation, shader);
-		setColorRGB(oldColor);
-		m_prenderManager->fillRect2D(localRect.shrinked(outlineWidth), rotation, shader);
+		m_commandBuffer.addRect(m_layer, m_outlineColor, localRect, rotation);
+		m_commandBuffer.addRect(m_layer, m_color, localRect.shrinked(outlineWidth), rotation);
 	}
 	else
 	{
-		m_prenderManager->fillRect2D(localRect, rotation, shader);
+		m_commandBuffer.addRect(m_layer, m_color, localRect, rotation);
 	}
 }
 
 void bbe::PrimitiveBrush2D::INTERNAL_drawImage(const Rectangle & rect, const Image & image, float rotation)
+{
+	INTERNAL_drawImage(rect, image, rotation, Rectangle(0, 0, 1, 1));
+}
+
+void bbe::PrimitiveBrush2D::INTERNAL_drawImage(const Rectangle & rect, const Image & image, float rotation, const Rectangle & uv)
 {
 	if (image.getWidth() == 0 || image.getHeight() == 0) return;
-	m_prenderManager->drawImage2D(rect.offset(m_offset).stretchedSpace(m_windowXScale, m_windowYScale), image, rotation);
+	bbe::AutoRef imageData;
+	const bool retained = m_prenderManager->retainImage2D(image, imageData);
+	m_commandBuffer.addImage(m_layer, m_color, rect.offset(m_offset).stretchedSpace(m_windowXScale, m_windowYScale), image, imageData, rotation, uv);
+	if (!retained)
+	{
+		// The backend reads the image on submission, but the caller may destroy it as soon as this returns.
+		INTERNAL_flush();
+	}
 }
 
 void bbe::PrimitiveBrush2D::INTERNAL_fillCircle(const Circle & circle, float outlineWidth)
@@ -60,26 +104,18 @@ void bbe::PrimitiveBrush2D::INTERNAL_fillCircle(const Circle & circle, float out
 
 	if (outlineWidth > 0)
 	{
-		Color oldColor = m_color;
-		setColorRGB(m_outlineColor);
-		m_prenderManager->fillCircle2D(localCircle);
-		setColorRGB(oldColor);
-		m_prenderManager->fillCircle2D(localCircle.shrinked(outlineWidth));
+		m_commandBuffer.addCircle(m_layer, m_outlineColor, localCircle);
+		m_commandBuffer.addCircle(m_layer, m_color, localCircle.shrinked(outlineWidth));
 	}
 	else
 	{
-		m_prenderManager->fillCircle2D(localCircle);
+		m_commandBuffer.addCircle(m_layer, m_color, localCircle);
 	}
 }
 
 void bbe::PrimitiveBrush2D::INTERNAL_setColor(float r, float g, float b, float a)
 {
-	Color newColor(r, g, b, a);
-	if (newColor.r != m_color.r || newColor.g != m_color.g || newColor.b != m_color.b || newColor.a != m_color.a)
-	{
-		m_color = newColor;
-		m_prenderManager->setColor2D(newColor);
-	}
+	m_color = Color(r, g, b, a);
 }
 
 struct Hasher
@@ -376,8 +412,18 @@ void bbe::PrimitiveBrush2D::fillChar(float x, float y, int32_t c, const bbe::Fon
 void bbe::PrimitiveBrush2D::fillChar(const Vector2& p, int32_t c, const bbe::Font& font, float rotation)
 {
 	if (c == ' ' || c == '\n' || c == '\r' || c == '\t') return;
-	const bbe::Image& charImage = font.getImage(c, m_windowXScale);
-	drawImage(p, font.getDimensions(c).as<float>(), charImage, rotation);
+	const bbe::Rectangle rect = bbe::Rectangle(p, font.getDimensions(c).as<float>());
+	if (m_prenderManager->isImageRegionSupported2D())
+	{
+		// All glyphs of a font share a few atlas pages, so a whole text run merges into one batch per page.
+		const bbe::Font::AtlasRegion region = font.getAtlasRegion(c, m_windowXScale);
+		if (region.page == nullptr) return;
+		INTERNAL_drawImage(rect, *region.page, rotation, region.uv);
+	}
+	else
+	{
+		drawImage(rect, font.getImage(c, m_windowXScale), rotation);
+	}
 }
 
 void bbe::PrimitiveBrush2D::fillChar(float x, float y, int32_t c, unsigned fontSize, const bbe::String& fontName, float rotation)
@@ -414,27 +460,27 @@ void bbe::PrimitiveBrush2D::fillLine(const Line2& line, float lineWidth)
 	fillLine(line.m_start, line.m_stop, lineWidth);
 }
 
-void bbe::PrimitiveBrush2D::fillLineStrip(const bbe::List<bbe::Vector2>& points, bool closed, float lineWidth)
+void bbe::PrimitiveBrush2D::fillLineStrip(const bbe::Vector2* points, size_t amountOfPoints, bool closed, float lineWidth)
 {
-	for (size_t i = 1; i < points.getLength(); i++)
+	for (size_t i = 1; i < amountOfPoints; i++)
 	{
 		fillLine(points[i - 1], points[i], lineWidth);
 	}
-	if (closed && points.getLength() > 0)
+	if (closed && amountOfPoints > 0)
 	{
-		fillLine(points[0], points[points.getLength() - 1], lineWidth);
+		fillLine(points[0], points[amountOfPoints - 1], lineWidth);
 	}
 }
 
-void bbe::PrimitiveBrush2D::fillLineStrip(const bbe::List<bbe::Vector2d>& points, bool closed, float lineWidth)
+void bbe::PrimitiveBrush2D::fillLineStrip(const bbe::Vector2d* points, size_t amountOfPoints, bool closed, float lineWidth)
 {
-	for (size_t i = 1; i < points.getLength(); i++)
+	for (size_t i = 1; i < amountOfPoints; i++)
 	{
 		fillLine(points[i - 1].as<float>(), points[i].as<float>(), lineWidth);
 	}
-	if (closed && points.getLength() > 0)
+	if (closed && amountOfPoints > 0)
 	{
-		fillLine(points[0].as<float>(), points[points.getLength() - 1].as<float>(), lineWidth);
+		fillLine(points[0].as<float>(), points[amountOfPoints - 1].as<float>(), lineWidth);
 	}
 }
 
@@ -476,8 +522,8 @@ void bbe::PrimitiveBrush2D::fillText(const Vector2& p, const char* text, Anchor
 		else
 		{
 			currentPosition.x += font.getLeftSideBearing(*text);
-			const bbe::Image& charImage = font.getImage(*text, m_windowXScale);
-			fillChar((bbe::Vector2(currentPosition.x, currentPosition.y + font.getVerticalOffset(*text)) + charImage.getDimensions().as<float>() / 2).rotate(rotation, p) - charImage.getDimensions().as<float>() / 2, *text, font, rotation);
+			const bbe::Vector2 dimensions = font.getDimensions(*text).as<float>();
+			fillChar((bbe::Vector2(currentPosition.x, currentPosition.y + font.getVerticalOffset(*text)) + dimensions / 2).rotate(rotation, p) - dimensions / 2, *text, font, rotation);
 			currentPosition.x += font.getAdvanceWidth(*text);
 		}
 
@@ -614,8 +660,30 @@ void bbe::PrimitiveBrush2D::setOutlineWidth(float outlineWidht)
 	m_outlineWidth = outlineWidht;
 }
 
+void bbe::PrimitiveBrush2D::setLayer(int32_t layer)
+{
+	m_layer = layer;
+}
+
+int32_t bbe::PrimitiveBrush2D::getLayer() const
+{
+	return m_layer;
+}
+
+void bbe::PrimitiveBrush2D::setReorderWithinLayers(bool reorder)
+{
+	m_commandBuffer.setReorderWithinLayers(reorder);
+}
+
+bool bbe::PrimitiveBrush2D::isReorderWithinLayers() const
+{
+	return m_commandBuffer.isReorderWithinLayers();
+}
+
 void bbe::PrimitiveBrush2D::setFillMode(FillMode fm)
 {
+	// Everything that was recorded so far still has to be drawn with the old fill mode.
+	INTERNAL_flush();
 	m_prenderManager->setFillMode2D(fm);
 }
 
@@ -631,5 +699,5 @@ void bbe::PrimitiveBrush2D::fillVertexIndexList(const bbe::List<uint32_t>& indic
 
 void bbe::PrimitiveBrush2D::fillVertexIndexList(const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, size_t amountOfVertices)
 {
-	m_prenderManager->fillVertexIndexList2D(indices, amountOfIndices, vertices, amountOfVertices, m_offset, { m_windowXScale, m_windowYScale });
+	m_commandBuffer.addVertexIndexList(m_layer, m_color, indices, amountOfIndices, vertices, amountOfVertices, m_offset, { m_windowXScale, m_windowYScale });
 }
@@ -9,6 +9,9 @@
 #ifdef BBE_RENDERER_OPENGL
 #include "BBE/OpenGL/OpenGLManager.h"
 #endif
+#ifdef BBE_RENDERER_SOFTWARE
+#include "BBE/SoftwareRenderer/SoftwareRendererManager.h"
+#endif
 
 void bbe::PrimitiveBrush3D::INTERNAL_setColor(float r, float g, float b, float a, bool force)
 {
@@ -190,6 +193,18 @@ bbe::Image bbe::PrimitiveBrush3D::bakeLightDetach(bbe::LightBaker& lightBaker)
 }
 #endif
 
+#ifdef BBE_RENDERER_SOFTWARE
+void bbe::PrimitiveBrush3D::fillRectangle(const bbe::Matrix4& transform)
+{
+	fillModel(transform, m_rectangle);
+}
+
+void bbe::PrimitiveBrush3D::fillModel(const bbe::Matrix4& transform, const bbe::Model& model)
+{
+	((bbe::INTERNAL::softwareRenderer::SoftwareRendererManager*)m_prenderManager)->fillModel3D(transform, model);
+}
+#endif
+
 void bbe::PrimitiveBrush3D::setColor(float r, float g, float b, float a)
 {
 	INTERNAL_setColor(r, g, b, a, false);
@@ -0,0 +1,297 @@
+#include "BBE/Profiler.h"
+#include "BBE/SimpleFile.h"
+#include "BBE/Math.h"
+#include "BBE/Error.h"
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+	// The fields are atomics so that collectZones may read a slot while its thread overwrites it. Such slots are
+	// detected afterwards by looking at the write counter and dropped.
+	struct Slot
+	{
+		std::atomic<const char*> name = nullptr;
+		std::atomic<int64_t> startNanos = 0;
+		std::atomic<int64_t> durationNanos = 0;
+		std::atomic<uint32_t> depth = 0;
+	};
+
+	struct OpenZone
+	{
+		const char* name;
+		int64_t startNanos;
+	};
+
+	struct ThreadBuffer
+	{
+		Slot slots[bbe::profiler::INTERNAL::ZONES_PER_THREAD];
+		std::atomic<uint64_t> written = 0;
+		std::atomic<uint64_t> clearedUntil = 0;
+		std::atomic<const char*> name = nullptr;
+		std::atomic_bool inUse = true;
+
+		// Only touched by the owning thread.
+		OpenZone openZones[bbe::profiler::INTERNAL::MAX_DEPTH];
+		uint32_t depth = 0;
+	};
+
+	struct CurrentBuffer
+	{
+		ThreadBuffer* buffer = nullptr;
+		bool outOfBuffers = false;
+		const char* name = nullptr;
+
+		~CurrentBuffer()
+		{
+			if (buffer)
+			{
+				buffer->depth = 0;
+				buffer->inUse = false;
+			}
+		}
+	};
+}
+
+// Buffers are never freed, as threads may still record zones while static objects are destroyed. Instead, the buffer
+// of a thread that ended is handed to the next new thread, so short lived threads can't use up all of them.
+static std::atomic<ThreadBuffer*> threadBuffers[bbe::profiler::INTERNAL::MAX_AMOUNT_OF_THREADS] = {};
+static std::atomic<uint32_t> amountOfThreads = 0;
+static thread_local CurrentBuffer current;
+
+static std::chrono::steady_clock::time_point getEpoch()
+{
+	static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+	return epoch;
+}
+
+static ThreadBuffer* getCurrentBuffer()
+{
+	if (current.buffer || current.outOfBuffers) return current.buffer;
+
+	const uint32_t amount = bbe::Math::min<uint32_t>(amountOfThreads.load(), bbe::profiler::INTERNAL::MAX_AMOUNT_OF_THREADS);
+	for (uint32_t i = 0; i < amount; i++)
+	{
+		ThreadBuffer* buffer = threadBuffers[i].load(std::memory_order_acquire);
+		bool expected = false;
+		if (buffer && buffer->inUse.compare_exchange_strong(expected, true))
+		{
+			buffer->name = current.name;
+			current.buffer = buffer;
+			return buffer;
+		}
+	}
+
+	const uint32_t index = amountOfThreads.fetch_add(1);
+	if (index >= bbe::profiler::INTERNAL::MAX_AMOUNT_OF_THREADS)
+	{
+		amountOfThreads--;
+		current.outOfBuffers = true;
+		return nullptr;
+	}
+	current.buffer = new ThreadBuffer();
+	current.buffer->name = current.name;
+	threadBuffers[index].store(current.buffer, std::memory_order_release);
+	return current.buffer;
+}
+
+static void writeSlot(ThreadBuffer* buffer, const char* name, int64_t startNanos, int64_t endNanos, uint32_t depth)
+{
+	const uint64_t written = buffer->written.load(std::memory_order_relaxed);
+	Slot& slot = buffer->slots[written % bbe::profiler::INTERNAL::ZONES_PER_THREAD];
+	// A reader that sees any of the following stores must also see the previous increment of written, otherwise it
+	// can't tell that it copied a slot that was being overwritten.
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.startNanos.store(startNanos, std::memory_order_relaxed);
+	slot.durationNanos.store(endNanos - startNanos, std::memory_order_relaxed);
+	slot.depth.store(depth, std::memory_order_relaxed);
+	buffer->written.store(written + 1, std::memory_order_release);
+}
+
+void bbe::profiler::setEnabled(bool enabled)
+{
+	INTERNAL::enabled = enabled;
+}
+
+bool bbe::profiler::isEnabled()
+{
+	return INTERNAL::enabled;
+}
+
+int64_t bbe::profiler::getTimeNanos()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - getEpoch()).count();
+}
+
+void bbe::profiler::setThreadName(const char* name)
+{
+	// The buffer is only taken once the thread records its first zone, so threads that never do don't cost one.
+	current.name = name;
+	if (current.buffer) current.buffer->name = name;
+}
+
+bool bbe::profiler::beginZone(const char* name, bool force)
+{
+	if (!force && !INTERNAL::enabled.load(std::memory_order_relaxed)) return false;
+	ThreadBuffer* buffer = getCurrentBuffer();
+	if (!buffer || buffer->depth >= INTERNAL::MAX_DEPTH) return false;
+
+	buffer->openZones[buffer->depth] = { name, getTimeNanos() };
+	buffer->depth++;
+	return true;
+}
+
+void bbe::profiler::endZone()
+{
+	const int64_t endNanos = getTimeNanos();
+	ThreadBuffer* buffer = current.buffer;
+	if (!buffer || buffer->depth == 0)
+	{
+		bbe::Crash(bbe::Error::IllegalState, "endZone without beginZone");
+	}
+	buffer->depth--;
+	const OpenZone& zone = buffer->openZones[buffer->depth];
+	writeSlot(buffer, zone.name, zone.startNanos, endNanos, buffer->depth);
+}
+
+void bbe::profiler::recordZone(const char* name, int64_t startNanos, int64_t endNanos, bool force)
+{
+	if (!force && !INTERNAL::enabled.load(std::memory_order_relaxed)) return;
+	ThreadBuffer* buffer = getCurrentBuffer();
+	if (!buffer) return;
+	writeSlot(buffer, name, startNanos, endNanos, buffer->depth);
+}
+
+void bbe::profiler::clear()
+{
+	const uint32_t amount = bbe::Math::min<uint32_t>(amountOfThreads.load(), INTERNAL::MAX_AMOUNT_OF_THREADS);
+	for (uint32_t i = 0; i < amount; i++)
+	{
+		ThreadBuffer* buffer = threadBuffers[i].load(std::memory_order_acquire);
+		if (!buffer) continue;
+		buffer->clearedUntil = buffer->written.load(std::memory_order_acquire);
+	}
+}
+
+bbe::List<bbe::profiler::ZoneRecord> bbe::profiler::collectZones()
+{
+	bbe::List<ZoneRecord> retVal;
+	const uint32_t amount = bbe::Math::min<uint32_t>(amountOfThreads.load(), INTERNAL::MAX_AMOUNT_OF_THREADS);
+	for (uint32_t i = 0; i < amount; i++)
+	{
+		ThreadBuffer* buffer = threadBuffers[i].load(std::memory_order_acquire);
+		if (!buffer) continue;
+
+		const uint64_t written = buffer->written.load(std::memory_order_acquire);
+		uint64_t begin = buffer->clearedUntil.load();
+		if (written > INTERNAL::ZONES_PER_THREAD) begin = bbe::Math::max<uint64_t>(begin, written - INTERNAL::ZONES_PER_THREAD);
+
+		bbe::List<ZoneRecord> copied;
+		copied.resizeCapacity((size_t)(written - begin));
+		for (uint64_t k = begin; k < written; k++)
+		{
+			const Slot& slot = buffer->slots[k % INTERNAL::ZONES_PER_THREAD];
+			ZoneRecord record;
+			record.name = slot.name.load(std::memory_order_relaxed);
+			record.startNanos = slot.startNanos.load(std::memory_order_relaxed);
+			record.durationNanos = slot.durationNanos.load(std::memory_order_relaxed);
+			record.depth = slot.depth.load(std::memory_order_relaxed);
+			record.threadIndex = i;
+			copied.add(record);
+		}
+
+		// The thread kept on recording while we copied. Everything that it wrapped around to is garbage, including the
+		// slot that it may be writing right now.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t writtenAfter = buffer->written.load(std::memory_order_relaxed);
+		const uint64_t validFrom = writtenAfter + 1 > INTERNAL::ZONES_PER_THREAD ? writtenAfter + 1 - INTERNAL::ZONES_PER_THREAD : 0;
+		for (uint64_t k = bbe::Math::max(begin, validFrom); k < written; k++)
+		{
+			retVal.add(copied[(size_t)(k - begin)]);
+		}
+	}
+
+	retVal.sort([](const ZoneRecord& a, const ZoneRecord& b)
+		{
+			if (a.startNanos != b.startNanos) return a.startNanos < b.startNanos;
+			return a.depth < b.depth;
+		});
+	return retVal;
+}
+
+static void appendJsonString(bbe::String& out, const char* str)
+{
+	out += '"';
+	for (const char* c = str; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			out += '\\';
+			out += *c;
+		}
+		else if ((unsigned char)*c < 0x20)
+		{
+			char buffer[8];
+			snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned)(unsigned char)*c);
+			out += buffer;
+		}
+		else
+		{
+			out += *c;
+		}
+	}
+	out += '"';
+}
+
+bbe::String bbe::profiler::toChromeTrace()
+{
+	const bbe::List<ZoneRecord> zones = collectZones();
+
+	bbe::String retVal = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	char buffer[128];
+
+	const uint32_t amount = bbe::Math::min<uint32_t>(amountOfThreads.load(), INTERNAL::MAX_AMOUNT_OF_THREADS);
+	for (uint32_t i = 0; i < amount; i++)
+	{
+		ThreadBuffer* threadBuffer = threadBuffers[i].load(std::memory_order_acquire);
+		if (!threadBuffer) continue;
+		const char* name = threadBuffer->name.load();
+
+		if (!first) retVal += ",";
+		first = false;
+		snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":", i);
+		retVal += buffer;
+		if (name)
+		{
+			appendJsonString(retVal, name);
+		}
+		else
+		{
+			snprintf(buffer, sizeof(buffer), "\"Thread %u\"", i);
+			retVal += buffer;
+		}
+		retVal += "}}";
+	}
+
+	for (size_t i = 0; i < zones.getLength(); i++)
+	{
+		const ZoneRecord& zone = zones[i];
+		if (!first) retVal += ",";
+		first = false;
+		retVal += "{\"name\":";
+		appendJsonString(retVal, zone.name);
+		// Timestamps are in microseconds.
+		snprintf(buffer, sizeof(buffer), ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", zone.threadIndex, zone.startNanos / 1000.0, zone.durationNanos / 1000.0);
+		retVal += buffer;
+	}
+
+	retVal += "]}";
+	return retVal;
+}
+
+void bbe::profiler::writeChromeTrace(const bbe::String& path)
+{
+	bbe::simpleFile::writeStringToFile(path, toChromeTrace());
+}
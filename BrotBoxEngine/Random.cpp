@@ -0,0 +1,34 @@
+#include "BBE/Random.h"
+#include "BBE/Bench.h"
+#include <atomic>
+
+static std::atomic_bool deterministicSeeding = false;
+static std::atomic<uint32_t> deterministicSeed = 0;
+static std::atomic<uint32_t> amountOfSeededRandoms = 0;
+
+unsigned int bbe::INTERNAL::getInitialRandomSeed(std::random_device& randomDevice)
+{
+	if (deterministicSeeding)
+	{
+		return deterministicSeed + amountOfSeededRandoms++;
+	}
+	// Looked up once instead of for every Random that is created.
+	static const bbe::bench::Config& benchConfig = bbe::bench::getEnvironmentConfig();
+	if (benchConfig.enabled)
+	{
+		return benchConfig.seed + amountOfSeededRandoms++;
+	}
+	return randomDevice();
+}
+
+void bbe::Random::setDeterministicSeed(uint32_t seed)
+{
+	deterministicSeed = seed;
+	amountOfSeededRandoms = 0;
+	deterministicSeeding = true;
+}
+
+void bbe::Random::clearDeterministicSeed()
+{
+	deterministicSeeding = false;
+}
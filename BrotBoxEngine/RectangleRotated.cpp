@@ -1,6 +1,7 @@
 #include "BBE/RectangleRotated.h"
 #include "BBE/Rectangle.h"
 #include "BBE/Vector2.h"
+#include "BBE/SeparatingAxis.h"
 
 bbe::RectangleRotated::RectangleRotated()
 	: m_x(0), m_y(0), m_width(0), m_height(0), m_rotation(0)
@@ -132,3 +133,38 @@ void bbe::RectangleRotated::getVertices(bbe::List<bbe::Vector2>& outVertices) co
 	outVertices.add(p3.rotate(m_rotation, center));
 	outVertices.add(p4.rotate(m_rotation, center));
 }
+
+bool bbe::RectangleRotated::intersects(const Shape<bbe::Vector2>& other) const
+{
+	if (const bbe::RectangleRotated* rect = dynamic_cast<const bbe::RectangleRotated*>(&other))
+	{
+		return bbe::sat::intersects(*this, *rect);
+	}
+	if (const bbe::Rectangle* rect = dynamic_cast<const bbe::Rectangle*>(&other))
+	{
+		return bbe::sat::intersects(*this, *rect);
+	}
+	return Shape2<bbe::Vector2>::intersects(other);
+}
+
+bool bbe::RectangleRotated::resolveIntersection(const Shape<bbe::Vector2>& other)
+{
+	bbe::sat::Hull2 otherHull;
+	if (const bbe::RectangleRotated* rect = dynamic_cast<const bbe::RectangleRotated*>(&other))
+	{
+		otherHull = bbe::sat::makeHull(*rect);
+	}
+	else if (const bbe::Rectangle* rect = dynamic_cast<const bbe::Rectangle*>(&other))
+	{
+		otherHull = bbe::sat::makeHull(*rect);
+	}
+	else
+	{
+		return Shape2<bbe::Vector2>::resolveIntersection(other);
+	}
+
+	bbe::Vector2 translation;
+	if (!bbe::sat::resolveIntersection(bbe::sat::makeHull(*this), otherHull, translation)) return false;
+	translate(translation);
+	return true;
+}
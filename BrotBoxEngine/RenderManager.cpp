@@ -1,4 +1,9 @@
 #include "BBE/RenderManager.h"
+#include "BBE/CommandBuffer2D.h"
+#include "BBE/Rectangle.h"
+#include "BBE/Circle.h"
+#include "BBE/Image.h"
+#include "BBE/Error.h"
 
 void bbe::RenderManager::setFillMode2D(bbe::FillMode fm)
 {
@@ -10,6 +15,58 @@ bbe::FillMode bbe::RenderManager::getFillMode2D()
 	return m_fillMode2D;
 }
 
+bool bbe::RenderManager::isFrameCaptureSupported() const
+{
+	return false;
+}
+
+void bbe::RenderManager::captureFrame(bbe::FrameCapture&, uint64_t)
+{
+	bbe::Crash(bbe::Error::NotImplemented);
+}
+
+void bbe::RenderManager::flushFrameCapture()
+{
+}
+
+bool bbe::RenderManager::isImageRegionSupported2D() const
+{
+	return false;
+}
+
+bool bbe::RenderManager::retainImage2D(const bbe::Image&, bbe::AutoRef&)
+{
+	return false;
+}
+
+void bbe::RenderManager::submit2D(const bbe::CommandBuffer2D& commandBuffer)
+{
+	const bbe::List<bbe::DrawCommand2D>& commands = commandBuffer.getCommands();
+	for (size_t i = 0; i < commands.getLength(); i++)
+	{
+		const bbe::DrawCommand2D& command = commands[i];
+		setColor2D(command.color);
+		switch (command.type)
+		{
+		case bbe::DrawCommandType2D::RECT:
+			fillRect2D(bbe::Rectangle(command.x, command.y, command.width, command.height), command.rotation, nullptr);
+			break;
+		case bbe::DrawCommandType2D::CIRCLE:
+			fillCircle2D(bbe::Circle(command.x, command.y, command.width, command.height));
+			break;
+		case bbe::DrawCommandType2D::IMAGE:
+			drawImage2D(bbe::Rectangle(command.x, command.y, command.width, command.height), *command.image, command.rotation);
+			break;
+		case bbe::DrawCommandType2D::VERTEX_INDEX_LIST:
+			fillVertexIndexList2D(
+				commandBuffer.getIndices().getRaw() + command.firstIndex, command.amountOfIndices,
+				commandBuffer.getVertices().getRaw() + command.firstVertex, command.amountOfVertices,
+				bbe::Vector2(command.x, command.y), bbe::Vector2(command.width, command.height));
+			break;
+		}
+	}
+}
+
 void bbe::RenderManager::setFillMode3D(bbe::FillMode fm)
 {
 	m_fillMode3D = fm;
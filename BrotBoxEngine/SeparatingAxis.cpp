@@ -0,0 +1,234 @@
+#include "BBE/SeparatingAxis.h"
+#include "BBE/RectangleRotated.h"
+#include "BBE/Rectangle.h"
+#include "BBE/Cube.h"
+#include "BBE/Math.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define BBE_SAT_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	struct Projection
+	{
+		float start;
+		float stop;
+	};
+
+#ifdef BBE_SAT_SSE
+	float horizontalMin(__m128 v)
+	{
+		v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(v);
+	}
+
+	float horizontalMax(__m128 v)
+	{
+		v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(v);
+	}
+#endif
+
+	Projection project(const bbe::sat::Hull2& hull, const bbe::Vector2& axis)
+	{
+#ifdef BBE_SAT_SSE
+		const __m128 dots = _mm_add_ps(
+			_mm_mul_ps(_mm_load_ps(hull.x), _mm_set1_ps(axis.x)),
+			_mm_mul_ps(_mm_load_ps(hull.y), _mm_set1_ps(axis.y)));
+		return { horizontalMin(dots), horizontalMax(dots) };
+#else
+		Projection retVal{ bbe::Math::INFINITY_POSITIVE, bbe::Math::INFINITY_NEGATIVE };
+		for (size_t i = 0; i < 4; i++)
+		{
+			const float dot = hull.x[i] * axis.x + hull.y[i] * axis.y;
+			retVal.start = bbe::Math::min(retVal.start, dot);
+			retVal.stop = bbe::Math::max(retVal.stop, dot);
+		}
+		return retVal;
+#endif
+	}
+
+	Projection project(const bbe::sat::Hull3& hull, const bbe::Vector3& axis)
+	{
+#ifdef BBE_SAT_SSE
+		const __m128 axisX = _mm_set1_ps(axis.x);
+		const __m128 axisY = _mm_set1_ps(axis.y);
+		const __m128 axisZ = _mm_set1_ps(axis.z);
+		const __m128 dotsLow = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_load_ps(hull.x), axisX),
+			_mm_mul_ps(_mm_load_ps(hull.y), axisY)),
+			_mm_mul_ps(_mm_load_ps(hull.z), axisZ));
+		const __m128 dotsHigh = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_load_ps(hull.x + 4), axisX),
+			_mm_mul_ps(_mm_load_ps(hull.y + 4), axisY)),
+			_mm_mul_ps(_mm_load_ps(hull.z + 4), axisZ));
+		return { horizontalMin(_mm_min_ps(dotsLow, dotsHigh)), horizontalMax(_mm_max_ps(dotsLow, dotsHigh)) };
+#else
+		Projection retVal{ bbe::Math::INFINITY_POSITIVE, bbe::Math::INFINITY_NEGATIVE };
+		for (size_t i = 0; i < 8; i++)
+		{
+			const float dot = hull.x[i] * axis.x + hull.y[i] * axis.y + hull.z[i] * axis.z;
+			retVal.start = bbe::Math::min(retVal.start, dot);
+			retVal.stop = bbe::Math::max(retVal.stop, dot);
+		}
+		return retVal;
+#endif
+	}
+
+	// See Shape::projectionsPenetration.
+	float penetration(const Projection& pr1, const Projection& pr2)
+	{
+		const float midPr1 = (pr1.start + pr1.stop) / 2.f;
+		const float midPr2 = (pr2.start + pr2.stop) / 2.f;
+		const float midDist = midPr2 - midPr1;
+		const float lengthPr1 = pr1.stop - pr1.start;
+		const float lengthPr2 = pr2.stop - pr2.start;
+		const float lengthAvg = (lengthPr1 + lengthPr2) / 2.f;
+
+		if (bbe::Math::abs(midDist) >= bbe::Math::abs(lengthAvg)) return 0.f;
+
+		return lengthAvg - midDist;
+	}
+
+	template<typename Hull, typename Vec>
+	bool separates(const Hull& a, const Hull& b, const Vec& axis)
+	{
+		return penetration(project(a, axis), project(b, axis)) == 0;
+	}
+
+	bbe::sat::Hull2 makeHull2(const bbe::Vector2 (&vertices)[4])
+	{
+		bbe::sat::Hull2 hull;
+		for (size_t i = 0; i < 4; i++)
+		{
+			hull.x[i] = vertices[i].x;
+			hull.y[i] = vertices[i].y;
+		}
+		hull.axes[0] = (vertices[1] - vertices[0]).rotate90Clockwise().normalize();
+		hull.axes[1] = (vertices[2] - vertices[1]).rotate90Clockwise().normalize();
+		return hull;
+	}
+}
+
+bbe::sat::Hull2 bbe::sat::makeHull(const bbe::RectangleRotated& rect)
+{
+	const bbe::Vector2 center = rect.getCenter();
+	const float x = rect.getX();
+	const float y = rect.getY();
+	const float width = rect.getWidth();
+	const float height = rect.getHeight();
+	const float rotation = rect.getRotation();
+	// Same order as RectangleRotated::getVertices.
+	const bbe::Vector2 vertices[4] = {
+		bbe::Vector2(x,         y         ).rotate(rotation, center),
+		bbe::Vector2(x,         y + height).rotate(rotation, center),
+		bbe::Vector2(x + width, y + height).rotate(rotation, center),
+		bbe::Vector2(x + width, y         ).rotate(rotation, center),
+	};
+	return makeHull2(vertices);
+}
+
+bbe::sat::Hull2 bbe::sat::makeHull(const bbe::Rectangle& rect)
+{
+	const bbe::Vector2 vertices[4] = {
+		bbe::Vector2(rect.x,              rect.y              ),
+		bbe::Vector2(rect.x,              rect.y + rect.height),
+		bbe::Vector2(rect.x + rect.width, rect.y + rect.height),
+		bbe::Vector2(rect.x + rect.width, rect.y              ),
+	};
+	return makeHull2(vertices);
+}
+
+bbe::sat::Hull3 bbe::sat::makeHull(const bbe::Cube& cube)
+{
+	const bbe::Matrix4& transform = cube.getTransform();
+	Hull3 hull;
+	size_t i = 0;
+	// Same order as Cube::getVertices.
+	for (float x : { +0.5f, -0.5f })
+	{
+		for (float y : { +0.5f, -0.5f })
+		{
+			for (float z : { +0.5f, -0.5f })
+			{
+				const bbe::Vector3 vertex = transform * bbe::Vector3(x, y, z);
+				hull.x[i] = vertex.x;
+				hull.y[i] = vertex.y;
+				hull.z[i] = vertex.z;
+				i++;
+			}
+		}
+	}
+	const bbe::Matrix4 rotation = transform.extractRotation();
+	hull.axes[0] = rotation * bbe::Vector3(1, 0, 0);
+	hull.axes[1] = rotation * bbe::Vector3(0, 1, 0);
+	hull.axes[2] = rotation * bbe::Vector3(0, 0, 1);
+	return hull;
+}
+
+bool bbe::sat::intersects(const Hull2& a, const Hull2& b)
+{
+	// Opposite normals give the same projection, so two axes per rectangle are enough.
+	for (const bbe::Vector2& axis : a.axes)
+	{
+		if (separates(a, b, axis)) return false;
+	}
+	for (const bbe::Vector2& axis : b.axes)
+	{
+		if (separates(a, b, axis)) return false;
+	}
+	return true;
+}
+
+bool bbe::sat::intersects(const Hull3& a, const Hull3& b)
+{
+	for (const bbe::Vector3& axis : a.axes)
+	{
+		if (separates(a, b, axis)) return false;
+	}
+	for (const bbe::Vector3& axis : b.axes)
+	{
+		if (separates(a, b, axis)) return false;
+	}
+	for (const bbe::Vector3& axisA : a.axes)
+	{
+		for (const bbe::Vector3& axisB : b.axes)
+		{
+			// Parallel edges don't span an axis. Shape3::intersects skips them as well, because their projection is NaN.
+			const bbe::Vector3 cross = axisA.cross(axisB);
+			if (cross.getLengthSq() < 0.000001f) continue;
+			if (separates(a, b, cross)) return false;
+		}
+	}
+	return true;
+}
+
+bool bbe::sat::resolveIntersection(const Hull2& a, const Hull2& b, bbe::Vector2& outTranslation)
+{
+	// Unlike the boolean test, the penetration depends on the direction of the axis, so every edge normal is checked
+	// in the same order as Shape2::resolveIntersection does.
+	const bbe::Vector2 normals[8] = {
+		a.axes[0], a.axes[1], -a.axes[0], -a.axes[1],
+		b.axes[0], b.axes[1], -b.axes[0], -b.axes[1],
+	};
+
+	float minPenetration = bbe::Math::INFINITY_POSITIVE;
+	bbe::Vector2 resolveAxis;
+	for (const bbe::Vector2& normal : normals)
+	{
+		const float pen = penetration(project(a, normal), project(b, normal));
+		if (pen == 0) return false;
+		if (bbe::Math::abs(pen) < bbe::Math::abs(minPenetration))
+		{
+			minPenetration = pen;
+			resolveAxis = normal;
+		}
+	}
+
+	outTranslation = -resolveAxis * minPenetration;
+	return true;
+}
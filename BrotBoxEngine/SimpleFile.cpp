@@ -1,4 +1,6 @@
 #include "BBE/SimpleFile.h"
+#include "BBE/Profiler.h"
+#include "BBE/Math.h"
 #include <fstream>
 #include <iostream>
 #include <stdlib.h>
@@ -9,6 +11,8 @@
 #include <atomic>
 #include <thread>
 #include <condition_variable>
+#include <future>
+#include <memory>
 
 static std::mutex backupPathMutex;
 static bbe::String backupPath;
@@ -412,53 +416,212 @@ bool bbe::simpleFile::showSaveDialog(bbe::String& outPath, const bbe::String& de
 #endif
 
 #ifndef __EMSCRIPTEN__
+#include <climits>
+#ifdef WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
 enum class AsyncJobType
 {
 	WRITE_BINARY,
 	CREATE_DIRECTORY,
 	APPEND_BINARY,
+	BARRIER,
 };
 
 struct AsyncJob
 {
 	AsyncJobType type;
 	bbe::String path;
-	bbe::ByteBuffer buffer;
+	// Appends that were queued back to back for the same path are merged into a single job and written in one go.
+	bbe::List<bbe::ByteBuffer> buffers;
+	std::shared_ptr<std::promise<void>> barrier;
 };
 
 bbe::ConcurrentList<AsyncJob> jobs;
+bool jobInFlight = false;
+std::atomic<uint64_t> bytesWritten = 0;
+std::atomic<uint64_t> coalescedJobs = 0;
 std::atomic_bool ioThreadRunning = false;
 std::thread ioThread;
 std::condition_variable_any conditional;
 
-static void innerIoThreadMain()
+static int openForWriting(const bbe::String& path, bool append)
 {
-	while (jobs.getLength() > 0)
+#ifdef WIN32
+	const int fd = _open(path.getRaw(), _O_WRONLY | _O_CREAT | _O_BINARY | (append ? _O_APPEND : _O_TRUNC), _S_IREAD | _S_IWRITE);
+#else
+	const int fd = ::open(path.getRaw(), O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644);
+#endif
+	if (fd < 0)
+	{
+		throw std::runtime_error("Could not open file!");
+	}
+	return fd;
+}
+
+static void writeBuffers(int fd, const bbe::List<bbe::ByteBuffer>& buffers)
+{
+#ifdef WIN32
+	for (size_t i = 0; i < buffers.getLength(); i++)
 	{
-		const AsyncJob job = jobs.popFront();
-		if (job.type == AsyncJobType::WRITE_BINARY)
+		const bbe::byte* data = buffers[i].getRaw();
+		size_t remaining = buffers[i].getLength();
+		while (remaining > 0)
 		{
-			bbe::simpleFile::backup::writeBinaryToFile(job.path, job.buffer);
+			const int written = _write(fd, data, (unsigned int)bbe::Math::min<size_t>(remaining, INT_MAX));
+			if (written < 0)
+			{
+				throw std::runtime_error("Could not write file!");
+			}
+			data += written;
+			remaining -= written;
+			bytesWritten += written;
 		}
-		else if (job.type == AsyncJobType::CREATE_DIRECTORY)
+	}
+#else
+	bbe::List<iovec> iov;
+	for (size_t i = 0; i < buffers.getLength(); i++)
+	{
+		if (buffers[i].getLength() == 0) continue;
+		iov.add({ (void*)buffers[i].getRaw(), buffers[i].getLength() });
+	}
+
+	// writev takes at most IOV_MAX buffers per call and is allowed to write less than it was asked to.
+	size_t first = 0;
+	while (first < iov.getLength())
+	{
+		const ssize_t written = ::writev(fd, iov.getRaw() + first, (int)bbe::Math::min<size_t>(iov.getLength() - first, IOV_MAX));
+		if (written < 0)
+		{
+			if (errno == EINTR) continue;
+			throw std::runtime_error("Could not write file!");
+		}
+		bytesWritten += written;
+
+		size_t remaining = (size_t)written;
+		while (first < iov.getLength() && remaining >= iov[first].iov_len)
 		{
-			bbe::simpleFile::backup::createDirectory(job.path);
+			remaining -= iov[first].iov_len;
+			first++;
 		}
-		else if (job.type == AsyncJobType::APPEND_BINARY)
+		if (remaining > 0)
 		{
-			bbe::simpleFile::backup::appendBinaryToFile(job.path, job.buffer);
+			iov[first].iov_base = (char*)iov[first].iov_base + remaining;
+			iov[first].iov_len -= remaining;
 		}
-		else
+	}
+#endif
+}
+
+static void syncAndClose(int fd)
+{
+#ifdef WIN32
+	const bool synced = _commit(fd) == 0;
+	_close(fd);
+#else
+	const bool synced = ::fsync(fd) == 0;
+	::close(fd);
+#endif
+	if (!synced)
+	{
+		throw std::runtime_error("Could not sync file!");
+	}
+}
+
+static void syncParentDirectory(const bbe::String& path)
+{
+#ifndef WIN32
+	// Makes the rename itself durable. Windows has no equivalent and commits the rename with the file system journal.
+	std::filesystem::path parent = std::filesystem::path(path.getRaw()).parent_path();
+	if (parent.empty()) parent = ".";
+	const int fd = ::open(parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd >= 0)
+	{
+		::fsync(fd);
+		::close(fd);
+	}
+#endif
+}
+
+// A crash leaves either the old or the new file behind, but never a partially written one.
+static void commitFile(const bbe::String& path, const bbe::List<bbe::ByteBuffer>& buffers)
+{
+	const bbe::String tempPath = path + ".tmp";
+	const int fd = openForWriting(tempPath, false);
+	writeBuffers(fd, buffers);
+	syncAndClose(fd);
+	std::filesystem::rename(tempPath.getRaw(), path.getRaw());
+	syncParentDirectory(path);
+}
+
+static void appendFile(const bbe::String& path, const bbe::List<bbe::ByteBuffer>& buffers)
+{
+	const int fd = openForWriting(path, true);
+	writeBuffers(fd, buffers);
+	syncAndClose(fd);
+}
+
+static void executeJob(AsyncJob& job)
+{
+	if (job.type == AsyncJobType::WRITE_BINARY)
+	{
+		commitFile(job.path, job.buffers);
+		if (bbe::simpleFile::backup::isBackupPathSet())
 		{
-			bbe::Crash(bbe::Error::IllegalState);
+			commitFile(bbe::simpleFile::backup::backupFullPath(job.path), job.buffers);
 		}
+	}
+	else if (job.type == AsyncJobType::CREATE_DIRECTORY)
+	{
+		bbe::simpleFile::backup::createDirectory(job.path);
+	}
+	else if (job.type == AsyncJobType::APPEND_BINARY)
+	{
+		appendFile(job.path, job.buffers);
+		if (bbe::simpleFile::backup::isBackupPathSet())
+		{
+			appendFile(bbe::simpleFile::backup::backupFullPath(job.path), job.buffers);
+		}
+	}
+	else if (job.type == AsyncJobType::BARRIER)
+	{
+		job.barrier->set_value();
+	}
+	else
+	{
+		bbe::Crash(bbe::Error::IllegalState);
+	}
+}
 
-		if (jobs.getLength() == 0 && ioThreadRunning)
+static void innerIoThreadMain()
+{
+	bbe::profiler::setThreadName("IO Thread");
+	while (true)
+	{
+		AsyncJob job;
 		{
 			std::unique_lock ul(jobs);
+			jobInFlight = false;
 			conditional.wait(ul, [] {
 				return jobs.getLength() > 0 || !ioThreadRunning;
 				});
+			// Even when stopped, everything that is still queued gets written first.
+			if (jobs.getLength() == 0) return;
+			job = jobs.getUnderlying().popFront();
+			// A barrier that is reached has nothing left to wait for, so it doesn't count towards the queue depth.
+			jobInFlight = job.type != AsyncJobType::BARRIER;
+		}
+		{
+			BBE_PROFILE_ZONE("IO Job");
+			executeJob(job);
 		}
 	}
 }
@@ -481,21 +644,108 @@ static void notifyIOThread()
 	}
 	conditional.notify_all();
 }
+
+// Returns the queued write or append for path that no other job has to wait for, if there is one. There is at most one
+// such job per path, because every write and append merges into it. Jobs before a barrier are off limits, as the
+// barrier promises that their data is on the disk. So are jobs before a createDirectory, because the write may go
+// into that directory.
+static AsyncJob* findCoalescableJob(const bbe::String& path)
+{
+	bbe::List<AsyncJob>& queue = jobs.getUnderlying();
+	for (size_t i = queue.getLength(); i > 0; i--)
+	{
+		AsyncJob& job = queue[i - 1];
+		if (job.type == AsyncJobType::BARRIER || job.type == AsyncJobType::CREATE_DIRECTORY) return nullptr;
+		if (job.path == path && (job.type == AsyncJobType::WRITE_BINARY || job.type == AsyncJobType::APPEND_BINARY)) return &job;
+	}
+	return nullptr;
+}
+
+static void queueWrite(AsyncJobType type, const bbe::String& path, const bbe::ByteBuffer& buffer)
+{
+	{
+		std::unique_lock ul(jobs);
+		AsyncJob* job = findCoalescableJob(path);
+		if (job == nullptr)
+		{
+			jobs.getUnderlying().add({ type, path, { buffer } });
+		}
+		else
+		{
+			coalescedJobs++;
+			if (type == AsyncJobType::WRITE_BINARY)
+			{
+				// Everything that was queued for this path is overwritten anyway.
+				job->type = AsyncJobType::WRITE_BINARY;
+				job->buffers.clear();
+			}
+			// Appending to a queued write simply makes the written file longer.
+			job->buffers.add(buffer);
+		}
+	}
+	notifyIOThread();
+}
 #endif
 
 bool bbe::simpleFile::backup::async::hasOpenIO()
+{
+	return getQueueDepth() > 0;
+}
+
+size_t bbe::simpleFile::backup::async::getQueueDepth()
 {
 #ifdef __EMSCRIPTEN__
-	return false;
+	return 0;
+#else
+	std::unique_lock ul(jobs);
+	return jobs.getLength() + (jobInFlight ? 1 : 0);
+#endif
+}
+
+uint64_t bbe::simpleFile::backup::async::getBytesWritten()
+{
+#ifdef __EMSCRIPTEN__
+	return 0;
 #else
-	return jobs.getLength() > 0;
+	return bytesWritten;
 #endif
 }
 
+uint64_t bbe::simpleFile::backup::async::getAmountOfCoalescedJobs()
+{
+#ifdef __EMSCRIPTEN__
+	return 0;
+#else
+	return coalescedJobs;
+#endif
+}
+
+std::future<void> bbe::simpleFile::backup::async::barrier()
+{
+	std::shared_ptr<std::promise<void>> promise = std::make_shared<std::promise<void>>();
+	std::future<void> retVal = promise->get_future();
+#ifdef __EMSCRIPTEN__
+	promise->set_value();
+#else
+	jobs.add({ AsyncJobType::BARRIER, "", {}, promise });
+	notifyIOThread();
+#endif
+	return retVal;
+}
+
+void bbe::simpleFile::backup::async::flush()
+{
+	barrier().wait();
+}
+
 void bbe::simpleFile::backup::async::stopIoThread()
 {
 #ifndef __EMSCRIPTEN__
-	ioThreadRunning = false;
+	{
+		// Under the lock, or the IO thread could miss the notification between checking the flag and waiting.
+		std::unique_lock ul(jobs);
+		ioThreadRunning = false;
+	}
 	conditional.notify_all();
 	if (ioThread.joinable())
 	{
@@ -509,8 +759,7 @@ void bbe::simpleFile::backup::async::writeBinaryToFile(const bbe::String& filePa
 #ifdef __EMSCRIPTEN__
 	bbe::simpleFile::backup::writeBinaryToFile(filePath, buffer);
 #else
-	jobs.add({ AsyncJobType::WRITE_BINARY, filePath, buffer });
-	notifyIOThread();
+	queueWrite(AsyncJobType::WRITE_BINARY, filePath, buffer);
 #endif
 }
 
@@ -529,7 +778,6 @@ void bbe::simpleFile::backup::async::appendBinaryToFile(const bbe::String& fileP
 #ifdef __EMSCRIPTEN__
 	bbe::simpleFile::backup::appendBinaryToFile(filePath, buffer);
 #else
-	jobs.add({ AsyncJobType::APPEND_BINARY, filePath, buffer });
-	notifyIOThread();
+	queueWrite(AsyncJobType::APPEND_BINARY, filePath, buffer);
 #endif
 }
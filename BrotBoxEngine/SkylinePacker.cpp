@@ -0,0 +1,123 @@
+#include "BBE/SkylinePacker.h"
+#include "BBE/Math.h"
+#include "BBE/Error.h"
+#include <climits>
+
+bbe::SkylinePacker::SkylinePacker(int32_t width, int32_t height)
+{
+	reset(width, height);
+}
+
+void bbe::SkylinePacker::reset(int32_t width, int32_t height)
+{
+	if (width <= 0 || height <= 0)
+	{
+		bbe::Crash(bbe::Error::IllegalArgument);
+	}
+	m_width = width;
+	m_height = height;
+	m_usedArea = 0;
+	m_skyline.clear();
+	m_skyline.add(Segment{ 0, 0, width });
+}
+
+bool bbe::SkylinePacker::insert(int32_t width, int32_t height, bbe::Vector2i& outPos)
+{
+	if (width < 0 || height < 0)
+	{
+		bbe::Crash(bbe::Error::IllegalArgument);
+	}
+	if (width > m_width || height > m_height) return false;
+	if (width == 0 || height == 0)
+	{
+		outPos = bbe::Vector2i(0, 0);
+		return true;
+	}
+
+	size_t bestIndex = (size_t)-1;
+	int32_t bestY = 0;
+	int32_t bestTop = INT32_MAX;
+	int32_t bestSegmentWidth = INT32_MAX;
+	for (size_t i = 0; i < m_skyline.getLength(); i++)
+	{
+		const int32_t x = m_skyline[i].x;
+		if (x + width > m_width) break;
+
+		// The rectangle rests on the highest segment below it.
+		int32_t y = 0;
+		int32_t remaining = width;
+		for (size_t k = i; remaining > 0; k++)
+		{
+			y = bbe::Math::max(y, m_skyline[k].y);
+			remaining -= m_skyline[k].width;
+		}
+
+		const int32_t top = y + height;
+		if (top > m_height) continue;
+		if (top < bestTop || (top == bestTop && m_skyline[i].width < bestSegmentWidth))
+		{
+			bestIndex = i;
+			bestY = y;
+			bestTop = top;
+			bestSegmentWidth = m_skyline[i].width;
+		}
+	}
+	if (bestIndex == (size_t)-1) return false;
+
+	const int32_t left = m_skyline[bestIndex].x;
+	const int32_t right = left + width;
+
+	// Rebuild the skyline with the new segment replacing everything it covers and merge segments of equal height.
+	m_scratch.clear();
+	auto addSegment = [this](const Segment& segment)
+		{
+			if (!m_scratch.isEmpty() && m_scratch.last().y == segment.y)
+			{
+				m_scratch.last().width += segment.width;
+			}
+			else
+			{
+				m_scratch.add(segment);
+			}
+		};
+	for (size_t i = 0; i < bestIndex; i++)
+	{
+		addSegment(m_skyline[i]);
+	}
+	addSegment(Segment{ left, bestTop, width });
+	for (size_t i = bestIndex; i < m_skyline.getLength(); i++)
+	{
+		const Segment& segment = m_skyline[i];
+		const int32_t segmentRight = segment.x + segment.width;
+		if (segmentRight <= right) continue;
+		if (segment.x < right)
+		{
+			addSegment(Segment{ right, segment.y, segmentRight - right });
+		}
+		else
+		{
+			addSegment(segment);
+		}
+	}
+	std::swap(m_skyline, m_scratch);
+
+	m_usedArea += (int64_t)width * height;
+	outPos = bbe::Vector2i(left, bestY);
+	return true;
+}
+
+int32_t bbe::SkylinePacker::getWidth() const
+{
+	return m_width;
+}
+
+int32_t bbe::SkylinePacker::getHeight() const
+{
+	return m_height;
+}
+
+float bbe::SkylinePacker::getFillRatio() const
+{
+	if (m_width == 0 || m_height == 0) return 0;
+	return (float)((double)m_usedArea / ((double)m_width * m_height));
+}
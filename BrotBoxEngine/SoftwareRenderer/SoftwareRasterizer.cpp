@@ -0,0 +1,463 @@
+#include "BBE/SoftwareRenderer/SoftwareRasterizer.h"
+#include "BBE/Image.h"
+#include "BBE/JobSystem.h"
+#include "BBE/Math.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BBE_RASTERIZER_SSE
+#include <emmintrin.h>
+#endif
+
+static_assert(bbe::INTERNAL::softwareRenderer::Rasterizer::TILE_SIZE % 4 == 0, "Tiles must be made of whole blocks of four pixels.");
+
+static int32_t clampToScreen(float value, int32_t max)
+{
+	// Clamped as float first, vertices far outside of the screen don't fit into an int.
+	if (!(value > -1.0f)) return -1;
+	if (value > (float)max + 1.0f) return max + 1;
+	return (int32_t)value;
+}
+
+static bool setupTriangle(bbe::INTERNAL::softwareRenderer::RasterTriangle& t, int32_t width, int32_t height)
+{
+	bbe::INTERNAL::softwareRenderer::RasterVertex* v = t.vertices;
+	float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+	if (area < 0)
+	{
+		std::swap(v[1], v[2]);
+		area = -area;
+	}
+	if (!(area > 0)) return false;
+	t.area = area;
+
+	for (int i = 0; i < 3; i++)
+	{
+		// The edge opposite of vertex i. Its edge function is the barycentric weight of vertex i.
+		const bbe::INTERNAL::softwareRenderer::RasterVertex& a = v[(i + 1) % 3];
+		const bbe::INTERNAL::softwareRenderer::RasterVertex& b = v[(i + 2) % 3];
+		t.edgeA[i] = a.y - b.y;
+		t.edgeB[i] = b.x - a.x;
+		t.edgeC[i] = a.x * b.y - a.y * b.x;
+		// A shared edge is walked in opposite directions by its two triangles, so exactly one of them owns pixels on it.
+		t.edgeInclusive[i] = t.edgeA[i] > 0 || (t.edgeA[i] == 0 && t.edgeB[i] > 0);
+	}
+
+	const float minX = bbe::Math::min(v[0].x, bbe::Math::min(v[1].x, v[2].x));
+	const float minY = bbe::Math::min(v[0].y, bbe::Math::min(v[1].y, v[2].y));
+	const float maxX = bbe::Math::max(v[0].x, bbe::Math::max(v[1].x, v[2].x));
+	const float maxY = bbe::Math::max(v[0].y, bbe::Math::max(v[1].y, v[2].y));
+	// Pixel x is covered if its center x + 0.5 is, so these are the first and one past the last pixel that can be.
+	t.minX = bbe::Math::max(0,      clampToScreen(std::ceil(minX - 0.5f), width));
+	t.minY = bbe::Math::max(0,      clampToScreen(std::ceil(minY - 0.5f), height));
+	t.maxX = bbe::Math::min(width,  clampToScreen(std::floor(maxX - 0.5f), width) + 1);
+	t.maxY = bbe::Math::min(height, clampToScreen(std::floor(maxY - 0.5f), height) + 1);
+	return t.minX < t.maxX && t.minY < t.maxY;
+}
+
+static float fetchChannel(const bbe::byte* data, size_t index)
+{
+	return (float)data[index] / 255.0f;
+}
+
+static int32_t wrap(int32_t value, int32_t size, bbe::ImageRepeatMode repeatMode)
+{
+	if (repeatMode == bbe::ImageRepeatMode::REPEAT)
+	{
+		value %= size;
+		return value < 0 ? value + size : value;
+	}
+	// All other modes are treated as clamp to edge.
+	return bbe::Math::clamp(value, 0, size - 1);
+}
+
+static bbe::Color fetchTexel(const bbe::Image& image, const bbe::byte* data, int32_t x, int32_t y)
+{
+	const size_t index = image.getIndexForRawAccess(x, y);
+	if (image.getAmountOfChannels() == 1)
+	{
+		// Single channel images are used as masks, e.g. for glyphs. Same as the swizzle of the GPU backends.
+		return bbe::Color(1.0f, 1.0f, 1.0f, fetchChannel(data, index));
+	}
+	return bbe::Color(fetchChannel(data, index), fetchChannel(data, index + 1), fetchChannel(data, index + 2), fetchChannel(data, index + 3));
+}
+
+bbe::Color bbe::INTERNAL::softwareRenderer::Rasterizer::sampleImage(const bbe::Image& image, float u, float v)
+{
+	const int32_t width = image.getWidth();
+	const int32_t height = image.getHeight();
+	if (width <= 0 || height <= 0 || !image.isLoadedCpu()) return bbe::Color(1.0f, 1.0f, 1.0f, 1.0f);
+	const bbe::byte* data = image.m_pdata.getRaw();
+	const bbe::ImageRepeatMode repeatMode = image.getRepeatMode();
+
+	if (image.getFilterMode() == bbe::ImageFilterMode::NEAREST)
+	{
+		const int32_t x = wrap((int32_t)std::floor(u * width), width, repeatMode);
+		const int32_t y = wrap((int32_t)std::floor(v * height), height, repeatMode);
+		return fetchTexel(image, data, x, y);
+	}
+
+	const float fx = u * width - 0.5f;
+	const float fy = v * height - 0.5f;
+	const float floorX = std::floor(fx);
+	const float floorY = std::floor(fy);
+	const float tx = fx - floorX;
+	const float ty = fy - floorY;
+	const int32_t x0 = wrap((int32_t)floorX,     width,  repeatMode);
+	const int32_t x1 = wrap((int32_t)floorX + 1, width,  repeatMode);
+	const int32_t y0 = wrap((int32_t)floorY,     height, repeatMode);
+	const int32_t y1 = wrap((int32_t)floorY + 1, height, repeatMode);
+	const bbe::Color top    = fetchTexel(image, data, x0, y0) * (1.0f - tx) + fetchTexel(image, data, x1, y0) * tx;
+	const bbe::Color bottom = fetchTexel(image, data, x0, y1) * (1.0f - tx) + fetchTexel(image, data, x1, y1) * tx;
+	return top * (1.0f - ty) + bottom * ty;
+}
+
+void bbe::INTERNAL::softwareRenderer::Rasterizer::resize(int32_t width, int32_t height)
+{
+	m_width = bbe::Math::max(width, 0);
+	m_height = bbe::Math::max(height, 0);
+	m_tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+	m_tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+	m_color.resizeCapacityAndLength((size_t)m_width * (size_t)m_height);
+	m_depth.resizeCapacityAndLength((size_t)m_width * (size_t)m_height);
+	m_tileBins.clear();
+	m_tileBins.resizeCapacityAndLength((size_t)m_tilesX * (size_t)m_tilesY);
+	m_triangles.clear();
+}
+
+void bbe::INTERNAL::softwareRenderer::Rasterizer::clear(const bbe::Color& color)
+{
+	const uint32_t packed = packColor(color);
+	for (size_t i = 0; i < m_color.getLength(); i++)
+	{
+		m_color[i] = packed;
+		m_depth[i] = 1.0f;
+	}
+}
+
+void bbe::INTERNAL::softwareRenderer::Rasterizer::addTriangle2D(const RasterVertex& a, const RasterVertex& b, const RasterVertex& c, const bbe::Image* image)
+{
+	RasterTriangle t;
+	t.vertices[0] = a;
+	t.vertices[1] = b;
+	t.vertices[2] = c;
+	t.image = image;
+	if (setupTriangle(t, m_width, m_height))
+	{
+		m_triangles.add(t);
+	}
+}
+
+void bbe::INTERNAL::softwareRenderer::Rasterizer::addEllipse2D(const bbe::Vector2& topLeft, const bbe::Vector2& size, const bbe::Color& color)
+{
+	if (!(size.x > 0) || !(size.y > 0)) return;
+	RasterVertex corners[4];
+	for (int i = 0; i < 4; i++)
+	{
+		corners[i].x = topLeft.x + (i % 2 == 0 ? 0 : size.x);
+		corners[i].y = topLeft.y + (i / 2 == 0 ? 0 : size.y);
+		corners[i].color = color;
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		RasterTriangle t;
+		t.vertices[0] = corners[i == 0 ? 0 : 3];
+		t.vertices[1] = corners[1];
+		t.vertices[2] = corners[2];
+		t.ellipse = true;
+		t.ellipseCenter = topLeft + size * 0.5f;
+		t.ellipseInvRadius = bbe::Vector2(2.0f / size.x, 2.0f / size.y);
+		if (setupTriangle(t, m_width, m_height))
+		{
+			m_triangles.add(t);
+		}
+	}
+}
+
+struct ClipVertex
+{
+	bbe::Vector4 pos;
+	bbe::Color color;
+};
+
+static ClipVertex lerp(const ClipVertex& a, const ClipVertex& b, float t)
+{
+	ClipVertex retVal;
+	retVal.pos = a.pos + (b.pos - a.pos) * t;
+	retVal.color = a.color + (b.color - a.color) * t;
+	return retVal;
+}
+
+void bbe::INTERNAL::softwareRenderer::Rasterizer::addTriangle3D(const bbe::Vector4& a, const bbe::Vector4& b, const bbe::Vector4& c, const bbe::Color& colorA, const bbe::Color& colorB, const bbe::Color& colorC)
+{
+	// Sutherland-Hodgman against the near plane z >= -w. A triangle becomes at most a quad.
+	const ClipVertex input[3] = { { a, colorA }, { b, colorB }, { c, colorC } };
+	ClipVertex clipped[4];
+	int amountOfClipped = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		const ClipVertex& current = input[i];
+		const ClipVertex& next = input[(i + 1) % 3];
+		const float currentDist = current.pos.z + current.pos.w;
+		const float nextDist = next.pos.z + next.pos.w;
+		if (currentDist >= 0)
+		{
+			clipped[amountOfClipped++] = current;
+		}
+		if ((currentDist >= 0) != (nextDist >= 0))
+		{
+			clipped[amountOfClipped++] = lerp(current, next, currentDist / (currentDist - nextDist));
+		}
+	}
+	if (amountOfClipped < 3) return;
+
+	RasterVertex screen[4];
+	for (int i = 0; i < amountOfClipped; i++)
+	{
+		const bbe::Vector4& pos = clipped[i].pos;
+		if (!(pos.w > 0)) return;
+		const float invW = 1.0f / pos.w;
+		screen[i].x = (pos.x * invW + 1.0f) * 0.5f * (float)m_width;
+		screen[i].y = (pos.y * invW + 1.0f) * 0.5f * (float)m_height;
+		screen[i].z = pos.z * invW * 0.5f + 0.5f;
+		screen[i].invW = invW;
+		screen[i].color = clipped[i].color;
+	}
+
+	for (int i = 1; i + 1 < amountOfClipped; i++)
+	{
+		RasterTriangle t;
+		t.vertices[0] = screen[0];
+		t.vertices[1] = screen[i];
+		t.vertices[2] = screen[i + 1];
+		t.depthTested = true;
+		if (setupTriangle(t, m_width, m_height))
+		{
+			m_triangles.add(t);
+		}
+	}
+}
+
+void bbe::INTERNAL::softwareRenderer::Rasterizer::flush(bool parallel)
+{
+	if (m_triangles.getLength() == 0) return;
+
+	for (size_t i = 0; i < m_tileBins.getLength(); i++)
+	{
+		m_tileBins[i].clear();
+	}
+	for (size_t i = 0; i < m_triangles.getLength(); i++)
+	{
+		const RasterTriangle& t = m_triangles[i];
+		for (int32_t tileY = t.minY / TILE_SIZE; tileY <= (t.maxY - 1) / TILE_SIZE; tileY++)
+		{
+			for (int32_t tileX = t.minX / TILE_SIZE; tileX <= (t.maxX - 1) / TILE_SIZE; tileX++)
+			{
+				m_tileBins[(size_t)tileY * m_tilesX + tileX].add((uint32_t)i);
+			}
+		}
+	}
+
+	const size_t amountOfTiles = m_tileBins.getLength();
+	auto rasterizeTiles = [&](size_t begin, size_t end)
+		{
+			for (size_t tile = begin; tile < end; tile++)
+			{
+				rasterizeTile((int32_t)(tile % m_tilesX), (int32_t)(tile / m_tilesX));
+			}
+		};
+	if (parallel)
+	{
+		bbe::jobs::parallelFor(0, amountOfTiles, 1, rasterizeTiles);
+	}
+	else
+	{
+		rasterizeTiles(0, amountOfTiles);
+	}
+
+	m_amountOfTrianglesDrawn += m_triangles.getLength();
+	m_triangles.clear();
+}
+
+void bbe::INTERNAL::softwareRenderer::Rasterizer::rasterizeTile(int32_t tileX, int32_t tileY)
+{
+	const bbe::List<uint32_t>& bin = m_tileBins[(size_t)tileY * m_tilesX + tileX];
+	const int32_t tileMinX = tileX * TILE_SIZE;
+	const int32_t tileMinY = tileY * TILE_SIZE;
+	const int32_t tileMaxX = bbe::Math::min(tileMinX + TILE_SIZE, m_width);
+	const int32_t tileMaxY = bbe::Math::min(tileMinY + TILE_SIZE, m_height);
+	for (size_t i = 0; i < bin.getLength(); i++)
+	{
+		const RasterTriangle& t = m_triangles[bin[i]];
+		rasterizeTriangle(t,
+			bbe::Math::max(t.minX, tileMinX), bbe::Math::max(t.minY, tileMinY),
+			bbe::Math::min(t.maxX, tileMaxX), bbe::Math::min(t.maxY, tileMaxY));
+	}
+}
+
+void bbe::INTERNAL::softwareRenderer::Rasterizer::rasterizeTriangle(const RasterTriangle& t, int32_t minX, int32_t minY, int32_t maxX, int32_t maxY)
+{
+	// Blocks of four pixels start at multiples of four, lanes outside of [minX, maxX) are masked. That way every pixel is
+	// always evaluated by the same lane with the same instructions, no matter which tile or triangle it is part of.
+	const int32_t firstBlockX = minX & ~3;
+	for (int32_t y = minY; y < maxY; y++)
+	{
+		const float py = (float)y + 0.5f;
+		float rowTerm[3];
+		for (int i = 0; i < 3; i++)
+		{
+			rowTerm[i] = t.edgeB[i] * py + t.edgeC[i];
+		}
+
+		for (int32_t x = firstBlockX; x < maxX; x += 4)
+		{
+			alignas(16) float weights[3][4];
+			int mask = 0;
+#ifdef BBE_RASTERIZER_SSE
+			const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+			const __m128i lane = _mm_add_epi32(_mm_set1_epi32(x), _mm_setr_epi32(0, 1, 2, 3));
+			__m128 covered = _mm_castsi128_ps(_mm_and_si128(
+				_mm_cmpgt_epi32(lane, _mm_set1_epi32(minX - 1)),
+				_mm_cmplt_epi32(lane, _mm_set1_epi32(maxX))));
+			for (int i = 0; i < 3; i++)
+			{
+				const __m128 e = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.edgeA[i]), px), _mm_set1_ps(rowTerm[i]));
+				covered = _mm_and_ps(covered, t.edgeInclusive[i] ? _mm_cmpge_ps(e, _mm_setzero_ps()) : _mm_cmpgt_ps(e, _mm_setzero_ps()));
+				_mm_store_ps(weights[i], e);
+			}
+			mask = _mm_movemask_ps(covered);
+#else
+			for (int k = 0; k < 4; k++)
+			{
+				const int32_t laneX = x + k;
+				bool covered = laneX >= minX && laneX < maxX;
+				const float px = (float)laneX + 0.5f;
+				for (int i = 0; i < 3; i++)
+				{
+					const float e = t.edgeA[i] * px + rowTerm[i];
+					covered = covered && (t.edgeInclusive[i] ? e >= 0 : e > 0);
+					weights[i][k] = e;
+				}
+				if (covered) mask |= 1 << k;
+			}
+#endif
+			if (mask == 0) continue;
+			for (int k = 0; k < 4; k++)
+			{
+				if (mask & (1 << k))
+				{
+					shadePixel(t, x + k, y, weights[0][k], weights[1][k], weights[2][k]);
+				}
+			}
+		}
+	}
+}
+
+void bbe::INTERNAL::softwareRenderer::Rasterizer::shadePixel(const RasterTriangle& t, int32_t x, int32_t y, float w0, float w1, float w2)
+{
+	if (t.ellipse)
+	{
+		const float dx = ((float)x + 0.5f - t.ellipseCenter.x) * t.ellipseInvRadius.x;
+		const float dy = ((float)y + 0.5f - t.ellipseCenter.y) * t.ellipseInvRadius.y;
+		if (dx * dx + dy * dy > 1.0f) return;
+	}
+
+	const size_t index = (size_t)y * m_width + x;
+	const float sum = w0 + w1 + w2;
+	float l0 = w0 / sum;
+	float l1 = w1 / sum;
+	float l2 = w2 / sum;
+	const RasterVertex* v = t.vertices;
+
+	if (t.depthTested)
+	{
+		// Depth is affine in screen space, everything else has to be corrected for the perspective.
+		const float z = l0 * v[0].z + l1 * v[1].z + l2 * v[2].z;
+		if (!(z < m_depth[index]) || z < 0.0f) return;
+		m_depth[index] = z;
+		const float q0 = l0 * v[0].invW;
+		const float q1 = l1 * v[1].invW;
+		const float q2 = l2 * v[2].invW;
+		const float qSum = q0 + q1 + q2;
+		l0 = q0 / qSum;
+		l1 = q1 / qSum;
+		l2 = q2 / qSum;
+	}
+
+	bbe::Color color = v[0].color * l0 + v[1].color * l1 + v[2].color * l2;
+	if (t.image != nullptr)
+	{
+		const float u = v[0].u * l0 + v[1].u * l1 + v[2].u * l2;
+		const float uvV = v[0].v * l0 + v[1].v * l1 + v[2].v * l2;
+		const bbe::Color texel = sampleImage(*t.image, u, uvV);
+		color = bbe::Color(color.r * texel.r, color.g * texel.g, color.b * texel.b, color.a * texel.a);
+	}
+
+	if (t.depthTested)
+	{
+		color.a = 1.0f;
+		m_color[index] = packColor(color);
+		return;
+	}
+
+	const bbe::Color dst = unpackColor(m_color[index]);
+	const float srcAlpha = bbe::Math::clamp01(color.a);
+	m_color[index] = packColor(bbe::Color(
+		color.r * srcAlpha + dst.r * (1.0f - srcAlpha),
+		color.g * srcAlpha + dst.g * (1.0f - srcAlpha),
+		color.b * srcAlpha + dst.b * (1.0f - srcAlpha),
+		srcAlpha + dst.a * (1.0f - srcAlpha)));
+}
+
+int32_t bbe::INTERNAL::softwareRenderer::Rasterizer::getWidth() const
+{
+	return m_width;
+}
+
+int32_t bbe::INTERNAL::softwareRenderer::Rasterizer::getHeight() const
+{
+	return m_height;
+}
+
+const uint32_t* bbe::INTERNAL::softwareRenderer::Rasterizer::getColorBuffer() const
+{
+	return m_color.getRaw();
+}
+
+uint32_t bbe::INTERNAL::softwareRenderer::Rasterizer::getPixel(int32_t x, int32_t y) const
+{
+	return m_color[(size_t)y * m_width + x];
+}
+
+float bbe::INTERNAL::softwareRenderer::Rasterizer::getDepth(int32_t x, int32_t y) const
+{
+	return m_depth[(size_t)y * m_width + x];
+}
+
+size_t bbe::INTERNAL::softwareRenderer::Rasterizer::getAmountOfQueuedTriangles() const
+{
+	return m_triangles.getLength();
+}
+
+uint64_t bbe::INTERNAL::softwareRenderer::Rasterizer::getAmountOfTrianglesDrawn() const
+{
+	return m_amountOfTrianglesDrawn;
+}
+
+uint32_t bbe::INTERNAL::softwareRenderer::Rasterizer::packColor(const bbe::Color& color)
+{
+	const uint32_t r = (uint32_t)(bbe::Math::clamp01(color.r) * 255.0f + 0.5f);
+	const uint32_t g = (uint32_t)(bbe::Math::clamp01(color.g) * 255.0f + 0.5f);
+	const uint32_t b = (uint32_t)(bbe::Math::clamp01(color.b) * 255.0f + 0.5f);
+	const uint32_t a = (uint32_t)(bbe::Math::clamp01(color.a) * 255.0f + 0.5f);
+	return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+bbe::Color bbe::INTERNAL::softwareRenderer::Rasterizer::unpackColor(uint32_t color)
+{
+	return bbe::Color(
+		(float)((color >>  0) & 0xFF) / 255.0f,
+		(float)((color >>  8) & 0xFF) / 255.0f,
+		(float)((color >> 16) & 0xFF) / 255.0f,
+		(float)((color >> 24) & 0xFF) / 255.0f);
+}
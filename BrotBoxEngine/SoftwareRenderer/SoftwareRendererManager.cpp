@@ -0,0 +1,397 @@
+#include "BBE/SoftwareRenderer/SoftwareRendererManager.h"
+#include "BBE/CommandBuffer2D.h"
+#include "BBE/Rectangle.h"
+#include "BBE/Circle.h"
+#include "BBE/Cube.h"
+#include "BBE/IcoSphere.h"
+#include "BBE/Math.h"
+#include "BBE/FrameCapture.h"
+#include "imgui.h"
+#include "imgui_impl_glfw.h"
+
+bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::SoftwareRendererManager()
+{
+	m_cubeVertices = bbe::Cube::getRenderVerticesDefault();
+	m_cubeIndices = bbe::Cube::getRenderIndicesDefault();
+	m_sphereVertices = bbe::IcoSphere::getRenderVerticesDefault();
+	m_sphereIndices = bbe::IcoSphere::getRenderIndicesDefault();
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::init(const char* appName, uint32_t major, uint32_t minor, uint32_t patch, GLFWwindow* window, uint32_t initialWindowWidth, uint32_t initialWindowHeight)
+{
+	m_pwindow = window;
+	resize(initialWindowWidth, initialWindowHeight);
+	imguiStart();
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::destroy()
+{
+	imguiStop();
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::preDraw2D()
+{
+	// 2D is always drawn on top of 3D.
+	flush3D();
+	m_primitiveBrush2D.INTERNAL_beginDraw(m_pwindow, (int)m_windowWidth, (int)m_windowHeight, this);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::preDraw3D()
+{
+	m_primitiveBrush3D.INTERNAL_beginDraw((int)m_windowWidth, (int)m_windowHeight, this);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::preDraw()
+{
+	m_amountOfDrawcallsPreviousFrame = m_amountOfDrawcalls;
+	m_amountOfDrawcalls = 0;
+	m_pointLights.clear();
+	m_vertices3D.clear();
+	m_indices3D.clear();
+	m_rasterizer.clear(bbe::Color(0, 0, 0, 1));
+	imguiStartFrame();
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::postDraw()
+{
+	m_primitiveBrush2D.INTERNAL_endDraw();
+	flush3D();
+	m_rasterizer.flush(m_parallel);
+	imguiEndFrame();
+
+	if (m_pframeCapture)
+	{
+		m_pframeCapture->submit(m_frameCaptureNumber, getFramebuffer());
+		m_pframeCapture = nullptr;
+	}
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::waitEndDraw()
+{
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::waitTillIdle()
+{
+}
+
+bbe::PrimitiveBrush2D& bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::getBrush2D()
+{
+	return m_primitiveBrush2D;
+}
+
+bbe::PrimitiveBrush3D& bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::getBrush3D()
+{
+	return m_primitiveBrush3D;
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::resize(uint32_t width, uint32_t height)
+{
+	m_windowWidth = width;
+	m_windowHeight = height;
+	m_rasterizer.resize((int32_t)width, (int32_t)height);
+	m_rasterizer.clear(bbe::Color(0, 0, 0, 1));
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::screenshot(const bbe::String& path)
+{
+	getFramebuffer().writeToFile(path);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::setVideoRenderingMode(const char*)
+{
+	// Unused, Game records videos through captureFrame.
+}
+
+bool bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::isFrameCaptureSupported() const
+{
+	return true;
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::captureFrame(bbe::FrameCapture& capture, uint64_t frameNumber)
+{
+	m_pframeCapture = &capture;
+	m_frameCaptureNumber = frameNumber;
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::addRect(const Rectangle& rect, float rotation, const bbe::Color& color, const bbe::Image* image, float uvX, float uvY, float uvWidth, float uvHeight)
+{
+	// Same corner order and rotation around the center as the vertex shaders of the GPU backends.
+	const bbe::Vector2 center = rect.getCenter();
+	const float s = bbe::Math::sin(rotation);
+	const float c = bbe::Math::cos(rotation);
+	RasterVertex corners[4];
+	for (int i = 0; i < 4; i++)
+	{
+		const float fx = (i % 2 == 0) ? 0.f : 1.f;
+		const float fy = (i / 2 == 0) ? 0.f : 1.f;
+		const float localX = (fx - 0.5f) * rect.width;
+		const float localY = (fy - 0.5f) * rect.height;
+		corners[i].x = center.x + c * localX - s * localY;
+		corners[i].y = center.y + s * localX + c * localY;
+		corners[i].color = color;
+		corners[i].u = uvX + fx * uvWidth;
+		corners[i].v = uvY + fy * uvHeight;
+	}
+	m_rasterizer.addTriangle2D(corners[0], corners[1], corners[2], image);
+	m_rasterizer.addTriangle2D(corners[3], corners[1], corners[2], image);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::addVertexIndexList(const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, const bbe::Vector2& pos, const bbe::Vector2& scale, const bbe::Color& color)
+{
+	for (size_t i = 0; i + 2 < amountOfIndices; i += 3)
+	{
+		RasterVertex triangle[3];
+		for (int k = 0; k < 3; k++)
+		{
+			const bbe::Vector2& vertex = vertices[indices[i + k]];
+			triangle[k].x = vertex.x * scale.x + pos.x;
+			triangle[k].y = vertex.y * scale.y + pos.y;
+			triangle[k].color = color;
+		}
+		m_rasterizer.addTriangle2D(triangle[0], triangle[1], triangle[2], nullptr);
+	}
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::setColor2D(const bbe::Color& color)
+{
+	m_color2D = color;
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::fillRect2D(const Rectangle& rect, float rotation, FragmentShader* shader)
+{
+	// Fragment shaders are GPU programs, shaded rects are drawn with their plain color.
+	addRect(rect, rotation, m_color2D, nullptr, 0, 0, 1, 1);
+	m_amountOfDrawcalls++;
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::fillCircle2D(const Circle& circle)
+{
+	m_rasterizer.addEllipse2D(circle.getPos(), circle.getDim(), m_color2D);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::drawImage2D(const Rectangle& rect, const Image& image, float rotation)
+{
+	addRect(rect, rotation, m_color2D, &image, 0, 0, 1, 1);
+	// The image doesn't have to outlive this call.
+	m_rasterizer.flush(m_parallel);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::fillVertexIndexList2D(const uint32_t* indices, size_t amountOfIndices, const bbe::Vector2* vertices, size_t amountOfVertices, const bbe::Vector2& pos, const bbe::Vector2& scale)
+{
+	addVertexIndexList(indices, amountOfIndices, vertices, pos, scale, m_color2D);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::submit2D(const bbe::CommandBuffer2D& commandBuffer)
+{
+	const bbe::List<bbe::DrawCommand2D>& commands = commandBuffer.getCommands();
+	const bbe::List<bbe::DrawBatch2D>& batches = commandBuffer.getBatches();
+	for (size_t i = 0; i < batches.getLength(); i++)
+	{
+		const bbe::DrawBatch2D& batch = batches[i];
+		for (size_t k = batch.firstCommand; k < batch.firstCommand + batch.amountOfCommands; k++)
+		{
+			const bbe::DrawCommand2D& command = commands[k];
+			switch (command.type)
+			{
+			case bbe::DrawCommandType2D::RECT:
+				addRect(bbe::Rectangle(command.x, command.y, command.width, command.height), command.rotation, command.color, nullptr, 0, 0, 1, 1);
+				break;
+			case bbe::DrawCommandType2D::CIRCLE:
+				m_rasterizer.addEllipse2D(bbe::Vector2(command.x, command.y), bbe::Vector2(command.width, command.height), command.color);
+				break;
+			case bbe::DrawCommandType2D::IMAGE:
+				addRect(bbe::Rectangle(command.x, command.y, command.width, command.height), command.rotation, command.color, command.image, command.uvX, command.uvY, command.uvWidth, command.uvHeight);
+				break;
+			case bbe::DrawCommandType2D::VERTEX_INDEX_LIST:
+				addVertexIndexList(
+					commandBuffer.getIndices().getRaw() + command.firstIndex, command.amountOfIndices,
+					commandBuffer.getVertices().getRaw() + command.firstVertex,
+					bbe::Vector2(command.x, command.y), bbe::Vector2(command.width, command.height), command.color);
+				break;
+			}
+		}
+	}
+	m_amountOfDrawcalls += (uint32_t)batches.getLength();
+	// The commands reference images that only have to live until the command buffer is cleared.
+	m_rasterizer.flush(m_parallel);
+}
+
+bool bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::isImageRegionSupported2D() const
+{
+	return true;
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::setColor3D(const bbe::Color& color)
+{
+	m_color3D = color;
+	m_color3D.a = 1.f;
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::setCamera3D(const bbe::Vector3& pos, const bbe::Matrix4& view, const bbe::Matrix4& projection)
+{
+	m_cameraPos = pos;
+	m_view = view;
+	m_projection = projection;
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::fillMesh3D(const bbe::Matrix4& transform, const bbe::List<bbe::PosNormalPair>& vertices, const bbe::List<uint32_t>& indices)
+{
+	const bbe::Matrix4 viewProjection = m_projection * m_view;
+	const uint32_t firstVertex = (uint32_t)m_vertices3D.getLength();
+	for (size_t i = 0; i < vertices.getLength(); i++)
+	{
+		const bbe::Vector4 worldPos = transform * bbe::Vector4(vertices[i].pos, 1.f);
+		Vertex3D vertex;
+		vertex.worldPos = worldPos.xyz();
+		vertex.normal = (transform * bbe::Vector4(vertices[i].normal, 0.f)).xyz().normalize();
+		vertex.clipPos = viewProjection * worldPos;
+		vertex.albedo = m_color3D;
+		m_vertices3D.add(vertex);
+	}
+	for (size_t i = 0; i < indices.getLength(); i++)
+	{
+		m_indices3D.add(firstVertex + indices[i]);
+	}
+	m_amountOfDrawcalls++;
+}
+
+bbe::Color bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::shadeVertex(const Vertex3D& vertex) const
+{
+	if (m_pointLights.getLength() == 0) return vertex.albedo;
+
+	// Diffuse part of the deferred light pass of the OpenGL backend, evaluated per vertex.
+	bbe::Vector3 retVal;
+	for (size_t i = 0; i < m_pointLights.getLength(); i++)
+	{
+		const bbe::PointLight& light = m_pointLights[i];
+		const bbe::Vector3 toLight = light.pos - vertex.worldPos;
+		const float distToLight = toLight.getLength();
+		float lightPower = light.lightStrength;
+		if (distToLight > 0.f)
+		{
+			switch (light.falloffMode)
+			{
+			case bbe::LightFalloffMode::LIGHT_FALLOFF_NONE:
+				break;
+			case bbe::LightFalloffMode::LIGHT_FALLOFF_LINEAR:
+				lightPower = lightPower / distToLight;
+				break;
+			case bbe::LightFalloffMode::LIGHT_FALLOFF_SQUARED:
+				lightPower = lightPower / distToLight / distToLight;
+				break;
+			case bbe::LightFalloffMode::LIGHT_FALLOFF_CUBIC:
+				lightPower = lightPower / distToLight / distToLight / distToLight;
+				break;
+			case bbe::LightFalloffMode::LIGHT_FALLOFF_SQRT:
+				lightPower = lightPower / bbe::Math::sqrt(distToLight);
+				break;
+			}
+		}
+		if (lightPower < 0.001f) continue;
+		const float diffuse = bbe::Math::max(vertex.normal * toLight.normalize(), 0.f) * lightPower;
+		retVal.x += vertex.albedo.r * light.lightColor.r * diffuse;
+		retVal.y += vertex.albedo.g * light.lightColor.g * diffuse;
+		retVal.z += vertex.albedo.b * light.lightColor.b * diffuse;
+	}
+	return bbe::Color(
+		bbe::Math::clamp01(retVal.x),
+		bbe::Math::clamp01(retVal.y),
+		bbe::Math::clamp01(retVal.z),
+		1.f);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::flush3D()
+{
+	bbe::List<bbe::Color> colors;
+	colors.resizeCapacityAndLength(m_vertices3D.getLength());
+	for (size_t i = 0; i < m_vertices3D.getLength(); i++)
+	{
+		colors[i] = shadeVertex(m_vertices3D[i]);
+	}
+	for (size_t i = 0; i + 2 < m_indices3D.getLength(); i += 3)
+	{
+		const uint32_t a = m_indices3D[i + 0];
+		const uint32_t b = m_indices3D[i + 1];
+		const uint32_t c = m_indices3D[i + 2];
+		m_rasterizer.addTriangle3D(m_vertices3D[a].clipPos, m_vertices3D[b].clipPos, m_vertices3D[c].clipPos, colors[a], colors[b], colors[c]);
+	}
+	m_vertices3D.clear();
+	m_indices3D.clear();
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::fillCube3D(const Cube& cube)
+{
+	fillMesh3D(cube.getTransform(), m_cubeVertices, m_cubeIndices);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::fillSphere3D(const IcoSphere& sphere)
+{
+	fillMesh3D(sphere.getTransform(), m_sphereVertices, m_sphereIndices);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::fillModel3D(const bbe::Matrix4& transform, const bbe::Model& model)
+{
+	fillMesh3D(transform, model.m_vertices, model.m_indices);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::addLight(const bbe::Vector3& pos, float lightStrength, const bbe::Color& lightColor, const bbe::Color& specularColor, LightFalloffMode falloffMode)
+{
+	bbe::PointLight light(pos);
+	light.lightStrength = lightStrength;
+	light.lightColor = lightColor;
+	light.specularColor = specularColor;
+	light.falloffMode = falloffMode;
+	m_pointLights.add(light);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::imguiStart()
+{
+	IMGUI_CHECKVERSION();
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	ImFontConfig fontConfig;
+	io.Fonts->AddFontDefault(&fontConfig);
+
+	unsigned char* pixels;
+	int width, height;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::imguiStop()
+{
+	ImGui::DestroyContext();
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::imguiStartFrame()
+{
+	ImGuiIO& io = ImGui::GetIO();
+	io.DisplaySize = ImVec2((float)m_windowWidth, (float)m_windowHeight);
+	ImGui::NewFrame();
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::imguiEndFrame()
+{
+	ImGui::Render();
+}
+
+bool bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::isReadyToDraw() const
+{
+	return true;
+}
+
+void bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::setParallel(bool parallel)
+{
+	m_parallel = parallel;
+}
+
+bbe::Image bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::getFramebuffer()
+{
+	m_rasterizer.flush(m_parallel);
+	return bbe::Image(m_rasterizer.getWidth(), m_rasterizer.getHeight(), m_rasterizer.getColorBuffer(), bbe::ImageFormat::R8G8B8A8);
+}
+
+uint32_t bbe::INTERNAL::softwareRenderer::SoftwareRendererManager::getAmountOfDrawcalls() const
+{
+	return m_amountOfDrawcallsPreviousFrame;
+}
@@ -1,17 +1,17 @@
 #include "BBE/Sound.h"
 #include "BBE/SoundManager.h"
 #include "BBE/Error.h"
-#include "BBE/SimpleFile.h"
+#include "BBE/MappedFile.h"
 #define MINIMP3_IMPLEMENTATION
 #ifndef BBE_NO_AUDIO
 
 #include "minimp3_ex.h"
 
-void bbe::Sound::loadMp3(const bbe::ByteBuffer& data)
+void bbe::Sound::loadMp3(const bbe::byte* data, size_t length)
 {
 	mp3dec_t mp3d = {};
 	mp3dec_file_info_t info = {};
-	const int err = mp3dec_load_buf(&mp3d, data.getRaw(), data.getLength(), &info, NULL, NULL);
+	const int err = mp3dec_load_buf(&mp3d, data, length, &info, NULL, NULL);
 	if (err)
 	{
 		free(info.buffer);
@@ -50,12 +50,12 @@ void bbe::Sound::loadMp3(const bbe::ByteBuffer& data)
 	free(info.buffer);
 }
 
-void bbe::Sound::loadRawMonoFloat44100(const bbe::ByteBuffer& data)
+void bbe::Sound::loadRawMonoFloat44100(const bbe::byte* data, size_t length)
 {
-	if (data.getLength() % sizeof(float) != 0) bbe::Crash(bbe::Error::IllegalArgument, "Not a multiple of float!");
+	if (length % sizeof(float) != 0) bbe::Crash(bbe::Error::IllegalArgument, "Not a multiple of float!");
 
-	m_data.resizeCapacityAndLengthUninit(data.getLength() / sizeof(float));
-	memcpy(m_data.getRaw(), data.getRaw(), data.getLength());
+	m_data.resizeCapacityAndLengthUninit(length / sizeof(float));
+	memcpy(m_data.getRaw(), data, length);
 
 	m_hz = 44100;
 	m_channels = 1;
@@ -73,11 +73,21 @@ bbe::Sound::Sound(const bbe::String& path, SoundLoadFormat soundLoadFormat)
 
 void bbe::Sound::load(const bbe::String& path, SoundLoadFormat soundLoadFormat)
 {
-	bbe::ByteBuffer data = bbe::simpleFile::readBinaryFile(path);
-	load(data, soundLoadFormat);
+	const bbe::MappedFile file(path);
+	load(file, soundLoadFormat);
 }
 
 void bbe::Sound::load(const bbe::ByteBuffer& data, SoundLoadFormat soundLoadFormat)
+{
+	load(data.getRaw(), data.getLength(), soundLoadFormat);
+}
+
+void bbe::Sound::load(const bbe::MappedFile& file, SoundLoadFormat soundLoadFormat)
+{
+	load(file.getRaw(), file.getLength(), soundLoadFormat);
+}
+
+void bbe::Sound::load(const bbe::byte* data, size_t length, SoundLoadFormat soundLoadFormat)
 {
 	if (isLoaded())
 	{
@@ -93,10 +103,10 @@ void bbe::Sound::load(const bbe::ByteBuffer& data, SoundLoadFormat soundLoadForm
 	switch (soundLoadFormat)
 	{
 	case SoundLoadFormat::MP3:
-		loadMp3(data);
+		loadMp3(data, length);
 		break;
 	case SoundLoadFormat::RAW_MONO_FLOAT_44100:
-		loadRawMonoFloat44100(data);
+		loadRawMonoFloat44100(data, length);
 		break;
 	default:
 		bbe::Crash(bbe::Error::IllegalArgument);
@@ -124,6 +134,22 @@ bool bbe::Sound::isLoaded() const
 	return m_loaded;
 }
 
+void bbe::SoundDataSourceDynamic::fillSamples(bbe::Span<float> out, size_t firstFrame, size_t frames, uint32_t channels) const
+{
+	if (out.getSize() < frames * channels)
+	{
+		bbe::Crash(bbe::Error::IllegalArgument);
+	}
+	float* raw = out.getRaw();
+	for (size_t i = 0; i < frames; i++)
+	{
+		for (uint32_t channel = 0; channel < channels; channel++)
+		{
+			raw[i * channels + channel] = getSample(firstFrame + i, channel);
+		}
+	}
+}
+
 bool bbe::SoundDataSourceStatic::isLooped() const
 {
 	return m_looped;
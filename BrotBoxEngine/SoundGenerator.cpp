@@ -15,16 +15,31 @@ int64_t bbe::SoundGenerator::getAmountOfSamples() const
 
 bbe::Sound bbe::SoundGenerator::finalize() const
 {
-	bbe::List<double> signal;
-	signal.resizeCapacityAndLength(getAmountOfSamples());
-
-	applyRecipes(signal);
+	return finalize(Precision::DOUBLE);
+}
 
+bbe::Sound bbe::SoundGenerator::finalize(Precision precision, bool parallel) const
+{
 	bbe::Sound retVal;
-	retVal.load(signal.as<float>());
+	retVal.load(render(precision, parallel));
 	return retVal;
 }
 
+bbe::List<float> bbe::SoundGenerator::render(Precision precision, bool parallel) const
+{
+	if (precision == Precision::FLOAT)
+	{
+		bbe::List<float> signal;
+		signal.resizeCapacityAndLength(getAmountOfSamples());
+		compile<float>().render(signal, parallel);
+		return signal;
+	}
+	bbe::List<double> signal;
+	signal.resizeCapacityAndLength(getAmountOfSamples());
+	compile<double>().render(signal, parallel);
+	return signal.as<float>();
+}
+
 void bbe::SoundGenerator::addRecipeSineWave(double offset, double mult, double frequency)
 {
 	recipes.add(Recipe(offset, mult, RecipeSine(frequency)));
@@ -85,62 +100,182 @@ void bbe::SoundGenerator::addRecipeEcho(double offset, double mult, double delay
 	recipes.add(Recipe(offset, mult, RecipeEcho{ delayTime, decayFactor }));
 }
 
-void bbe::SoundGenerator::applyRecipes(bbe::List<double>& signal) const
+template<typename T>
+bbe::dsp::Graph<T> bbe::SoundGenerator::compile() const
 {
+	// Same as 2 * PI of the recipes before they were compiled, which used the float PI.
+	constexpr double twoPi = (double)bbe::Math::PI * 2;
+	const size_t length = (size_t)getAmountOfSamples();
+	bbe::dsp::Graph<T> graph;
 	for (size_t i = 0; i < recipes.getLength(); i++)
 	{
 		const Recipe& r = recipes[i];
+		const double offset = r.offset;
+		const double mult = r.mult;
 
 		std::visit([&](auto&& arg)
 			{
-				using T = std::decay_t<decltype(arg)>;
-				if constexpr (std::is_same_v<T, RecipeSine>)
+				using R = std::decay_t<decltype(arg)>;
+				if constexpr (std::is_same_v<R, RecipeSine>)
 				{
-					applyRecipeSineWave(signal, r.offset, r.mult, arg.frequency);
+					const double phaseStep = 1.0 / hz * arg.frequency * twoPi;
+					graph.addPointwise([=](T* signal, size_t begin, size_t end)
+						{
+							bbe::dsp::addSine(signal, begin, end, offset, phaseStep, mult);
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeSquare>)
+				else if constexpr (std::is_same_v<R, RecipeSquare>)
 				{
-					applyRecipeSquareWave(signal, r.offset, r.mult, arg.highDur, arg.lowDur, arg.highValue, arg.lowValue);
+					graph.addPointwise([=](T* signal, size_t begin, size_t end)
+						{
+							const double totalDur = arg.highDur + arg.lowDur;
+							for (size_t k = begin; k < end; k++)
+							{
+								const double time = (double)k / hz + offset;
+								signal[k] += (T)((std::fmod(time, totalDur) < arg.highDur ? arg.highValue : arg.lowValue) * mult);
+							}
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeSawtooth>)
+				else if constexpr (std::is_same_v<R, RecipeSawtooth>)
 				{
-					applyRecipeSawtoothWave(signal, r.offset, r.mult, arg.period);
+					graph.addPointwise([=](T* signal, size_t begin, size_t end)
+						{
+							for (size_t k = begin; k < end; k++)
+							{
+								const double time = (double)k / hz + offset;
+								const double frac = std::fmod(time, arg.period) / arg.period;
+								signal[k] += (T)((frac * 2.0 - 1.0) * mult);
+							}
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeTriangle>)
+				else if constexpr (std::is_same_v<R, RecipeTriangle>)
 				{
-					applyRecipeTriangleWave(signal, r.offset, r.mult, arg.raiseDur, arg.fallDur, arg.upDur, arg.downDur);
+					graph.addPointwise([=](T* signal, size_t begin, size_t end)
+						{
+							for (size_t k = begin; k < end; k++)
+							{
+								const double time = (double)k / hz + offset;
+								const double modTime = std::fmod(time, arg.upDur + arg.downDur);
+								if (modTime < arg.upDur) // Rising part of the triangle wave
+								{
+									signal[k] += (T)(((modTime / arg.upDur) * arg.raiseDur) * mult);
+								}
+								else // Falling part of the triangle wave
+								{
+									signal[k] += (T)(((1.0 - ((modTime - arg.upDur) / arg.downDur)) * arg.fallDur) * mult);
+								}
+							}
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeADSR>)
+				else if constexpr (std::is_same_v<R, RecipeADSR>)
 				{
-					applyRecipeADSR(signal, arg.attackDur, arg.decayDur, arg.sustainLevel, arg.releaseDur);
+					const size_t attackSamples = (size_t)(arg.attackDur * hz);
+					const size_t decaySamples = (size_t)(arg.decayDur * hz);
+					const size_t releaseSamples = (size_t)(arg.releaseDur * hz);
+					const double sustainLevel = arg.sustainLevel;
+					graph.addPointwise([=](T* signal, size_t begin, size_t end)
+						{
+							for (size_t k = begin; k < end; k++)
+							{
+								if (k < attackSamples) // Attack phase
+								{
+									signal[k] *= (T)((double)k / attackSamples);
+								}
+								else if (k < attackSamples + decaySamples) // Decay phase
+								{
+									const size_t decayIndex = k - attackSamples;
+									signal[k] *= (T)(1.0 - (1.0 - sustainLevel) * ((double)decayIndex / decaySamples));
+								}
+								else if (k >= length - releaseSamples) // Release phase
+								{
+									const size_t releaseIndex = k - (length - releaseSamples);
+									signal[k] *= (T)(1.0 - (double)releaseIndex / releaseSamples);
+								}
+								else // Sustain phase
+								{
+									signal[k] *= (T)sustainLevel;
+								}
+							}
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeNormalization>)
+				else if constexpr (std::is_same_v<R, RecipeNormalization>)
 				{
-					applyRecipeNormalization(signal);
+					graph.addWholeSignal([](bbe::List<T>& signal, bool parallel)
+						{
+							bbe::dsp::normalize(signal, parallel);
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeRingModulation>)
+				else if constexpr (std::is_same_v<R, RecipeRingModulation>)
 				{
-					applyRecipeRingModulation(signal, r.offset, r.mult, arg.frequency, arg.modDepth);
+					const double phaseStep = 1.0 / hz * arg.frequency * twoPi;
+					const double modDepth = arg.modDepth;
+					graph.addPointwise([=](T* signal, size_t begin, size_t end)
+						{
+							bbe::dsp::multiplySine(signal, begin, end, 0.0, phaseStep, 1.0, modDepth);
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeChorusEffect>)
+				else if constexpr (std::is_same_v<R, RecipeChorusEffect>)
 				{
-					applyRecipeChorusEffect(signal, r.offset, r.mult, arg.delayTime, arg.depth, arg.rate);
+					const size_t delaySamples = (size_t)(arg.delayTime * hz);
+					const double depth = arg.depth;
+					const double rate = arg.rate;
+					// The modulation shifts the delay by at most this much in either direction.
+					const int64_t maxShift = (int64_t)(std::fabs(depth) * hz);
+					const size_t minDelay = (int64_t)delaySamples > maxShift ? delaySamples - (size_t)maxShift : 0;
+					graph.addWholeSignal([=](bbe::List<T>& signal, bool parallel)
+						{
+							T* data = signal.getRaw();
+							bbe::dsp::forEachIndependentBlock(delaySamples, signal.getLength(), minDelay, parallel, [&](size_t begin, size_t end)
+								{
+									for (size_t k = begin; k < end; k++)
+									{
+										const double mod = depth * bbe::Math::sin((double)k / hz * rate * twoPi);
+										const int64_t modDelay = (int64_t)delaySamples + (int64_t)(mod * hz);
+										if (modDelay >= 0 && (int64_t)k >= modDelay)
+										{
+											data[k] += (T)(data[k - modDelay] * mult);
+										}
+									}
+								});
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeLowPassFilter>)
+				else if constexpr (std::is_same_v<R, RecipeLowPassFilter>)
 				{
-					applyRecipeLowPassFilter(signal, r.offset, r.mult, arg.cutoffFrequency);
+					const double RC = 1.0 / (arg.cutoffFrequency * twoPi);
+					const double dt = 1.0 / hz;
+					const double alpha = dt / (RC + dt);
+					graph.addWholeSignal([=](bbe::List<T>& signal, bool parallel)
+						{
+							bbe::dsp::lowPass(signal, alpha, parallel);
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeBitcrusher>)
+				else if constexpr (std::is_same_v<R, RecipeBitcrusher>)
 				{
-					applyRecipeBitcrusher(signal, r.offset, r.mult, arg.bitDepth);
+					const double maxValue = (1 << (arg.bitDepth - 1)) - 1;
+					graph.addPointwise([=](T* signal, size_t begin, size_t end)
+						{
+							for (size_t k = begin; k < end; k++)
+							{
+								signal[k] = (T)(std::round(signal[k] * maxValue) / maxValue * mult);
+							}
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeFrequencyShifter>)
+				else if constexpr (std::is_same_v<R, RecipeFrequencyShifter>)
 				{
-					applyRecipeFrequencyShifter(signal, r.offset, r.mult, arg.frequencyShift);
+					const double phaseStep = 1.0 / hz * arg.frequencyShift * twoPi;
+					graph.addPointwise([=](T* signal, size_t begin, size_t end)
+						{
+							bbe::dsp::multiplySine(signal, begin, end, 0.0, phaseStep, 0.0, mult);
+						});
 				}
-				else if constexpr (std::is_same_v<T, RecipeEcho>)
+				else if constexpr (std::is_same_v<R, RecipeEcho>)
 				{
-					applyRecipeEcho(signal, r.offset, r.mult, arg.delayTime, arg.decayFactor);
+					const size_t delaySamples = (size_t)(arg.delayTime * hz);
+					const double factor = arg.decayFactor * mult;
+					graph.addWholeSignal([=](bbe::List<T>& signal, bool parallel)
+						{
+							bbe::dsp::feedbackDelay(signal, delaySamples, factor, parallel);
+						});
 				}
 				else
 				{
@@ -148,171 +283,8 @@ void bbe::SoundGenerator::applyRecipes(bbe::List<double>& signal) const
 				}
 			}, r.details);
 	}
+	return graph;
 }
 
-void bbe::SoundGenerator::applyRecipeSineWave(bbe::List<double>& signal, double offset, double mult, double frequency) const
-{
-	for (size_t i = 0; i < signal.getLength(); i++)
-	{
-		signal[i] += bbe::Math::sin(offset + (double)i / hz * frequency * bbe::Math::PI * 2) * mult;
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeSquareWave(bbe::List<double>& signal, double offset, double mult, double highDur, double lowDur, double highValue, double lowValue) const
-{
-	const double totalDur = highDur + lowDur;
-	for (size_t i = 0; i < signal.getLength(); i++)
-	{
-		const double time = (double)i / hz + offset;
-		if (std::fmod(time, totalDur) < highDur)
-		{
-			signal[i] += highValue * mult;
-		}
-		else
-		{
-			signal[i] += lowValue * mult;
-		}
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeSawtoothWave(bbe::List<double>& signal, double offset, double mult, double period) const
-{
-	for (size_t i = 0; i < signal.getLength(); i++)
-	{
-		double time = (double)i / hz + offset;
-		double frac = std::fmod(time, period) / period;
-		signal[i] += (frac * 2.0 - 1.0) * mult;
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeTriangleWave(bbe::List<double>& signal, double offset, double mult, double raiseDur, double fallDur, double upDur, double downDur) const
-{
-	const double totalDur = raiseDur + fallDur;
-	for (size_t i = 0; i < signal.getLength(); i++)
-	{
-		const double time = (double)i / hz + offset;
-		const double modTime = std::fmod(time, upDur + downDur);
-
-		if (modTime < upDur) // Rising part of the triangle wave
-		{
-			signal[i] += ((modTime / upDur) * raiseDur) * mult;
-		}
-		else // Falling part of the triangle wave
-		{
-			signal[i] += ((1.0 - ((modTime - upDur) / downDur)) * fallDur) * mult;
-		}
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeADSR(bbe::List<double>& signal, double attackDur, double decayDur, double sustainLevel, double releaseDur) const
-{
-	size_t attackSamples = (size_t)(attackDur * hz);
-	size_t decaySamples = (size_t)(decayDur * hz);
-	size_t releaseSamples = (size_t)(releaseDur * hz);
-
-	for (size_t i = 0; i < signal.getLength(); i++)
-	{
-		if (i < attackSamples) // Attack phase
-		{
-			signal[i] *= (double)i / attackSamples;
-		}
-		else if (i < attackSamples + decaySamples) // Decay phase
-		{
-			size_t decayIndex = i - attackSamples;
-			signal[i] *= (1.0 - (1.0 - sustainLevel) * ((double)decayIndex / decaySamples));
-		}
-		else if (i >= signal.getLength() - releaseSamples) // Release phase
-		{
-			size_t releaseIndex = i - (signal.getLength() - releaseSamples);
-			signal[i] *= (1.0 - (double)releaseIndex / releaseSamples);
-		}
-		else // Sustain phase
-		{
-			signal[i] *= sustainLevel;
-		}
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeNormalization(bbe::List<double>& signal) const
-{
-	double maxAmplitude = 0.0;
-	// Find the maximum absolute amplitude
-	for (size_t i = 0; i < signal.getLength(); i++)
-	{
-		if (std::fabs(signal[i]) > maxAmplitude)
-		{
-			maxAmplitude = std::fabs(signal[i]);
-		}
-	}
-	// Normalize the signal to the maximum amplitude
-	if (maxAmplitude > 0.0)
-	{
-		for (size_t i = 0; i < signal.getLength(); i++)
-		{
-			signal[i] /= maxAmplitude;
-		}
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeRingModulation(bbe::List<double>& signal, double offset, double mult, double frequency, double modDepth) const
-{
-	for (size_t i = 0; i < signal.getLength(); i++)
-	{
-		double modulator = bbe::Math::sin((double)i / hz * frequency * bbe::Math::PI * 2);
-		signal[i] *= (1.0 + modDepth * modulator);
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeChorusEffect(bbe::List<double>& signal, double offset, double mult, double delayTime, double depth, double rate) const
-{
-	size_t delaySamples = (size_t)(delayTime * hz);
-	for (size_t i = delaySamples; i < signal.getLength(); i++)
-	{
-		double mod = depth * bbe::Math::sin((double)i / hz * rate * bbe::Math::PI * 2);
-		size_t modDelay = delaySamples + (size_t)(mod * hz);
-		if (i >= modDelay)
-		{
-			signal[i] += signal[i - modDelay] * mult;
-		}
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeLowPassFilter(bbe::List<double>& signal, double offset, double mult, double cutoffFrequency) const
-{
-	double RC = 1.0 / (cutoffFrequency * 2 * bbe::Math::PI);
-	double dt = 1.0 / hz;
-	double alpha = dt / (RC + dt);
-
-	double previousValue = signal[0];
-	for (size_t i = 1; i < signal.getLength(); i++)
-	{
-		signal[i] = previousValue + alpha * (signal[i] - previousValue);
-		previousValue = signal[i];
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeBitcrusher(bbe::List<double>& signal, double offset, double mult, int bitDepth) const
-{
-	double maxValue = (1 << (bitDepth - 1)) - 1;
-	for (size_t i = 0; i < signal.getLength(); i++)
-	{
-		signal[i] = round(signal[i] * maxValue) / maxValue * mult;
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeFrequencyShifter(bbe::List<double>& signal, double offset, double mult, double frequencyShift) const
-{
-	for (size_t i = 0; i < signal.getLength(); i++)
-	{
-		signal[i] *= bbe::Math::sin((double)i / hz * frequencyShift * bbe::Math::PI * 2) * mult;
-	}
-}
-
-void bbe::SoundGenerator::applyRecipeEcho(bbe::List<double>& signal, double offset, double mult, double delayTime, double decayFactor) const
-{
-	size_t delaySamples = (size_t)(delayTime * hz);
-	for (size_t i = delaySamples; i < signal.getLength(); i++)
-	{
-		signal[i] += signal[i - delaySamples] * decayFactor * mult;
-	}
-}
+template bbe::dsp::Graph<float> bbe::SoundGenerator::compile<float>() const;
+template bbe::dsp::Graph<double> bbe::SoundGenerator::compile<double>() const;
@@ -1,8 +1,10 @@
 #ifndef BBE_NO_AUDIO
 
 #include "BBE/SoundManager.h"
+#include "BBE/SoundMixer.h"
 #include "BBE/Error.h"
 #include "BBE/Logging.h"
+#include "BBE/Profiler.h"
 #include "BBE/WriterReaderBuffer.h"
 #include <algorithm>
 #include <iostream>
@@ -26,7 +28,7 @@ namespace bbe
 }
 
 // No mutexes:
-using BufferContents = bbe::Array<bbe::Vector2, 1024>;
+using BufferContents = bbe::Array<float, bbe::INTERNAL::SoundMixer::BLOCK_FRAMES * 2>;
 
 static bbe::List<ALuint> staticSources;
 
@@ -45,8 +47,7 @@ struct ListenerData
 };
 static bbe::WriterReaderBuffer<ListenerData, 1024> newListenerData;
 static auto newListenerDataReader = newListenerData.reader();
-static ListenerData listener;
-static ListenerData listenerPrevious;
+static bbe::INTERNAL::SoundMixer mixer;
 static std::atomic_bool restartRequest = false;
 
 struct SetPositionRequest
@@ -188,105 +189,19 @@ static void freeStaticSource(ALuint source)
 
 struct SoundInstanceData
 {
-	uint64_t m_samples_loaded = 0;
-	const bbe::SoundDataSource* m_psound = nullptr;
-	float m_volume = 1.0f;
-	bool posAvailable = false;
-	bbe::Vector3 pos;
-	bbe::Vector3 posPreviousLoad;
-
-	bool stopRequested = false;
-	bool readyForDelete = false;
+	// Dynamic sounds are played by the mixer, static ones by a source of their own.
+	bool dynamic = false;
 	ALuint source = 0;
 
-	void loadDynamicBuffer(const bbe::SoundDataSourceDynamic* sdsd, bbe::Vector2* samples, size_t numSamples)
-	{
-		const uint32_t channels = sdsd->getAmountOfChannels();
-		for (size_t i = 0; i < numSamples; i++)
-		{
-			bbe::Vector2 sample;
-			float percentage = (float)i / (float)numSamples;
-
-			if (channels == 1)
-			{
-				float leftMult = 1.0f;
-				float rightMult = 1.0f;
-
-				if (posAvailable)
-				{
-					bbe::Vector3 lerpedPos = bbe::Math::interpolateLinear(posPreviousLoad, pos, percentage);
-					bbe::Vector3 lerpedListenerPos = bbe::Math::interpolateLinear(listenerPrevious.pos, listener.pos, percentage);
-
-					bbe::Vector3 toListener = lerpedListenerPos - lerpedPos;
-					bbe::Vector2 toListener2d = bbe::Vector2(toListener.x, toListener.y);
-					bbe::Vector2 toListener2dNorm = toListener2d.normalize();
-
-					// TODO: Slerp instead?
-					bbe::Vector3 lerpedDirection = bbe::Math::interpolateLinear(listenerPrevious.dir, listener.dir, percentage).normalize();
-
-					bbe::Vector2 listenerRight = bbe::Vector2(-lerpedDirection.y, lerpedDirection.x).normalize();
-
-					//TODO: This isn't quite right. When looking directly at a sound, it still is coming more from one side than the other
-					rightMult = toListener2dNorm * listenerRight;
-					leftMult = 1.0f - rightMult;
-
-					float distSq = toListener.getLengthSq();
-					if (distSq < 1.0f) distSq = 1.0f;
-					rightMult /= distSq;
-					leftMult /= distSq;
-				}
-
-				float val = sdsd->getSample(m_samples_loaded, 0);
-				sample = bbe::Vector2(leftMult * val, rightMult * val);
-			}
-			else if (channels == 2)
-			{
-				if (posAvailable)
-				{
-					// A position for a multi channel sound is currently unsupported.
-					bbe::Crash(bbe::Error::IllegalState);
-				}
-				sample = bbe::Vector2(
-					sdsd->getSample(m_samples_loaded, 0),
-					sdsd->getSample(m_samples_loaded, 1));
-			}
-			else
-			{
-				bbe::Crash(bbe::Error::IllegalState);
-			}
-
-			if (stopRequested)
-			{
-				sample *= (1.0f - percentage);
-			}
-			samples[i] += sample * m_volume;
-
-			m_samples_loaded++;
-		}
-
-		if (stopRequested)
-		{
-			readyForDelete = true;
-		}
-		posPreviousLoad = pos;
-	}
-
-	bool isPlaying() const
+	bool isPlaying(uint64_t index) const
 	{
-		if (dynamic_cast<const bbe::SoundDataSourceDynamic*>(m_psound))
+		if (dynamic)
 		{
-			return true;
-		}
-		else if (dynamic_cast<const bbe::SoundDataSourceStatic*>(m_psound))
-		{
-			ALint state = 0;
-			eh::alGetSourcei(source, AL_SOURCE_STATE, &state);
-			return state == AL_PLAYING;
-		}
-		else
-		{
-			bbe::Crash(bbe::Error::IllegalState);
+			return mixer.isPlaying(index);
 		}
+		ALint state = 0;
+		eh::alGetSourcei(source, AL_SOURCE_STATE, &state);
+		return state == AL_PLAYING;
 	}
 };
 static std::map<uint64_t, SoundInstanceData> playingSounds;
@@ -303,6 +218,7 @@ static void destroySoundSystem()
 		removedIds.add(sound.first);
 	}
 	playingSounds.clear();
+	mixer.clear();
 	for (ALuint source : staticSources)
 	{
 		freeStaticSource(source);
@@ -339,28 +255,11 @@ static ALint freeUsedUpBuffers()
 static void loadAllBuffers()
 {
 	BufferContents samples;
-
-	for (auto it = playingSounds.begin(); it != playingSounds.end(); ++it)
-	{
-		SoundInstanceData& sid = it->second;
-		if (const bbe::SoundDataSourceDynamic* sdsd = dynamic_cast<const bbe::SoundDataSourceDynamic*>(sid.m_psound))
-		{
-			sid.loadDynamicBuffer(sdsd, samples.getRaw(), samples.getLength());
-			if (sid.m_psound->getHz() != 44100)
-			{
-				bbe::String errorMsg = "";
-				errorMsg += sid.m_psound->getHz();
-				errorMsg += " Hz not supported";
-				bbe::Crash(bbe::Error::IllegalState, errorMsg.getRaw());
-			}
-		}
-	}
+	mixer.mix(samples.getRaw(), bbe::INTERNAL::SoundMixer::BLOCK_FRAMES);
 
 	ALuint buffer = getNewBuffer();
-	eh::alBufferData(buffer, AL_FORMAT_STEREO_FLOAT32, samples.getRaw(), (ALsizei)(sizeof(bbe::Vector2) * samples.getLength()), 44100); // TODO HZ
+	eh::alBufferData(buffer, AL_FORMAT_STEREO_FLOAT32, samples.getRaw(), (ALsizei)(sizeof(float) * samples.getLength()), bbe::INTERNAL::SoundMixer::HZ);
 	eh::alSourceQueueBuffers(mainSource, 1, &buffer);
-
-	listenerPrevious = listener;
 }
 
 static void refreshBuffers()
@@ -439,11 +338,7 @@ static void updateSoundSystem()
 		while(setPositionRequestsReader.hasNext())
 		{
 			const SetPositionRequest& spr = setPositionRequestsReader.next();
-			auto it = playingSounds.find(spr.index);
-			if (it != playingSounds.end())
-			{
-				it->second.pos = spr.pos;
-			}
+			mixer.setPosition(spr.index, spr.pos);
 		}
 	}
 
@@ -452,10 +347,6 @@ static void updateSoundSystem()
 		{
 			const PlayRequest& pr = playRequestsReader.next();
 			SoundInstanceData sid;
-			sid.m_psound = pr.sound;
-			sid.m_volume = pr.volume;
-			sid.pos = pr.pos;
-			sid.posAvailable = pr.posAvailable;
 
 			if (const bbe::SoundDataSourceStatic* SDSS = dynamic_cast<const bbe::SoundDataSourceStatic*>(pr.sound))
 			{
@@ -485,8 +376,10 @@ static void updateSoundSystem()
 				eh::alSourcePlay(source);
 				sid.source = source;
 			}
-			else if (dynamic_cast<const bbe::SoundDataSourceDynamic*>(pr.sound))
+			else if (const bbe::SoundDataSourceDynamic* SDSD = dynamic_cast<const bbe::SoundDataSourceDynamic*>(pr.sound))
 			{
+				mixer.add(pr.index, *SDSD, pr.volume, pr.posAvailable ? &pr.pos : nullptr);
+				sid.dynamic = true;
 				usingDynamicSounds = true;
 			}
 			else
@@ -500,7 +393,7 @@ static void updateSoundSystem()
 
 	for (auto it = playingSounds.begin(); it != playingSounds.end(); /*no inc*/)
 	{
-		if (!it->second.isPlaying() || it->second.readyForDelete)
+		if (!it->second.isPlaying(it->first))
 		{
 			removedIds.add(it->first);
 			playingSounds.erase(it++);
@@ -515,11 +408,7 @@ static void updateSoundSystem()
 		while (stopRequestsReader.hasNext())
 		{
 			const int64_t& index = stopRequestsReader.next();
-			auto it = playingSounds.find(index);
-			if (it != playingSounds.end())
-			{
-				it->second.stopRequested = true;
-			}
+			mixer.stop(index);
 		}
 	}
 
@@ -551,7 +440,8 @@ static void updateSoundSystem()
 	{
 		while (newListenerDataReader.hasNext())
 		{
-			listener = newListenerDataReader.next();
+			const ListenerData& listener = newListenerDataReader.next();
+			mixer.setListener(listener.pos, listener.dir);
 		}
 		refreshBuffers();
 	}
@@ -587,10 +477,14 @@ static void initSoundSystemLoop()
 
 static void innerSoundSystemMain()
 {
+	bbe::profiler::setThreadName("Sound Thread");
 	initSoundSystemLoop();
 	while (!isEndRequested())
 	{
-		updateSoundSystem();
+		{
+			BBE_PROFILE_ZONE("Sound Update");
+			updateSoundSystem();
+		}
 		if (!previouslyDied)
 		{
 			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // A more relaxed version of yield...
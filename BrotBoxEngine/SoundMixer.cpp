@@ -0,0 +1,248 @@
+#ifndef BBE_NO_AUDIO
+
+#include "BBE/SoundMixer.h"
+#include "BBE/Error.h"
+#include "BBE/Math.h"
+#include "BBE/StopWatch.h"
+#include "BBE/String.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BBE_MIXER_SSE
+#include <emmintrin.h>
+#endif
+
+bbe::INTERNAL::SoundMixer::Voice* bbe::INTERNAL::SoundMixer::findVoice(uint64_t id)
+{
+	for (size_t i = 0; i < m_voices.getLength(); i++)
+	{
+		if (m_voices[i].id == id) return &m_voices[i];
+	}
+	return nullptr;
+}
+
+bbe::INTERNAL::SoundMixer::Gains bbe::INTERNAL::SoundMixer::getGains(const Voice& voice, const Listener& listener, const bbe::Vector3& pos) const
+{
+	Gains retVal;
+	if (voice.posAvailable)
+	{
+		const bbe::Vector3 toListener = listener.pos - pos;
+		const bbe::Vector2 toListener2dNorm = bbe::Vector2(toListener.x, toListener.y).normalize();
+		const bbe::Vector3 direction = listener.dir.normalize();
+		const bbe::Vector2 listenerRight = bbe::Vector2(-direction.y, direction.x).normalize();
+
+		//TODO: This isn't quite right. When looking directly at a sound, it still is coming more from one side than the other
+		retVal.right = toListener2dNorm * listenerRight;
+		retVal.left = 1.0f - retVal.right;
+
+		float distSq = toListener.getLengthSq();
+		if (distSq < 1.0f) distSq = 1.0f;
+		retVal.right /= distSq;
+		retVal.left /= distSq;
+	}
+	retVal.left *= voice.volume;
+	retVal.right *= voice.volume;
+	return retVal;
+}
+
+void bbe::INTERNAL::SoundMixer::add(uint64_t id, const bbe::SoundDataSourceDynamic& source, float volume, const bbe::Vector3* pos)
+{
+	if (source.getHz() != HZ)
+	{
+		bbe::String errorMsg = "";
+		errorMsg += source.getHz();
+		errorMsg += " Hz not supported";
+		bbe::Crash(bbe::Error::IllegalState, errorMsg.getRaw());
+	}
+
+	Voice voice;
+	voice.id = id;
+	voice.source = &source;
+	voice.channels = source.getAmountOfChannels();
+	voice.volume = volume;
+	if (voice.channels != 1 && voice.channels != 2)
+	{
+		bbe::Crash(bbe::Error::IllegalState);
+	}
+	if (pos != nullptr)
+	{
+		if (voice.channels != 1)
+		{
+			// A position for a multi channel sound is currently unsupported.
+			bbe::Crash(bbe::Error::IllegalState);
+		}
+		voice.posAvailable = true;
+		voice.pos = *pos;
+		voice.posPreviousMix = *pos;
+	}
+	m_voices.add(voice);
+}
+
+void bbe::INTERNAL::SoundMixer::stop(uint64_t id)
+{
+	if (Voice* voice = findVoice(id))
+	{
+		voice->stopRequested = true;
+	}
+}
+
+void bbe::INTERNAL::SoundMixer::setPosition(uint64_t id, const bbe::Vector3& pos)
+{
+	if (Voice* voice = findVoice(id))
+	{
+		voice->pos = pos;
+	}
+}
+
+void bbe::INTERNAL::SoundMixer::setListener(const bbe::Vector3& pos, const bbe::Vector3& lookDirection)
+{
+	m_listener.pos = pos;
+	m_listener.dir = lookDirection;
+}
+
+void bbe::INTERNAL::SoundMixer::clear()
+{
+	m_voices.clear();
+}
+
+bool bbe::INTERNAL::SoundMixer::isPlaying(uint64_t id) const
+{
+	for (size_t i = 0; i < m_voices.getLength(); i++)
+	{
+		if (m_voices[i].id == id) return true;
+	}
+	return false;
+}
+
+size_t bbe::INTERNAL::SoundMixer::getAmountOfVoices() const
+{
+	return m_voices.getLength();
+}
+
+void bbe::INTERNAL::SoundMixer::mix(float* out, size_t frames)
+{
+	memset(out, 0, sizeof(float) * 2 * frames);
+	for (size_t i = 0; i < m_voices.getLength(); i++)
+	{
+		Voice& voice = m_voices[i];
+		const size_t samples = frames * voice.channels;
+		if (m_scratch.getLength() < samples)
+		{
+			m_scratch.resizeCapacityAndLength(samples);
+		}
+		voice.source->fillSamples(bbe::Span<float>(m_scratch.getRaw(), samples), voice.framesMixed, frames, voice.channels);
+
+		const Gains from = getGains(voice, m_listenerPreviousMix, voice.posPreviousMix);
+		// Stopping fades out over the block instead of cutting off, which would click.
+		const Gains to = voice.stopRequested ? Gains{ 0.0f, 0.0f } : getGains(voice, m_listener, voice.pos);
+		mixer::addRamped(out, m_scratch.getRaw(), voice.channels, frames, from.left, from.right, to.left, to.right);
+
+		voice.framesMixed += frames;
+		voice.posPreviousMix = voice.pos;
+	}
+
+	for (size_t i = m_voices.getLength(); i > 0; i--)
+	{
+		if (m_voices[i - 1].stopRequested)
+		{
+			m_voices.removeIndex(i - 1);
+		}
+	}
+	m_listenerPreviousMix = m_listener;
+}
+
+bbe::INTERNAL::NullAudioOutput::NullAudioOutput(SoundMixer& mixer, size_t blockFrames) :
+	m_pmixer(&mixer)
+{
+	m_block.resizeCapacityAndLength(blockFrames * 2);
+}
+
+int64_t bbe::INTERNAL::NullAudioOutput::pull()
+{
+	bbe::StopWatch sw;
+	m_pmixer->mix(m_block.getRaw(), getBlockFrames());
+	m_lastMixNanoseconds = sw.getTimeExpiredNanoseconds();
+	m_framesPlayed += getBlockFrames();
+	return m_lastMixNanoseconds;
+}
+
+const float* bbe::INTERNAL::NullAudioOutput::getLastBlock() const
+{
+	return m_block.getRaw();
+}
+
+size_t bbe::INTERNAL::NullAudioOutput::getBlockFrames() const
+{
+	return m_block.getLength() / 2;
+}
+
+uint64_t bbe::INTERNAL::NullAudioOutput::getFramesPlayed() const
+{
+	return m_framesPlayed;
+}
+
+int64_t bbe::INTERNAL::NullAudioOutput::getLastMixNanoseconds() const
+{
+	return m_lastMixNanoseconds;
+}
+
+void bbe::INTERNAL::mixer::addRamped(float* out, const float* in, uint32_t inChannels, size_t frames, float leftFrom, float rightFrom, float leftTo, float rightTo)
+{
+	if (frames == 0) return;
+	const float leftStep = (leftTo - leftFrom) / (float)frames;
+	const float rightStep = (rightTo - rightFrom) / (float)frames;
+
+	size_t i = 0;
+#ifdef BBE_MIXER_SSE
+	// Lanes hold the left and right gain of two neighbouring frames.
+	const __m128 from = _mm_setr_ps(leftFrom, rightFrom, leftFrom, rightFrom);
+	const __m128 step = _mm_setr_ps(leftStep, rightStep, leftStep, rightStep);
+	const __m128 offset01 = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+	if (inChannels == 1)
+	{
+		const __m128 offset23 = _mm_setr_ps(2.0f, 2.0f, 3.0f, 3.0f);
+		for (; i + 4 <= frames; i += 4)
+		{
+			const __m128 index = _mm_set1_ps((float)i);
+			const __m128 gains01 = _mm_add_ps(from, _mm_mul_ps(step, _mm_add_ps(index, offset01)));
+			const __m128 gains23 = _mm_add_ps(from, _mm_mul_ps(step, _mm_add_ps(index, offset23)));
+			const __m128 samples = _mm_loadu_ps(in + i);
+			const __m128 samples01 = _mm_unpacklo_ps(samples, samples);
+			const __m128 samples23 = _mm_unpackhi_ps(samples, samples);
+			_mm_storeu_ps(out + 2 * i,     _mm_add_ps(_mm_loadu_ps(out + 2 * i),     _mm_mul_ps(samples01, gains01)));
+			_mm_storeu_ps(out + 2 * i + 4, _mm_add_ps(_mm_loadu_ps(out + 2 * i + 4), _mm_mul_ps(samples23, gains23)));
+		}
+	}
+	else if (inChannels == 2)
+	{
+		for (; i + 2 <= frames; i += 2)
+		{
+			const __m128 gains = _mm_add_ps(from, _mm_mul_ps(step, _mm_add_ps(_mm_set1_ps((float)i), offset01)));
+			const __m128 samples = _mm_loadu_ps(in + 2 * i);
+			_mm_storeu_ps(out + 2 * i, _mm_add_ps(_mm_loadu_ps(out + 2 * i), _mm_mul_ps(samples, gains)));
+		}
+	}
+#endif
+
+	for (; i < frames; i++)
+	{
+		const float left = leftFrom + leftStep * (float)i;
+		const float right = rightFrom + rightStep * (float)i;
+		if (inChannels == 1)
+		{
+			out[2 * i]     += in[i] * left;
+			out[2 * i + 1] += in[i] * right;
+		}
+		else if (inChannels == 2)
+		{
+			out[2 * i]     += in[2 * i] * left;
+			out[2 * i + 1] += in[2 * i + 1] * right;
+		}
+		else
+		{
+			bbe::Crash(bbe::Error::IllegalArgument);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,75 @@
+#include "BBE/StreamRing.h"
+#include "BBE/Error.h"
+
+static size_t alignOffset(size_t offset)
+{
+	return (offset + bbe::StreamRing::alignment - 1) & ~(bbe::StreamRing::alignment - 1);
+}
+
+bbe::StreamRing::StreamRing(size_t segmentSize)
+{
+	resize(segmentSize);
+}
+
+size_t bbe::StreamRing::beginFrame()
+{
+	m_segment = (m_segment + 1) % amountOfSegments;
+	m_offset = 0;
+	m_amountOfStreamedBytes = 0;
+	return m_segment;
+}
+
+bool bbe::StreamRing::fits(size_t length) const
+{
+	return alignOffset(m_offset) + length <= m_segmentSize;
+}
+
+size_t bbe::StreamRing::getGrownSegmentSize(size_t length) const
+{
+	size_t newSegmentSize = m_segmentSize * 2;
+	while (newSegmentSize < length) newSegmentSize *= 2;
+	return newSegmentSize;
+}
+
+void bbe::StreamRing::resize(size_t segmentSize)
+{
+	if (segmentSize == 0)
+	{
+		bbe::Crash(bbe::Error::IllegalArgument);
+	}
+	m_segmentSize = segmentSize;
+	m_segment = 0;
+	m_offset = 0;
+}
+
+size_t bbe::StreamRing::allocate(size_t length)
+{
+	if (!fits(length))
+	{
+		bbe::Crash(bbe::Error::IllegalArgument);
+	}
+	const size_t alignedOffset = alignOffset(m_offset);
+	m_offset = alignedOffset + length;
+	m_amountOfStreamedBytes += length;
+	return m_segment * m_segmentSize + alignedOffset;
+}
+
+size_t bbe::StreamRing::getSegmentSize() const
+{
+	return m_segmentSize;
+}
+
+size_t bbe::StreamRing::getBufferSize() const
+{
+	return m_segmentSize * amountOfSegments;
+}
+
+size_t bbe::StreamRing::getSegment() const
+{
+	return m_segment;
+}
+
+size_t bbe::StreamRing::getAmountOfStreamedBytes() const
+{
+	return m_amountOfStreamedBytes;
+}
@@ -222,6 +222,11 @@ bool bbe::Utf8String::operator==(const char*       other) const
 {
 	return strcmp(getRaw(), other) == 0;
 }
+
+bool bbe::Utf8String::operator==(std::string_view  other) const
+{
+	return std::string_view(getRaw()) == other;
+}
 namespace bbe
 {
 	bool operator==(const char* arr, const bbe::Utf8String& string)
@@ -1127,27 +1132,33 @@ std::wstring bbe::Utf8String::toStdWString() const
 }
 
 
-template<>
-uint32_t bbe::hash(const bbe::String & t)
+// FNV-1a over the UTF-8 bytes. Strings, const char* and std::string_view with the same content hash the same, so that
+// they can be used interchangeably to look up String keys.
+static uint32_t hashBytes(const char* data, size_t length)
 {
-	//UNTESTED
-	//This function is based on the djb2 hashing algorithm by Dan Bernstein
-	//See: http://www.cse.yorku.ca/~oz/hash.html
-	//Changes to the original algorithm:
-	//  1. A 32 bit hash is used instead of a 64 bit hash
-	//  2. Only the first 128 chars are used for hashing
-	//  3. wchar_t is used instead of char
-	uint32_t _hash = 5381;
-	size_t length = utf8len(t.getRaw());
-	if (length > 128)
-	{
-		length = 128;
-	}
-
+	uint32_t _hash = 2166136261u;
 	for (size_t i = 0; i < length; i++)
 	{
-		_hash = ((_hash << 5) + _hash) + t[i];
+		_hash ^= (uint8_t)data[i];
+		_hash *= 16777619u;
 	}
-
 	return _hash;
 }
+
+template<>
+uint32_t bbe::hash(const bbe::String & t)
+{
+	return hashBytes(t.getRaw(), t.getLengthBytes());
+}
+
+template<>
+uint32_t bbe::hash(const char* const & t)
+{
+	return hashBytes(t, strlen(t));
+}
+
+template<>
+uint32_t bbe::hash(const std::string_view & t)
+{
+	return hashBytes(t.data(), t.size());
+}
@@ -12,6 +12,13 @@ uint32_t bbe::hash(const Vector2& t)
 	return uint32_t((((int32_t)t.x) ^ ((int32_t)t.y)) + t.x * 7001.f + t.y * 17.f);
 }
 
+template<>
+uint32_t bbe::hash(const Vector2i64& t)
+{
+	const uint64_t h = (uint64_t)t.x * 0x9E3779B97F4A7C15ull ^ (uint64_t)t.y * 0xC2B2AE3D27D4EB4Full;
+	return (uint32_t)(h ^ (h >> 32));
+}
+
 void bbe::LineIterator::init(const bbe::Vector2i& a, const bbe::Vector2i& b)
 {
 	this->a = a;
@@ -1,39 +1,135 @@
 #include "BBE/ViewFrustum.h"
+#include "BBE/Math.h"
+#include "BBE/Error.h"
 
-void bbe::INTERNAL::vulkan::ViewFrustum::updatePlanes(const bbe::Matrix4 &mvpMatrix)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BBE_FRUSTUM_SSE
+#include <emmintrin.h>
+#endif
+
+bbe::ViewFrustum::ViewFrustum()
 {
-	planes[0].x = mvpMatrix.get(3, 0) + mvpMatrix.get(0, 0);
-	planes[0].y = mvpMatrix.get(3, 1) + mvpMatrix.get(0, 1);
-	planes[0].z = mvpMatrix.get(3, 2) + mvpMatrix.get(0, 2);
-	planes[0].w = mvpMatrix.get(3, 3) + mvpMatrix.get(0, 3);
+	for (size_t i = 0; i < amountOfPaddedPlanes; i++)
+	{
+		m_planesX[i] = 0;
+		m_planesY[i] = 0;
+		m_planesZ[i] = 0;
+		m_planesW[i] = 1;
+	}
+}
 
-	planes[1].x = mvpMatrix.get(3, 0) - mvpMatrix.get(0, 0);
-	planes[1].y = mvpMatrix.get(3, 1) - mvpMatrix.get(0, 1);
-	planes[1].z = mvpMatrix.get(3, 2) - mvpMatrix.get(0, 2);
-	planes[1].w = mvpMatrix.get(3, 3) - mvpMatrix.get(0, 3);
+bbe::ViewFrustum::ViewFrustum(const bbe::Matrix4& viewProjection)
+	: ViewFrustum()
+{
+	updatePlanes(viewProjection);
+}
 
-	planes[2].x = mvpMatrix.get(3, 0) - mvpMatrix.get(1, 0);
-	planes[2].y = mvpMatrix.get(3, 1) - mvpMatrix.get(1, 1);
-	planes[2].z = mvpMatrix.get(3, 2) - mvpMatrix.get(1, 2);
-	planes[2].w = mvpMatrix.get(3, 3) - mvpMatrix.get(1, 3);
+void bbe::ViewFrustum::updatePlanes(const bbe::Matrix4& viewProjection)
+{
+	const bbe::Vector4 row0 = viewProjection.getRow(0);
+	const bbe::Vector4 row1 = viewProjection.getRow(1);
+	const bbe::Vector4 row2 = viewProjection.getRow(2);
+	const bbe::Vector4 row3 = viewProjection.getRow(3);
 
-	planes[3].x = mvpMatrix.get(3, 0) + mvpMatrix.get(1, 0);
-	planes[3].y = mvpMatrix.get(3, 1) + mvpMatrix.get(1, 1);
-	planes[3].z = mvpMatrix.get(3, 2) + mvpMatrix.get(1, 2);
-	planes[3].w = mvpMatrix.get(3, 3) + mvpMatrix.get(1, 3);
+	const bbe::Vector4 planes[amountOfPlanes] = {
+		row3 + row0,
+		row3 - row0,
+		row3 + row1,
+		row3 - row1,
+		row3 + row2,
+		row3 - row2,
+	};
 
-	planes[4].x = mvpMatrix.get(3, 0) + mvpMatrix.get(2, 0);
-	planes[4].y = mvpMatrix.get(3, 1) + mvpMatrix.get(2, 1);
-	planes[4].z = mvpMatrix.get(3, 2) + mvpMatrix.get(2, 2);
-	planes[4].w = mvpMatrix.get(3, 3) + mvpMatrix.get(2, 3);
+	for (size_t i = 0; i < amountOfPlanes; i++)
+	{
+		const bbe::Vector4 plane = planes[i].normalizeXYZ();
+		m_planesX[i] = plane.x;
+		m_planesY[i] = plane.y;
+		m_planesZ[i] = plane.z;
+		m_planesW[i] = plane.w;
+	}
+}
 
-	for (int i = 0; i < 5; i++)
+bbe::Vector4 bbe::ViewFrustum::getPlane(size_t index) const
+{
+	if (index >= amountOfPlanes)
 	{
-		planes[i] = planes[i].normalizeXYZ();
+		bbe::Crash(bbe::Error::IllegalIndex);
 	}
+	return bbe::Vector4(m_planesX[index], m_planesY[index], m_planesZ[index], m_planesW[index]);
 }
 
-bbe::Vector4 * bbe::INTERNAL::vulkan::ViewFrustum::getPlanes()
+bool bbe::ViewFrustum::isSphereVisible(const bbe::Vector3& center, float radius) const
 {
-	return planes;
+#ifdef BBE_FRUSTUM_SSE
+	const __m128 cx = _mm_set1_ps(center.x);
+	const __m128 cy = _mm_set1_ps(center.y);
+	const __m128 cz = _mm_set1_ps(center.z);
+	const __m128 r = _mm_set1_ps(radius);
+	const __m128 zero = _mm_setzero_ps();
+	for (size_t i = 0; i < amountOfPaddedPlanes; i += 4)
+	{
+		__m128 distance = _mm_add_ps(_mm_mul_ps(_mm_load_ps(m_planesX + i), cx), _mm_mul_ps(_mm_load_ps(m_planesY + i), cy));
+		distance = _mm_add_ps(distance, _mm_mul_ps(_mm_load_ps(m_planesZ + i), cz));
+		distance = _mm_add_ps(distance, _mm_load_ps(m_planesW + i));
+		if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, r), zero)) != 0) return false;
+	}
+	return true;
+#else
+	for (size_t i = 0; i < amountOfPlanes; i++)
+	{
+		const float distance = m_planesX[i] * center.x + m_planesY[i] * center.y + m_planesZ[i] * center.z + m_planesW[i];
+		if (distance + radius < 0) return false;
+	}
+	return true;
+#endif
+}
+
+bool bbe::ViewFrustum::isAabbVisible(const bbe::Vector3& center, const bbe::Vector3& halfExtent) const
+{
+	// The box is behind a plane if even its corner that is furthest along the plane normal is.
+#ifdef BBE_FRUSTUM_SSE
+	const __m128 cx = _mm_set1_ps(center.x);
+	const __m128 cy = _mm_set1_ps(center.y);
+	const __m128 cz = _mm_set1_ps(center.z);
+	const __m128 ex = _mm_set1_ps(halfExtent.x);
+	const __m128 ey = _mm_set1_ps(halfExtent.y);
+	const __m128 ez = _mm_set1_ps(halfExtent.z);
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const __m128 zero = _mm_setzero_ps();
+	for (size_t i = 0; i < amountOfPaddedPlanes; i += 4)
+	{
+		const __m128 px = _mm_load_ps(m_planesX + i);
+		const __m128 py = _mm_load_ps(m_planesY + i);
+		const __m128 pz = _mm_load_ps(m_planesZ + i);
+		__m128 distance = _mm_add_ps(_mm_mul_ps(px, cx), _mm_mul_ps(py, cy));
+		distance = _mm_add_ps(distance, _mm_mul_ps(pz, cz));
+		distance = _mm_add_ps(distance, _mm_load_ps(m_planesW + i));
+		__m128 reach = _mm_add_ps(_mm_mul_ps(_mm_and_ps(px, absMask), ex), _mm_mul_ps(_mm_and_ps(py, absMask), ey));
+		reach = _mm_add_ps(reach, _mm_mul_ps(_mm_and_ps(pz, absMask), ez));
+		if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, reach), zero)) != 0) return false;
+	}
+	return true;
+#else
+	for (size_t i = 0; i < amountOfPlanes; i++)
+	{
+		const float distance = m_planesX[i] * center.x + m_planesY[i] * center.y + m_planesZ[i] * center.z + m_planesW[i];
+		const float reach = bbe::Math::abs(m_planesX[i]) * halfExtent.x + bbe::Math::abs(m_planesY[i]) * halfExtent.y + bbe::Math::abs(m_planesZ[i]) * halfExtent.z;
+		if (distance + reach < 0) return false;
+	}
+	return true;
+#endif
+}
+
+bool bbe::ViewFrustum::isAabbVisible(const bbe::Matrix4& transform, const bbe::Vector3& center, const bbe::Vector3& halfExtent) const
+{
+	bbe::Vector3 worldCenter;
+	bbe::Vector3 worldHalfExtent;
+	for (int row = 0; row < 3; row++)
+	{
+		const bbe::Vector4 r = transform.getRow(row);
+		worldCenter[row] = r.x * center.x + r.y * center.y + r.z * center.z + r.w;
+		worldHalfExtent[row] = bbe::Math::abs(r.x) * halfExtent.x + bbe::Math::abs(r.y) * halfExtent.y + bbe::Math::abs(r.z) * halfExtent.z;
+	}
+	return isAabbVisible(worldCenter, worldHalfExtent);
 }
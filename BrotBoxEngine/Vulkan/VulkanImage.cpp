@@ -20,6 +20,7 @@ bbe::INTERNAL::vulkan::VulkanImage::VulkanImage(const bbe::Image& image, const I
 	}
 
 	image.m_prendererData = this;
+	image.clearDirtyRegion();
 
 	m_format = (VkFormat)image.m_format;
 	m_width = image.getWidth();
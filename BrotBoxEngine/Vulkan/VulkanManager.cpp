@@ -331,6 +331,7 @@ void bbe::INTERNAL::vulkan::VulkanManager::preDraw()
 
 void bbe::INTERNAL::vulkan::VulkanManager::postDraw()
 {
+	m_primitiveBrush2D.INTERNAL_endDraw();
 	imguiEndFrame();
 
 	vkCmdEndRenderPass(*m_currentFrameDrawCommandBuffer);
@@ -899,6 +900,12 @@ void bbe::INTERNAL::vulkan::VulkanManager::drawImage2D(const Rectangle& rect, co
 		m_pipelineRecord2D = PipelineRecord2D::IMAGE;
 	}
 
+	if (image.hasDirtyRegion())
+	{
+		// No partial uploads here. The old image stays alive in imageDatas until its frame is done.
+		image.m_prendererData = nullptr;
+	}
+
 	bbe::INTERNAL::vulkan::VulkanImage* vi = nullptr;
 	if (image.m_prendererData == nullptr)
 	{
@@ -11,7 +11,9 @@
 #ifdef BBE_RENDERER_VULKAN
 #include "BBE/Vulkan/VulkanManager.h"
 #endif
-#ifdef BBE_RENDERER_NULL
+#if defined(BBE_RENDERER_SOFTWARE)
+#include "BBE/SoftwareRenderer/SoftwareRendererManager.h"
+#elif defined(BBE_RENDERER_NULL)
 #include "BBE/NullRenderer/NullRendererManager.h"
 #endif
 #ifdef BBE_RENDERER_OPENGL
@@ -42,7 +44,9 @@ bbe::Window::Window(int width, int height, const char* title, bbe::Game* game, u
 #ifdef BBE_RENDERER_VULKAN
 	m_renderManager.reset(new bbe::INTERNAL::vulkan::VulkanManager());
 #endif
-#ifdef BBE_RENDERER_NULL
+#if defined(BBE_RENDERER_SOFTWARE)
+	m_renderManager.reset(new bbe::INTERNAL::softwareRenderer::SoftwareRendererManager());
+#elif defined(BBE_RENDERER_NULL)
 	m_renderManager.reset(new bbe::INTERNAL::nullRenderer::NullRendererManager());
 #endif
 #ifdef BBE_RENDERER_OPENGL
@@ -366,6 +370,21 @@ void bbe::Window::setVideoRenderingMode(const char* path)
 	m_renderManager->setVideoRenderingMode(path);
 }
 
+bool bbe::Window::isFrameCaptureSupported() const
+{
+	return m_renderManager->isFrameCaptureSupported();
+}
+
+void bbe::Window::captureFrame(bbe::FrameCapture& capture, uint64_t frameNumber)
+{
+	m_renderManager->captureFrame(capture, frameNumber);
+}
+
+void bbe::Window::flushFrameCapture()
+{
+	m_renderManager->flushFrameCapture();
+}
+
 void bbe::Window::close()
 {
 	glfwWrapper::glfwSetWindowShouldClose(m_pwindow, GLFW_TRUE);
@@ -430,6 +449,38 @@ uint32_t bbe::Window::getAmountOfDrawcalls() const
 {
 	return ((bbe::INTERNAL::openGl::OpenGLManager*)m_renderManager.get())->getAmountOfDrawcalls();
 }
+
+size_t bbe::Window::getAmountOfStreamedBytes() const
+{
+	return ((bbe::INTERNAL::openGl::OpenGLManager*)m_renderManager.get())->getAmountOfStreamedBytes();
+}
+
+uint32_t bbe::Window::getAmountOfVisibleObjects3D() const
+{
+	return ((bbe::INTERNAL::openGl::OpenGLManager*)m_renderManager.get())->getAmountOfVisibleObjects3D();
+}
+
+uint32_t bbe::Window::getAmountOfCulledObjects3D() const
+{
+	return ((bbe::INTERNAL::openGl::OpenGLManager*)m_renderManager.get())->getAmountOfCulledObjects3D();
+}
+#endif
+
+#if defined(BBE_RENDERER_SOFTWARE)
+uint32_t bbe::Window::getAmountOfDrawcalls() const
+{
+	return ((bbe::INTERNAL::softwareRenderer::SoftwareRendererManager*)m_renderManager.get())->getAmountOfDrawcalls();
+}
+
+bbe::Image bbe::Window::getFramebuffer()
+{
+	return ((bbe::INTERNAL::softwareRenderer::SoftwareRendererManager*)m_renderManager.get())->getFramebuffer();
+}
+#elif defined(BBE_RENDERER_NULL)
+uint32_t bbe::Window::getAmountOfDrawcalls() const
+{
+	return ((bbe::INTERNAL::nullRenderer::NullRendererManager*)m_renderManager.get())->getAmountOfDrawcalls();
+}
 #endif
 
 void bbe::INTERNAL_keyCallback(GLFWwindow * window, int keyCode, int scanCode, int action, int mods)
@@ -250,7 +250,8 @@ int bbe::glfwWrapper::glfwGetWindowAttrib(GLFWwindow* window, int attrib)
 #ifndef BBE_RENDERER_NULL
 	return ::glfwGetWindowAttrib(window, attrib);
 #else
-	return 0;
+	// Headless windows count as shown, else the draw functions would never be called.
+	return attrib == GLFW_VISIBLE ? 1 : 0;
 #endif
 }
 
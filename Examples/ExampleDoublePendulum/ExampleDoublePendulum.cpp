@@ -1,6 +1,5 @@
 #include "BBE/BrotBoxEngine.h"
 #include <iostream>
-#include <future>
 
 constexpr int WINDOW_WIDTH = 1280;
 constexpr int WINDOW_HEIGHT = 720;
@@ -161,16 +160,10 @@ class MyGame : public bbe::Game
 					ticks = (size_t)((float)ticks * (1.f - statePercentage));
 				}
 
-				bbe::List<std::future<void>> futures;
-				const size_t increment = pendulums.getLength() / 12;
-				for (size_t i = 0; i < pendulums.getLength(); i += increment)
-				{
-					futures.add(bbe::async(&MyGame::tickPendulums, this, i, i + increment, ticks));
-				}
-				for (size_t i = 0; i < futures.getLength(); i++)
-				{
-					futures[i].wait();
-				}
+				bbe::jobs::parallelFor(0, pendulums.getLength(), 0, [&](size_t from, size_t to)
+					{
+						tickPendulums(from, to, ticks);
+					});
 			}
 		}
 		else if (state == State::restarting)
@@ -1,6 +1,5 @@
 #include "BBE/BrotBoxEngine.h"
 #include <iostream>
-#include <future>
 
 constexpr int32_t WINDOW_WIDTH = 1280;
 constexpr int32_t WINDOW_HEIGHT = 720;
@@ -149,20 +148,12 @@ public:
 
 	void linearSolve(BoundBehaviour b, bbe::List<float>& x, const bbe::List<float>& x0, float a, float c)
 	{
-		constexpr size_t amountOfThreads = 10;
 		const float cReciprocal = 1.0 / c;
 		for (int32_t k = 0; k < iter; k++) {
-			bbe::List<std::future<void>> futures;
-			for (size_t i = 0; i < amountOfThreads; i++)
-			{
-				size_t start = 1 + (getWidth() * i / amountOfThreads);
-				size_t end  = 1 + (getWidth() * (i + 1) / amountOfThreads);
-				futures.add(bbe::async(&FluidSquare::linearSolveThread, start, end, getWidth(), getHeight(), &x, &x0, a, cReciprocal));
-			}
-			for (size_t i = 0; i < amountOfThreads; i++)
-			{
-				futures[i].wait();
-			}
+			bbe::jobs::parallelFor(1, getWidth() - 1, 0, [&](size_t start, size_t end)
+				{
+					linearSolveThread(start, end, getWidth(), getHeight(), &x, &x0, a, cReciprocal);
+				});
 			setBound(b, x);
 		}
 	}
@@ -255,13 +246,11 @@ public:
 
 		clearDivergence(Vx, Vy, Vx0, Vy0);
 
-		auto futureR = bbe::async(&FluidSquare::densityStep, this, &densityR, dt);
-		auto futureG = bbe::async(&FluidSquare::densityStep, this, &densityG, dt);
-		auto futureB = bbe::async(&FluidSquare::densityStep, this, &densityB, dt);
-
-		futureR.wait();
-		futureG.wait();
-		futureB.wait();
+		bbe::jobs::waitAll({
+			bbe::jobs::schedule([&]() { densityStep(&densityR, dt); }),
+			bbe::jobs::schedule([&]() { densityStep(&densityG, dt); }),
+			bbe::jobs::schedule([&]() { densityStep(&densityB, dt); }),
+		});
 	}
 
 	void densityLoss()
@@ -1,5 +1,4 @@
 #include "BBE/BrotBoxEngine.h"
-#include <future>
 
 constexpr int WINDOW_WIDTH = 1280;
 constexpr int WINDOW_HEIGHT = 720;
@@ -173,17 +172,10 @@ class MyGame : public bbe::Game
 
 	virtual void update(float timeSinceLastFrame) override
 	{
-		bbe::List<std::future<void>> futures;
-		futures.resizeCapacity(particles.getLength());
-		const size_t increment = amountOfParticles / 12;
-		for (size_t i = 0; i < particles.getLength(); i += increment)
-		{
-			futures.add(bbe::async(&MyGame::updateParticleSpeed, this, i, i + increment));
-		}
-		for (size_t i = 0; i < futures.getLength(); i++)
-		{
-			futures[i].wait();
-		}
+		bbe::jobs::parallelFor(0, particles.getLength(), 0, [&](size_t begin, size_t end)
+			{
+				updateParticleSpeed(begin, end);
+			});
 
 		for (size_t i = 0; i < particles.getLength(); i++)
 		{
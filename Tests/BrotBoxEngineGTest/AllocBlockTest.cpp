@@ -0,0 +1,170 @@
+#include "gtest/gtest.h"
+#include "BBE/AllocBlock.h"
+#include "BBE/Random.h"
+#include "BBE/List.h"
+#include <cstring>
+#include <thread>
+
+TEST(AllocBlock, ZeroSize)
+{
+	bbe::AllocBlock block = bbe::allocateBlock(0);
+	ASSERT_EQ(block.data, nullptr);
+	ASSERT_EQ(block.size, 0);
+	bbe::freeBlock(block);
+}
+
+TEST(AllocBlock, SizesAndAlignment)
+{
+	for (size_t size = 1; size < 200 * 1024; size = size * 5 / 4 + 1)
+	{
+		bbe::AllocBlock block = bbe::allocateBlock(size);
+		ASSERT_NE(block.data, nullptr);
+		ASSERT_GE(block.size, size);
+		ASSERT_EQ((uintptr_t)block.data % 16, 0);
+		memset(block.data, 0xAB, block.size);
+		bbe::freeBlock(block);
+		ASSERT_EQ(block.data, nullptr);
+		ASSERT_EQ(block.size, 0);
+	}
+}
+
+TEST(AllocBlock, BlocksDoNotOverlap)
+{
+	bbe::Random rand;
+	rand.setSeed(17);
+	std::vector<bbe::AllocBlock> blocks;
+	for (uint32_t i = 0; i < 2000; i++)
+	{
+		const size_t size = 1 + rand.randomInt(i % 10 == 0 ? 100000 : 600);
+		blocks.push_back(bbe::allocateBlock(size));
+		memset(blocks.back().data, (int)(i & 0xFF), blocks.back().size);
+	}
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		const unsigned char* data = (const unsigned char*)blocks[i].data;
+		for (size_t k = 0; k < blocks[i].size; k++)
+		{
+			ASSERT_EQ(data[k], (unsigned char)(i & 0xFF));
+		}
+		bbe::freeBlock(blocks[i]);
+	}
+}
+
+TEST(AllocBlock, ReuseIsAHit)
+{
+	bbe::AllocBlock warmup = bbe::allocateBlock(100);
+	bbe::freeBlock(warmup);
+
+	const bbe::AllocStats before = bbe::getAllocStats();
+	for (int i = 0; i < 100; i++)
+	{
+		bbe::AllocBlock block = bbe::allocateBlock(100);
+		bbe::freeBlock(block);
+	}
+	const bbe::AllocStats after = bbe::getAllocStats();
+
+	size_t sizeClass = 0;
+	while (after.sizeClasses[sizeClass].blockSize < 100) sizeClass++;
+	ASSERT_EQ(after.sizeClasses[sizeClass].hits - before.sizeClasses[sizeClass].hits, 100);
+	ASSERT_EQ(after.sizeClasses[sizeClass].misses, before.sizeClasses[sizeClass].misses);
+	ASSERT_EQ(after.sizeClasses[sizeClass].frees - before.sizeClasses[sizeClass].frees, 100);
+	ASSERT_GT(after.sizeClasses[sizeClass].getHitRate(), 0.0);
+}
+
+TEST(AllocBlock, LargeAllocationsAreTracked)
+{
+	const bbe::AllocStats before = bbe::getAllocStats();
+	bbe::AllocBlock block = bbe::allocateBlock(1024 * 1024 + 1);
+	ASSERT_GE(block.size, 1024 * 1024 + 1);
+	const bbe::AllocStats during = bbe::getAllocStats();
+	ASSERT_EQ(during.largeLiveBytes - before.largeLiveBytes, block.size);
+	ASSERT_EQ(during.largeAllocations - before.largeAllocations, 1);
+	bbe::freeBlock(block);
+	const bbe::AllocStats after = bbe::getAllocStats();
+	ASSERT_EQ(after.largeLiveBytes, before.largeLiveBytes);
+	ASSERT_EQ(after.largeFrees - before.largeFrees, 1);
+}
+
+TEST(AllocBlock, CrossThreadFree)
+{
+	constexpr size_t amount = 10000;
+	std::vector<bbe::AllocBlock> blocks(amount);
+	std::thread producer([&]()
+		{
+			for (size_t i = 0; i < amount; i++)
+			{
+				blocks[i] = bbe::allocateBlock(16 + (i % 50) * 8);
+				memset(blocks[i].data, 0x5A, blocks[i].size);
+			}
+		});
+	producer.join();
+
+	std::thread consumer([&]()
+		{
+			for (size_t i = 0; i < amount; i++)
+			{
+				bbe::freeBlock(blocks[i]);
+			}
+		});
+	consumer.join();
+
+	// A new thread adopts the cache of a finished thread. Blocks that were freed remotely are handed out again.
+	const bbe::AllocStats before = bbe::getAllocStats();
+	std::thread reuser([&]()
+		{
+			for (size_t i = 0; i < amount; i++)
+			{
+				blocks[i] = bbe::allocateBlock(16 + (i % 50) * 8);
+			}
+			for (size_t i = 0; i < amount; i++)
+			{
+				bbe::freeBlock(blocks[i]);
+			}
+		});
+	reuser.join();
+	const bbe::AllocStats after = bbe::getAllocStats();
+
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	for (size_t i = 0; i < bbe::INTERNAL::AMOUNT_OF_SIZE_CLASSES; i++)
+	{
+		hits += after.sizeClasses[i].hits - before.sizeClasses[i].hits;
+		misses += after.sizeClasses[i].misses - before.sizeClasses[i].misses;
+	}
+	ASSERT_EQ(hits + misses, amount);
+}
+
+TEST(AllocBlock, ConcurrentListsAcrossThreads)
+{
+	bbe::List<bbe::List<int32_t>> handOver[4];
+	std::vector<std::thread> threads;
+	for (int32_t t = 0; t < 4; t++)
+	{
+		threads.emplace_back([&, t]()
+			{
+				for (int32_t i = 0; i < 200; i++)
+				{
+					bbe::List<int32_t> list;
+					for (int32_t k = 0; k < i; k++) list.add(k * t);
+					handOver[t].add(std::move(list));
+				}
+			});
+	}
+	for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+	threads.clear();
+
+	// Every thread frees the lists of its neighbour, which were allocated by another thread cache.
+	for (int32_t t = 0; t < 4; t++)
+	{
+		threads.emplace_back([&, t]()
+			{
+				bbe::List<bbe::List<int32_t>>& other = handOver[(t + 1) % 4];
+				for (size_t i = 0; i < other.getLength(); i++)
+				{
+					ASSERT_EQ(other[i].getLength(), i);
+				}
+				other.clear();
+			});
+	}
+	for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+}
@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+TEST(Bench, ParseConfig)
+{
+	const bbe::bench::Config config = bbe::bench::parseConfig("frames=100, warmup=10,frametime=0.02,seed=42,out=result.json");
+	ASSERT_TRUE(config.enabled);
+	ASSERT_EQ(config.frames, 100);
+	ASSERT_EQ(config.warmupFrames, 10);
+	ASSERT_FLOAT_EQ(config.fixedFrameTime, 0.02f);
+	ASSERT_EQ(config.seed, 42);
+	ASSERT_EQ(config.outputPath, "result.json");
+
+	const bbe::bench::Config defaults = bbe::bench::parseConfig("");
+	ASSERT_TRUE(defaults.enabled);
+	ASSERT_EQ(defaults.frames, 600);
+	ASSERT_EQ(defaults.warmupFrames, 60);
+	ASSERT_TRUE(defaults.outputPath.isEmpty());
+}
+
+TEST(Bench, Percentiles)
+{
+	bbe::List<double> samples;
+	for (int32_t i = 100; i >= 1; i--)
+	{
+		samples.add(i / 1000.0);
+	}
+	const bbe::bench::PhaseStats stats = bbe::bench::computeStats("test", samples);
+	ASSERT_STREQ(stats.name, "test");
+	ASSERT_DOUBLE_EQ(stats.mean, 50.5);
+	ASSERT_DOUBLE_EQ(stats.p50, 50);
+	ASSERT_DOUBLE_EQ(stats.p90, 90);
+	ASSERT_DOUBLE_EQ(stats.p99, 99);
+	ASSERT_DOUBLE_EQ(stats.max, 100);
+
+	const bbe::bench::PhaseStats empty = bbe::bench::computeStats("empty", bbe::List<double>());
+	ASSERT_EQ(empty.max, 0);
+}
+
+TEST(Bench, Json)
+{
+	bbe::List<bbe::bench::FrameTimings> frames;
+	bbe::bench::FrameTimings timings;
+	timings.update = 0.002;
+	timings.frame = 0.003;
+	frames.add(timings);
+
+	bbe::bench::Config config;
+	config.seed = 7;
+	const bbe::bench::Result result = bbe::bench::computeResult("My \"Game\"", config, frames);
+	ASSERT_EQ(result.measuredFrames, 1);
+	ASSERT_EQ(result.phases.getLength(), 5);
+
+	const bbe::String json = bbe::bench::toJson(result);
+	ASSERT_TRUE(json.startsWith("{\"name\":\"My \\\"Game\\\"\",\"frames\":1,"));
+	ASSERT_NE(json.search("\"seed\":7"), -1);
+	ASSERT_NE(json.search("\"update\":{\"meanMs\":2.0000,\"p50Ms\":2.0000,\"p90Ms\":2.0000,\"p99Ms\":2.0000,\"maxMs\":2.0000}"), -1);
+	ASSERT_NE(json.search("\"frame\":{\"meanMs\":3.0000"), -1);
+	ASSERT_TRUE(json.endsWith("}}"));
+}
+
+TEST(Bench, DeterministicSeed)
+{
+	bbe::Random::setDeterministicSeed(1234);
+	bbe::Random a;
+	bbe::Random b;
+	bbe::Random::setDeterministicSeed(1234);
+	bbe::Random a2;
+	bbe::Random b2;
+	bbe::Random::clearDeterministicSeed();
+
+	for (int32_t i = 0; i < 100; i++)
+	{
+		const int32_t aVal = a.randomInt(1000000);
+		ASSERT_EQ(aVal, a2.randomInt(1000000));
+		ASSERT_EQ(b.randomInt(1000000), b2.randomInt(1000000));
+	}
+}
+
+namespace
+{
+	class BenchTestGame : public bbe::Game
+	{
+	public:
+		static inline int32_t firstRandom = 0;
+		static inline int32_t amountOfUpdates = 0;
+		static inline float lastTimeSinceLastFrame = 0;
+
+		bbe::Random rand;
+
+		virtual void onStart() override
+		{
+			firstRandom = rand.randomInt(1000000);
+			amountOfUpdates = 0;
+			// The benchmark must win against whatever the game configures.
+			setFixedFrametime(1.f);
+			setMaxFrame(1);
+		}
+		virtual void update(float timeSinceLastFrame) override
+		{
+			amountOfUpdates++;
+			lastTimeSinceLastFrame = timeSinceLastFrame;
+		}
+		virtual void draw3D(bbe::PrimitiveBrush3D& brush) override
+		{
+		}
+		virtual void draw2D(bbe::PrimitiveBrush2D& brush) override
+		{
+		}
+		virtual void onEnd() override
+		{
+		}
+	};
+}
+
+TEST(Bench, RunGame)
+{
+	bbe::bench::Config config;
+	config.frames = 20;
+	config.warmupFrames = 5;
+	config.fixedFrameTime = 0.25f;
+	config.seed = 99;
+
+	const bbe::bench::Result result = bbe::bench::run<BenchTestGame>(config, "Bench Test Game");
+	ASSERT_EQ(BenchTestGame::amountOfUpdates, 25);
+	ASSERT_FLOAT_EQ(BenchTestGame::lastTimeSinceLastFrame, 0.25f);
+	ASSERT_EQ(result.name, "Bench Test Game");
+	ASSERT_EQ(result.measuredFrames, 20);
+	ASSERT_EQ(result.phases.getLength(), 5);
+	ASSERT_STREQ(result.phases[0].name, "update");
+	for (size_t i = 0; i < result.phases.getLength(); i++)
+	{
+		ASSERT_GE(result.phases[i].p50, 0);
+		ASSERT_LE(result.phases[i].p50, result.phases[i].p99);
+		ASSERT_LE(result.phases[i].p99, result.phases[i].max);
+	}
+
+	const int32_t firstRandom = BenchTestGame::firstRandom;
+	bbe::bench::run<BenchTestGame>(config, "Bench Test Game");
+	ASSERT_EQ(BenchTestGame::firstRandom, firstRandom);
+}
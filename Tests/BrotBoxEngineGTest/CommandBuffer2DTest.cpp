@@ -0,0 +1,196 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+TEST(CommandBuffer2D, SubmissionOrderOnlyMergesNeighbours)
+{
+	bbe::CommandBuffer2D buffer;
+	buffer.addRect(0, bbe::Color(1, 0, 0), bbe::Rectangle(0, 0, 10, 10), 0);
+	buffer.addRect(0, bbe::Color(0, 1, 0), bbe::Rectangle(5, 5, 10, 10), 0);
+	buffer.addCircle(0, bbe::Color(0, 0, 1), bbe::Circle(0, 0, 10, 10));
+	buffer.addRect(0, bbe::Color(1, 1, 1), bbe::Rectangle(0, 0, 1, 1), 0);
+	buffer.sortAndMerge();
+
+	const bbe::List<bbe::DrawBatch2D>& batches = buffer.getBatches();
+	ASSERT_EQ(batches.getLength(), 3);
+	ASSERT_EQ(batches[0].type, bbe::DrawCommandType2D::RECT);
+	ASSERT_EQ(batches[0].firstCommand, 0);
+	ASSERT_EQ(batches[0].amountOfCommands, 2);
+	ASSERT_EQ(batches[1].type, bbe::DrawCommandType2D::CIRCLE);
+	ASSERT_EQ(batches[2].type, bbe::DrawCommandType2D::RECT);
+	ASSERT_EQ(batches[2].firstCommand, 3);
+	ASSERT_EQ(buffer.getCommands()[1].x, 5);
+}
+
+TEST(CommandBuffer2D, LayersAreSortedStably)
+{
+	bbe::CommandBuffer2D buffer;
+	buffer.addRect(1, bbe::Color(1, 0, 0), bbe::Rectangle(1, 0, 1, 1), 0);
+	buffer.addCircle(0, bbe::Color(0, 1, 0), bbe::Circle(2, 0, 1, 1));
+	buffer.addRect(1, bbe::Color(0, 0, 1), bbe::Rectangle(3, 0, 1, 1), 0);
+	buffer.addRect(-5, bbe::Color(0, 0, 0), bbe::Rectangle(4, 0, 1, 1), 0);
+	buffer.sortAndMerge();
+
+	const bbe::List<bbe::DrawCommand2D>& commands = buffer.getCommands();
+	ASSERT_EQ(commands.getLength(), 4);
+	ASSERT_EQ(commands[0].x, 4);
+	ASSERT_EQ(commands[1].x, 2);
+	ASSERT_EQ(commands[2].x, 1);
+	ASSERT_EQ(commands[3].x, 3);
+	ASSERT_EQ(commands[2].color.r, 1);
+	ASSERT_EQ(commands[3].color.b, 1);
+	ASSERT_EQ(buffer.getBatches().getLength(), 3);
+}
+
+TEST(CommandBuffer2D, ReorderWithinLayers)
+{
+	bbe::Image imageA;
+	bbe::Image imageB;
+	bbe::CommandBuffer2D buffer;
+	buffer.setReorderWithinLayers(true);
+	for (int32_t i = 0; i < 100; i++)
+	{
+		buffer.addRect(0, bbe::Color(1, 1, 1), bbe::Rectangle((float)i, 0, 1, 1), 0);
+		buffer.addImage(0, bbe::Color(1, 1, 1), bbe::Rectangle((float)i, 1, 1, 1), i % 2 == 0 ? imageA : imageB, bbe::AutoRef(), 0);
+		buffer.addCircle(0, bbe::Color(1, 1, 1), bbe::Circle((float)i, 2, 1, 1));
+	}
+	buffer.addRect(1, bbe::Color(1, 1, 1), bbe::Rectangle(0, 3, 1, 1), 0);
+	buffer.sortAndMerge();
+
+	const bbe::List<bbe::DrawBatch2D>& batches = buffer.getBatches();
+	ASSERT_EQ(batches.getLength(), 5);
+	ASSERT_EQ(batches[0].type, bbe::DrawCommandType2D::RECT);
+	ASSERT_EQ(batches[0].amountOfCommands, 100);
+	ASSERT_EQ(batches[1].type, bbe::DrawCommandType2D::CIRCLE);
+	ASSERT_EQ(batches[1].amountOfCommands, 100);
+	ASSERT_EQ(batches[2].type, bbe::DrawCommandType2D::IMAGE);
+	ASSERT_EQ(batches[2].amountOfCommands, 50);
+	ASSERT_EQ(batches[3].type, bbe::DrawCommandType2D::IMAGE);
+	ASSERT_NE(batches[2].image, batches[3].image);
+	ASSERT_EQ(batches[4].type, bbe::DrawCommandType2D::RECT);
+	ASSERT_EQ(batches[4].amountOfCommands, 1);
+
+	// Within a batch the recording order is kept.
+	const bbe::List<bbe::DrawCommand2D>& commands = buffer.getCommands();
+	for (size_t i = 1; i < batches[0].amountOfCommands; i++)
+	{
+		ASSERT_LT(commands[i - 1].x, commands[i].x);
+	}
+	for (size_t i = batches[2].firstCommand + 1; i < batches[2].firstCommand + batches[2].amountOfCommands; i++)
+	{
+		ASSERT_LT(commands[i - 1].x, commands[i].x);
+	}
+}
+
+TEST(CommandBuffer2D, VertexIndexLists)
+{
+	const uint32_t indices[] = { 0, 1, 2 };
+	const bbe::Vector2 verticesA[] = { { 0, 0 }, { 1, 0 }, { 0, 1 } };
+	const bbe::Vector2 verticesB[] = { { 5, 5 }, { 6, 5 }, { 5, 6 } };
+
+	bbe::CommandBuffer2D buffer;
+	buffer.setReorderWithinLayers(true);
+	buffer.addVertexIndexList(0, bbe::Color(1, 0, 0), indices, 3, verticesA, 3, { 10, 20 }, { 2, 3 });
+	buffer.addVertexIndexList(0, bbe::Color(0, 1, 0), indices, 3, verticesB, 3, { 0, 0 }, { 1, 1 });
+	buffer.sortAndMerge();
+
+	// Every list has its own geometry, so they are never merged.
+	ASSERT_EQ(buffer.getBatches().getLength(), 2);
+	const bbe::DrawCommand2D& second = buffer.getCommands()[1];
+	ASSERT_EQ(second.firstVertex, 3);
+	ASSERT_EQ(second.amountOfVertices, 3);
+	ASSERT_EQ(second.firstIndex, 3);
+	ASSERT_EQ(buffer.getVertices()[second.firstVertex].x, 5);
+	ASSERT_EQ(buffer.getIndices()[second.firstIndex + 2], 2);
+	ASSERT_EQ(buffer.getCommands()[0].x, 10);
+	ASSERT_EQ(buffer.getCommands()[0].height, 3);
+
+	buffer.clear();
+	ASSERT_TRUE(buffer.isEmpty());
+	ASSERT_EQ(buffer.getVertices().getLength(), 0);
+	ASSERT_EQ(buffer.getBatches().getLength(), 0);
+}
+
+struct TrackedImageData : public bbe::AutoRefCountable
+{
+	static inline int32_t alive = 0;
+	TrackedImageData() { alive++; }
+	~TrackedImageData() override { alive--; }
+};
+
+TEST(CommandBuffer2D, ImageDataOutlivesImage)
+{
+	bbe::CommandBuffer2D buffer;
+	{
+		bbe::Image temporary;
+		buffer.addImage(0, bbe::Color(1, 1, 1), bbe::Rectangle(0, 0, 1, 1), temporary, new TrackedImageData(), 0);
+		buffer.addImage(0, bbe::Color(1, 1, 1), bbe::Rectangle(1, 0, 1, 1), temporary, new TrackedImageData(), 0);
+	}
+	ASSERT_EQ(TrackedImageData::alive, 2);
+
+	// Both commands name the same Image, but they are drawn from different data.
+	buffer.sortAndMerge();
+	ASSERT_EQ(buffer.getBatches().getLength(), 2);
+	ASSERT_EQ(buffer.getBatches()[0].imageData, buffer.getCommands()[0].imageData.get());
+	ASSERT_EQ(TrackedImageData::alive, 2);
+
+	buffer.clear();
+	ASSERT_EQ(TrackedImageData::alive, 0);
+}
+
+#ifdef BBE_RENDERER_NULL
+namespace
+{
+	class BatchingTestGame : public bbe::Game
+	{
+	public:
+		static inline bool reorder = false;
+		static inline uint32_t drawcalls = 0;
+
+		virtual void onStart() override
+		{
+			// getAmountOfDrawcalls() reports the previous frame, so the first drawn frame shows up in the third update.
+			setMaxFrame(3);
+		}
+		virtual void update(float timeSinceLastFrame) override
+		{
+			drawcalls = getAmountOfDrawcalls();
+		}
+		virtual void draw3D(bbe::PrimitiveBrush3D& brush) override
+		{
+		}
+		virtual void draw2D(bbe::PrimitiveBrush2D& brush) override
+		{
+			brush.setReorderWithinLayers(reorder);
+			for (int32_t i = 0; i < 50; i++)
+			{
+				brush.fillRect(i * 10.f, 0, 5, 5);
+				brush.fillCircle(i * 10.f, 10, 5, 5);
+				brush.fillRect(i * 10.f, 20, 1, 10);
+			}
+			brush.setLayer(-1);
+			brush.fillRect(0, 0, 1000, 1000);
+		}
+		virtual void onEnd() override
+		{
+		}
+	};
+}
+
+TEST(CommandBuffer2D, NullRendererBatchCount)
+{
+	BatchingTestGame::reorder = false;
+	{
+		BatchingTestGame game;
+		game.start(1280, 720, "Batching Test Game");
+	}
+	// The background rect goes first and merges with the first rect, after that every circle splits the rects.
+	ASSERT_EQ(BatchingTestGame::drawcalls, 50 + 51);
+
+	BatchingTestGame::reorder = true;
+	{
+		BatchingTestGame game;
+		game.start(1280, 720, "Batching Test Game");
+	}
+	ASSERT_EQ(BatchingTestGame::drawcalls, 2);
+}
+#endif
@@ -1,7 +1,9 @@
 ﻿#include "gtest/gtest.h"
 #include "TestUtils.h"
 #include "BBE/EndlessGrid.h"
+#include "BBE/Grid.h"
 #include "BBE/Random.h"
+#include "BBE/JobSystem.h"
 
 TEST(EndlessGrid, SimpleChecks)
 {
@@ -60,3 +62,157 @@ TEST(EndlessGrid, RandomChecks)
 		}
 	}
 }
+
+TEST(EndlessGrid, ChunkBorders)
+{
+	bbe::EndlessGrid<int32_t, 4> grid;
+	int32_t value = 1;
+	for (int64_t x = -9; x <= 9; x++)
+	{
+		for (int64_t y = -9; y <= 9; y++)
+		{
+			grid[x][y] = value++;
+		}
+	}
+	// -9 to 9 touches the chunks -3 to 2 on both axes.
+	ASSERT_EQ(grid.getAmountOfChunks(), 36);
+
+	value = 1;
+	for (int64_t x = -9; x <= 9; x++)
+	{
+		for (int64_t y = -9; y <= 9; y++)
+		{
+			ASSERT_EQ(grid.observe(x, y), value);
+			value++;
+		}
+	}
+	ASSERT_EQ(grid.observe(100, -100), 0);
+	ASSERT_EQ(grid.getAmountOfChunks(), 36);
+}
+
+TEST(EndlessGrid, WalkingOutwardOnlyAllocatesTouchedChunks)
+{
+	bbe::EndlessGrid<int32_t> grid;
+	grid.setDefaultValue(-1);
+	constexpr int64_t steps = 128000;
+	for (int64_t i = 0; i < steps; i++)
+	{
+		grid[-i - 1][i] = (int32_t)i;
+	}
+	ASSERT_EQ(grid.getAmountOfChunks(), (size_t)(steps / grid.getChunkSize()));
+	ASSERT_EQ(grid.observe(-12346, 12345), 12345);
+	ASSERT_EQ(grid.observe(-12346, 12344), -1);
+	ASSERT_EQ(grid.observe(12345, 12345), -1);
+
+	int64_t amountOfCells = 0;
+	int64_t sum = 0;
+	grid.forEachCell([&](int64_t x, int64_t y, const int32_t& cell)
+		{
+			amountOfCells++;
+			if (cell >= 0)
+			{
+				EXPECT_EQ(-x - 1, y);
+				sum += cell;
+			}
+		});
+	ASSERT_EQ(amountOfCells, (int64_t)grid.getAmountOfChunks() * grid.getChunkSize() * grid.getChunkSize());
+	ASSERT_EQ(sum, steps * (steps - 1) / 2);
+}
+
+TEST(EndlessGrid, Eviction)
+{
+	bbe::EndlessGrid<int32_t, 8> grid;
+	bbe::List<bbe::Vector2i64> evicted;
+	int64_t evictedSum = 0;
+	grid.setEvictionCallback([&](const bbe::Vector2i64& origin, bbe::List<int32_t>& cells)
+		{
+			evicted.add(origin);
+			for (size_t i = 0; i < cells.getLength(); i++) evictedSum += cells[i];
+		});
+	grid.setMaxAmountOfChunks(3);
+
+	grid[0][0] = 1;
+	grid[8][0] = 2;
+	grid[16][0] = 3;
+	// Touching the first chunk again makes the second one the least recently used.
+	grid[1][1] = 4;
+	grid[-1][-1] = 5;
+	ASSERT_EQ(grid.getAmountOfChunks(), 3);
+	ASSERT_EQ(evicted.getLength(), 1);
+	ASSERT_EQ(evicted[0], bbe::Vector2i64(8, 0));
+	ASSERT_EQ(evictedSum, 2);
+	ASSERT_EQ(grid.observe(8, 0), 0);
+	ASSERT_EQ(grid.observe(0, 0), 1);
+
+	ASSERT_TRUE(grid.evict(-3, -3));
+	ASSERT_FALSE(grid.evict(-3, -3));
+	ASSERT_EQ(evicted.last(), bbe::Vector2i64(-8, -8));
+	ASSERT_EQ(grid.observe(-1, -1), 0);
+	// Cells of evicted chunks start over from the default value.
+	ASSERT_EQ(grid[-1][-1], 0);
+}
+
+TEST(EndlessGrid, EvictsInLeastRecentlyUsedOrder)
+{
+	bbe::EndlessGrid<int32_t, 4> grid;
+	bbe::List<bbe::Vector2i64> evicted;
+	grid.setEvictionCallback([&](const bbe::Vector2i64& origin, bbe::List<int32_t>&)
+		{
+			evicted.add(origin);
+		});
+	grid.setMaxAmountOfChunks(100);
+	for (int64_t i = 0; i < 100; i++)
+	{
+		grid[i * 4][0] = (int32_t)i;
+	}
+	// Touch every even chunk again, so the odd ones are older.
+	for (int64_t i = 0; i < 100; i += 2)
+	{
+		grid[i * 4][1] = 1;
+	}
+	for (int64_t i = 0; i < 100; i++)
+	{
+		grid[i * 4][100] = 1;
+	}
+	ASSERT_EQ(grid.getAmountOfChunks(), 100);
+	ASSERT_EQ(evicted.getLength(), 100);
+	for (int64_t i = 0; i < 50; i++)
+	{
+		ASSERT_EQ(evicted[(size_t)i], bbe::Vector2i64((i * 2 + 1) * 4, 0));
+		ASSERT_EQ(evicted[(size_t)i + 50], bbe::Vector2i64(i * 2 * 4, 0));
+	}
+
+	grid.setMaxAmountOfChunks(10);
+	ASSERT_EQ(grid.getAmountOfChunks(), 10);
+	ASSERT_EQ(evicted.last(), bbe::Vector2i64(89 * 4, 100));
+	ASSERT_EQ(grid.observe(99 * 4, 100), 1);
+}
+
+TEST(EndlessGrid, ConcurrentObserve)
+{
+	bbe::EndlessGrid<int32_t, 8> grid;
+	for (int64_t x = 0; x < 64; x++)
+	{
+		for (int64_t y = 0; y < 64; y++)
+		{
+			grid[x][y] = (int32_t)(x * 64 + y);
+		}
+	}
+	const bbe::EndlessGrid<int32_t, 8>& constGrid = grid;
+	std::atomic<int32_t> mismatches = 0;
+	bbe::jobs::parallelFor(0, 64, 1, [&](size_t begin, size_t end)
+		{
+			for (int32_t round = 0; round < 10; round++)
+			{
+				for (int64_t x = (int64_t)begin; x < (int64_t)end; x++)
+				{
+					for (int64_t y = 0; y < 64; y++)
+					{
+						if (constGrid.observe(x, y) != x * 64 + y) mismatches++;
+						if (constGrid.observe(63 - x, 63 - y) != (63 - x) * 64 + 63 - y) mismatches++;
+					}
+				}
+			}
+		});
+	ASSERT_EQ(mismatches, 0);
+}
@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+TEST(Font, GlyphsShareOneAtlasPage)
+{
+	bbe::Font font("OpenSansRegular.ttf", 20);
+	ASSERT_EQ(font.getAmountOfAtlasPages(), 0);
+
+	bbe::List<bbe::Rectangle> uvs;
+	const bbe::Image* page = nullptr;
+	for (int32_t c = 33; c < 127; c++)
+	{
+		const bbe::Font::AtlasRegion region = font.getAtlasRegion(c, 1.0f);
+		ASSERT_NE(region.page, nullptr);
+		if (page == nullptr) page = region.page;
+		ASSERT_EQ(region.page, page);
+		for (size_t i = 0; i < uvs.getLength(); i++)
+		{
+			ASSERT_FALSE(region.uv.intersects(uvs[i]));
+		}
+		uvs.add(region.uv);
+	}
+	ASSERT_EQ(font.getAmountOfAtlasPages(), 1);
+	ASSERT_EQ(&font.getAtlasPage(0), page);
+
+	// Asking again must not pack the glyph a second time.
+	ASSERT_EQ(font.getAtlasRegion('A', 1.0f).uv.x, font.getAtlasRegion('A', 1.0f).uv.x);
+	ASSERT_EQ(font.getAtlasRegion('A', 1.0f).uv.y, font.getAtlasRegion('A', 1.0f).uv.y);
+
+	// Nothing to draw for a space.
+	ASSERT_EQ(font.getAtlasRegion(' ', 1.0f).page, nullptr);
+}
+
+TEST(Font, AtlasMatchesStandaloneImages)
+{
+	bbe::Font font("OpenSansRegular.ttf", 30);
+	// 0x20AC is the euro sign, which isn't in the latin 1 table.
+	for (int32_t c : { (int32_t)'g', (int32_t)'W', 0xE4, 0x20AC })
+	{
+		const bbe::Image& image = font.getImage(c, 1.0f);
+		ASSERT_EQ(image.getDimensions(), font.getDimensions(c));
+		ASSERT_GT(image.getWidth(), 0);
+
+		const bbe::Font::AtlasRegion region = font.getAtlasRegion(c, 1.0f);
+		const bbe::Vector2i origin((int32_t)std::round(region.uv.x * region.page->getWidth()), (int32_t)std::round(region.uv.y * region.page->getHeight()));
+		ASSERT_FLOAT_EQ(region.uv.width * region.page->getWidth(), (float)image.getWidth());
+		ASSERT_FLOAT_EQ(region.uv.height * region.page->getHeight(), (float)image.getHeight());
+		for (int32_t y = 0; y < image.getHeight(); y++)
+		{
+			for (int32_t x = 0; x < image.getWidth(); x++)
+			{
+				ASSERT_EQ(image.getPixel(x, y).r, region.page->getPixel(origin.x + x, origin.y + y).r);
+			}
+		}
+	}
+
+	// Different scales are different glyphs.
+	ASSERT_GT(font.getAtlasRegion('g', 2.0f).uv.width, font.getAtlasRegion('g', 1.0f).uv.width);
+	ASSERT_GT(font.getImage('g', 2.0f).getWidth(), font.getImage('g', 1.0f).getWidth());
+}
+
+TEST(Font, HugeGlyphsGetTheirOwnPage)
+{
+	bbe::Font font("OpenSansRegular.ttf", 20);
+	font.getAtlasRegion('a', 1.0f);
+	const bbe::Font::AtlasRegion region = font.getAtlasRegion('W', 50.0f);
+	ASSERT_EQ(font.getAmountOfAtlasPages(), 2);
+	ASSERT_GT(region.page->getWidth(), 512);
+	ASSERT_EQ(region.uv.x, 0);
+	ASSERT_EQ(region.uv.y, 0);
+}
+
+#ifdef BBE_RENDERER_NULL
+namespace
+{
+	class TextBatchingTestGame : public bbe::Game
+	{
+	public:
+		static inline uint32_t drawcalls = 0;
+
+		virtual void onStart() override
+		{
+			setMaxFrame(3);
+		}
+		virtual void update(float timeSinceLastFrame) override
+		{
+			drawcalls = getAmountOfDrawcalls();
+		}
+		virtual void draw3D(bbe::PrimitiveBrush3D& brush) override
+		{
+		}
+		virtual void draw2D(bbe::PrimitiveBrush2D& brush) override
+		{
+			for (int32_t i = 0; i < 10; i++)
+			{
+				brush.fillText(10, 20.f + i * 20, "The quick brown fox jumps over the lazy dog.");
+			}
+		}
+		virtual void onEnd() override
+		{
+		}
+	};
+}
+
+TEST(Font, TextIsOneBatchPerPage)
+{
+	{
+		TextBatchingTestGame game;
+		game.start(1280, 720, "Text Batching Test Game");
+	}
+	ASSERT_EQ(TextBatchingTestGame::drawcalls, 1);
+}
+#endif
@@ -0,0 +1,148 @@
+#include "gtest/gtest.h"
+#include "BBE/FrameArena.h"
+#include "BBE/JobSystem.h"
+#include <cstring>
+#include <thread>
+
+TEST(FrameArena, AllocateAndReset)
+{
+	bbe::FrameArena arena(1024);
+	bbe::AllocBlock a = arena.allocate(10);
+	bbe::AllocBlock b = arena.allocate(100);
+	ASSERT_GE(a.size, 10);
+	ASSERT_GE(b.size, 100);
+	ASSERT_EQ((uintptr_t)a.data % 16, 0);
+	ASSERT_EQ((uintptr_t)b.data % 16, 0);
+	ASSERT_TRUE(arena.owns(a.data));
+	ASSERT_TRUE(arena.owns(b.data));
+	ASSERT_NE(a.data, b.data);
+	ASSERT_EQ(arena.getUsedBytes(), a.size + b.size);
+
+	int dummy = 0;
+	ASSERT_FALSE(arena.owns(&dummy));
+
+	arena.reset();
+	ASSERT_EQ(arena.getUsedBytes(), 0);
+	bbe::AllocBlock c = arena.allocate(10);
+	ASSERT_EQ(c.data, a.data);
+}
+
+TEST(FrameArena, GrowsAndConsolidates)
+{
+	bbe::FrameArena arena(1024);
+	for (int i = 0; i < 100; i++)
+	{
+		bbe::AllocBlock block = arena.allocate(200);
+		memset(block.data, i, block.size);
+	}
+	ASSERT_GT(arena.getAmountOfChunks(), 1);
+	const size_t used = arena.getUsedBytes();
+	ASSERT_GE(arena.getCapacity(), used);
+
+	arena.reset();
+	ASSERT_EQ(arena.getAmountOfChunks(), 1);
+	ASSERT_GE(arena.getCapacity(), used);
+	ASSERT_EQ(arena.getHighWaterMark(), used);
+
+	for (int i = 0; i < 100; i++)
+	{
+		arena.allocate(200);
+	}
+	ASSERT_EQ(arena.getAmountOfChunks(), 1);
+}
+
+TEST(FrameArena, ConcurrentAllocations)
+{
+	bbe::FrameArena arena(4096);
+	constexpr size_t amount = 10000;
+	bbe::List<bbe::AllocBlock> blocks(amount, bbe::AllocBlock{});
+	bbe::jobs::parallelFor(0, amount, 64, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				blocks[i] = arena.allocate(24 + i % 64);
+				memset(blocks[i].data, (int)(i & 0xFF), blocks[i].size);
+			}
+		});
+	for (size_t i = 0; i < amount; i++)
+	{
+		const unsigned char* data = (const unsigned char*)blocks[i].data;
+		for (size_t k = 0; k < blocks[i].size; k++)
+		{
+			ASSERT_EQ(data[k], (unsigned char)(i & 0xFF));
+		}
+	}
+}
+
+TEST(FrameArena, FrameList)
+{
+	bbe::FrameArena arena;
+	bbe::FrameArena::setActive(&arena);
+	{
+		bbe::FrameList<int32_t> list;
+		for (int32_t i = 0; i < 1000; i++)
+		{
+			list.add(i);
+		}
+		ASSERT_TRUE(arena.owns(list.getRaw()));
+		for (int32_t i = 0; i < 1000; i++)
+		{
+			ASSERT_EQ(list[i], i);
+		}
+	}
+	bbe::FrameArena::setActive(nullptr);
+	arena.reset();
+
+	// Without an active arena, FrameLists live on the heap.
+	bbe::FrameList<int32_t> list = { 1, 2, 3 };
+	ASSERT_FALSE(arena.owns(list.getRaw()));
+	ASSERT_EQ(list.getLength(), 3);
+}
+
+TEST(FrameArena, ActivePerThread)
+{
+	bbe::FrameArena arena;
+	bbe::FrameArena::setActive(&arena);
+
+	std::atomic_bool otherThreadHadArena = true;
+	std::thread([&]() { otherThreadHadArena = bbe::FrameArena::getActive() != nullptr; }).join();
+	ASSERT_FALSE(otherThreadHadArena);
+
+	bool plainJobHadArena = true;
+	bbe::jobs::schedule([&]() { plainJobHadArena = bbe::FrameArena::getActive() != nullptr; }).wait();
+	ASSERT_FALSE(plainJobHadArena);
+
+	std::atomic<int32_t> chunksWithArena = 0;
+	bbe::jobs::parallelFor(0, 64, 1, [&](size_t, size_t)
+		{
+			if (bbe::FrameArena::getActive() == &arena) chunksWithArena++;
+		});
+	ASSERT_EQ(chunksWithArena, 64);
+	ASSERT_EQ(bbe::FrameArena::getActive(), &arena);
+
+	bbe::FrameArena::setActive(nullptr);
+}
+
+TEST(FrameArena, FreeAfterDeactivation)
+{
+	bbe::FrameArena arena;
+	bbe::FrameArena::setActive(&arena);
+	bbe::FrameList<int32_t>* list = new bbe::FrameList<int32_t>({ 1, 2, 3 });
+	ASSERT_TRUE(arena.owns(list->getRaw()));
+	bbe::FrameArena::setActive(nullptr);
+
+	// Must not hand arena memory to the heap, neither on this nor on another thread.
+	std::thread([&]() { delete list; }).join();
+
+	// Same if a different arena is active by then.
+	bbe::FrameArena other;
+	bbe::FrameArena::setActive(&arena);
+	{
+		bbe::FrameList<int32_t> inFirst = { 4, 5, 6 };
+		ASSERT_TRUE(arena.owns(inFirst.getRaw()));
+		bbe::FrameArena::setActive(&other);
+	}
+	bbe::FrameArena::setActive(nullptr);
+	arena.reset();
+	other.reset();
+}
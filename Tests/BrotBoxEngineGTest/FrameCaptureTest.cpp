@@ -0,0 +1,202 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+#include "BBE/FrameCapture.h"
+
+namespace
+{
+	bbe::Image frameImage(int width, int height, int frame)
+	{
+		return bbe::Image(width, height, bbe::Color(frame * 0.1f, 0.5f, 1.0f - frame * 0.1f, 1.0f));
+	}
+}
+
+TEST(FrameCapture, PpmStreamKeepsSubmitOrder)
+{
+	const bbe::String path = "FrameCaptureTest.ppm";
+	bbe::FrameCaptureSettings settings;
+	settings.format = bbe::FrameCaptureFormat::PPM;
+	settings.amountOfEncoderThreads = 4;
+	settings.maxFramesInFlight = 3;
+
+	bbe::FrameCapture capture;
+	capture.start(path, settings);
+	for (int i = 0; i < 10; i++)
+	{
+		ASSERT_TRUE(capture.submit(i, frameImage(5, 3, i)));
+	}
+	capture.stop();
+	ASSERT_EQ(capture.getAmountOfWrittenFrames(), 10);
+	ASSERT_EQ(capture.getAmountOfDroppedFrames(), 0);
+
+	const bbe::ByteBuffer file = bbe::simpleFile::readBinaryFile(path);
+	const char* header = "P6\n5 3\n255\n";
+	const size_t headerLength = strlen(header);
+	const size_t frameLength = headerLength + 5 * 3 * 3;
+	ASSERT_EQ(file.getLength(), 10 * frameLength);
+	for (int i = 0; i < 10; i++)
+	{
+		const bbe::byte* frame = file.getRaw() + i * frameLength;
+		ASSERT_EQ(memcmp(frame, header, headerLength), 0);
+		const bbe::Colori expected = frameImage(1, 1, i).getPixel(0, 0);
+		for (size_t k = 0; k < 5 * 3; k++)
+		{
+			ASSERT_EQ(frame[headerLength + k * 3 + 0], expected.r);
+			ASSERT_EQ(frame[headerLength + k * 3 + 1], expected.g);
+			ASSERT_EQ(frame[headerLength + k * 3 + 2], expected.b);
+		}
+	}
+
+	bbe::simpleFile::deleteFile(path);
+}
+
+TEST(FrameCapture, Y4mStream)
+{
+	const bbe::String path = "FrameCaptureTest.y4m";
+	bbe::FrameCaptureSettings settings;
+	settings.format = bbe::FrameCaptureFormat::Y4M;
+	settings.framesPerSecond = 30;
+
+	bbe::FrameCapture capture;
+	capture.start(path, settings);
+	capture.submit(1, bbe::Image(4, 2, bbe::Color(1, 1, 1, 1)));
+	capture.submit(2, bbe::Image(4, 2, bbe::Color(0, 0, 0, 1)));
+	capture.submit(3, bbe::Image(4, 2, bbe::Color(1, 0, 0, 1)));
+	capture.stop();
+
+	const bbe::ByteBuffer file = bbe::simpleFile::readBinaryFile(path);
+	const char* header = "YUV4MPEG2 W4 H2 F30:1 Ip A1:1 C444 XCOLORRANGE=FULL\n";
+	const size_t headerLength = strlen(header);
+	const size_t frameLength = 6 + 4 * 2 * 3;
+	ASSERT_EQ(file.getLength(), headerLength + 3 * frameLength);
+	ASSERT_EQ(memcmp(file.getRaw(), header, headerLength), 0);
+
+	const bbe::byte expected[3][3] = {
+		{ 255, 128, 128 }, // White
+		{   0, 128, 128 }, // Black
+		{  76,  85, 255 }, // Red
+	};
+	for (int i = 0; i < 3; i++)
+	{
+		const bbe::byte* frame = file.getRaw() + headerLength + i * frameLength;
+		ASSERT_EQ(memcmp(frame, "FRAME\n", 6), 0);
+		for (int plane = 0; plane < 3; plane++)
+		{
+			for (int k = 0; k < 4 * 2; k++)
+			{
+				ASSERT_EQ(frame[6 + plane * 8 + k], expected[i][plane]) << i << " " << plane;
+			}
+		}
+	}
+
+	bbe::simpleFile::deleteFile(path);
+}
+
+TEST(FrameCapture, Y4mStreamDropsResizedFrames)
+{
+	const bbe::String path = "FrameCaptureResizeTest.y4m";
+	bbe::FrameCaptureSettings settings;
+	settings.format = bbe::FrameCaptureFormat::Y4M;
+
+	bbe::FrameCapture capture;
+	capture.start(path, settings);
+	ASSERT_TRUE(capture.submit(1, bbe::Image(4, 2, bbe::Color(1, 1, 1, 1))));
+	// As if the window was resized during the recording.
+	ASSERT_FALSE(capture.submit(2, bbe::Image(8, 4, bbe::Color(0, 0, 0, 1))));
+	ASSERT_TRUE(capture.submit(3, bbe::Image(4, 2, bbe::Color(1, 0, 0, 1))));
+	capture.stop();
+	ASSERT_EQ(capture.getAmountOfWrittenFrames(), 2);
+	ASSERT_EQ(capture.getAmountOfDroppedFrames(), 1);
+
+	const bbe::ByteBuffer file = bbe::simpleFile::readBinaryFile(path);
+	const size_t headerLength = strlen("YUV4MPEG2 W4 H2 F60:1 Ip A1:1 C444 XCOLORRANGE=FULL\n");
+	ASSERT_EQ(file.getLength(), headerLength + 2 * (6 + 4 * 2 * 3));
+
+	bbe::simpleFile::deleteFile(path);
+}
+
+TEST(FrameCapture, PngFilesAreNamedByFrameNumber)
+{
+	bbe::FrameCapture capture;
+	capture.start("FrameCaptureTest");
+	capture.submit(7, frameImage(3, 3, 2));
+	capture.submit(8, frameImage(3, 3, 4));
+	capture.stop();
+
+	for (int i = 0; i < 2; i++)
+	{
+		const bbe::String path = bbe::String("FrameCaptureTest") + (7 + i) + ".png";
+		ASSERT_TRUE(bbe::simpleFile::doesFileExist(path));
+		const bbe::Image image(path);
+		ASSERT_EQ(image.getWidth(), 3);
+		ASSERT_EQ(image.getPixel(1, 1), frameImage(1, 1, 2 + i * 2).getPixel(0, 0));
+		bbe::simpleFile::deleteFile(path);
+	}
+}
+
+TEST(FrameCapture, Backpressure)
+{
+	const bbe::String path = "FrameCaptureTest.ppm";
+	for (int policy = 0; policy < 2; policy++)
+	{
+		bbe::FrameCaptureSettings settings;
+		settings.format = bbe::FrameCaptureFormat::PPM;
+		settings.backpressure = policy == 0 ? bbe::FrameCaptureBackpressure::BLOCK : bbe::FrameCaptureBackpressure::DROP;
+		settings.maxFramesInFlight = 2;
+		settings.amountOfEncoderThreads = 1;
+
+		bbe::FrameCapture capture;
+		capture.start(path, settings);
+		uint64_t accepted = 0;
+		for (int i = 0; i < 50; i++)
+		{
+			if (capture.submit(i, frameImage(64, 64, i % 10))) accepted++;
+			ASSERT_LE(capture.getAmountOfFramesInFlight(), 2);
+		}
+		capture.stop();
+
+		ASSERT_EQ(capture.getAmountOfWrittenFrames(), accepted);
+		ASSERT_EQ(capture.getAmountOfWrittenFrames() + capture.getAmountOfDroppedFrames(), 50);
+		if (settings.backpressure == bbe::FrameCaptureBackpressure::BLOCK)
+		{
+			ASSERT_EQ(capture.getAmountOfDroppedFrames(), 0);
+		}
+		ASSERT_EQ(bbe::simpleFile::readBinaryFile(path).getLength(), accepted * (strlen("P6\n64 64\n255\n") + 64 * 64 * 3));
+	}
+	bbe::simpleFile::deleteFile(path);
+}
+
+TEST(FrameCapture, UnwritablePngPathIsReported)
+{
+	bbe::FrameCapture capture;
+	capture.start("FrameCaptureMissingDirectory/FrameCaptureTest");
+	capture.submit(1, frameImage(3, 3, 1));
+	capture.submit(2, frameImage(3, 3, 2));
+	ASSERT_THROW(capture.stop(), std::runtime_error);
+	ASSERT_EQ(capture.getAmountOfWrittenFrames(), 0);
+	ASSERT_EQ(capture.getAmountOfDroppedFrames(), 2);
+}
+
+#ifdef __linux__
+TEST(FrameCapture, FullDiskIsReported)
+{
+	// Every write to /dev/full fails with ENOSPC.
+	bbe::FrameCaptureSettings settings;
+	settings.format = bbe::FrameCaptureFormat::PPM;
+
+	bbe::FrameCapture capture;
+	capture.start("/dev/full", settings);
+	for (int i = 0; i < 3; i++)
+	{
+		capture.submit(i, frameImage(64, 64, i));
+	}
+	ASSERT_THROW(capture.stop(), std::runtime_error);
+	ASSERT_GT(capture.getAmountOfDroppedFrames(), 0);
+	ASSERT_EQ(capture.getAmountOfWrittenFrames() + capture.getAmountOfDroppedFrames(), 3);
+
+	// Small enough to stay in the buffer, so only closing the stream fails.
+	settings.format = bbe::FrameCaptureFormat::Y4M;
+	capture.start("/dev/full", settings);
+	capture.submit(1, frameImage(2, 2, 1));
+	ASSERT_THROW(capture.stop(), std::runtime_error);
+}
+#endif
@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+namespace
+{
+	template<typename Layout>
+	void checkLayout()
+	{
+		constexpr size_t width = 13;
+		constexpr size_t height = 29;
+		bbe::Grid<int32_t, Layout> grid(width, height);
+		grid.fill(-1);
+		for (size_t x = 0; x < width; x++)
+		{
+			for (size_t y = 0; y < height; y++)
+			{
+				grid[x][y] = (int32_t)(x * 1000 + y);
+			}
+		}
+		for (size_t x = 0; x < width; x++)
+		{
+			for (size_t y = 0; y < height; y++)
+			{
+				ASSERT_EQ(grid.get(x, y), (int32_t)(x * 1000 + y));
+				ASSERT_EQ(grid[bbe::Vector2i((int32_t)x, (int32_t)y)], (int32_t)(x * 1000 + y));
+			}
+		}
+		ASSERT_EQ(grid.count(-1), 0);
+		ASSERT_EQ(grid.count(12028), 1);
+
+		const bbe::Grid<int32_t, Layout> transposed = grid.transposed();
+		ASSERT_EQ(transposed.getWidth(), height);
+		ASSERT_EQ(transposed[28][12], 12028);
+
+		const bbe::Grid<int32_t> columnMajor = grid.template withLayout<bbe::GridLayout::ColumnMajor>();
+		ASSERT_EQ(columnMajor[7][3], 7003);
+	}
+
+	template<typename Layout>
+	void checkStencil(const bbe::Grid<float>& input, const bbe::GridStencil<float>& kernel)
+	{
+		const bbe::Grid<float, Layout> grid = input.withLayout<Layout>();
+		bbe::Grid<float, Layout> out;
+		grid.stencil(kernel, out);
+		bbe::Grid<float, Layout> outParallel;
+		grid.stencil(kernel, outParallel, true);
+
+		const int64_t width = (int64_t)input.getWidth();
+		const int64_t height = (int64_t)input.getHeight();
+		for (int64_t x = 0; x < width; x++)
+		{
+			for (int64_t y = 0; y < height; y++)
+			{
+				float expected = 0;
+				for (int64_t dy = -1; dy <= 1; dy++)
+				{
+					for (int64_t dx = -1; dx <= 1; dx++)
+					{
+						const int64_t sx = std::clamp<int64_t>(x + dx, 0, width - 1);
+						const int64_t sy = std::clamp<int64_t>(y + dy, 0, height - 1);
+						expected += kernel.weights[dx + 1][dy + 1] * input[sx][sy];
+					}
+				}
+				ASSERT_NEAR(out.get(x, y), expected, 1e-4f);
+				ASSERT_EQ(out.get(x, y), outParallel.get(x, y));
+			}
+		}
+	}
+}
+
+TEST(Grid, Layouts)
+{
+	checkLayout<bbe::GridLayout::ColumnMajor>();
+	checkLayout<bbe::GridLayout::RowMajor>();
+	checkLayout<bbe::GridLayout::Tiled<8>>();
+	checkLayout<bbe::GridLayout::Tiled<4>>();
+	checkLayout<bbe::GridLayout::ZOrder>();
+}
+
+TEST(Grid, Stencil)
+{
+	bbe::Random rand;
+	rand.setSeed(7);
+	bbe::Grid<float> input(37, 23);
+	for (size_t x = 0; x < input.getWidth(); x++)
+	{
+		for (size_t y = 0; y < input.getHeight(); y++)
+		{
+			input[x][y] = rand.randomFloat() * 10.f - 5.f;
+		}
+	}
+
+	const bbe::GridStencil<float> fivePoint = bbe::GridStencil<float>::fivePoint(-4.f, 1.f);
+	bbe::GridStencil<float> ninePoint = bbe::GridStencil<float>::ninePoint(0.25f, 0.125f, 0.0625f);
+	ninePoint.weights[2][0] = 3.f; // Asymmetric, to catch mixed up axes.
+
+	checkStencil<bbe::GridLayout::ColumnMajor>(input, fivePoint);
+	checkStencil<bbe::GridLayout::ColumnMajor>(input, ninePoint);
+	checkStencil<bbe::GridLayout::RowMajor>(input, ninePoint);
+	checkStencil<bbe::GridLayout::Tiled<8>>(input, ninePoint);
+	checkStencil<bbe::GridLayout::ZOrder>(input, ninePoint);
+
+	bbe::Grid<double> doubles(5, 3);
+	doubles.fill(2.0);
+	bbe::Grid<double> doublesOut;
+	doubles.stencil(bbe::GridStencil<double>::ninePoint(1.0, 1.0, 1.0), doublesOut);
+	ASSERT_EQ(doublesOut[4][2], 18.0);
+
+	bbe::Grid<int32_t> ints(3, 3);
+	ints[1][1] = 1;
+	bbe::Grid<int32_t> intsOut;
+	ints.stencil(bbe::GridStencil<int32_t>::fivePoint(2, 1), intsOut);
+	ASSERT_EQ(intsOut[1][1], 2);
+	ASSERT_EQ(intsOut[0][1], 1);
+	ASSERT_EQ(intsOut[0][0], 0);
+}
+
+namespace
+{
+	template<typename Layout>
+	void checkSameStencil(const bbe::Grid<float>& input, const bbe::GridStencil<float>& kernel, const bbe::Grid<float>& expected)
+	{
+		const bbe::Grid<float, Layout> grid = input.withLayout<Layout>();
+		bbe::Grid<float, Layout> out;
+		grid.stencil(kernel, out);
+		bbe::Grid<float, Layout> outParallel;
+		grid.stencil(kernel, outParallel, true);
+		for (size_t x = 0; x < input.getWidth(); x++)
+		{
+			for (size_t y = 0; y < input.getHeight(); y++)
+			{
+				ASSERT_NEAR(out.get(x, y), expected[x][y], 1e-5f);
+				ASSERT_EQ(out.get(x, y), outParallel.get(x, y));
+			}
+		}
+	}
+}
+
+TEST(Grid, StencilLayoutsAgreeOnLargeGrids)
+{
+	// Big enough to be split into many blocks for the parallel path.
+	constexpr size_t size = 256;
+	bbe::Grid<float> input(size, size);
+	for (size_t x = 0; x < size; x++)
+	{
+		for (size_t y = 0; y < size; y++)
+		{
+			input[x][y] = (float)((x * 7 + y * 13) % 17);
+		}
+	}
+	const bbe::GridStencil<float> kernel = bbe::GridStencil<float>::fivePoint(0.5f, 0.125f);
+	bbe::Grid<float> expected;
+	input.stencil(kernel, expected);
+
+	checkSameStencil<bbe::GridLayout::ColumnMajor>(input, kernel, expected);
+	checkSameStencil<bbe::GridLayout::RowMajor>(input, kernel, expected);
+	checkSameStencil<bbe::GridLayout::Tiled<8>>(input, kernel, expected);
+	checkSameStencil<bbe::GridLayout::ZOrder>(input, kernel, expected);
+}
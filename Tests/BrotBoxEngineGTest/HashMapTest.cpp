@@ -0,0 +1,309 @@
+#include "gtest/gtest.h"
+#include "BBE/HashMap.h"
+#include "BBE/String.h"
+#include "BBE/Vector2.h"
+#include "BBE/Random.h"
+#include "TestUtils.h"
+#include <map>
+#include <unordered_map>
+
+TEST(HashMap, AddGetContains)
+{
+	bbe::HashMap<int32_t, bbe::String> map;
+	ASSERT_TRUE(map.isEmpty());
+	ASSERT_EQ(map.get(1), nullptr);
+	for (int32_t i = 0; i < 10000; i++)
+	{
+		map.add(i, bbe::String(i));
+	}
+	ASSERT_EQ(map.getLength(), 10000);
+	for (int32_t i = 0; i < 10000; i++)
+	{
+		ASSERT_TRUE(map.contains(i));
+		ASSERT_EQ(*map.get(i), bbe::String(i));
+	}
+	ASSERT_FALSE(map.contains(-1));
+	ASSERT_FALSE(map.contains(10000));
+
+	*map.get(17) = "Changed";
+	ASSERT_EQ(*map.get(17), "Changed");
+}
+
+TEST(HashMap, RemoveAgainstReference)
+{
+	bbe::Random rand;
+	rand.setSeed(5);
+	bbe::HashMap<int32_t, int32_t> map;
+	std::map<int32_t, int32_t> reference;
+	for (int32_t i = 0; i < 20000; i++)
+	{
+		const int32_t key = rand.randomInt(2000);
+		if (rand.randomBool())
+		{
+			const bool existed = reference.count(key) > 0;
+			ASSERT_EQ(map.remove(key), existed);
+			reference.erase(key);
+		}
+		else if (!map.contains(key))
+		{
+			map.add(key, i);
+			reference[key] = i;
+		}
+		ASSERT_EQ(map.getLength(), reference.size());
+	}
+	for (const auto& [key, value] : reference)
+	{
+		ASSERT_NE(map.get(key), nullptr);
+		ASSERT_EQ(*map.get(key), value);
+	}
+}
+
+TEST(HashMap, Iteration)
+{
+	bbe::HashMap<bbe::Vector2i, int32_t> map;
+	int32_t expectedSum = 0;
+	for (int32_t x = 0; x < 30; x++)
+	{
+		for (int32_t y = 0; y < 30; y++)
+		{
+			map.add(bbe::Vector2i(x, y), x * 100 + y);
+			expectedSum += x * 100 + y;
+		}
+	}
+
+	int32_t sum = 0;
+	size_t amount = 0;
+	for (auto kv : map)
+	{
+		ASSERT_EQ(kv.value, kv.key.x * 100 + kv.key.y);
+		kv.value++;
+		sum += kv.key.x * 100 + kv.key.y;
+		amount++;
+	}
+	ASSERT_EQ(sum, expectedSum);
+	ASSERT_EQ(amount, map.getLength());
+
+	const bbe::HashMap<bbe::Vector2i, int32_t>& constMap = map;
+	for (auto kv : constMap)
+	{
+		ASSERT_EQ(kv.value, kv.key.x * 100 + kv.key.y + 1);
+	}
+
+	bbe::HashMap<int32_t, int32_t> empty;
+	ASSERT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(HashMap, ReserveAndClear)
+{
+	bbe::HashMap<int32_t, int32_t> map;
+	map.reserve(1000);
+	const size_t buckets = map.getAmountOfBuckets();
+	ASSERT_GE(buckets, 1000);
+	for (int32_t i = 0; i < 1000; i++)
+	{
+		map.add(i, i);
+	}
+	ASSERT_EQ(map.getAmountOfBuckets(), buckets);
+
+	map.clear();
+	ASSERT_EQ(map.getLength(), 0);
+	ASSERT_EQ(map.getAmountOfBuckets(), buckets);
+	ASSERT_FALSE(map.contains(5));
+	map.add(5, 6);
+	ASSERT_EQ(*map.get(5), 6);
+}
+
+TEST(HashMap, CopyAndMove)
+{
+	bbe::HashMap<int32_t, SomeClass<int>> map;
+	for (int32_t i = 0; i < 100; i++)
+	{
+		map.add(i, SomeClass<int>(i + 1));
+	}
+
+	bbe::HashMap<int32_t, SomeClass<int>> copy = map;
+	ASSERT_EQ(copy.getLength(), 100);
+	map.remove(3);
+	ASSERT_EQ(copy.get(3)->getLength(), 4);
+
+	bbe::HashMap<int32_t, SomeClass<int>> moved = std::move(copy);
+	ASSERT_EQ(moved.getLength(), 100);
+	ASSERT_EQ(copy.getLength(), 0);
+	ASSERT_EQ(copy.get(3), nullptr);
+
+	copy = moved;
+	moved = std::move(map);
+	ASSERT_EQ(copy.getLength(), 100);
+	ASSERT_EQ(moved.getLength(), 99);
+}
+
+TEST(HashMap, StringKeysHeterogeneousLookup)
+{
+	bbe::HashMap<bbe::String, int32_t> map;
+	map.add("Hello", 1);
+	map.add(bbe::String("A rather long key that does not fit into the SSO buffer"), 2);
+
+	const char* hello = "Hello";
+	ASSERT_EQ(*map.get(hello), 1);
+	ASSERT_EQ(*map.get("A rather long key that does not fit into the SSO buffer"), 2);
+	ASSERT_EQ(*map.get(std::string_view("Hello, World").substr(0, 5)), 1);
+	ASSERT_TRUE(map.contains("Hello"));
+	ASSERT_FALSE(map.contains("World"));
+	ASSERT_EQ(bbe::hash(bbe::String("Hello")), bbe::hash(hello));
+
+	ASSERT_TRUE(map.remove("Hello"));
+	ASSERT_FALSE(map.contains(bbe::String("Hello")));
+}
+
+TEST(HashMap, FundamentalHashes)
+{
+	ASSERT_NE(bbe::hash(0.25f), bbe::hash(0.5f));
+	ASSERT_NE(bbe::hash(0.25), bbe::hash(0.5));
+	ASSERT_EQ(bbe::hash(0.0), bbe::hash(-0.0));
+	// Casting would drop the upper half.
+	ASSERT_NE(bbe::hash((int64_t)0), bbe::hash((int64_t)1 << 32));
+}
+
+namespace
+{
+	template<typename Key, typename Hasher = std::hash<Key>>
+	void checkAgainstUnorderedMap(const bbe::List<Key>& keys, const bbe::List<Key>& missingKeys)
+	{
+		bbe::HashMap<Key, uint64_t> map;
+		std::unordered_map<Key, uint64_t, Hasher> reference;
+		for (size_t i = 0; i < keys.getLength(); i++)
+		{
+			map.add(keys[i], i);
+			reference.emplace(keys[i], i);
+		}
+		ASSERT_EQ(map.getLength(), reference.size());
+		for (size_t i = 0; i < keys.getLength(); i++)
+		{
+			ASSERT_NE(map.get(keys[i]), nullptr);
+			ASSERT_EQ(*map.get(keys[i]), reference.find(keys[i])->second);
+		}
+		for (size_t i = 0; i < missingKeys.getLength(); i++)
+		{
+			ASSERT_EQ(map.contains(missingKeys[i]), reference.count(missingKeys[i]) > 0);
+		}
+		// Every other key goes, then the rest still has to be found.
+		for (size_t i = 0; i < keys.getLength(); i += 2)
+		{
+			ASSERT_EQ(map.remove(keys[i]), reference.erase(keys[i]) > 0);
+		}
+		ASSERT_EQ(map.getLength(), reference.size());
+		for (size_t i = 0; i < keys.getLength(); i++)
+		{
+			const auto it = reference.find(keys[i]);
+			if (it == reference.end()) ASSERT_EQ(map.get(keys[i]), nullptr);
+			else ASSERT_EQ(*map.get(keys[i]), it->second);
+		}
+	}
+
+	struct StringHasher
+	{
+		size_t operator()(const bbe::String& s) const
+		{
+			return bbe::hash(s);
+		}
+	};
+}
+
+TEST(HashMap, MatchesUnorderedMap)
+{
+	// Sequential keys used to cluster, random keys contain duplicates.
+	bbe::Random rand;
+	rand.setSeed(1337);
+	bbe::List<int32_t> sequential;
+	bbe::List<int32_t> sequentialMissing;
+	bbe::List<int32_t> random;
+	bbe::List<int32_t> randomMissing;
+	bbe::List<bbe::String> strings;
+	bbe::List<bbe::String> stringsMissing;
+	for (int32_t i = 0; i < 20000; i++)
+	{
+		sequential.add(i);
+		sequentialMissing.add(i + 20000);
+		random.add((int32_t)rand.randomInt(30000) * 2);
+		randomMissing.add((int32_t)rand.randomInt(30000) * 2 + 1);
+		if (i % 8 == 0)
+		{
+			strings.add(bbe::String("some/path/to/a/resource_") + i);
+			stringsMissing.add(bbe::String("some/other/path/resource_") + i);
+		}
+	}
+	random.sort();
+	random.removeAll([previous = (int32_t)-1](const int32_t& val) mutable {
+		const bool duplicate = val == previous;
+		previous = val;
+		return duplicate;
+		});
+	random.shuffle(42);
+
+	checkAgainstUnorderedMap(sequential, sequentialMissing);
+	checkAgainstUnorderedMap(random, randomMissing);
+	checkAgainstUnorderedMap<bbe::String, StringHasher>(strings, stringsMissing);
+}
+
+namespace
+{
+	struct CollidingKey
+	{
+		int32_t value = 0;
+
+		bool operator==(const CollidingKey& other) const
+		{
+			return value == other.value;
+		}
+	};
+}
+
+template<>
+uint32_t bbe::hash(const CollidingKey&)
+{
+	return 42;
+}
+
+TEST(HashMap, ConstantHash)
+{
+	// Equal hashes collide at every capacity, so the entries beyond the maximum probe distance must not make the
+	// table grow forever.
+	bbe::HashMap<CollidingKey, int32_t> map;
+	for (int32_t i = 0; i < 1000; i++)
+	{
+		map.add(CollidingKey{ i }, i * 3);
+	}
+	ASSERT_EQ(map.getLength(), 1000);
+	ASSERT_LE(map.getAmountOfBuckets(), 2048);
+	for (int32_t i = 0; i < 1000; i++)
+	{
+		ASSERT_NE(map.get(CollidingKey{ i }), nullptr);
+		ASSERT_EQ(*map.get(CollidingKey{ i }), i * 3);
+	}
+	ASSERT_FALSE(map.contains(CollidingKey{ 1000 }));
+
+	size_t iterated = 0;
+	for (auto kv : map)
+	{
+		ASSERT_EQ(kv.value, kv.key.value * 3);
+		iterated++;
+	}
+	ASSERT_EQ(iterated, 1000);
+
+	bbe::HashMap<CollidingKey, int32_t> copy = map;
+	for (int32_t i = 0; i < 1000; i += 2)
+	{
+		ASSERT_TRUE(map.remove(CollidingKey{ i }));
+	}
+	ASSERT_EQ(map.getLength(), 500);
+	for (int32_t i = 0; i < 1000; i++)
+	{
+		ASSERT_EQ(map.contains(CollidingKey{ i }), i % 2 == 1);
+		ASSERT_TRUE(copy.contains(CollidingKey{ i }));
+	}
+	for (int32_t i = 1; i < 1000; i += 2)
+	{
+		ASSERT_TRUE(map.remove(CollidingKey{ i }));
+	}
+	ASSERT_TRUE(map.isEmpty());
+}
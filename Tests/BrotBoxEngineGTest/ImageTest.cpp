@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+TEST(Image, SetPixelsR8)
+{
+	const bbe::byte zeros[4 * 3] = {};
+	bbe::Image image(4, 3, zeros, bbe::ImageFormat::R8);
+	const bbe::byte region[2 * 2] = { 1, 2, 3, 4 };
+	image.setPixels(bbe::Vector2i(2, 1), 2, 2, region);
+
+	bbe::byte pixels[4 * 3];
+	image.getPixels(bbe::Vector2i(0, 0), 4, 3, pixels);
+	const bbe::byte expected[4 * 3] = {
+		0, 0, 0, 0,
+		0, 0, 1, 2,
+		0, 0, 3, 4,
+	};
+	for (size_t i = 0; i < 4 * 3; i++)
+	{
+		ASSERT_EQ(pixels[i], expected[i]) << i;
+	}
+	ASSERT_EQ(image.getPixel(3, 2).r, 4);
+}
+
+TEST(Image, SetPixelsFloat)
+{
+	// The offsets of float images are four times the ones of byte images with the same amount of channels.
+	const float zeros[4 * 3] = {};
+	bbe::Image image(4, 3, zeros, bbe::ImageFormat::R32FLOAT);
+	const float region[2 * 2] = { 1.5f, 2.5f, 3.5f, 4.5f };
+	image.setPixels(bbe::Vector2i(2, 1), 2, 2, region);
+
+	float pixels[4 * 3];
+	image.getPixels(bbe::Vector2i(0, 0), 4, 3, pixels);
+	const float expected[4 * 3] = {
+		0, 0,    0,    0,
+		0, 0, 1.5f, 2.5f,
+		0, 0, 3.5f, 4.5f,
+	};
+	for (size_t i = 0; i < 4 * 3; i++)
+	{
+		ASSERT_EQ(pixels[i], expected[i]) << i;
+	}
+
+	const float rgbaZeros[3 * 2 * 4] = {};
+	bbe::Image rgba(3, 2, rgbaZeros, bbe::ImageFormat::R32G32B32A32FLOAT);
+	const float pixel[4] = { 0.25f, 0.5f, 0.75f, 1.0f };
+	rgba.setPixels(bbe::Vector2i(2, 1), 1, 1, pixel);
+	float readBack[4] = {};
+	rgba.getPixels(bbe::Vector2i(2, 1), 1, 1, readBack);
+	for (size_t i = 0; i < 4; i++)
+	{
+		ASSERT_EQ(readBack[i], pixel[i]);
+	}
+	float first[4] = {};
+	rgba.getPixels(bbe::Vector2i(0, 0), 1, 1, first);
+	for (size_t i = 0; i < 4; i++)
+	{
+		ASSERT_EQ(first[i], 0.0f);
+	}
+}
@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+#include "BBE/JobSystem.h"
+#include "BBE/FrameArena.h"
+#include <atomic>
+#include <stdexcept>
+
+TEST(JobSystem, ScheduleAndWait)
+{
+	std::atomic<int32_t> counter = 0;
+	bbe::List<bbe::JobHandle> handles;
+	for (int32_t i = 0; i < 1000; i++)
+	{
+		handles.add(bbe::jobs::schedule([&]() { counter++; }));
+	}
+	bbe::jobs::waitAll(handles);
+	ASSERT_EQ(counter.load(), 1000);
+	for (size_t i = 0; i < handles.getLength(); i++)
+	{
+		ASSERT_TRUE(handles[i].isDone());
+	}
+}
+
+TEST(JobSystem, Dependencies)
+{
+	for (int32_t repeat = 0; repeat < 100; repeat++)
+	{
+		std::atomic<int32_t> step = 0;
+		int32_t seenByA = -1;
+		int32_t seenByB = -1;
+		int32_t seenByC = -1;
+		bbe::JobHandle a = bbe::jobs::schedule([&]() { seenByA = step++; });
+		bbe::JobHandle b = bbe::jobs::schedule([&]() { seenByB = step++; }, a);
+		bbe::JobHandle c = bbe::jobs::schedule([&]() { seenByC = step++; }, bbe::List<bbe::JobHandle>{ a, b });
+		c.wait();
+		ASSERT_EQ(seenByA, 0);
+		ASSERT_EQ(seenByB, 1);
+		ASSERT_EQ(seenByC, 2);
+	}
+}
+
+TEST(JobSystem, NestedWaitDoesNotDeadlock)
+{
+	std::atomic<int32_t> counter = 0;
+	bbe::List<bbe::JobHandle> outer;
+	for (size_t i = 0; i < bbe::jobs::getAmountOfWorkers() * 4; i++)
+	{
+		outer.add(bbe::jobs::schedule([&]()
+			{
+				bbe::jobs::parallelFor(0, 100, 7, [&](size_t begin, size_t end)
+					{
+						counter += (int32_t)(end - begin);
+					});
+			}));
+	}
+	bbe::jobs::waitAll(outer);
+	ASSERT_EQ(counter.load(), (int32_t)(bbe::jobs::getAmountOfWorkers() * 4 * 100));
+}
+
+TEST(JobSystem, ParallelForCoversRangeExactlyOnce)
+{
+	for (size_t grain : { 0, 1, 3, 64, 1000, 5000 })
+	{
+		bbe::List<int32_t> touched(1000, 0);
+		bbe::jobs::parallelFor(17, 1000, grain, [&](size_t begin, size_t end)
+			{
+				ASSERT_LE(begin, end);
+				if (grain != 0) ASSERT_LE(end - begin, grain);
+				for (size_t i = begin; i < end; i++)
+				{
+					touched[i]++;
+				}
+			});
+		for (size_t i = 0; i < touched.getLength(); i++)
+		{
+			ASSERT_EQ(touched[i], i < 17 ? 0 : 1);
+		}
+	}
+
+	bool called = false;
+	bbe::jobs::parallelFor(5, 5, 1, [&](size_t, size_t) { called = true; });
+	ASSERT_FALSE(called);
+}
+
+TEST(JobSystem, StopAndRestart)
+{
+	std::atomic<int32_t> counter = 0;
+	bbe::jobs::schedule([&]() { counter++; }).wait();
+	bbe::jobs::stopWorkers();
+	bbe::jobs::schedule([&]() { counter++; }).wait();
+	ASSERT_EQ(counter.load(), 2);
+	ASSERT_GE(bbe::jobs::getAmountOfWorkers(), 1);
+}
+
+TEST(JobSystem, ExceptionsReachWait)
+{
+	bbe::FrameArena arena;
+	bbe::FrameArena::setActive(&arena);
+
+	std::atomic_bool continuationRan = false;
+	bbe::JobHandle throwing = bbe::jobs::schedule([]() { throw std::runtime_error("job failed"); });
+	bbe::JobHandle continuation = bbe::jobs::schedule([&]() { continuationRan = true; }, throwing);
+	ASSERT_THROW(throwing.wait(), std::runtime_error);
+	ASSERT_TRUE(throwing.isDone());
+	continuation.wait();
+	ASSERT_TRUE(continuationRan);
+	// Also if the job ran on this thread.
+	ASSERT_EQ(bbe::FrameArena::getActive(), &arena);
+
+	std::atomic<int32_t> finishedChunks = 0;
+	ASSERT_THROW(bbe::jobs::parallelFor(0, 64, 1, [&](size_t begin, size_t)
+		{
+			if (begin == 10) throw std::runtime_error("chunk failed");
+			finishedChunks++;
+		}), std::runtime_error);
+	// All other chunks are done by the time parallelFor throws.
+	ASSERT_EQ(finishedChunks, 63);
+	ASSERT_EQ(bbe::FrameArena::getActive(), &arena);
+
+	bbe::FrameArena::setActive(nullptr);
+}
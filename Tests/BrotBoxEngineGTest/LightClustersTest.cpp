@@ -0,0 +1,134 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+#include "BBE/LightClusters.h"
+
+static bbe::Matrix4 createProjection()
+{
+	return bbe::Matrix4::createPerspectiveMatrix(bbe::Math::toRadians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+}
+
+static bbe::PointLight createLight(const bbe::Vector3& pos, float lightStrength)
+{
+	bbe::PointLight light(pos);
+	light.lightStrength = lightStrength;
+	return light;
+}
+
+static bool clusterContains(const bbe::LightClusters& clusters, uint32_t clusterIndex, uint32_t lightIndex)
+{
+	const bbe::LightClusters::Cluster& cluster = clusters.getClusters()[clusterIndex];
+	for (uint32_t i = 0; i < cluster.amountOfLights; i++)
+	{
+		if (clusters.getLightIndices()[cluster.offset + i] == lightIndex) return true;
+	}
+	return false;
+}
+
+TEST(LightClusters, Planes)
+{
+	bbe::LightClusters clusters;
+	clusters.build({}, bbe::Matrix4(), createProjection());
+	ASSERT_NEAR(clusters.getNearPlane(), 0.1f, 0.0001f);
+	ASSERT_NEAR(clusters.getFarPlane(), 100.0f, 0.1f);
+	ASSERT_EQ(clusters.getClusters().getLength(), 16 * 9 * 24);
+	ASSERT_EQ(clusters.getLightIndices().getLength(), 0);
+
+	ASSERT_EQ(clusters.getClusterIndex(bbe::Vector3(0, 0, -0.1f)), clusters.getClusterIndex(8, 4, 0));
+	ASSERT_EQ(clusters.getClusterIndex(bbe::Vector3(0, 0, -99.0f)), clusters.getClusterIndex(8, 4, 23));
+}
+
+TEST(LightClusters, SmallLights)
+{
+	// Looking along +x from the origin, z is up.
+	const bbe::Matrix4 view = bbe::Matrix4::createViewMatrix(bbe::Vector3(0, 0, 0), bbe::Vector3(1, 0, 0), bbe::Vector3(0, 0, 1));
+	bbe::List<bbe::PointLight> lights;
+	lights.add(createLight(bbe::Vector3( 10, 0, 0), 0.02f)); // Radius 0.5, in view.
+	lights.add(createLight(bbe::Vector3(-10, 0, 0), 0.02f)); // Behind the camera.
+	lights.add(createLight(bbe::Vector3(200, 0, 0), 0.02f)); // Beyond the far plane.
+	lights.add(createLight(bbe::Vector3( 10, 0, 30), 0.02f)); // Above the view.
+
+	bbe::LightClusters clusters;
+	clusters.build(lights, view, createProjection());
+
+	const bbe::Vector3 viewPos = clusters.getViewSpaceLightPositions()[0];
+	ASSERT_NEAR(viewPos.z, -10.0f, 0.0001f);
+	ASSERT_TRUE(clusterContains(clusters, clusters.getClusterIndex(viewPos), 0));
+
+	// A small light only ends up in a handful of clusters and the others aren't in any.
+	ASSERT_GT(clusters.getLightIndices().getLength(), 0);
+	ASSERT_LT(clusters.getLightIndices().getLength(), 20);
+	for (size_t i = 0; i < clusters.getLightIndices().getLength(); i++)
+	{
+		ASSERT_EQ(clusters.getLightIndices()[i], 0);
+	}
+}
+
+TEST(LightClusters, LightAroundCamera)
+{
+	bbe::List<bbe::PointLight> lights;
+	lights.add(createLight(bbe::Vector3(0, 0, 0.5f), 0.1f)); // Radius 2.5, contains the camera.
+
+	bbe::LightClusters clusters;
+	clusters.build(lights, bbe::Matrix4(), createProjection());
+
+	for (uint32_t y = 0; y < clusters.getTilesY(); y++)
+	{
+		for (uint32_t x = 0; x < clusters.getTilesX(); x++)
+		{
+			ASSERT_TRUE(clusterContains(clusters, clusters.getClusterIndex(x, y, 0), 0));
+		}
+	}
+	ASSERT_FALSE(clusterContains(clusters, clusters.getClusterIndex(0, 0, 23), 0));
+}
+
+TEST(LightClusters, MatchesBruteForce)
+{
+	bbe::Random rand;
+	rand.setSeed(3);
+	const bbe::Matrix4 projection = createProjection();
+	const bbe::Matrix4 view = bbe::Matrix4::createViewMatrix(bbe::Vector3(1, 2, 3), bbe::Vector3(20, 5, 0), bbe::Vector3(0, 0, 1));
+
+	bbe::List<bbe::PointLight> lights;
+	for (int32_t i = 0; i < 300; i++)
+	{
+		const bbe::Vector3 pos(rand.randomFloat() * 80 - 20, rand.randomFloat() * 80 - 40, rand.randomFloat() * 40 - 20);
+		bbe::PointLight light = createLight(pos, rand.randomFloat() * 0.2f + 0.01f);
+		if (i % 10 == 0) light.falloffMode = bbe::LightFalloffMode::LIGHT_FALLOFF_LINEAR;
+		lights.add(light);
+	}
+
+	bbe::LightClusters clusters;
+	clusters.build(lights, view, projection);
+
+	// The lists are packed back to back.
+	uint32_t expectedOffset = 0;
+	for (size_t i = 0; i < clusters.getClusters().getLength(); i++)
+	{
+		ASSERT_EQ(clusters.getClusters()[i].offset, expectedOffset);
+		expectedOffset += clusters.getClusters()[i].amountOfLights;
+	}
+	ASSERT_EQ(expectedOffset, clusters.getLightIndices().getLength());
+
+	// Every point inside the view must find every light that reaches it in its cluster.
+	const float p00 = projection.get(0, 0);
+	const float p11 = projection.get(1, 1);
+	int32_t amountOfLitPoints = 0;
+	for (int32_t i = 0; i < 3000; i++)
+	{
+		const float depth = 0.1f + rand.randomFloat() * rand.randomFloat() * 99.8f;
+		const bbe::Vector3 point((rand.randomFloat() * 2 - 1) * depth / p00, (rand.randomFloat() * 2 - 1) * depth / p11, -depth);
+		const uint32_t clusterIndex = clusters.getClusterIndex(point);
+		for (size_t k = 0; k < lights.getLength(); k++)
+		{
+			if ((clusters.getViewSpaceLightPositions()[k] - point).getLength() <= lights[k].getLightRadius() * 0.999f)
+			{
+				ASSERT_TRUE(clusterContains(clusters, clusterIndex, (uint32_t)k)) << i << " " << k;
+				amountOfLitPoints++;
+			}
+		}
+	}
+	ASSERT_GT(amountOfLitPoints, 100);
+
+	// Binning has to be a lot tighter than giving every cluster every light.
+	ASSERT_LT(clusters.getLightIndices().getLength(), clusters.getClusters().getLength() * lights.getLength() / 10);
+}
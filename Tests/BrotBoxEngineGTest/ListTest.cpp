@@ -678,3 +678,77 @@ TEST(Queue, TestQueue)
 		}
 	}
 }
+
+TEST(List, TriviallyRelocatableTrait)
+{
+	static_assert(bbe::IsTriviallyRelocatable<int32_t>::value);
+	static_assert(bbe::IsTriviallyRelocatable<bbe::Vector2>::value);
+	static_assert(bbe::IsTriviallyRelocatable<bbe::Vector3>::value);
+	static_assert(bbe::IsTriviallyRelocatable<bbe::Color>::value);
+	static_assert(bbe::IsTriviallyRelocatable<bbe::PosNormalPair>::value);
+	static_assert(bbe::IsTriviallyRelocatable<bbe::String>::value);
+	static_assert(bbe::IsTriviallyRelocatable<bbe::List<bbe::String>>::value);
+	static_assert(!bbe::IsTriviallyRelocatable<SomeClass<int>>::value);
+}
+
+TEST(List, RelocatingGrowth)
+{
+	bbe::List<bbe::String> list;
+	for (int32_t i = 0; i < 1000; i++)
+	{
+		// Alternating between strings that fit into the small buffer and strings that live on the heap.
+		list.add(i % 2 == 0 ? bbe::String(i) : bbe::String("A rather long string that does not fit into the SSO buffer ") + i);
+	}
+	for (int32_t i = 0; i < 1000; i++)
+	{
+		ASSERT_EQ(list[i], i % 2 == 0 ? bbe::String(i) : bbe::String("A rather long string that does not fit into the SSO buffer ") + i);
+	}
+
+	bbe::List<bbe::List<int32_t>> nested;
+	for (int32_t i = 0; i < 100; i++)
+	{
+		nested.add(bbe::List<int32_t>(i, i));
+	}
+	for (int32_t i = 0; i < 100; i++)
+	{
+		ASSERT_EQ(nested[i].getLength(), i);
+		if (i > 0) ASSERT_EQ(nested[i].last(), i);
+	}
+}
+
+TEST(List, RelocatingRemove)
+{
+	bbe::List<bbe::List<int32_t>> list;
+	for (int32_t i = 0; i < 20; i++)
+	{
+		list.add(bbe::List<int32_t>(i + 1, i));
+	}
+
+	list.removeIndex(0);
+	list.removeIndex(18);
+	list.removeIndex(5);
+	ASSERT_EQ(list.getLength(), 17);
+	ASSERT_EQ(list[0][0], 1);
+	ASSERT_EQ(list[4][0], 5);
+	ASSERT_EQ(list[5][0], 7);
+	ASSERT_EQ(list[16][0], 18);
+
+	list.removeRange(2, 3); // Removes 3, 4, 5
+	ASSERT_EQ(list.getLength(), 14);
+	ASSERT_EQ(list[1][0], 2);
+	ASSERT_EQ(list[2][0], 7);
+	ASSERT_EQ(list[13][0], 18);
+
+	const size_t removed = list.removeAll([](const bbe::List<int32_t>& l) { return l[0] % 3 == 0; });
+	ASSERT_EQ(removed, 4); // 6 is already gone, removes 9, 12, 15, 18
+	ASSERT_EQ(list.getLength(), 10);
+	const int32_t expected[] = { 1, 2, 7, 8, 10, 11, 13, 14, 16, 17 };
+	for (size_t i = 0; i < list.getLength(); i++)
+	{
+		ASSERT_EQ(list[i][0], expected[i]);
+		ASSERT_EQ(list[i].getLength(), expected[i] + 1);
+	}
+
+	ASSERT_EQ(list.removeAll([](const bbe::List<int32_t>&) { return true; }), 10);
+	ASSERT_TRUE(list.isEmpty());
+}
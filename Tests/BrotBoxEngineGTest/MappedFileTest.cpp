@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+TEST(MappedFile, ReadsWholeFile)
+{
+	const bbe::String path = "MappedFileTest.dat";
+	bbe::ByteBuffer buffer;
+	for (int32_t i = 0; i < 10000; i++)
+	{
+		buffer.write(i);
+	}
+	const char* text = "Hello";
+	buffer.writeNullString(text);
+	bbe::simpleFile::writeBinaryToFile(path, buffer);
+
+	bbe::MappedFile file(path);
+	ASSERT_TRUE(file.isOpen());
+	ASSERT_EQ(file.getLength(), buffer.getLength());
+	ASSERT_EQ(memcmp(file.getRaw(), buffer.getRaw(), buffer.getLength()), 0);
+
+	bbe::ByteBufferSpan span = file.getSpan();
+	ASSERT_TRUE(span.valid());
+	for (int32_t i = 0; i < 10000; i++)
+	{
+		ASSERT_EQ(span.readI32(), i);
+	}
+	bbe::ByteBufferSpan rest = span.readSpan(span.getLength());
+	ASSERT_EQ(rest.getRaw(), file.getRaw() + 40000);
+	ASSERT_STREQ(rest.readNullString(), "Hello");
+	ASSERT_FALSE(rest.hasMore());
+
+	bbe::MappedFile moved = std::move(file);
+	ASSERT_FALSE(file.isOpen());
+	ASSERT_TRUE(moved.isOpen());
+	ASSERT_EQ(moved.getSpan().readI32(), 0);
+	moved.close();
+	ASSERT_FALSE(moved.isOpen());
+	ASSERT_EQ(moved.getLength(), 0);
+
+	bbe::simpleFile::deleteFile(path);
+}
+
+TEST(MappedFile, EmptyAndMissingFiles)
+{
+	const bbe::String path = "MappedFileEmptyTest.dat";
+	bbe::simpleFile::writeBinaryToFile(path, bbe::ByteBuffer());
+	{
+		bbe::MappedFile file(path, bbe::MappedFile::AccessPattern::RANDOM);
+		ASSERT_TRUE(file.isOpen());
+		ASSERT_EQ(file.getLength(), 0);
+		ASSERT_FALSE(file.getSpan().hasMore());
+	}
+	bbe::simpleFile::deleteFile(path);
+
+	ASSERT_THROW(bbe::MappedFile("MappedFileDoesNotExist.dat"), std::runtime_error);
+}
@@ -0,0 +1,211 @@
+#include "gtest/gtest.h"
+#include "BBE/Profiler.h"
+#include "BBE/JobSystem.h"
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+	// The profiler is global, so every test starts with a clean and enabled one and leaves it disabled.
+	struct ProfilerScope
+	{
+		ProfilerScope()
+		{
+			bbe::profiler::clear();
+			bbe::profiler::setEnabled(true);
+		}
+		~ProfilerScope()
+		{
+			bbe::profiler::setEnabled(false);
+			bbe::profiler::clear();
+		}
+	};
+
+	bbe::List<bbe::profiler::ZoneRecord> zonesNamed(const char* name)
+	{
+		bbe::List<bbe::profiler::ZoneRecord> zones = bbe::profiler::collectZones();
+		zones.removeAll([name](const bbe::profiler::ZoneRecord& zone) { return strcmp(zone.name, name) != 0; });
+		return zones;
+	}
+}
+
+TEST(Profiler, NestedZones)
+{
+	ProfilerScope scope;
+	{
+		BBE_PROFILE_ZONE("Outer");
+		{
+			BBE_PROFILE_ZONE("Inner");
+			BBE_PROFILE_ZONE("Innermost");
+		}
+		BBE_PROFILE_ZONE("Inner2");
+	}
+
+	const bbe::List<bbe::profiler::ZoneRecord> zones = bbe::profiler::collectZones();
+	ASSERT_EQ(zones.getLength(), 4);
+	ASSERT_STREQ(zones[0].name, "Outer");
+	ASSERT_STREQ(zones[1].name, "Inner");
+	ASSERT_STREQ(zones[2].name, "Innermost");
+	ASSERT_STREQ(zones[3].name, "Inner2");
+	ASSERT_EQ(zones[0].depth, 0);
+	ASSERT_EQ(zones[1].depth, 1);
+	ASSERT_EQ(zones[2].depth, 2);
+	ASSERT_EQ(zones[3].depth, 1);
+	for (size_t i = 1; i < zones.getLength(); i++)
+	{
+		ASSERT_GE(zones[i].startNanos, zones[0].startNanos);
+		ASSERT_LE(zones[i].startNanos + zones[i].durationNanos, zones[0].startNanos + zones[0].durationNanos);
+	}
+}
+
+TEST(Profiler, DisabledRecordsNothing)
+{
+	ProfilerScope scope;
+	bbe::profiler::setEnabled(false);
+	{
+		BBE_PROFILE_ZONE("Nothing");
+		bbe::profiler::recordZone("Nothing", 0, 10);
+		// Turning it on while a zone is open must not end that zone.
+		bbe::profiler::setEnabled(true);
+	}
+	ASSERT_EQ(zonesNamed("Nothing").getLength(), 0);
+
+	bbe::profiler::setEnabled(false);
+	ASSERT_TRUE(bbe::profiler::beginZone("Forced", true));
+	bbe::profiler::endZone();
+	bbe::profiler::recordZone("Forced", 5, 15, true);
+	const bbe::List<bbe::profiler::ZoneRecord> forced = zonesNamed("Forced");
+	ASSERT_EQ(forced.getLength(), 2);
+	ASSERT_EQ(forced[0].startNanos, 5);
+	ASSERT_EQ(forced[0].durationNanos, 10);
+}
+
+TEST(Profiler, NamingAThreadTakesNoBuffer)
+{
+	ProfilerScope scope;
+	bbe::profiler::setEnabled(false);
+	std::thread thread([]() {
+		bbe::profiler::setThreadName("Idle Profiler Test Thread");
+		BBE_PROFILE_ZONE("Nothing");
+		});
+	thread.join();
+	ASSERT_EQ(bbe::profiler::toChromeTrace().search("Idle Profiler Test Thread"), -1);
+}
+
+TEST(Profiler, RingBufferIsBounded)
+{
+	ProfilerScope scope;
+	const size_t amount = bbe::profiler::INTERNAL::ZONES_PER_THREAD + 1000;
+	for (size_t i = 0; i < amount; i++)
+	{
+		bbe::profiler::recordZone("Ring", (int64_t)i, (int64_t)i + 1);
+	}
+	const bbe::List<bbe::profiler::ZoneRecord> zones = zonesNamed("Ring");
+	ASSERT_EQ(zones.getLength(), bbe::profiler::INTERNAL::ZONES_PER_THREAD - 1);
+	ASSERT_EQ(zones[0].startNanos, 1001);
+	ASSERT_EQ(zones.last().startNanos, (int64_t)amount - 1);
+
+	bbe::profiler::clear();
+	ASSERT_EQ(zonesNamed("Ring").getLength(), 0);
+}
+
+TEST(Profiler, CollectWhileTheRingIsOverwritten)
+{
+	ProfilerScope scope;
+	std::atomic_bool done = false;
+	std::thread writer([&]() {
+		// Wraps around the ring many times. Every zone is consistent in itself, so a torn copy is easy to spot.
+		for (int64_t i = 0; i < (int64_t)bbe::profiler::INTERNAL::ZONES_PER_THREAD * 400; i++)
+		{
+			bbe::profiler::recordZone(i % 2 == 0 ? "Even" : "Odd", i, i * 2);
+		}
+		done = true;
+		});
+	size_t amountOfTornZones = 0;
+	while (!done)
+	{
+		const bbe::List<bbe::profiler::ZoneRecord> zones = bbe::profiler::collectZones();
+		for (size_t k = 0; k < zones.getLength(); k++)
+		{
+			const bbe::profiler::ZoneRecord& zone = zones[k];
+			if (strcmp(zone.name, "Even") != 0 && strcmp(zone.name, "Odd") != 0) continue;
+			const char* expectedName = zone.startNanos % 2 == 0 ? "Even" : "Odd";
+			if (zone.durationNanos != zone.startNanos || strcmp(zone.name, expectedName) != 0) amountOfTornZones++;
+		}
+	}
+	writer.join();
+	ASSERT_EQ(amountOfTornZones, 0);
+}
+
+TEST(Profiler, MultipleThreads)
+{
+	ProfilerScope scope;
+	std::thread threads[4];
+	for (size_t i = 0; i < 4; i++)
+	{
+		threads[i] = std::thread([]() {
+			bbe::profiler::setThreadName("Profiler Test Thread");
+			for (int32_t k = 0; k < 1000; k++)
+			{
+				BBE_PROFILE_ZONE("Thread Zone");
+			}
+			});
+	}
+	// Collecting while the threads are recording must only ever return complete zones.
+	for (int32_t i = 0; i < 10; i++)
+	{
+		const bbe::List<bbe::profiler::ZoneRecord> zones = zonesNamed("Thread Zone");
+		for (size_t k = 0; k < zones.getLength(); k++)
+		{
+			ASSERT_GE(zones[k].durationNanos, 0);
+		}
+	}
+	for (size_t i = 0; i < 4; i++)
+	{
+		threads[i].join();
+	}
+
+	const bbe::List<bbe::profiler::ZoneRecord> zones = zonesNamed("Thread Zone");
+	ASSERT_EQ(zones.getLength(), 4000);
+	for (size_t i = 1; i < zones.getLength(); i++)
+	{
+		ASSERT_LE(zones[i - 1].startNanos, zones[i].startNanos);
+	}
+	ASSERT_NE(bbe::profiler::toChromeTrace().search("Profiler Test Thread"), -1);
+}
+
+TEST(Profiler, JobsAreRecorded)
+{
+	ProfilerScope scope;
+	bbe::List<bbe::JobHandle> handles;
+	for (int32_t i = 0; i < 16; i++)
+	{
+		handles.add(bbe::jobs::schedule([]() { BBE_PROFILE_ZONE("Job Body"); }));
+	}
+	bbe::jobs::waitAll(handles);
+
+	const bbe::List<bbe::profiler::ZoneRecord> bodies = zonesNamed("Job Body");
+	ASSERT_EQ(bodies.getLength(), 16);
+	for (size_t i = 0; i < bodies.getLength(); i++)
+	{
+		// Every body is nested in the zone that the job system opens around each job.
+		ASSERT_EQ(bodies[i].depth, 1);
+	}
+	ASSERT_EQ(zonesNamed("Job").getLength(), 16);
+}
+
+TEST(Profiler, ChromeTrace)
+{
+	ProfilerScope scope;
+	bbe::profiler::setThreadName("Main \"Thread\"");
+	bbe::profiler::recordZone("Trace Zone", 2000, 3500);
+
+	const bbe::String trace = bbe::profiler::toChromeTrace();
+	ASSERT_TRUE(trace.startsWith("{"));
+	ASSERT_TRUE(trace.endsWith("]}"));
+	ASSERT_NE(trace.search("\"traceEvents\":["), -1);
+	ASSERT_NE(trace.search("{\"name\":\"Trace Zone\",\"ph\":\"X\""), -1);
+	ASSERT_NE(trace.search("\"ts\":2.000,\"dur\":1.500}"), -1);
+	ASSERT_NE(trace.search("\"args\":{\"name\":\"Main \\\"Thread\\\"\"}"), -1);
+}
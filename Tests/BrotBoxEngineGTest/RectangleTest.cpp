@@ -0,0 +1,146 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+static void assertNoOverlap(const bbe::List<bbe::Rectanglei>& rects, const bbe::List<uint32_t>* pages = nullptr)
+{
+	for (size_t i = 0; i < rects.getLength(); i++)
+	{
+		for (size_t k = i + 1; k < rects.getLength(); k++)
+		{
+			if (pages != nullptr && (*pages)[i] != (*pages)[k]) continue;
+			const bbe::Rectanglei& a = rects[i];
+			const bbe::Rectanglei& b = rects[k];
+			const bool overlap = a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+			ASSERT_FALSE(overlap);
+		}
+	}
+}
+
+static bbe::List<bbe::Rectanglei> randomRects(size_t amount, int32_t maxSize)
+{
+	bbe::Random rand;
+	rand.setSeed(42);
+	bbe::List<bbe::Rectanglei> rects;
+	for (size_t i = 0; i < amount; i++)
+	{
+		rects.add(bbe::Rectanglei(0, 0, rand.randomInt(maxSize) + 1, rand.randomInt(maxSize) + 1));
+	}
+	return rects;
+}
+
+TEST(Rectangle, PackSinglePage)
+{
+	bbe::List<bbe::Rectanglei> rects = randomRects(300, 64);
+	const bbe::List<bbe::Rectanglei> original = rects;
+
+	const bbe::Vector2i dim = bbe::Rectanglei::pack(rects);
+	assertNoOverlap(rects);
+	int64_t area = 0;
+	for (size_t i = 0; i < rects.getLength(); i++)
+	{
+		ASSERT_EQ(rects[i].width, original[i].width);
+		ASSERT_EQ(rects[i].height, original[i].height);
+		ASSERT_GE(rects[i].x, 0);
+		ASSERT_GE(rects[i].y, 0);
+		ASSERT_LE(rects[i].getRight(), dim.x);
+		ASSERT_LE(rects[i].getBottom(), dim.y);
+		area += rects[i].width * rects[i].height;
+	}
+	ASSERT_GT((double)area / ((double)dim.x * dim.y), 0.75);
+
+	bbe::List<bbe::Rectanglei> empty;
+	ASSERT_EQ(bbe::Rectanglei::pack(empty), bbe::Vector2i(0, 0));
+}
+
+TEST(Rectangle, PackPagesPowerOfTwo)
+{
+	bbe::List<bbe::Rectanglei> rects = randomRects(500, 40);
+
+	bbe::Rectanglei::PackSettings settings;
+	settings.maxPageSize = bbe::Vector2i(200, 200);
+	settings.powerOfTwo = true;
+	const bbe::Rectanglei::PackResult result = bbe::Rectanglei::pack(rects, settings);
+
+	ASSERT_GT(result.pageSizes.getLength(), 1);
+	for (const bbe::Vector2i& pageSize : result.pageSizes)
+	{
+		ASSERT_LE(pageSize.x, 128);
+		ASSERT_LE(pageSize.y, 128);
+		ASSERT_EQ(pageSize.x & (pageSize.x - 1), 0);
+		ASSERT_EQ(pageSize.y & (pageSize.y - 1), 0);
+	}
+	assertNoOverlap(rects, &result.pages);
+	int64_t area = 0;
+	for (size_t i = 0; i < rects.getLength(); i++)
+	{
+		const bbe::Vector2i& pageSize = result.pageSizes[result.pages[i]];
+		ASSERT_LE(rects[i].getRight(), pageSize.x);
+		ASSERT_LE(rects[i].getBottom(), pageSize.y);
+		ASSERT_FALSE(result.rotated[i]);
+		area += rects[i].width * rects[i].height;
+	}
+	int64_t pagesArea = 0;
+	for (const bbe::Vector2i& pageSize : result.pageSizes)
+	{
+		pagesArea += pageSize.x * pageSize.y;
+	}
+	ASSERT_FLOAT_EQ(result.fillRatio, (float)((double)area / (double)pagesArea));
+	ASSERT_GT(result.fillRatio, 0.6f);
+}
+
+TEST(Rectangle, PackRotated)
+{
+	bbe::List<bbe::Rectanglei> rects;
+	rects.add(bbe::Rectanglei(0, 0, 100, 10));
+	rects.add(bbe::Rectanglei(0, 0, 10, 100));
+
+	bbe::Rectanglei::PackSettings settings;
+	settings.maxPageSize = bbe::Vector2i(20, 200);
+	settings.allowRotation = true;
+	const bbe::Rectanglei::PackResult result = bbe::Rectanglei::pack(rects, settings);
+
+	ASSERT_EQ(result.pageSizes.getLength(), 1);
+	ASSERT_EQ(result.pageSizes[0], bbe::Vector2i(20, 100));
+	ASSERT_TRUE(result.rotated[0]);
+	ASSERT_FALSE(result.rotated[1]);
+	ASSERT_EQ(rects[0].width, 10);
+	ASSERT_EQ(rects[0].height, 100);
+	ASSERT_FLOAT_EQ(result.fillRatio, 1.0f);
+	assertNoOverlap(rects);
+}
+
+TEST(Rectangle, PackFloats)
+{
+	bbe::List<bbe::Rectangle> rects;
+	for (int32_t i = 0; i < 20; i++)
+	{
+		rects.add(bbe::Rectangle(0, 0, 1.5f + i * 0.25f, 2.5f));
+	}
+	const bbe::Vector2 dim = bbe::Rectangle::pack(rects);
+	for (size_t i = 0; i < rects.getLength(); i++)
+	{
+		ASSERT_LE(rects[i].getRight(), dim.x);
+		ASSERT_LE(rects[i].getBottom(), dim.y);
+		for (size_t k = i + 1; k < rects.getLength(); k++)
+		{
+			const bbe::Rectangle& a = rects[i];
+			const bbe::Rectangle& b = rects[k];
+			ASSERT_FALSE(a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height);
+		}
+	}
+}
+
+TEST(Rectangle, MaxRectsPacker)
+{
+	bbe::MaxRectsPackeri packer(bbe::Vector2i(10, 10));
+	bbe::Vector2i pos;
+	ASSERT_TRUE(packer.insert(bbe::Vector2i(10, 5), pos));
+	ASSERT_EQ(pos, bbe::Vector2i(0, 0));
+	ASSERT_TRUE(packer.insert(bbe::Vector2i(5, 5), pos));
+	ASSERT_EQ(pos, bbe::Vector2i(0, 5));
+	ASSERT_TRUE(packer.insert(bbe::Vector2i(5, 5), pos));
+	ASSERT_EQ(pos, bbe::Vector2i(5, 5));
+	ASSERT_FALSE(packer.insert(bbe::Vector2i(1, 1), pos));
+	ASSERT_FLOAT_EQ(packer.getFillRatio(), 1.0f);
+	ASSERT_EQ(packer.getUsedDimensions(), bbe::Vector2i(10, 10));
+}
@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+static bbe::RectangleRotated randomRectangleRotated(bbe::Random& rand)
+{
+	return bbe::RectangleRotated(rand.randomFloat() * 100, rand.randomFloat() * 100, rand.randomFloat() * 40 + 1, rand.randomFloat() * 40 + 1, rand.randomFloat() * 7);
+}
+
+TEST(SeparatingAxis, RectangleRotatedMatchesShape)
+{
+	bbe::Random rand;
+	rand.setSeed(1);
+	size_t hits = 0;
+	for (int32_t i = 0; i < 2000; i++)
+	{
+		const bbe::RectangleRotated a = randomRectangleRotated(rand);
+		const bbe::RectangleRotated b = randomRectangleRotated(rand);
+		const bool expected = a.Shape2<bbe::Vector2>::intersects(b);
+		ASSERT_EQ(bbe::sat::intersects(a, b), expected);
+		ASSERT_EQ(a.intersects(b), expected);
+		if (expected) hits++;
+
+		const bbe::Rectangle rect(rand.randomFloat() * 100, rand.randomFloat() * 100, rand.randomFloat() * 40 + 1, rand.randomFloat() * 40 + 1);
+		ASSERT_EQ(a.intersects(rect), a.Shape2<bbe::Vector2>::intersects(rect));
+	}
+	// Make sure both outcomes were actually tested.
+	ASSERT_GT(hits, 100);
+	ASSERT_LT(hits, 1900);
+}
+
+TEST(SeparatingAxis, ResolveIntersection)
+{
+	bbe::Random rand;
+	rand.setSeed(2);
+	for (int32_t i = 0; i < 500; i++)
+	{
+		bbe::RectangleRotated fast = randomRectangleRotated(rand);
+		bbe::RectangleRotated slow = fast;
+		const bbe::RectangleRotated other = randomRectangleRotated(rand);
+
+		const bool resolved = fast.resolveIntersection(other);
+		ASSERT_EQ(resolved, slow.Shape2<bbe::Vector2>::resolveIntersection(other));
+		ASSERT_NEAR(fast.getX(), slow.getX(), 0.01f);
+		ASSERT_NEAR(fast.getY(), slow.getY(), 0.01f);
+	}
+}
+
+TEST(SeparatingAxis, CubeMatchesShape)
+{
+	bbe::Random rand;
+	rand.setSeed(3);
+	size_t hits = 0;
+	for (int32_t i = 0; i < 1000; i++)
+	{
+		const bbe::Cube a(rand.randomVector3() * 5, rand.randomVector3() * 3 + bbe::Vector3(0.5f), rand.randomVector3().normalize(), rand.randomFloat() * 7);
+		const bbe::Cube b(rand.randomVector3() * 5, rand.randomVector3() * 3 + bbe::Vector3(0.5f), rand.randomVector3().normalize(), rand.randomFloat() * 7);
+		const bool expected = a.Shape3::intersects(b);
+		ASSERT_EQ(a.intersects(b), expected);
+		if (expected) hits++;
+	}
+	ASSERT_GT(hits, 50);
+	ASSERT_LT(hits, 950);
+
+	// Axis aligned cubes have parallel edges everywhere.
+	ASSERT_TRUE(bbe::Cube(bbe::Vector3(0, 0, 0)).intersects(bbe::Cube(bbe::Vector3(0.9f, 0, 0))));
+	ASSERT_FALSE(bbe::Cube(bbe::Vector3(0, 0, 0)).intersects(bbe::Cube(bbe::Vector3(1.1f, 0, 0))));
+}
+
+TEST(SeparatingAxis, Batch)
+{
+	bbe::Random rand;
+	rand.setSeed(4);
+	const bbe::RectangleRotated shape(40, 40, 30, 20, 0.5f);
+	bbe::List<bbe::RectangleRotated> others;
+	for (int32_t i = 0; i < 300; i++)
+	{
+		others.add(randomRectangleRotated(rand));
+	}
+	bbe::List<bool> results;
+	results.resizeCapacityAndLength(others.getLength());
+	const size_t hits = bbe::sat::intersects(shape, others.getRaw(), others.getLength(), results.getRaw());
+
+	size_t expectedHits = 0;
+	for (size_t i = 0; i < others.getLength(); i++)
+	{
+		ASSERT_EQ(results[i], shape.intersects(others[i]));
+		if (results[i]) expectedHits++;
+	}
+	ASSERT_EQ(hits, expectedHits);
+}
@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+namespace
+{
+	struct JournalEntry
+	{
+		BBE_SERIALIZABLE_DATA(
+			((bbe::String), name),
+			((int32_t), value)
+		)
+	};
+
+	JournalEntry makeEntry(const char* name, int32_t value)
+	{
+		JournalEntry entry;
+		entry.name = name;
+		entry.value = value;
+		return entry;
+	}
+
+	size_t fileLength(const bbe::String& path)
+	{
+		bbe::simpleFile::backup::async::stopIoThread();
+		return bbe::simpleFile::readBinaryFile(path).getLength();
+	}
+}
+
+TEST(SerializableList, JournalReplay)
+{
+	const bbe::String path = "SerializableListJournalTest.dat";
+	bbe::simpleFile::deleteFile(path);
+	{
+		bbe::SerializableList<JournalEntry> list(path);
+		list.add(makeEntry("a", 1));
+		list.add(makeEntry("b", 2));
+		list.add(makeEntry("c", 3));
+		list.add(makeEntry("d", 4));
+		list.removeIndex(1);
+		list.swap(0, 2);
+		list[1].value = 30;
+		list.writeToFile();
+	}
+	// Writes are asynchronous, reopening has to wait for them.
+	bbe::simpleFile::backup::async::stopIoThread();
+	{
+		bbe::SerializableList<JournalEntry> list(path);
+		ASSERT_EQ(list.getLength(), 3);
+		ASSERT_EQ(list[0].name, "d");
+		ASSERT_EQ(list[1].name, "c");
+		ASSERT_EQ(list[1].value, 30);
+		ASSERT_EQ(list[2].name, "a");
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	bbe::simpleFile::deleteFile(path);
+}
+
+TEST(SerializableList, JournalTornTail)
+{
+	const bbe::String path = "SerializableListTornTest.dat";
+	bbe::simpleFile::deleteFile(path);
+	{
+		bbe::SerializableList<JournalEntry> list(path);
+		list.add(makeEntry("a", 1));
+		list.add(makeEntry("b", 2));
+	}
+	const size_t validLength = fileLength(path);
+	{
+		bbe::SerializableList<JournalEntry> list(path);
+		list.add(makeEntry("c", 3));
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	// Cutting the last record in half is what a crash in the middle of a write leaves behind.
+	bbe::ByteBuffer binary = bbe::simpleFile::readBinaryFile(path);
+	bbe::ByteBuffer torn;
+	for (size_t i = 0; i < validLength + 10; i++)
+	{
+		uint8_t b = binary.getRaw()[i];
+		torn.write(b);
+	}
+	bbe::simpleFile::writeBinaryToFile(path, torn);
+	{
+		bbe::SerializableList<JournalEntry> list(path);
+		ASSERT_EQ(list.getLength(), 2);
+		ASSERT_EQ(list[1].name, "b");
+		list.add(makeEntry("d", 4));
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	{
+		bbe::SerializableList<JournalEntry> list(path);
+		ASSERT_EQ(list.getLength(), 3);
+		ASSERT_EQ(list[2].name, "d");
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	bbe::simpleFile::deleteFile(path);
+}
+
+TEST(SerializableList, JournalCompaction)
+{
+	const bbe::String path = "SerializableListCompactionTest.dat";
+	bbe::simpleFile::deleteFile(path);
+	{
+		bbe::SerializableList<JournalEntry> list(path);
+		list.add(makeEntry("counter", 0));
+		const size_t compactedLength = fileLength(path);
+		for (int32_t i = 1; i <= 2000; i++)
+		{
+			list[0].value = i;
+			list.writeToFile();
+			// Each update is a single record appended to the file.
+			if (i == 1) ASSERT_LT(fileLength(path) - compactedLength, 64);
+		}
+		ASSERT_LT(fileLength(path), 20 * 1024);
+	}
+	{
+		bbe::SerializableList<JournalEntry> list(path);
+		ASSERT_EQ(list.getLength(), 1);
+		ASSERT_EQ(list[0].value, 2000);
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	bbe::simpleFile::deleteFile(path);
+}
+
+TEST(SerializableList, LegacyFileIsConverted)
+{
+	const bbe::String path = "SerializableListLegacyTest.dat";
+	bbe::ByteBuffer legacy;
+	for (int32_t i = 0; i < 3; i++)
+	{
+		JournalEntry entry = makeEntry("legacy", i);
+		bbe::ByteBuffer element;
+		element.write(entry);
+		int64_t size = element.getLength();
+		legacy.write(size);
+		for (size_t k = 0; k < element.getLength(); k++)
+		{
+			uint8_t b = element.getRaw()[k];
+			legacy.write(b);
+		}
+	}
+	bbe::simpleFile::writeBinaryToFile(path, legacy);
+	{
+		bbe::SerializableList<JournalEntry> list(path);
+		ASSERT_EQ(list.getLength(), 3);
+		ASSERT_EQ(list[2].value, 2);
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	ASSERT_TRUE(bbe::INTERNAL::journal::hasHeader(bbe::MappedFile(path).getSpan()));
+	{
+		bbe::SerializableList<JournalEntry> list(path);
+		ASSERT_EQ(list.getLength(), 3);
+		ASSERT_EQ(list[0].name, "legacy");
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	bbe::simpleFile::deleteFile(path);
+}
@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+namespace
+{
+	bbe::ByteBuffer makeBuffer(uint8_t value, size_t length)
+	{
+		bbe::ByteBuffer buffer;
+		for (size_t i = 0; i < length; i++)
+		{
+			buffer.write(value);
+		}
+		return buffer;
+	}
+}
+
+TEST(SimpleFile, AsyncWritesAndAppends)
+{
+	const bbe::String path = "SimpleFileAsyncTest.dat";
+	const uint64_t bytesBefore = bbe::simpleFile::backup::async::getBytesWritten();
+
+	for (uint8_t i = 0; i < 10; i++)
+	{
+		bbe::simpleFile::backup::async::writeBinaryToFile(path, makeBuffer(i, 100));
+	}
+	for (uint8_t i = 0; i < 10; i++)
+	{
+		bbe::simpleFile::backup::async::appendBinaryToFile(path, makeBuffer(100 + i, 10));
+	}
+	std::future<void> barrier = bbe::simpleFile::backup::async::barrier();
+	barrier.wait();
+	ASSERT_EQ(bbe::simpleFile::backup::async::getQueueDepth(), 0);
+	ASSERT_FALSE(bbe::simpleFile::backup::async::hasOpenIO());
+
+	bbe::ByteBuffer contents = bbe::simpleFile::readBinaryFile(path);
+	ASSERT_EQ(contents.getLength(), 200);
+	for (size_t i = 0; i < 100; i++)
+	{
+		ASSERT_EQ(contents.getRaw()[i], 9);
+	}
+	for (size_t i = 0; i < 100; i++)
+	{
+		ASSERT_EQ(contents.getRaw()[100 + i], 100 + i / 10);
+	}
+	ASSERT_FALSE(bbe::simpleFile::doesFileExist(path + ".tmp"));
+
+	// Superseded writes may have been skipped, but the final file was written at least once.
+	const uint64_t written = bbe::simpleFile::backup::async::getBytesWritten() - bytesBefore;
+	ASSERT_GE(written, 200);
+	ASSERT_LE(written, 10 * 100 + 10 * 10);
+
+	// Flushing also works when nothing is queued.
+	bbe::simpleFile::backup::async::flush();
+	bbe::simpleFile::backup::async::stopIoThread();
+	bbe::simpleFile::deleteFile(path);
+}
+
+TEST(SimpleFile, AsyncWritesDontPassCreateDirectory)
+{
+	const bbe::String directory = "SimpleFileAsyncTestDir";
+	const bbe::String path = "SimpleFileAsyncTestOrder.dat";
+	const bbe::String pathInDirectory = directory + "/file.dat";
+
+	// A write that is queued after a createDirectory may go into that directory, so it must not be merged into a job
+	// that runs before it.
+	bbe::simpleFile::backup::async::flush();
+	const uint64_t coalescedBefore = bbe::simpleFile::backup::async::getAmountOfCoalescedJobs();
+	bbe::simpleFile::backup::async::writeBinaryToFile(path, makeBuffer(1, 10));
+	bbe::simpleFile::backup::async::createDirectory(directory);
+	bbe::simpleFile::backup::async::writeBinaryToFile(path, makeBuffer(2, 10));
+	bbe::simpleFile::backup::async::writeBinaryToFile(pathInDirectory, makeBuffer(3, 10));
+	bbe::simpleFile::backup::async::flush();
+	ASSERT_EQ(bbe::simpleFile::backup::async::getAmountOfCoalescedJobs(), coalescedBefore);
+
+	ASSERT_EQ(bbe::simpleFile::readBinaryFile(path).getRaw()[0], 2);
+	ASSERT_EQ(bbe::simpleFile::readBinaryFile(pathInDirectory).getRaw()[0], 3);
+
+	bbe::simpleFile::backup::async::stopIoThread();
+	bbe::simpleFile::deleteFile(path);
+	bbe::simpleFile::deleteFile(pathInDirectory);
+	bbe::simpleFile::deleteFile(directory);
+}
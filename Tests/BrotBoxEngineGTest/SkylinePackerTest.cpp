@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+static bool overlaps(const bbe::Vector2i& posA, const bbe::Vector2i& dimA, const bbe::Vector2i& posB, const bbe::Vector2i& dimB)
+{
+	return posA.x < posB.x + dimB.x && posB.x < posA.x + dimA.x
+		&& posA.y < posB.y + dimB.y && posB.y < posA.y + dimA.y;
+}
+
+TEST(SkylinePacker, FillsRowsBottomLeft)
+{
+	bbe::SkylinePacker packer(100, 100);
+	bbe::Vector2i pos;
+	ASSERT_TRUE(packer.insert(50, 10, pos));
+	ASSERT_EQ(pos, bbe::Vector2i(0, 0));
+	ASSERT_TRUE(packer.insert(50, 20, pos));
+	ASSERT_EQ(pos, bbe::Vector2i(50, 0));
+	ASSERT_TRUE(packer.insert(50, 10, pos));
+	ASSERT_EQ(pos, bbe::Vector2i(0, 10));
+	ASSERT_FLOAT_EQ(packer.getFillRatio(), 0.2f);
+
+	ASSERT_FALSE(packer.insert(101, 1, pos));
+	ASSERT_FALSE(packer.insert(10, 81, pos));
+	ASSERT_EQ(pos, bbe::Vector2i(0, 10));
+
+	packer.reset(100, 100);
+	ASSERT_EQ(packer.getFillRatio(), 0);
+	ASSERT_TRUE(packer.insert(100, 100, pos));
+	ASSERT_EQ(pos, bbe::Vector2i(0, 0));
+	ASSERT_FALSE(packer.insert(1, 1, pos));
+	ASSERT_FLOAT_EQ(packer.getFillRatio(), 1.0f);
+}
+
+TEST(SkylinePacker, NeverOverlaps)
+{
+	bbe::Random rand;
+	rand.setSeed(17);
+	bbe::SkylinePacker packer(256, 256);
+	bbe::List<bbe::Vector2i> positions;
+	bbe::List<bbe::Vector2i> dimensions;
+	for (int32_t i = 0; i < 1000; i++)
+	{
+		const bbe::Vector2i dim((int32_t)rand.randomInt(20) + 1, (int32_t)rand.randomInt(20) + 1);
+		bbe::Vector2i pos;
+		if (!packer.insert(dim.x, dim.y, pos)) continue;
+		ASSERT_GE(pos.x, 0);
+		ASSERT_GE(pos.y, 0);
+		ASSERT_LE(pos.x + dim.x, 256);
+		ASSERT_LE(pos.y + dim.y, 256);
+		for (size_t k = 0; k < positions.getLength(); k++)
+		{
+			ASSERT_FALSE(overlaps(pos, dim, positions[k], dimensions[k]));
+		}
+		positions.add(pos);
+		dimensions.add(dim);
+	}
+	ASSERT_GT(packer.getFillRatio(), 0.7f);
+}
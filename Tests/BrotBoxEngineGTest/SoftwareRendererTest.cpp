@@ -0,0 +1,208 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+#ifdef BBE_RENDERER_NULL
+#include "BBE/SoftwareRenderer/SoftwareRasterizer.h"
+#include "BBE/SoftwareRenderer/SoftwareRendererManager.h"
+
+using bbe::INTERNAL::softwareRenderer::Rasterizer;
+using bbe::INTERNAL::softwareRenderer::RasterVertex;
+
+namespace
+{
+	RasterVertex vertex(float x, float y, const bbe::Color& color)
+	{
+		RasterVertex retVal;
+		retVal.x = x;
+		retVal.y = y;
+		retVal.color = color;
+		return retVal;
+	}
+
+	void addRect(Rasterizer& rasterizer, float x, float y, float width, float height, const bbe::Color& color)
+	{
+		rasterizer.addTriangle2D(vertex(x, y, color), vertex(x + width, y, color), vertex(x, y + height, color), nullptr);
+		rasterizer.addTriangle2D(vertex(x + width, y + height, color), vertex(x + width, y, color), vertex(x, y + height, color), nullptr);
+	}
+
+	bool isColor(uint32_t pixel, const bbe::Color& color)
+	{
+		return pixel == Rasterizer::packColor(color);
+	}
+}
+
+TEST(SoftwareRasterizer, RectCoverage)
+{
+	Rasterizer rasterizer;
+	rasterizer.resize(100, 70);
+	rasterizer.clear(bbe::Color(0, 0, 0, 1));
+	addRect(rasterizer, 10, 20, 30, 40, bbe::Color(1, 0, 0, 1));
+	rasterizer.flush();
+
+	for (int32_t y = 0; y < 70; y++)
+	{
+		for (int32_t x = 0; x < 100; x++)
+		{
+			const bool inside = x >= 10 && x < 40 && y >= 20 && y < 60;
+			ASSERT_TRUE(isColor(rasterizer.getPixel(x, y), inside ? bbe::Color(1, 0, 0, 1) : bbe::Color(0, 0, 0, 1))) << x << " " << y;
+		}
+	}
+}
+
+TEST(SoftwareRasterizer, SharedEdgesAreDrawnOnce)
+{
+	// A fan of triangles around the center of the screen. With a translucent color, any pixel that was drawn twice
+	// would end up brighter than the rest.
+	Rasterizer rasterizer;
+	rasterizer.resize(64, 64);
+	rasterizer.clear(bbe::Color(0, 0, 0, 1));
+	const bbe::Color color(1, 1, 1, 0.4f);
+	const bbe::Vector2 outline[] = { {3.3f, 2.1f}, {60.7f, 4.9f}, {61.2f, 59.5f}, {31.1f, 62.2f}, {1.9f, 40.4f} };
+	const RasterVertex center = vertex(33.37f, 29.81f, color);
+	for (int i = 0; i < 5; i++)
+	{
+		const bbe::Vector2& a = outline[i];
+		const bbe::Vector2& b = outline[(i + 1) % 5];
+		rasterizer.addTriangle2D(center, vertex(a.x, a.y, color), vertex(b.x, b.y, color), nullptr);
+	}
+	rasterizer.flush();
+
+	const uint32_t once = Rasterizer::packColor(bbe::Color(0.4f, 0.4f, 0.4f, 1));
+	const uint32_t background = Rasterizer::packColor(bbe::Color(0, 0, 0, 1));
+	size_t amountOfDrawnPixels = 0;
+	for (int32_t y = 0; y < 64; y++)
+	{
+		for (int32_t x = 0; x < 64; x++)
+		{
+			const uint32_t pixel = rasterizer.getPixel(x, y);
+			ASSERT_TRUE(pixel == once || pixel == background) << x << " " << y;
+			if (pixel == once) amountOfDrawnPixels++;
+		}
+	}
+	ASSERT_GT(amountOfDrawnPixels, 2500);
+}
+
+TEST(SoftwareRasterizer, Ellipse)
+{
+	Rasterizer rasterizer;
+	rasterizer.resize(64, 64);
+	rasterizer.clear(bbe::Color(0, 0, 0, 1));
+	rasterizer.addEllipse2D(bbe::Vector2(8, 16), bbe::Vector2(48, 32), bbe::Color(0, 1, 0, 1));
+	rasterizer.flush();
+
+	ASSERT_TRUE(isColor(rasterizer.getPixel(32, 32), bbe::Color(0, 1, 0, 1)));
+	ASSERT_TRUE(isColor(rasterizer.getPixel(9, 32), bbe::Color(0, 1, 0, 1)));
+	ASSERT_TRUE(isColor(rasterizer.getPixel(32, 17), bbe::Color(0, 1, 0, 1)));
+	ASSERT_TRUE(isColor(rasterizer.getPixel(9, 17), bbe::Color(0, 0, 0, 1)));
+	ASSERT_TRUE(isColor(rasterizer.getPixel(54, 46), bbe::Color(0, 0, 0, 1)));
+	ASSERT_TRUE(isColor(rasterizer.getPixel(7, 32), bbe::Color(0, 0, 0, 1)));
+}
+
+TEST(SoftwareRasterizer, DepthTest)
+{
+	for (int order = 0; order < 2; order++)
+	{
+		Rasterizer rasterizer;
+		rasterizer.resize(32, 32);
+		rasterizer.clear(bbe::Color(0, 0, 0, 1));
+		const bbe::Color near(1, 0, 0, 1);
+		const bbe::Color far(0, 0, 1, 1);
+		for (int i = 0; i < 2; i++)
+		{
+			const bool drawNear = (i == order);
+			const float z = drawNear ? -0.5f : 0.5f;
+			const bbe::Color& color = drawNear ? near : far;
+			rasterizer.addTriangle3D(bbe::Vector4(-1, -1, z, 1), bbe::Vector4(1, -1, z, 1), bbe::Vector4(-1, 1, z, 1), color, color, color);
+			rasterizer.addTriangle3D(bbe::Vector4(1, 1, z, 1), bbe::Vector4(1, -1, z, 1), bbe::Vector4(-1, 1, z, 1), color, color, color);
+		}
+		rasterizer.flush();
+
+		for (int32_t y = 0; y < 32; y++)
+		{
+			for (int32_t x = 0; x < 32; x++)
+			{
+				ASSERT_TRUE(isColor(rasterizer.getPixel(x, y), near)) << x << " " << y;
+				ASSERT_NEAR(rasterizer.getDepth(x, y), 0.25f, 0.0001f);
+			}
+		}
+	}
+}
+
+TEST(SoftwareRasterizer, NearPlaneClipping)
+{
+	Rasterizer rasterizer;
+	rasterizer.resize(32, 32);
+	rasterizer.clear(bbe::Color(0, 0, 0, 1));
+	const bbe::Color color(1, 1, 0, 1);
+	// The third vertex is in front of the near plane, so the triangle is cut into a quad that ends at ndc y = 0.625.
+	rasterizer.addTriangle3D(bbe::Vector4(-0.5f, -0.5f, 0, 1), bbe::Vector4(0.5f, -0.5f, 0, 1), bbe::Vector4(0, 2, -2, 0.5f), color, color, color);
+	ASSERT_EQ(rasterizer.getAmountOfQueuedTriangles(), 2);
+	rasterizer.flush();
+
+	ASSERT_TRUE(isColor(rasterizer.getPixel(16, 9), color));
+	ASSERT_TRUE(isColor(rasterizer.getPixel(16, 25), color));
+	ASSERT_TRUE(isColor(rasterizer.getPixel(16, 30), bbe::Color(0, 0, 0, 1)));
+}
+
+TEST(SoftwareRasterizer, ParallelMatchesSerial)
+{
+	Rasterizer serial;
+	Rasterizer parallel;
+	serial.resize(333, 222);
+	parallel.resize(333, 222);
+	serial.clear(bbe::Color(0.1f, 0.2f, 0.3f, 1));
+	parallel.clear(bbe::Color(0.1f, 0.2f, 0.3f, 1));
+
+	bbe::Random rand;
+	for (int i = 0; i < 500; i++)
+	{
+		RasterVertex v[3];
+		for (int k = 0; k < 3; k++)
+		{
+			v[k] = vertex(rand.randomFloat(430) - 50, rand.randomFloat(320) - 50, bbe::Color(rand.randomFloat(), rand.randomFloat(), rand.randomFloat(), rand.randomFloat()));
+		}
+		serial.addTriangle2D(v[0], v[1], v[2], nullptr);
+		parallel.addTriangle2D(v[0], v[1], v[2], nullptr);
+	}
+	serial.flush(false);
+	parallel.flush(true);
+
+	ASSERT_EQ(serial.getAmountOfTrianglesDrawn(), parallel.getAmountOfTrianglesDrawn());
+	for (int32_t y = 0; y < 222; y++)
+	{
+		for (int32_t x = 0; x < 333; x++)
+		{
+			ASSERT_EQ(serial.getPixel(x, y), parallel.getPixel(x, y)) << x << " " << y;
+		}
+	}
+}
+
+TEST(SoftwareRendererManager, Frame)
+{
+	bbe::INTERNAL::softwareRenderer::SoftwareRendererManager manager;
+	manager.init("Test", 0, 0, 0, nullptr, 64, 48);
+
+	manager.preDraw();
+	manager.preDraw3D();
+	bbe::PrimitiveBrush3D& brush3D = manager.getBrush3D();
+	brush3D.setCamera(bbe::Vector3(-3, 0, 0), bbe::Vector3(0, 0, 0));
+	brush3D.setColor(0, 1, 0);
+	brush3D.fillCube(bbe::Cube(bbe::Vector3(0, 0, 0)));
+	manager.preDraw2D();
+	bbe::PrimitiveBrush2D& brush2D = manager.getBrush2D();
+	brush2D.setColorRGB(1, 0, 0);
+	brush2D.fillRect(0, 0, 8, 8);
+	manager.postDraw();
+	manager.waitEndDraw();
+
+	const bbe::Image framebuffer = manager.getFramebuffer();
+	ASSERT_EQ(framebuffer.getWidth(), 64);
+	ASSERT_EQ(framebuffer.getHeight(), 48);
+	ASSERT_EQ(framebuffer.getPixel(32, 24), bbe::Colori(0, 255, 0, 255));
+	ASSERT_EQ(framebuffer.getPixel(4, 4), bbe::Colori(255, 0, 0, 255));
+	ASSERT_EQ(framebuffer.getPixel(60, 4), bbe::Colori(0, 0, 0, 255));
+
+	manager.destroy();
+}
+
+#endif
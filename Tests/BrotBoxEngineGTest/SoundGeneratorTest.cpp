@@ -0,0 +1,190 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+#include "BBE/DspGraph.h"
+#include "BBE/SoundGenerator.h"
+#include <cmath>
+
+namespace
+{
+	// Long enough to span several chunks, with a ragged last one.
+	constexpr size_t testLength = bbe::dsp::CHUNK_SIZE * 5 + 123;
+
+	bbe::List<double> makeNoise(size_t length)
+	{
+		bbe::List<double> retVal;
+		uint32_t state = 12345;
+		for (size_t i = 0; i < length; i++)
+		{
+			state = state * 1664525u + 1013904223u;
+			retVal.add((double)(state >> 8) / (double)(1u << 24) * 2.0 - 1.0);
+		}
+		return retVal;
+	}
+}
+
+TEST(DspGraph, AddSine)
+{
+	bbe::List<double> signal;
+	signal.resizeCapacityAndLength(testLength);
+	const double phaseStep = 0.0123;
+	for (size_t begin = 0; begin < testLength; begin += bbe::dsp::CHUNK_SIZE)
+	{
+		bbe::dsp::addSine(signal.getRaw(), begin, bbe::Math::min(begin + bbe::dsp::CHUNK_SIZE, testLength), 0.5, phaseStep, 0.75);
+	}
+	for (size_t i = 0; i < testLength; i++)
+	{
+		ASSERT_NEAR(signal[i], std::sin(0.5 + (double)i * phaseStep) * 0.75, 1e-9);
+	}
+}
+
+TEST(DspGraph, LowPass)
+{
+	const bbe::List<double> input = makeNoise(testLength);
+	const double alpha = 0.05;
+
+	bbe::List<double> expected = input;
+	for (size_t i = 1; i < expected.getLength(); i++)
+	{
+		expected[i] = expected[i - 1] + alpha * (expected[i] - expected[i - 1]);
+	}
+
+	for (int parallel = 0; parallel < 2; parallel++)
+	{
+		bbe::List<double> actual = input;
+		bbe::dsp::lowPass(actual, alpha, parallel == 1);
+		for (size_t i = 0; i < testLength; i++)
+		{
+			ASSERT_NEAR(actual[i], expected[i], 1e-9);
+		}
+	}
+}
+
+TEST(DspGraph, FeedbackDelay)
+{
+	const bbe::List<double> input = makeNoise(testLength);
+	const size_t delay = bbe::dsp::CHUNK_SIZE + 17;
+
+	bbe::List<double> expected = input;
+	for (size_t i = delay; i < expected.getLength(); i++)
+	{
+		expected[i] += expected[i - delay] * 0.5;
+	}
+
+	for (int parallel = 0; parallel < 2; parallel++)
+	{
+		bbe::List<double> actual = input;
+		bbe::dsp::feedbackDelay(actual, delay, 0.5, parallel == 1);
+		for (size_t i = 0; i < testLength; i++)
+		{
+			ASSERT_DOUBLE_EQ(actual[i], expected[i]);
+		}
+	}
+}
+
+TEST(DspGraph, FusesPointwiseStages)
+{
+	bbe::dsp::Graph<double> graph;
+	graph.addPointwise([](double* signal, size_t begin, size_t end) { for (size_t i = begin; i < end; i++) signal[i] += 1.0; });
+	graph.addPointwise([](double* signal, size_t begin, size_t end) { for (size_t i = begin; i < end; i++) signal[i] *= (double)i; });
+	graph.addWholeSignal([](bbe::List<double>& signal, bool parallel) { bbe::dsp::normalize(signal, parallel); });
+	graph.addPointwise([](double* signal, size_t begin, size_t end) { for (size_t i = begin; i < end; i++) signal[i] -= 1.0; });
+	ASSERT_EQ(graph.getAmountOfStages(), 4);
+	ASSERT_EQ(graph.getAmountOfPasses(), 3);
+
+	bbe::List<double> signal;
+	signal.resizeCapacityAndLength(testLength);
+	graph.render(signal, true);
+	for (size_t i = 0; i < testLength; i++)
+	{
+		ASSERT_NEAR(signal[i], (double)i / (double)(testLength - 1) - 1.0, 1e-12);
+	}
+}
+
+#ifndef BBE_NO_AUDIO
+
+TEST(SoundGenerator, MatchesReference)
+{
+	bbe::SoundGenerator gen(500.0);
+	gen.addRecipeSineWave(0.25, 0.5, 440.0);
+	gen.addRecipeSquareWave(0.0, 0.1);
+	gen.addRecipeADSR();
+	gen.addRecipeRingModulation();
+	gen.addRecipeLowPassFilter(0.0, 1.0, 2000.0);
+	gen.addRecipeEcho(0.0, 1.0, 0.1, 0.5);
+	gen.addRecipeNormalization();
+
+	// The recipes as plain loops over the whole signal, one after another.
+	const size_t length = (size_t)gen.getAmountOfSamples();
+	const double hz = (double)bbe::SoundGenerator::hz;
+	const double twoPi = (double)bbe::Math::PI * 2;
+	bbe::List<double> expected;
+	expected.resizeCapacityAndLength(length);
+	for (size_t i = 0; i < length; i++)
+	{
+		expected[i] += std::sin(0.25 + (double)i / hz * 440.0 * twoPi) * 0.5;
+		expected[i] += (std::fmod((double)i / hz, 0.02) < 0.01 ? 1.0 : -1.0) * 0.1;
+	}
+	const size_t attack = (size_t)(0.1 * hz);
+	const size_t decay = (size_t)(0.1 * hz);
+	const size_t release = (size_t)(0.2 * hz);
+	for (size_t i = 0; i < length; i++)
+	{
+		if (i < attack) expected[i] *= (double)i / attack;
+		else if (i < attack + decay) expected[i] *= 1.0 - 0.3 * ((double)(i - attack) / decay);
+		else if (i >= length - release) expected[i] *= 1.0 - (double)(i - (length - release)) / release;
+		else expected[i] *= 0.7;
+	}
+	for (size_t i = 0; i < length; i++)
+	{
+		expected[i] *= 1.0 + 0.5 * std::sin((double)i / hz * 30.0 * twoPi);
+	}
+	const double rc = 1.0 / (2000.0 * twoPi);
+	const double alpha = (1.0 / hz) / (rc + 1.0 / hz);
+	for (size_t i = 1; i < length; i++)
+	{
+		expected[i] = expected[i - 1] + alpha * (expected[i] - expected[i - 1]);
+	}
+	const size_t echoDelay = (size_t)(0.1 * hz);
+	for (size_t i = echoDelay; i < length; i++)
+	{
+		expected[i] += expected[i - echoDelay] * 0.5;
+	}
+	double maxAmplitude = 0;
+	for (size_t i = 0; i < length; i++)
+	{
+		maxAmplitude = bbe::Math::max(maxAmplitude, std::fabs(expected[i]));
+	}
+	for (size_t i = 0; i < length; i++)
+	{
+		expected[i] /= maxAmplitude;
+	}
+
+	const bbe::List<float> serial = gen.render(bbe::SoundGenerator::Precision::DOUBLE, false);
+	const bbe::List<float> parallel = gen.render(bbe::SoundGenerator::Precision::DOUBLE, true);
+	const bbe::List<float> single = gen.render(bbe::SoundGenerator::Precision::FLOAT, true);
+	ASSERT_EQ(serial.getLength(), length);
+	ASSERT_EQ(parallel.getLength(), length);
+	ASSERT_EQ(single.getLength(), length);
+	for (size_t i = 0; i < length; i++)
+	{
+		ASSERT_NEAR(serial[i], expected[i], 1e-5);
+		ASSERT_FLOAT_EQ(parallel[i], serial[i]);
+		ASSERT_NEAR(single[i], expected[i], 1e-3);
+	}
+}
+
+TEST(SoundGenerator, Chorus)
+{
+	bbe::SoundGenerator gen(300.0);
+	gen.addRecipeSawtoothWave();
+	gen.addRecipeChorusEffect(0.0, 0.5, 0.2, 0.003, 1.5);
+	const bbe::List<float> serial = gen.render(bbe::SoundGenerator::Precision::DOUBLE, false);
+	const bbe::List<float> parallel = gen.render(bbe::SoundGenerator::Precision::DOUBLE, true);
+	ASSERT_EQ(serial.getLength(), parallel.getLength());
+	for (size_t i = 0; i < serial.getLength(); i++)
+	{
+		ASSERT_FLOAT_EQ(parallel[i], serial[i]);
+	}
+}
+
+#endif
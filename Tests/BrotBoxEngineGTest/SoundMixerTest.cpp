@@ -0,0 +1,183 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+#include "BBE/SoundMixer.h"
+
+#ifndef BBE_NO_AUDIO
+
+namespace
+{
+	// Sample i of channel c is i + c * 1000, so every sample tells where it came from.
+	class CountingSource : public bbe::SoundDataSourceDynamic
+	{
+	public:
+		uint32_t channels = 1;
+
+		virtual float getSample(size_t i, uint32_t channel) const override
+		{
+			return (float)i + (float)channel * 1000.f;
+		}
+
+		virtual uint32_t getAmountOfChannels() const override
+		{
+			return channels;
+		}
+
+		virtual uint32_t getHz() const override
+		{
+			return 44100;
+		}
+	};
+}
+
+TEST(SoundMixer, AddRampedMatchesScalar)
+{
+	for (uint32_t channels = 1; channels <= 2; channels++)
+	{
+		constexpr size_t frames = 37;
+		bbe::List<float> in;
+		bbe::List<float> out;
+		for (size_t i = 0; i < frames * channels; i++)
+		{
+			in.add((float)i * 0.25f - 3.f);
+		}
+		for (size_t i = 0; i < frames * 2; i++)
+		{
+			out.add((float)i);
+		}
+
+		bbe::INTERNAL::mixer::addRamped(out.getRaw(), in.getRaw(), channels, frames, 1.f, 0.5f, -1.f, 2.f);
+
+		for (size_t i = 0; i < frames; i++)
+		{
+			const float t = (float)i / (float)frames;
+			const float left = 1.f + (-1.f - 1.f) * t;
+			const float right = 0.5f + (2.f - 0.5f) * t;
+			const float inLeft = in[i * channels];
+			const float inRight = in[i * channels + channels - 1];
+			ASSERT_NEAR(out[2 * i],     (float)(2 * i)     + inLeft * left,   1e-4f);
+			ASSERT_NEAR(out[2 * i + 1], (float)(2 * i + 1) + inRight * right, 1e-4f);
+		}
+	}
+}
+
+TEST(SoundMixer, MixesAndStops)
+{
+	CountingSource mono;
+	CountingSource stereo;
+	stereo.channels = 2;
+
+	bbe::INTERNAL::SoundMixer mixer;
+	mixer.add(1, mono, 1.f, nullptr);
+	mixer.add(2, stereo, 0.5f, nullptr);
+	ASSERT_EQ(mixer.getAmountOfVoices(), 2);
+
+	bbe::INTERNAL::NullAudioOutput output(mixer, 16);
+	output.pull();
+	output.pull();
+	ASSERT_EQ(output.getFramesPlayed(), 32);
+
+	// The second block continues where the first one stopped.
+	const float* block = output.getLastBlock();
+	for (size_t i = 0; i < 16; i++)
+	{
+		const float frame = (float)(16 + i);
+		ASSERT_FLOAT_EQ(block[2 * i],     frame + 0.5f * frame);
+		ASSERT_FLOAT_EQ(block[2 * i + 1], frame + 0.5f * (frame + 1000.f));
+	}
+
+	mixer.stop(2);
+	ASSERT_TRUE(mixer.isPlaying(2));
+	output.pull();
+	// Fades out over the block instead of cutting off.
+	ASSERT_FLOAT_EQ(block[1], 32.f + 0.5f * 1032.f);
+	ASSERT_LT(block[31] - 47.f, 0.5f * 1047.f * 0.1f);
+	ASSERT_FALSE(mixer.isPlaying(2));
+	ASSERT_TRUE(mixer.isPlaying(1));
+
+	output.pull();
+	ASSERT_FLOAT_EQ(block[1], 48.f);
+
+	mixer.clear();
+	output.pull();
+	ASSERT_EQ(block[0], 0.f);
+	ASSERT_EQ(mixer.getAmountOfVoices(), 0);
+}
+
+TEST(SoundMixer, Positional)
+{
+	CountingSource mono;
+	bbe::INTERNAL::SoundMixer mixer;
+	mixer.setListener(bbe::Vector3(0, 0, 0), bbe::Vector3(0, 1, 0));
+	const bbe::Vector3 pos(0, 10, 0);
+	mixer.add(1, mono, 1.f, &pos);
+	bbe::INTERNAL::NullAudioOutput output(mixer, 8);
+	output.pull();
+	output.pull();
+	// Straight ahead, so far away that the distance dominates.
+	const float* block = output.getLastBlock();
+	ASSERT_GT(block[2], 0.f);
+	ASSERT_LT(block[2], 10.f / 100.f * 1.01f);
+}
+
+namespace
+{
+	// Produces the same samples as CountingSource, but fills whole blocks at once.
+	class BlockCountingSource : public CountingSource
+	{
+	public:
+		virtual void fillSamples(bbe::Span<float> out, size_t firstFrame, size_t frames, uint32_t channels) const override
+		{
+			float* raw = out.getRaw();
+			for (uint32_t channel = 0; channel < channels; channel++)
+			{
+				for (size_t i = 0; i < frames; i++)
+				{
+					raw[i * channels + channel] = (float)(firstFrame + i) + (float)channel * 1000.f;
+				}
+			}
+		}
+	};
+
+	template<typename Source>
+	bbe::List<float> mixVoices(size_t amountOfVoices, size_t blocks)
+	{
+		bbe::List<Source> sources;
+		sources.resizeCapacityAndLength(amountOfVoices);
+		bbe::INTERNAL::SoundMixer mixer;
+		mixer.setListener(bbe::Vector3(0, 0, 0), bbe::Vector3(0, 1, 0));
+		bbe::List<bbe::Vector3> positions;
+		for (size_t i = 0; i < amountOfVoices; i++)
+		{
+			positions.add(bbe::Vector3((float)i, 1.f, 0.f));
+		}
+		for (size_t i = 0; i < amountOfVoices; i++)
+		{
+			sources[i].channels = (uint32_t)(i % 2 + 1);
+			// Every fourth voice is positional, which only works for mono sources.
+			mixer.add(i + 1, sources[i], 0.5f, i % 4 == 0 ? &positions[i] : nullptr);
+		}
+
+		bbe::INTERNAL::NullAudioOutput output(mixer, 64);
+		bbe::List<float> retVal;
+		for (size_t i = 0; i < blocks; i++)
+		{
+			output.pull();
+			retVal.addArray(output.getLastBlock(), 64 * 2);
+		}
+		return retVal;
+	}
+}
+
+TEST(SoundMixer, BlockSourcesMixLikeSampleSources)
+{
+	const bbe::List<float> perSample = mixVoices<CountingSource>(6, 4);
+	const bbe::List<float> block = mixVoices<BlockCountingSource>(6, 4);
+	ASSERT_EQ(perSample.getLength(), block.getLength());
+	for (size_t i = 0; i < perSample.getLength(); i++)
+	{
+		ASSERT_EQ(perSample[i], block[i]) << i;
+	}
+	ASSERT_GT(perSample.last(), 0.f);
+}
+
+#endif
@@ -0,0 +1,201 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+#include "BBE/SpatialHashPerformanceTime.h"
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+	bbe::List<bbe::Vector2> randomPoints2D(size_t amount, float worldSize, uint32_t seed)
+	{
+		bbe::Random rand;
+		rand.setSeed(seed);
+		bbe::List<bbe::Vector2> retVal;
+		for (size_t i = 0; i < amount; i++)
+		{
+			// Negative coordinates make sure floor is used for the cells instead of truncation.
+			retVal.add(bbe::Vector2(rand.randomFloat() * worldSize - worldSize / 2, rand.randomFloat() * worldSize - worldSize / 2));
+		}
+		return retVal;
+	}
+
+	bbe::List<uint32_t> sorted(bbe::List<uint32_t> list)
+	{
+		std::sort(list.begin(), list.end());
+		return list;
+	}
+}
+
+TEST(SpatialHash, RadiusMatchesBruteForce)
+{
+	const bbe::List<bbe::Vector2> points = randomPoints2D(2000, 200, 17);
+	bbe::SpatialHash2D hash(7.5f);
+	hash.rebuild(points);
+	ASSERT_EQ(hash.getLength(), 2000);
+
+	const float radii[] = { 0.f, 3.f, 7.5f, 20.f, 1000.f };
+	for (float radius : radii)
+	{
+		for (size_t i = 0; i < 50; i++)
+		{
+			const bbe::Vector2 center = points[i * 7] + bbe::Vector2(1.3f, -0.7f);
+			bbe::List<uint32_t> expected;
+			for (size_t k = 0; k < points.getLength(); k++)
+			{
+				if ((points[k] - center).getLengthSq() <= radius * radius) expected.add((uint32_t)k);
+			}
+			bbe::List<uint32_t> actual;
+			hash.queryRadius(center, radius, actual);
+			ASSERT_EQ(sorted(actual), expected);
+		}
+	}
+}
+
+TEST(SpatialHash, BoxMatchesBruteForce)
+{
+	const bbe::List<bbe::Vector2> points = randomPoints2D(1000, 100, 3);
+	bbe::SpatialHash2D hash(4);
+	hash.rebuild(points);
+
+	const bbe::Vector2 min(-12.5f, -30);
+	const bbe::Vector2 max(20, 4);
+	bbe::List<uint32_t> expected;
+	for (size_t k = 0; k < points.getLength(); k++)
+	{
+		if (points[k].x >= min.x && points[k].x <= max.x && points[k].y >= min.y && points[k].y <= max.y) expected.add((uint32_t)k);
+	}
+	bbe::List<uint32_t> actual;
+	hash.queryBox(min, max, actual);
+	ASSERT_FALSE(expected.isEmpty());
+	ASSERT_EQ(sorted(actual), expected);
+
+	actual.clear();
+	hash.queryBox(max, min, actual);
+	ASSERT_TRUE(actual.isEmpty());
+}
+
+TEST(SpatialHash, KNearest)
+{
+	const bbe::List<bbe::Vector2> points = randomPoints2D(500, 300, 5);
+	bbe::SpatialHash2D hash(2);
+	hash.rebuild(points);
+
+	const bbe::Vector2 centers[] = { { 0, 0 }, { 149, -149 }, { 5000, 5000 } };
+	for (const bbe::Vector2& center : centers)
+	{
+		bbe::List<uint32_t> expected;
+		for (size_t k = 0; k < points.getLength(); k++) expected.add((uint32_t)k);
+		std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b)
+			{
+				return (points[a] - center).getLengthSq() < (points[b] - center).getLengthSq();
+			});
+
+		bbe::List<uint32_t> actual;
+		hash.queryKNearest(center, 10, actual);
+		ASSERT_EQ(actual.getLength(), 10);
+		for (size_t i = 0; i < 10; i++)
+		{
+			ASSERT_EQ(actual[i], expected[i]);
+		}
+	}
+
+	bbe::List<uint32_t> all;
+	hash.queryKNearest({ 0, 0 }, 100000, all);
+	ASSERT_EQ(all.getLength(), 500);
+
+	bbe::SpatialHash2D empty;
+	hash.queryKNearest({ 0, 0 }, 0, all);
+	empty.queryKNearest({ 0, 0 }, 3, all);
+	ASSERT_EQ(all.getLength(), 500);
+}
+
+TEST(SpatialHash, PairsMatchBruteForce)
+{
+	const bbe::List<bbe::Vector2> points = randomPoints2D(3000, 150, 11);
+	const float radius = 2.5f;
+	bbe::SpatialHash2D hash(radius);
+	hash.rebuild(points);
+
+	uint64_t expectedAmount = 0;
+	uint64_t expectedChecksum = 0;
+	for (size_t a = 0; a < points.getLength(); a++)
+	{
+		for (size_t b = a + 1; b < points.getLength(); b++)
+		{
+			if ((points[a] - points[b]).getLengthSq() <= radius * radius)
+			{
+				expectedAmount++;
+				expectedChecksum += a * 3001 + b;
+			}
+		}
+	}
+	ASSERT_GT(expectedAmount, 0);
+
+	uint64_t amount = 0;
+	uint64_t checksum = 0;
+	hash.forEachPair(radius, [&](uint32_t a, uint32_t b)
+		{
+			ASSERT_LT(a, b);
+			amount++;
+			checksum += a * 3001ull + b;
+		});
+	ASSERT_EQ(amount, expectedAmount);
+	ASSERT_EQ(checksum, expectedChecksum);
+
+	std::atomic<uint64_t> parallelAmount = 0;
+	std::atomic<uint64_t> parallelChecksum = 0;
+	hash.forEachPairParallel(radius, [&](uint32_t a, uint32_t b)
+		{
+			parallelAmount++;
+			parallelChecksum += a * 3001ull + b;
+		}, 64);
+	ASSERT_EQ(parallelAmount.load(), expectedAmount);
+	ASSERT_EQ(parallelChecksum.load(), expectedChecksum);
+}
+
+TEST(SpatialHash, ThreeDimensionsAndRebuild)
+{
+	bbe::Random rand;
+	rand.setSeed(99);
+	bbe::List<bbe::Vector3> points;
+	for (size_t i = 0; i < 1000; i++)
+	{
+		points.add(rand.randomVector3() * 40.f - bbe::Vector3(20, 20, 20));
+	}
+	bbe::SpatialHash3D hash(3);
+	hash.rebuild(points);
+
+	const bbe::Vector3 center(1, -2, 3);
+	bbe::List<uint32_t> expected;
+	for (size_t k = 0; k < points.getLength(); k++)
+	{
+		if ((points[k] - center).getLengthSq() <= 6 * 6) expected.add((uint32_t)k);
+	}
+	bbe::List<uint32_t> actual;
+	hash.queryRadius(center, 6, actual);
+	ASSERT_FALSE(expected.isEmpty());
+	ASSERT_EQ(sorted(actual), expected);
+
+	// Rebuilding with fewer points must not leave stale entries behind.
+	hash.rebuild(points.getRaw(), 10);
+	actual.clear();
+	hash.queryRadius(center, 1000, actual);
+	ASSERT_EQ(sorted(actual).getLength(), 10);
+	ASSERT_EQ(sorted(actual).last(), 9);
+
+	hash.rebuild(points.getRaw(), 0);
+	actual.clear();
+	hash.queryRadius(center, 1000, actual);
+	ASSERT_TRUE(actual.isEmpty());
+}
+
+TEST(SpatialHash, Benchmark)
+{
+	const bbe::List<bbe::test::SpatialHashBenchmarkResult> results = bbe::test::spatialHashPrintSpeed({ 1000, 4000 }, 200, 1);
+	ASSERT_EQ(results.getLength(), 2);
+	for (size_t i = 0; i < results.getLength(); i++)
+	{
+		ASSERT_EQ(results[i].hashHits, results[i].bruteHits);
+		ASSERT_GT(results[i].hashHits, 0);
+	}
+}
@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+TEST(StreamRing, WrapsAround)
+{
+	bbe::StreamRing ring(256);
+	ASSERT_EQ(ring.getBufferSize(), 256 * bbe::StreamRing::amountOfSegments);
+	for (size_t frame = 1; frame <= 3 * bbe::StreamRing::amountOfSegments; frame++)
+	{
+		const size_t segment = ring.beginFrame();
+		ASSERT_EQ(segment, frame % bbe::StreamRing::amountOfSegments);
+		ASSERT_EQ(ring.getSegment(), segment);
+
+		// Everything a frame streams stays within its own segment.
+		for (size_t i = 0; i < 8; i++)
+		{
+			ASSERT_TRUE(ring.fits(17));
+			const size_t position = ring.allocate(17);
+			ASSERT_EQ(position % bbe::StreamRing::alignment, 0);
+			ASSERT_GE(position, segment * 256);
+			ASSERT_LE(position + 17, (segment + 1) * 256);
+		}
+		ASSERT_FALSE(ring.fits(17));
+		ASSERT_EQ(ring.getAmountOfStreamedBytes(), 8 * 17);
+	}
+}
+
+TEST(StreamRing, ReusesSegmentsPerFrame)
+{
+	bbe::StreamRing ring(1024);
+	bbe::List<size_t> firstPositions;
+	for (size_t frame = 0; frame < 2 * bbe::StreamRing::amountOfSegments; frame++)
+	{
+		ring.beginFrame();
+		firstPositions.add(ring.allocate(100));
+		ASSERT_EQ(ring.allocate(4), firstPositions.last() + 112);
+		ASSERT_EQ(ring.getAmountOfStreamedBytes(), 104);
+	}
+	for (size_t i = 0; i < bbe::StreamRing::amountOfSegments; i++)
+	{
+		// A frame starts at the front of its segment, no matter how much the frame before streamed.
+		ASSERT_EQ(firstPositions[i] % 1024, 0);
+		ASSERT_EQ(firstPositions[i], firstPositions[i + bbe::StreamRing::amountOfSegments]);
+		for (size_t k = 0; k < i; k++)
+		{
+			ASSERT_NE(firstPositions[i], firstPositions[k]);
+		}
+	}
+}
+
+TEST(StreamRing, Grows)
+{
+	bbe::StreamRing ring(64);
+	ring.beginFrame();
+	ring.allocate(40);
+	ASSERT_FALSE(ring.fits(40));
+	ASSERT_EQ(ring.getGrownSegmentSize(40), 128);
+	ASSERT_EQ(ring.getGrownSegmentSize(1000), 1024);
+
+	ring.resize(ring.getGrownSegmentSize(1000));
+	ASSERT_EQ(ring.getSegmentSize(), 1024);
+	ASSERT_EQ(ring.getSegment(), 0);
+	ASSERT_TRUE(ring.fits(1000));
+	ASSERT_EQ(ring.allocate(1000), 0);
+	ASSERT_EQ(ring.getAmountOfStreamedBytes(), 1040);
+}
@@ -0,0 +1,346 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+TEST(UndoableList, EditsAndSteps)
+{
+	bbe::UndoableList<bbe::String> list;
+	ASSERT_FALSE(list.isUndoable());
+	ASSERT_FALSE(list.isRedoable());
+
+	list.add("a");
+	list.submit();
+	list.add("b");
+	list.add("c");
+	list.submit();
+	list.swap(0, 2);
+	list.submit();
+	list.replace(1, "B");
+	list.submit();
+	list.removeIndex(0);
+	list.submit();
+	// Submitting without any edit doesn't create an empty step.
+	list.submit();
+	ASSERT_EQ(list.get(), bbe::List<bbe::String>({ "B", "a" }));
+
+	list.undo();
+	ASSERT_EQ(list.get(), bbe::List<bbe::String>({ "c", "B", "a" }));
+	list.undo();
+	ASSERT_EQ(list.get(), bbe::List<bbe::String>({ "c", "b", "a" }));
+	list.undo();
+	ASSERT_EQ(list.get(), bbe::List<bbe::String>({ "a", "b", "c" }));
+	list.undo();
+	ASSERT_EQ(list.get(), bbe::List<bbe::String>({ "a" }));
+	list.undo();
+	ASSERT_TRUE(list.get().isEmpty());
+	ASSERT_FALSE(list.isUndoable());
+
+	list.redo();
+	list.redo();
+	list.redo();
+	ASSERT_EQ(list.get(), bbe::List<bbe::String>({ "c", "b", "a" }));
+
+	// A new edit drops everything that could have been redone.
+	list.add("d");
+	list.submit();
+	ASSERT_FALSE(list.isRedoable());
+	ASSERT_EQ(list.get(), bbe::List<bbe::String>({ "c", "b", "a", "d" }));
+	list.undo();
+	list.undo();
+	ASSERT_EQ(list.get(), bbe::List<bbe::String>({ "a", "b", "c" }));
+	list.redo();
+	list.redo();
+	ASSERT_FALSE(list.isRedoable());
+	ASSERT_EQ(list.get(), bbe::List<bbe::String>({ "c", "b", "a", "d" }));
+
+	ASSERT_FALSE(list.removeIndex(100));
+	ASSERT_FALSE(list.swap(0, 100));
+	ASSERT_FALSE(list.replace(100, "x"));
+}
+
+TEST(UndoableList, RecordedEdits)
+{
+	bbe::UndoableList<int32_t> list(bbe::List<int32_t>({ 1, 2, 3 }));
+
+	list.get()[1] = 20;
+	list.recordReplaced(1, 2);
+	list.get()[2] = 30;
+	list.recordReplaced(2, 3);
+	list.submit();
+
+	bbe::List<int32_t> previous = list.get();
+	list.get().clear();
+	list.get().add(7);
+	list.recordSnapshot(previous);
+	list.submit();
+
+	list.undo();
+	ASSERT_EQ(list.get(), bbe::List<int32_t>({ 1, 20, 30 }));
+	list.undo();
+	ASSERT_EQ(list.get(), bbe::List<int32_t>({ 1, 2, 3 }));
+	list.redo();
+	list.redo();
+	ASSERT_EQ(list.get(), bbe::List<int32_t>({ 7 }));
+
+	// Undo closes a step that is still open.
+	list.add(8);
+	list.undo();
+	ASSERT_EQ(list.get(), bbe::List<int32_t>({ 7 }));
+}
+
+TEST(UndoableList, MaxHistoryDepth)
+{
+	bbe::UndoableList<int32_t> list;
+	list.setMaxHistoryDepth(10);
+	for (int32_t i = 0; i < 1000; i++)
+	{
+		list.add(i);
+		list.submit();
+	}
+	ASSERT_EQ(list.get().getLength(), 1000);
+
+	size_t amountOfUndos = 0;
+	while (list.isUndoable())
+	{
+		list.undo();
+		amountOfUndos++;
+	}
+	ASSERT_EQ(amountOfUndos, 10);
+	ASSERT_EQ(list.get().getLength(), 990);
+	ASSERT_EQ(list.get().last(), 989);
+
+	// Undone steps survive a lower limit until they are redone.
+	list.setMaxHistoryDepth(3);
+	size_t amountOfRedos = 0;
+	while (list.isRedoable())
+	{
+		list.redo();
+		amountOfRedos++;
+	}
+	ASSERT_EQ(amountOfRedos, 10);
+	ASSERT_EQ(list.get().getLength(), 1000);
+
+	list.add(1000);
+	list.submit();
+	amountOfUndos = 0;
+	while (list.isUndoable())
+	{
+		list.undo();
+		amountOfUndos++;
+	}
+	ASSERT_EQ(amountOfUndos, 3);
+}
+
+TEST(UndoableObject, MaxHistoryDepth)
+{
+	bbe::UndoableObject<int32_t> obj(0);
+	obj.setMaxHistoryDepth(2);
+	for (int32_t i = 1; i <= 5; i++)
+	{
+		obj.get() = i;
+		obj.submit();
+	}
+	obj.undo();
+	obj.undo();
+	ASSERT_EQ(obj.get(), 3);
+	ASSERT_FALSE(obj.isUndoable());
+	obj.redo();
+	ASSERT_EQ(obj.get(), 4);
+}
+
+namespace
+{
+	struct UndoableEntry
+	{
+		BBE_SERIALIZABLE_DATA(
+			((bbe::String), name),
+			((int32_t), value)
+		)
+	};
+}
+
+TEST(SerializableList, UndoRecordsOnlyTheChange)
+{
+	const bbe::String path = "SerializableListUndoTest.dat";
+	bbe::simpleFile::deleteFile(path);
+	{
+		bbe::SerializableList<UndoableEntry> list(path, "", bbe::Undoable::YES);
+		ASSERT_FALSE(list.canUndo());
+
+		UndoableEntry entry;
+		entry.name = "first";
+		entry.value = 1;
+		list.add(entry);
+		entry.name = "second";
+		entry.value = 2;
+		list.add(entry);
+		entry.name = "third";
+		entry.value = 3;
+		list.add(entry);
+
+		// Changes through operator[] are found by comparing with what was written.
+		list[1].value = 20;
+		list[2].name = "THIRD";
+		list.writeToFile();
+		// Writing again without changes doesn't add a step.
+		list.writeToFile();
+
+		list.swap(0, 2);
+		list.removeIndex(1);
+		ASSERT_EQ(list.getLength(), 2);
+		ASSERT_EQ(list[0].name, "THIRD");
+		ASSERT_EQ(list[1].name, "first");
+
+		list.undo();
+		ASSERT_EQ(list.getLength(), 3);
+		ASSERT_EQ(list[1].name, "second");
+		list.undo();
+		ASSERT_EQ(list[0].name, "first");
+		ASSERT_EQ(list[2].name, "THIRD");
+		list.undo();
+		ASSERT_EQ(list[1].value, 2);
+		ASSERT_EQ(list[2].name, "third");
+		list.undo();
+		ASSERT_EQ(list.getLength(), 2);
+
+		list.redo();
+		list.redo();
+		ASSERT_EQ(list[1].value, 20);
+		ASSERT_EQ(list[2].name, "THIRD");
+
+		// Length changes through getList() fall back to a snapshot.
+		list.getList().clear();
+		list.writeToFile();
+		ASSERT_EQ(list.getLength(), 0);
+		list.undo();
+		ASSERT_EQ(list.getLength(), 3);
+		ASSERT_EQ(list[2].name, "THIRD");
+	}
+	// Joining the IO thread makes sure that every write reached the file.
+	bbe::simpleFile::backup::async::stopIoThread();
+	{
+		bbe::SerializableList<UndoableEntry> list(path, "", bbe::Undoable::YES);
+		ASSERT_EQ(list.getLength(), 3);
+		ASSERT_EQ(list[1].value, 20);
+		ASSERT_EQ(list[2].name, "THIRD");
+		ASSERT_FALSE(list.canUndo());
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	bbe::simpleFile::deleteFile(path);
+}
+
+namespace
+{
+	struct CountedEntry
+	{
+		static inline int32_t amountOfSerializations = 0;
+		int32_t value = 0;
+
+		void serialize(bbe::ByteBuffer& buffer) const
+		{
+			amountOfSerializations++;
+			int32_t copy = value;
+			buffer.write(copy);
+		}
+
+		static CountedEntry deserialize(bbe::ByteBufferSpan& buffer)
+		{
+			CountedEntry entry;
+			buffer.read(entry.value);
+			return entry;
+		}
+	};
+}
+
+TEST(SerializableList, EditsOnlySerializeWhatChanged)
+{
+	const bbe::String path = "SerializableListDirtyTest.dat";
+	bbe::simpleFile::deleteFile(path);
+	{
+		bbe::SerializableList<CountedEntry> list(path, "", bbe::Undoable::YES);
+		for (int32_t i = 0; i < 100; i++)
+		{
+			CountedEntry entry;
+			entry.value = i;
+			list.add(entry);
+		}
+
+		// None of these may serialize the whole list.
+		CountedEntry::amountOfSerializations = 0;
+		list.swap(3, 7);
+		list.removeIndex(50);
+		list[10].value = 1000;
+		list.swap(0, 1);
+		list.undo();
+		list.undo();
+		list.redo();
+		list.undo();
+		list.redo();
+		list.redo();
+		ASSERT_LT(CountedEntry::amountOfSerializations, 20);
+
+		ASSERT_EQ(list.getLength(), 99);
+		ASSERT_EQ(list[0].value, 1);
+		ASSERT_EQ(list[1].value, 0);
+		ASSERT_EQ(list[3].value, 7);
+		ASSERT_EQ(list[7].value, 3);
+		ASSERT_EQ(list[10].value, 1000);
+		ASSERT_EQ(list[50].value, 51);
+
+		list.undo();
+		list.undo();
+		list.undo();
+		ASSERT_EQ(list.getLength(), 100);
+		ASSERT_EQ(list[10].value, 10);
+		ASSERT_EQ(list[50].value, 50);
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	{
+		// The file got every undo and redo.
+		bbe::SerializableList<CountedEntry> list(path);
+		ASSERT_EQ(list.getLength(), 100);
+		ASSERT_EQ(list[3].value, 7);
+		ASSERT_EQ(list[7].value, 3);
+		ASSERT_EQ(list[10].value, 10);
+		ASSERT_EQ(list[50].value, 50);
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	bbe::simpleFile::deleteFile(path);
+}
+
+TEST(SerializableList, ReadsDontPileUpDirtyElements)
+{
+	const bbe::String path = "SerializableListReadTest.dat";
+	bbe::simpleFile::deleteFile(path);
+	{
+		bbe::SerializableList<CountedEntry> list(path, "", bbe::Undoable::YES);
+		for (int32_t i = 0; i < 100; i++)
+		{
+			CountedEntry entry;
+			entry.value = i;
+			list.add(entry);
+		}
+
+		// Like a game that reads every element through the non const operator[] every frame.
+		int32_t sum = 0;
+		for (int32_t frame = 0; frame < 100; frame++)
+		{
+			for (size_t i = 0; i < list.getLength(); i++)
+			{
+				sum += list[i].value;
+			}
+		}
+		ASSERT_EQ(sum, 100 * 4950);
+
+		// Every element is compared once, not once per read.
+		CountedEntry::amountOfSerializations = 0;
+		CountedEntry entry;
+		list.add(entry);
+		ASSERT_LE(CountedEntry::amountOfSerializations, 101);
+
+		CountedEntry::amountOfSerializations = 0;
+		list.swap(0, 1);
+		ASSERT_LT(CountedEntry::amountOfSerializations, 5);
+	}
+	bbe::simpleFile::backup::async::stopIoThread();
+	bbe::simpleFile::deleteFile(path);
+}
@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+#include "BBE/BrotBoxEngine.h"
+
+static bbe::ViewFrustum createFrustum()
+{
+	// Looking along +x from the origin, z is up.
+	const bbe::Matrix4 view = bbe::Matrix4::createViewMatrix(bbe::Vector3(0, 0, 0), bbe::Vector3(1, 0, 0), bbe::Vector3(0, 0, 1));
+	const bbe::Matrix4 projection = bbe::Matrix4::createPerspectiveMatrix(bbe::Math::toRadians(90.0f), 1.0f, 0.1f, 100.0f);
+	return bbe::ViewFrustum(projection * view);
+}
+
+TEST(ViewFrustum, Spheres)
+{
+	const bbe::ViewFrustum frustum = createFrustum();
+
+	ASSERT_TRUE (frustum.isSphereVisible(bbe::Vector3(   10,    0,    0), 1));
+	ASSERT_TRUE (frustum.isSphereVisible(bbe::Vector3(   10,    9,   -9), 1));
+	ASSERT_FALSE(frustum.isSphereVisible(bbe::Vector3(  -10,    0,    0), 1));
+	ASSERT_FALSE(frustum.isSphereVisible(bbe::Vector3(  110,    0,    0), 1));
+	ASSERT_FALSE(frustum.isSphereVisible(bbe::Vector3(   10,   20,    0), 1));
+	ASSERT_FALSE(frustum.isSphereVisible(bbe::Vector3(   10,    0,  -20), 1));
+
+	// Only touching the frustum is enough.
+	ASSERT_TRUE (frustum.isSphereVisible(bbe::Vector3(  -0.5f, 0,    0), 1));
+	ASSERT_TRUE (frustum.isSphereVisible(bbe::Vector3(  100.5f, 0,   0), 1));
+	ASSERT_TRUE (frustum.isSphereVisible(bbe::Vector3(   10,   11,    0), 1.5f));
+}
+
+TEST(ViewFrustum, Aabbs)
+{
+	const bbe::ViewFrustum frustum = createFrustum();
+
+	ASSERT_TRUE (frustum.isAabbVisible(bbe::Vector3(  10, 0, 0), bbe::Vector3(0.5f)));
+	ASSERT_FALSE(frustum.isAabbVisible(bbe::Vector3( -10, 0, 0), bbe::Vector3(0.5f)));
+	ASSERT_FALSE(frustum.isAabbVisible(bbe::Vector3( 200, 0, 0), bbe::Vector3(0.5f)));
+	ASSERT_FALSE(frustum.isAabbVisible(bbe::Vector3(  10, 0, 12), bbe::Vector3(0.5f)));
+	ASSERT_TRUE (frustum.isAabbVisible(bbe::Vector3(  10, 0, 12), bbe::Vector3(0.5f, 0.5f, 3)));
+	// A huge box around the camera.
+	ASSERT_TRUE (frustum.isAabbVisible(bbe::Vector3(   0, 0, 0), bbe::Vector3(1000)));
+
+	// A unit cube that is scaled and moved into view.
+	const bbe::Matrix4 inView = bbe::Matrix4::createTransform(bbe::Vector3(10, 0, 0), bbe::Vector3(2), bbe::Vector3(0, 0, 1), 0.7f);
+	const bbe::Matrix4 behind = bbe::Matrix4::createTransform(bbe::Vector3(-10, 0, 0), bbe::Vector3(2), bbe::Vector3(0, 0, 1), 0.7f);
+	const bbe::Matrix4 stretched = bbe::Matrix4::createTransform(bbe::Vector3(-10, 0, 0), bbe::Vector3(30, 1, 1), bbe::Vector3(0, 0, 1), 0.0f);
+	ASSERT_TRUE (frustum.isAabbVisible(inView, bbe::Vector3(0), bbe::Vector3(0.5f)));
+	ASSERT_FALSE(frustum.isAabbVisible(behind, bbe::Vector3(0), bbe::Vector3(0.5f)));
+	ASSERT_TRUE (frustum.isAabbVisible(stretched, bbe::Vector3(0), bbe::Vector3(0.5f)));
+}
+
+TEST(ViewFrustum, MatchesScalarReference)
+{
+	bbe::Random rand;
+	rand.setSeed(7);
+	const bbe::Matrix4 view = bbe::Matrix4::createViewMatrix(bbe::Vector3(3, -2, 1), bbe::Vector3(-4, 5, 2), bbe::Vector3(0, 0, 1));
+	const bbe::Matrix4 projection = bbe::Matrix4::createPerspectiveMatrix(bbe::Math::toRadians(60.0f), 16.0f / 9.0f, 0.5f, 40.0f);
+	const bbe::ViewFrustum frustum(projection * view);
+
+	int32_t amountOfVisible = 0;
+	int32_t amountOfTests = 0;
+	for (int32_t i = 0; i < 5000; i++)
+	{
+		const bbe::Vector3 center(rand.randomFloat() * 100 - 50, rand.randomFloat() * 100 - 50, rand.randomFloat() * 100 - 50);
+		const bbe::Vector3 extent(rand.randomFloat() * 5, rand.randomFloat() * 5, rand.randomFloat() * 5);
+		const float radius = extent.x;
+
+		float minAabbDistance = 1e30f;
+		float minSphereDistance = 1e30f;
+		for (size_t k = 0; k < bbe::ViewFrustum::amountOfPlanes; k++)
+		{
+			const bbe::Vector4 plane = frustum.getPlane(k);
+			const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+			const float reach = bbe::Math::abs(plane.x) * extent.x + bbe::Math::abs(plane.y) * extent.y + bbe::Math::abs(plane.z) * extent.z;
+			minAabbDistance = bbe::Math::min(minAabbDistance, distance + reach);
+			minSphereDistance = bbe::Math::min(minSphereDistance, distance + radius);
+		}
+
+		// Rounding may go either way right at a plane.
+		if (bbe::Math::abs(minAabbDistance) > 0.001f)
+		{
+			ASSERT_EQ(frustum.isAabbVisible(center, extent), minAabbDistance >= 0) << i;
+			amountOfTests++;
+			if (minAabbDistance >= 0) amountOfVisible++;
+		}
+		if (bbe::Math::abs(minSphereDistance) > 0.001f)
+		{
+			ASSERT_EQ(frustum.isSphereVisible(center, radius), minSphereDistance >= 0) << i;
+		}
+	}
+	// Make sure both outcomes were actually tested.
+	ASSERT_GT(amountOfVisible, 100);
+	ASSERT_LT(amountOfVisible, amountOfTests - 100);
+}